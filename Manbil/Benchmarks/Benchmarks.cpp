@@ -0,0 +1,383 @@
+#include "Benchmarks.h"
+
+#include <iostream>
+#include <memory>
+#include <cstdio>
+#include <SFML/System/Clock.hpp>
+
+#include "../Threading/ThreadPool.h"
+#include "../Math/Higher Math/BumpmapToNormalmap.h"
+#include "../Math/Noise Generation/Perlin.h"
+#include "../Math/Noise Generation/Worley.h"
+#include "../Math/Noise Generation/LayeredOctave.h"
+#include "../IO/XmlSerialization.h"
+#include "../IO/BinarySerialization.h"
+#include "../K1LL/Level Info/LevelInfo.h"
+#include "../K1LL/Room Editor/RoomCollection.h"
+
+
+namespace
+{
+    //The number of times each benchmark is run. The fastest run is the one that's reported.
+    const unsigned int N_RUNS = 3;
+
+
+    template<typename Func>
+    //Runs "func()" a few times and returns the fastest time, in milliseconds.
+    float TimeBest(Func func)
+    {
+        sf::Clock clock;
+        float best = std::numeric_limits<float>::max();
+        for (unsigned int i = 0; i < N_RUNS; ++i)
+        {
+            clock.restart();
+            func();
+            best = Mathf::Min(best, clock.getElapsedTime().asSeconds() * 1000.0f);
+        }
+        return best;
+    }
+
+    template<typename Func>
+    //Times "func(ThreadPool* threads)" with 1, 2, 4, and 8 threads
+    //    (and every hardware thread, if there are more than that), printing each time on one line.
+    //With 1 thread, "func" is given a null pool.
+    void TimeThreadCounts(const std::string& name, Func func)
+    {
+        std::cout << name << ":";
+
+        unsigned int maxThreads = Mathf::Max(8U, ThreadPool::GetNHardwareThreads());
+        for (unsigned int nThreads = 1; nThreads <= maxThreads; nThreads *= 2)
+        {
+            //The thread calling into the pool also does work, so it needs one less worker.
+            std::unique_ptr<ThreadPool> threads;
+            if (nThreads > 1)
+                threads.reset(new ThreadPool(nThreads - 1));
+
+            ThreadPool* threadsPtr = threads.get();
+            float ms = TimeBest([&func, threadsPtr]() { func(threadsPtr); });
+            std::cout << "  " << nThreads << "T " << ms << "ms";
+
+            //Make sure the hardware thread count gets its own timing.
+            if (nThreads < maxThreads && nThreads * 2 > maxThreads)
+                nThreads = maxThreads / 2;
+        }
+
+        std::cout << "\n";
+    }
+
+    //A big list of floats, written either one element at a time or as a single block of bytes.
+    struct FloatList : public ISerializable
+    {
+        std::vector<float> Values;
+        bool AsOneBlock = false;
+
+        virtual void WriteData(DataWriter* writer) const override
+        {
+            if (AsOneBlock)
+            {
+                writer->WriteTrivialCollection(Values, "Values");
+            }
+            else
+            {
+                writer->WriteCollection(Values,
+                                        [](DataWriter* writer, const float& value, unsigned int)
+                                        {
+                                            writer->WriteFloat(value, "Value");
+                                        }, "Values");
+            }
+        }
+        virtual void ReadData(DataReader* reader) override
+        {
+            if (AsOneBlock)
+            {
+                reader->ReadTrivialCollection(Values);
+            }
+            else
+            {
+                reader->ReadCollection(Values,
+                                       [](DataReader* reader, float& outValue, unsigned int)
+                                       {
+                                           reader->ReadFloat(outValue);
+                                       });
+            }
+        }
+    };
+
+    //Times writing "toWrite" to an XML file and reading it back into "toRead", then deletes the file.
+    void TimeXml(const std::string& name, const IWritable& toWrite, IReadable& toRead)
+    {
+        const std::string path = "Benchmark.xml";
+
+        float writeMs = TimeBest([&toWrite, &path]()
+        {
+            XmlWriter writer("Benchmark");
+            writer.WriteDataStructure(toWrite, "Data");
+
+            std::string err = writer.SaveData(path);
+            if (!err.empty())
+                std::cout << "Error saving " << path << ": " << err << "\n";
+        });
+        float readMs = TimeBest([&toRead, &path]()
+        {
+            XmlReader reader(path);
+            if (!reader.ErrorMessage.empty())
+            {
+                std::cout << "Error opening " << path << ": " << reader.ErrorMessage << "\n";
+                return;
+            }
+
+            try
+            {
+                reader.ReadDataStructure(toRead);
+            }
+            catch (int ex)
+            {
+                assert(ex == DataReader::EXCEPTION_FAILURE);
+                std::cout << "Error reading " << path << ": " << reader.ErrorMessage << "\n";
+            }
+        });
+
+        std::remove(path.c_str());
+        std::cout << name << ", XML:  write " << writeMs << "ms  read " << readMs << "ms\n";
+    }
+    //Times writing "toWrite" to a binary file and reading it back into "toRead", then deletes the file.
+    void TimeBinary(const std::string& name, const IWritable& toWrite, IReadable& toRead)
+    {
+        const std::string path = "Benchmark.bin";
+
+        float writeMs = TimeBest([&toWrite, &path]()
+        {
+            BinaryWriter writer(true);
+            writer.WriteDataStructure(toWrite, "Data");
+
+            std::string err = writer.SaveData(path);
+            if (!err.empty())
+                std::cout << "Error saving " << path << ": " << err << "\n";
+        });
+        float readMs = TimeBest([&toRead, &path]()
+        {
+            BinaryReader reader(true, path);
+            if (!reader.ErrorMessage.empty())
+            {
+                std::cout << "Error opening " << path << ": " << reader.ErrorMessage << "\n";
+                return;
+            }
+
+            try
+            {
+                reader.ReadDataStructure(toRead);
+            }
+            catch (int ex)
+            {
+                assert(ex == DataReader::EXCEPTION_FAILURE);
+                std::cout << "Error reading " << path << ": " << reader.ErrorMessage << "\n";
+            }
+        });
+
+        std::remove(path.c_str());
+        std::cout << name << ", binary:  write " << writeMs << "ms  read " << readMs << "ms\n";
+    }
+
+    //Gets the block at the given spot in a made-up room: walls around the edges with a doorway
+    //    in the middle of each side, and a scattering of walls and spawns inside.
+    BlockTypes GetTestBlock(Vector2u pos, unsigned int roomSize, unsigned int seed)
+    {
+        bool isEdge = (pos.x == 0 || pos.y == 0 || pos.x == roomSize - 1 || pos.y == roomSize - 1);
+        if (isEdge)
+            return (pos.x == roomSize / 2 || pos.y == roomSize / 2) ? BT_DOORWAY : BT_WALL;
+
+        unsigned int hash = (pos.x * 73856093) ^ (pos.y * 19349663) ^ (seed * 83492791);
+        switch (hash % 16)
+        {
+            case 0: return BT_WALL;
+            case 1: return BT_SPAWN;
+            default: return BT_NONE;
+        }
+    }
+
+    //Fills the given heightmap with bumps that vary in every direction.
+    void MakeHeightmap(unsigned int size, Array2D<float>& outHeights)
+    {
+        outHeights.Reset(size, size);
+        for (Vector2u pos(0, 0); pos.y < size; ++pos.y)
+            for (pos.x = 0; pos.x < size; ++pos.x)
+                outHeights[pos] = 0.5f + (0.25f * sinf(pos.x * 0.05f)) + (0.25f * cosf(pos.y * 0.08f));
+    }
+}
+
+
+void Benchmarks::NormalMaps(void)
+{
+    std::cout << "BumpmapToNormalmap:\n";
+
+    const unsigned int sizes[] = { 256, 1024, 2048, 4096 };
+    const BumpmapToNormalmap::Filters filters[] = { BumpmapToNormalmap::F_TRIANGLES,
+                                                    BumpmapToNormalmap::F_CENTRAL_DIFFERENCE,
+                                                    BumpmapToNormalmap::F_SOBEL };
+    const char* filterNames[] = { "triangles", "central difference", "sobel" };
+
+    Array2D<float> heights(1, 1);
+    Array2D<Vector3f> normals(1, 1);
+    Array2D<Vector4b> pixels(1, 1);
+    for (unsigned int sizeI = 0; sizeI < sizeof(sizes) / sizeof(sizes[0]); ++sizeI)
+    {
+        unsigned int size = sizes[sizeI];
+        MakeHeightmap(size, heights);
+        std::string sizeName = std::to_string(size) + "^2";
+
+        for (unsigned int filterI = 0; filterI < sizeof(filters) / sizeof(filters[0]); ++filterI)
+        {
+            BumpmapToNormalmap::Filters filter = filters[filterI];
+            TimeThreadCounts(sizeName + ", " + filterNames[filterI] + ", Vector3f",
+                             [&](ThreadPool* threads)
+                             {
+                                 BumpmapToNormalmap::Convert(heights, 8.0f, true, normals,
+                                                             filter, threads);
+                             });
+            TimeThreadCounts(sizeName + ", " + filterNames[filterI] + ", Vector4b",
+                             [&](ThreadPool* threads)
+                             {
+                                 BumpmapToNormalmap::Convert(heights, 8.0f, pixels, filter, threads);
+                             });
+        }
+
+        TimeThreadCounts(sizeName + ", triangles, Vector4b in 512^2 tiles",
+                         [&](ThreadPool* threads)
+                         {
+                             BumpmapToNormalmap::ConvertTiled(heights, 8.0f,
+                                                              [](Vector2u, const Array2D<Vector4b>&) { },
+                                                              BumpmapToNormalmap::DEFAULT_TILE_SIZE,
+                                                              BumpmapToNormalmap::F_TRIANGLES, threads);
+                         });
+    }
+
+    std::cout << "\n";
+}
+void Benchmarks::NoiseGeneration(void)
+{
+    std::cout << "Noise generation:\n";
+
+    Perlin2D perlin2(64.0f, Perlin2D::Quintic);
+    Worley2D worley2;
+    Perlin2D octave2s[3] = { Perlin2D(128.0f, Perlin2D::Quintic, Vector2i(), 1),
+                             Perlin2D(32.0f, Perlin2D::Quintic, Vector2i(), 2),
+                             Perlin2D(8.0f, Perlin2D::Quintic, Vector2i(), 3) };
+    const Generator2D* octave2Ptrs[3] = { &octave2s[0], &octave2s[1], &octave2s[2] };
+    const float octaveWeights[3] = { 0.6f, 0.3f, 0.1f };
+    LayeredOctave2D layered2(3, octaveWeights, octave2Ptrs);
+
+    const unsigned int sizes2D[] = { 512, 1024, 2048, 4096 };
+    Noise2D noise2(1, 1);
+    for (unsigned int sizeI = 0; sizeI < sizeof(sizes2D) / sizeof(sizes2D[0]); ++sizeI)
+    {
+        unsigned int size = sizes2D[sizeI];
+        noise2.Reset(size, size);
+        std::string sizeName = std::to_string(size) + "^2";
+
+        TimeThreadCounts(sizeName + ", Perlin", [&](ThreadPool* threads)
+        {
+            perlin2.Threads = threads;
+            perlin2.Generate(noise2);
+        });
+        TimeThreadCounts(sizeName + ", Worley", [&](ThreadPool* threads)
+        {
+            worley2.Threads = threads;
+            worley2.Generate(noise2);
+        });
+        TimeThreadCounts(sizeName + ", 3 Perlin octaves", [&](ThreadPool* threads)
+        {
+            for (unsigned int i = 0; i < 3; ++i)
+                octave2s[i].Threads = threads;
+            layered2.Threads = threads;
+            layered2.Generate(noise2);
+        });
+    }
+
+    Perlin3D perlin3(16.0f, Perlin3D::Quintic);
+    Worley3D worley3;
+    worley3.CellSize = 16;
+    Perlin3D octave3s[3] = { Perlin3D(32.0f, Perlin3D::Quintic, Vector3i(), 1),
+                             Perlin3D(8.0f, Perlin3D::Quintic, Vector3i(), 2),
+                             Perlin3D(2.0f, Perlin3D::Quintic, Vector3i(), 3) };
+    const Generator3D* octave3Ptrs[3] = { &octave3s[0], &octave3s[1], &octave3s[2] };
+    LayeredOctave3D layered3(3, octaveWeights, octave3Ptrs);
+
+    const unsigned int sizes3D[] = { 64, 128, 256 };
+    Noise3D noise3(1, 1, 1);
+    for (unsigned int sizeI = 0; sizeI < sizeof(sizes3D) / sizeof(sizes3D[0]); ++sizeI)
+    {
+        unsigned int size = sizes3D[sizeI];
+        noise3.Reset(size, size, size);
+        std::string sizeName = std::to_string(size) + "^3";
+
+        TimeThreadCounts(sizeName + ", Perlin", [&](ThreadPool* threads)
+        {
+            perlin3.Threads = threads;
+            perlin3.Generate(noise3);
+        });
+        TimeThreadCounts(sizeName + ", Worley", [&](ThreadPool* threads)
+        {
+            worley3.Threads = threads;
+            worley3.Generate(noise3);
+        });
+        TimeThreadCounts(sizeName + ", 3 Perlin octaves", [&](ThreadPool* threads)
+        {
+            for (unsigned int i = 0; i < 3; ++i)
+                octave3s[i].Threads = threads;
+            layered3.Threads = threads;
+            layered3.Generate(noise3);
+        });
+    }
+
+    std::cout << "\n";
+}
+void Benchmarks::Serialization(void)
+{
+    std::cout << "Serialization:\n";
+
+    //A level with a 32x32 grid of 24x24 rooms.
+    const unsigned int levelWidth = 32,
+                       roomSize = 24;
+    LevelInfo level, levelCopy;
+    for (unsigned int y = 0; y < levelWidth; ++y)
+    {
+        for (unsigned int x = 0; x < levelWidth; ++x)
+        {
+            Array2D<BlockTypes> walls(roomSize, roomSize);
+            for (Vector2u pos(0, 0); pos.y < roomSize; ++pos.y)
+                for (pos.x = 0; pos.x < roomSize; ++pos.x)
+                    walls[pos] = GetTestBlock(pos, roomSize, level.Rooms.size());
+
+            level.Rooms.push_back(LevelInfo::RoomData(walls, Vector2u(x, y) * (roomSize - 1),
+                                                      IT_NONE, (float)roomSize));
+        }
+    }
+    std::string levelName = std::to_string(level.Rooms.size()) + " rooms of " +
+                                std::to_string(roomSize) + "^2 in a level";
+    TimeXml(levelName, level, levelCopy);
+    TimeBinary(levelName, level, levelCopy);
+
+    //The same rooms, as a room collection.
+    RoomCollection rooms, roomsCopy;
+    rooms.Rooms.resize(level.Rooms.size());
+    for (unsigned int i = 0; i < level.Rooms.size(); ++i)
+        rooms.Rooms[i].RoomGrid = level.Rooms[i].Walls;
+    std::string roomsName = std::to_string(rooms.Rooms.size()) + " rooms of " +
+                                std::to_string(roomSize) + "^2 in a room collection";
+    TimeXml(roomsName, rooms, roomsCopy);
+    TimeBinary(roomsName, rooms, roomsCopy);
+
+    //A big list of floats, first element by element, then as one block.
+    FloatList floats, floatsCopy;
+    floats.Values.resize(1 << 20);
+    for (unsigned int i = 0; i < floats.Values.size(); ++i)
+        floats.Values[i] = sinf((float)i);
+    TimeXml("2^20 floats one at a time", floats, floatsCopy);
+    TimeBinary("2^20 floats one at a time", floats, floatsCopy);
+    floats.AsOneBlock = true;
+    floatsCopy.AsOneBlock = true;
+    TimeXml("2^20 floats as one block", floats, floatsCopy);
+    TimeBinary("2^20 floats as one block", floats, floatsCopy);
+
+    std::cout << "\n";
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+
+//Timing runs for the engine's heavier CPU-side work, for checking how much an optimization actually helps.
+//None of them need a window or a rendering context, so they can be run straight from "main()"
+//    instead of a world. Each one prints its results to the console.
+//Every timing is the fastest of a few runs, in milliseconds.
+class Benchmarks
+{
+public:
+
+    //Times "BumpmapToNormalmap" on square heightmaps of several sizes, for each filter,
+    //    for both float and packed output, and with different numbers of threads.
+    static void NormalMaps(void);
+    //Times Perlin, Worley, and layered-octave noise generation at sizes up to 4096^2 and 256^3,
+    //    with different numbers of threads.
+    static void NoiseGeneration(void);
+    //Times writing and reading a large level and room collection as XML and binary files,
+    //    plus a big collection of floats written element-by-element and as one block.
+    //The files are written to the current directory and deleted afterwards.
+    static void Serialization(void);
+};
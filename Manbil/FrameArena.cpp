@@ -0,0 +1,134 @@
+#include "FrameArena.h"
+
+#include <assert.h>
+#include <mutex>
+#include <memory>
+
+
+#ifdef _MSC_VER
+    #define FRAME_ARENA_THREAD_LOCAL __declspec(thread)
+#else
+    #define FRAME_ARENA_THREAD_LOCAL __thread
+#endif
+
+
+namespace
+{
+    //Each thread's arena. Only plain pointers can be thread-local on every compiler we use.
+    FRAME_ARENA_THREAD_LOCAL FrameArena* threadArena = 0;
+
+    //Owns every thread's arena, so they're cleaned up when the program ends.
+    std::mutex allArenasLock;
+    std::vector<std::unique_ptr<FrameArena>> allArenas;
+}
+
+
+FrameArena& FrameArena::GetThreadArena(void)
+{
+    if (threadArena == 0)
+    {
+        threadArena = new FrameArena();
+
+        std::lock_guard<std::mutex> lock(allArenasLock);
+        allArenas.push_back(std::unique_ptr<FrameArena>(threadArena));
+    }
+
+    return *threadArena;
+}
+
+
+FrameArena::FrameArena(size_t _blockSize)
+    : currentBlock(0), currentOffset(0), blockSize(_blockSize), nBlockAllocations(0)
+{
+
+}
+FrameArena::~FrameArena(void)
+{
+    for (unsigned int i = 0; i < blocks.size(); ++i)
+        delete[] blocks[i].Memory;
+}
+
+void* FrameArena::Allocate(size_t nBytes, size_t alignment)
+{
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    while (true)
+    {
+        //If there are no more blocks to use, get a new one.
+        if (currentBlock >= blocks.size())
+        {
+            AddBlock(nBytes + alignment);
+            currentBlock = (unsigned int)blocks.size() - 1;
+            currentOffset = 0;
+        }
+
+        //Try to fit the allocation into the current block.
+        const Block& block = blocks[currentBlock];
+        size_t start = AlignOffset(block, currentOffset, alignment);
+        if (start + nBytes <= block.Size)
+        {
+            currentOffset = start + nBytes;
+            return block.Memory + start;
+        }
+
+        //Move on to the next block.
+        currentBlock += 1;
+        currentOffset = 0;
+    }
+}
+
+void FrameArena::RewindTo(Marker marker)
+{
+    assert(marker.Block < currentBlock ||
+           (marker.Block == currentBlock && marker.Offset <= currentOffset));
+
+    currentBlock = marker.Block;
+    currentOffset = marker.Offset;
+}
+void FrameArena::Reset(void)
+{
+    if (blocks.size() > 1)
+    {
+        size_t totalSize = GetCapacity();
+
+        for (unsigned int i = 0; i < blocks.size(); ++i)
+            delete[] blocks[i].Memory;
+        blocks.clear();
+
+        AddBlock(totalSize);
+    }
+
+    currentBlock = 0;
+    currentOffset = 0;
+}
+
+size_t FrameArena::GetNBytesUsed(void) const
+{
+    size_t total = currentOffset;
+    for (unsigned int i = 0; i < currentBlock && i < blocks.size(); ++i)
+        total += blocks[i].Size;
+    return total;
+}
+size_t FrameArena::GetCapacity(void) const
+{
+    size_t total = 0;
+    for (unsigned int i = 0; i < blocks.size(); ++i)
+        total += blocks[i].Size;
+    return total;
+}
+
+size_t FrameArena::AlignOffset(const Block& block, size_t offset, size_t alignment)
+{
+    size_t address = (size_t)(block.Memory + offset),
+           alignedAddress = (address + alignment - 1) & ~(alignment - 1);
+    return offset + (alignedAddress - address);
+}
+void FrameArena::AddBlock(size_t minSize)
+{
+    Block block;
+    block.Size = (minSize > blockSize ? minSize : blockSize);
+    block.Memory = new char[block.Size];
+
+    blocks.push_back(block);
+    nBlockAllocations += 1;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include "MemoryAllocator.h"
+
+
+//A fast allocator for short-lived memory: allocating just moves a pointer forward,
+//    "Deallocate()" does nothing, and everything is freed at once by rewinding or resetting.
+//Each thread has its own arena, from "GetThreadArena()". The main thread's arena is reset
+//    at the start of every frame by "SFMLWorld", so memory from it lasts until the end of the frame.
+//Code that may run on other threads (or outside of the game loop) should wrap its use
+//    of the arena in a "Scope" so the memory is given back when it's done.
+//Not thread-safe; only use an arena from the thread it belongs to.
+class FrameArena : public MemoryAllocator
+{
+public:
+
+    //A point in an arena's allocations that it can be rewound back to.
+    struct Marker
+    {
+        unsigned int Block;
+        size_t Offset;
+        Marker(unsigned int block = 0, size_t offset = 0) : Block(block), Offset(offset) { }
+    };
+
+    //Rewinds an arena back to where it was when this instance was created,
+    //    freeing everything allocated from it in the meantime.
+    //Anything using that memory (e.x. containers with a "StdAllocator") must be destroyed first,
+    //    so declare the scope before them.
+    class Scope
+    {
+    public:
+        Scope(FrameArena& _arena) : arena(_arena), marker(_arena.GetMarker()) { }
+        ~Scope(void) { arena.RewindTo(marker); }
+
+        Scope(const Scope& cpy) = delete;
+        Scope& operator=(const Scope& cpy) = delete;
+
+    private:
+        FrameArena& arena;
+        Marker marker;
+    };
+
+
+    //Gets the calling thread's arena, creating it if it doesn't exist yet.
+    static FrameArena& GetThreadArena(void);
+
+
+    //"blockSize" is the size of each chunk of memory the arena grabs from the heap.
+    //Allocations that don't fit in a block get their own bigger block.
+    FrameArena(size_t blockSize = 1024 * 1024);
+    ~FrameArena(void);
+
+    FrameArena(const FrameArena& cpy) = delete;
+    FrameArena& operator=(const FrameArena& cpy) = delete;
+
+
+    virtual void* Allocate(size_t nBytes, size_t alignment = DEFAULT_ALIGNMENT) override;
+    //Does nothing; memory is only given back by "RewindTo()" and "Reset()".
+    virtual void Deallocate(void*) override { }
+
+
+    Marker GetMarker(void) const { return Marker(currentBlock, currentOffset); }
+    //Frees everything that was allocated since the given marker was gotten.
+    void RewindTo(Marker marker);
+
+    //Frees everything in this arena.
+    //If more than one block of memory was needed since the last reset, they're all merged
+    //    into one big block so that the same amount of allocation won't touch the heap next time.
+    void Reset(void);
+
+
+    //Gets the number of bytes currently allocated from this arena, including alignment padding.
+    size_t GetNBytesUsed(void) const;
+    //Gets the total size of the blocks this arena has gotten from the heap.
+    size_t GetCapacity(void) const;
+    //Gets the number of times this arena has had to get a new block from the heap.
+    unsigned int GetNBlockAllocations(void) const { return nBlockAllocations; }
+
+
+private:
+
+    struct Block
+    {
+        char* Memory;
+        size_t Size;
+    };
+
+    std::vector<Block> blocks;
+    unsigned int currentBlock;
+    size_t currentOffset;
+
+    size_t blockSize;
+    unsigned int nBlockAllocations;
+
+
+    //Gets the offset of the first spot at or after "offset" in the given block
+    //    that has the given alignment.
+    static size_t AlignOffset(const Block& block, size_t offset, size_t alignment);
+    //Adds a new block to the end of the list that can hold at least the given number of bytes.
+    void AddBlock(size_t minSize);
+};
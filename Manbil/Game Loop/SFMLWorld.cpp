@@ -10,7 +10,8 @@ typedef sf::Clock Clock;
 
 SFMLWorld::SFMLWorld(int windWidth, int windHeight)
     : totalElapsedSeconds(0.0f), window(0),
-      windowWidth(windWidth), windowHeight(windHeight)
+      windowWidth(windWidth), windowHeight(windHeight),
+      nHeapAllocationsAtFrameStart(0), nHeapAllocationsLastFrame(0)
 {
     window = 0;
 }
@@ -39,9 +40,16 @@ void SFMLWorld::RunWorld(void)
     windowHasFocus = true;
 
 	cl.restart();
+    nHeapAllocationsAtFrameStart = MemoryAllocator::GetNHeapAllocations();
 
 	while (window->isOpen() && !worldOver)
 	{
+        //Free the last frame's temporary memory and track how much it used the heap.
+        FrameArena::GetThreadArena().Reset();
+        unsigned int nHeapAllocations = MemoryAllocator::GetNHeapAllocations();
+        nHeapAllocationsLastFrame = nHeapAllocations - nHeapAllocationsAtFrameStart;
+        nHeapAllocationsAtFrameStart = nHeapAllocations;
+
 		//Handle window events first.
 		while (window->pollEvent(windowEvent))
 		{
@@ -4,6 +4,7 @@
 #include <SFML/Graphics.hpp>
 #include "../Input/InputManager.h"
 #include "../Events/Timing.h"
+#include "../FrameArena.h"
 
 
 
@@ -22,6 +23,9 @@ public:
 
     bool IsWindowInFocus(void) const { return windowHasFocus; }
 
+    //Gets the number of heap allocations (from any thread) during the last frame.
+    unsigned int GetNHeapAllocationsLastFrame(void) const { return nHeapAllocationsLastFrame; }
+
 	bool IsGameOver(void) const { return worldOver; }
 	
 	void EndWorld(void) { worldOver = true; }
@@ -89,4 +93,6 @@ private:
 
 	bool worldOver;
     bool windowHasFocus;
+
+    unsigned int nHeapAllocationsAtFrameStart, nHeapAllocationsLastFrame;
 };
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Graph.h"
 #include "IndexedPriorityQueue.h"
 #include "GraphSearchGoal.h"
+#include "../FrameArena.h"
 
 
 
@@ -26,6 +27,7 @@ class AStarSearch
 public:
 
     typedef Graph<NodeType, EdgeType>* GraphPtrRaw;
+    typedef typename Graph<NodeType, EdgeType>::EdgeList EdgeList;
     
     
     //User-specified data that will get passed into edges' cost-calculation methods.
@@ -46,18 +48,23 @@ public:
                 float& outTravelCost, float& outSearchCost, std::vector<NodeType>& outPath,
                 float maxSearchCost = -1.0f) const
     {
+        //All the temporary data for the search comes from this thread's arena,
+        //    which is rewound once the search is done.
+        FrameArena& arena = FrameArena::GetThreadArena();
+        FrameArena::Scope arenaScope(arena);
+
         //Each node will be indexed to the connecting node that takes you back towards the start node.
-        std::unordered_map<NodeType, NodeType, NodeHasher> pathTree;
+        NodeMap<NodeType> pathTree((NodeMapAllocator<NodeType>(arena)));
         //Each node will be indexed by the cost to traverse to it from the start node.
-        std::unordered_map<NodeType, float, NodeHasher> costToTraverseToNode;
+        NodeMap<float> costToTraverseToNode((NodeMapAllocator<float>(arena)));
         //Each node will be indexed by the cost to search to it from the start node.
-        std::unordered_map<NodeType, float, NodeHasher> costToSearchToNode;
+        NodeMap<float> costToSearchToNode((NodeMapAllocator<float>(arena)));
 
         //All nodes that have been searched already.
-        std::vector<NodeType> consideredNodes;
+        std::vector<NodeType, StdAllocator<NodeType>> consideredNodes((StdAllocator<NodeType>(arena)));
 
         //A temp list used inside the main loop.
-        std::vector<EdgeType> tempConnections;
+        EdgeList tempConnections((StdAllocator<EdgeType>(arena)));
 
         //The connections that need to be searched next.
         IndexedPriorityQueue<EdgeType> edgesToSearch;
@@ -183,10 +190,18 @@ public:
 
 private:
 
+    //The allocator for a dictionary from nodes to some kind of value.
+    template<typename ValueType>
+    using NodeMapAllocator = StdAllocator<std::pair<const NodeType, ValueType>>;
+    //A dictionary from nodes to some kind of value, stored in a "FrameArena".
+    template<typename ValueType>
+    using NodeMap = std::unordered_map<NodeType, ValueType, NodeHasher,
+                                       std::equal_to<NodeType>, NodeMapAllocator<ValueType>>;
+
+
     //Builds a path between the given start/end nodes using the given "path tree" (a dictionary which
     //    associates each node key with the next node to travel to in order to get back to the start). 
-    void BuildPath(NodeType start, NodeType end,
-                   const std::unordered_map<NodeType, NodeType, NodeHasher>& pathTree,
+    void BuildPath(NodeType start, NodeType end, const NodeMap<NodeType>& pathTree,
                    std::vector<NodeType>& outPath) const
     {
         //The path tree is used to traverse the path in reverse.
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "Edge.h"
+#include "../MemoryAllocator.h"
 
 
 //"NodeType" is the type of item representing a single spot on a graph;
@@ -13,6 +14,9 @@ class Graph
 {
 public:
 
+    //A list of edges. Searches get their lists' memory from a "FrameArena".
+    typedef std::vector<EdgeType, StdAllocator<EdgeType>> EdgeList;
+
     //Gets all edges connecting the given node to another node.
-    virtual void GetConnectedEdges(NodeType startNode, std::vector<EdgeType>& outConnections) const = 0;
+    virtual void GetConnectedEdges(NodeType startNode, EdgeList& outConnections) const = 0;
 };
\ No newline at end of file
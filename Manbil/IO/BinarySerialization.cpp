@@ -45,15 +45,9 @@ void BinaryWriter::WriteSimpleData(unsigned int sizeofType, BinaryDataTypes data
         byteData.insert(byteData.end(), dataType);
     }
 
-    //Reserve space for the data.
-    unsigned int startIndex = byteData.size();
-    for (unsigned int i = 0; i < sizeofType; ++i)
-    {
-        byteData.insert(byteData.end(), 0);
-    }
-
-    //Set the data.
-    memcpy(&byteData.data()[startIndex], pData, sizeofType);
+    //Append the data as one contiguous block.
+    const unsigned char* pBytes = (const unsigned char*)pData;
+    byteData.insert(byteData.end(), pBytes, pBytes + sizeofType);
 }
 
 #pragma warning(disable: 4100)
@@ -81,10 +75,7 @@ void BinaryWriter::WriteBytes(const unsigned char* bytes, unsigned int nBytes, c
     return WriteSimpleData(nBytes, BDT_BYTES, bytes);
 }
 
-void BinaryWriter::WriteCollection(ElementWriter writerFunc, const std::string& name,
-                                   unsigned int bytesPerElement,
-                                   const void* collection, unsigned int collectionSize,
-                                   void* optionalData)
+void BinaryWriter::BeginCollection(const std::string& name, unsigned int nElements)
 {
     //Insert the header describing the data type.
     if (EnsureTypeSafety)
@@ -93,15 +84,10 @@ void BinaryWriter::WriteCollection(ElementWriter writerFunc, const std::string&
     }
 
     //Write the size of the collection.
-    WriteUInt(collectionSize, "size");
-
-    //Write each collection element.
-    for (unsigned int i = 0; i < collectionSize; ++i)
-    {
-        const void* toWrite = ((const char*)collection) + (i * bytesPerElement);
-        writerFunc(this, toWrite, i, optionalData);
-    }
-
+    WriteUInt(nElements, "size");
+}
+void BinaryWriter::EndCollection(void)
+{
     //Insert the footer indicating the end of the data type.
     if (EnsureTypeSafety)
     {
@@ -260,8 +246,7 @@ void BinaryReader::ReadSimpleData(unsigned int sizeofType, BinaryDataTypes expec
     }
 }
 
-void BinaryReader::ReadCollection(ElementReader readerFunc, CollectionResizer resizer,
-                                  void* pCollection, void* optionalData)
+unsigned int BinaryReader::BeginCollection(void)
 {
     //Check the header describing the data type.
     if (EnsureTypeSafety)
@@ -285,14 +270,10 @@ void BinaryReader::ReadCollection(ElementReader readerFunc, CollectionResizer re
     //Read the size of the collection.
     unsigned int readSize;
     ReadUInt(readSize);
-    resizer(pCollection, readSize);
-
-    //Read each collection element.
-    for (unsigned int i = 0; i < readSize; ++i)
-    {
-        readerFunc(this, pCollection, i, optionalData);
-    }
-
+    return readSize;
+}
+void BinaryReader::EndCollection(void)
+{
     //Check that the data structure is at its end.
     if (EnsureTypeSafety)
     {
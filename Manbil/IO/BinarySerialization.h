@@ -58,12 +58,14 @@ public:
     virtual void WriteBytes(const unsigned char* bytes, unsigned int nBytes,
                             const std::string& name) override;
 
-    virtual void WriteCollection(ElementWriter writerFunc, const std::string& name,
-                                 unsigned int bytesPerElement,
-                                 const void* collection, unsigned int collectionSize,
-                                 void* optionalData = 0) override;
-
     virtual void WriteDataStructure(const IWritable& toSerialize, const std::string& name) override;
+
+protected:
+
+    virtual void BeginCollection(const std::string& name, unsigned int nElements) override;
+    virtual void BeginCollectionElement(unsigned int elementIndex) override { }
+    virtual void EndCollectionElement(void) override { }
+    virtual void EndCollection(void) override;
     
 private:
 
@@ -100,11 +102,15 @@ public:
     virtual void ReadString(std::string& outStr) override;
     virtual void ReadBytes(std::vector<unsigned char>& outBytes) override;
 
-    virtual void ReadCollection(ElementReader readerFunc, CollectionResizer resizer,
-                                void* pCollection, void* optionalData = 0) override;
-
     virtual void ReadDataStructure(IReadable& toSerialize) override;
 
+protected:
+
+    virtual unsigned int BeginCollection(void) override;
+    virtual void BeginCollectionElement(unsigned int elementIndex) override { }
+    virtual void EndCollectionElement(void) override { }
+    virtual void EndCollection(void) override;
+
 private:
 
     void ReadSimpleData(unsigned int sizeofType, BinaryDataTypes expectedType,
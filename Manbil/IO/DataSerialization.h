@@ -1,9 +1,11 @@
 #pragma once
 
 #include <assert.h>
+#include <string.h>
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <type_traits>
 
 
 
@@ -61,48 +63,81 @@ public:
     virtual void WriteDataStructure(const IWritable& toSerialize, const std::string& name) = 0;
 
 
-    //A function that writes the given element of a collection using the given DataWriter,
-    //   with optional data passed in.
-    typedef void(*ElementWriter)(DataWriter* writer, const void* elementToWrite,
-                                 unsigned int elementIndex, void* userData);
+    template<typename Collection, typename ElementWriterFunc>
     //Writes a collection of some kind of data.
-    //TODO: Implement this using templates in the same way that "WriteDictionary" is implemented.
-    virtual void WriteCollection(ElementWriter writerFunc, const std::string& name,
-                                 unsigned int bytesPerElement,
-                                 const void* collection, unsigned int collectionSize,
-                                 void* userData = 0) = 0;
+    //The collection must have "size()" and "operator[]" (e.x. std::vector).
+    //The writer function is called for each element with the signature
+    //    "void f(DataWriter* writer, const Element& element, unsigned int elementIndex)",
+    //    and it is inlined into the loop instead of being called through a pointer.
+    void WriteCollection(const Collection& collection, ElementWriterFunc writerFunc,
+                         const std::string& name)
+    {
+        unsigned int size = (unsigned int)collection.size();
+        BeginCollection(name, size);
+        for (unsigned int i = 0; i < size; ++i)
+        {
+            BeginCollectionElement(i);
+            writerFunc(this, collection[i], i);
+            EndCollectionElement();
+        }
+        EndCollection();
+    }
 
+    template<typename T>
+    //Writes a collection of trivially-copyable data (numbers, vectors, POD structs, etc.)
+    //    as a single contiguous block of bytes instead of element-by-element.
+    //Must be read back with "DataReader::ReadTrivialCollection()".
+    //Note that the bytes are written in this machine's layout/endianness.
+    void WriteTrivialCollection(const T* elements, unsigned int nElements, const std::string& name)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "WriteTrivialCollection() only works with trivially-copyable data");
+        WriteBytes((const unsigned char*)elements, nElements * sizeof(T), name);
+    }
+    template<typename T>
+    //Writes a collection of trivially-copyable data (numbers, vectors, POD structs, etc.)
+    //    as a single contiguous block of bytes instead of element-by-element.
+    //Must be read back with "DataReader::ReadTrivialCollection()".
+    void WriteTrivialCollection(const std::vector<T>& elements, const std::string& name)
+    {
+        WriteTrivialCollection(elements.data(), (unsigned int)elements.size(), name);
+    }
 
-    template<typename Key, typename Value>
-    //Writes a key and value pair.
-    using DictElementWriter = void(*)(DataWriter* writer, const Key* k, const Value* v, void* userData);
 
-    template<typename Key, typename Value>
+    template<typename Key, typename Value, typename PairWriterFunc>
     //Writes a set of key-value pairs.
+    //The writer function is called for each pair with the signature
+    //    "void f(DataWriter* writer, const Key& k, const Value& v)".
     void WriteDictionary(const std::unordered_map<Key, Value>& toWrite,
-                         DictElementWriter<Key, Value> pairWriter,
-                         const std::string& name, void* userData = 0)
+                         PairWriterFunc pairWriter, const std::string& name)
     {
-        KVPDict_Write<Key, Value> helper(toWrite, pairWriter, userData);
+        KVPDict_Write<Key, Value, PairWriterFunc> helper(toWrite, pairWriter);
         WriteDataStructure(helper, name);
     }
 
+protected:
+
+    //The following functions are used by "WriteCollection()" to mark the structure of the collection.
+    //Element data is written between "BeginCollectionElement()" and "EndCollectionElement()".
+
+    virtual void BeginCollection(const std::string& name, unsigned int nElements) = 0;
+    virtual void BeginCollectionElement(unsigned int elementIndex) = 0;
+    virtual void EndCollectionElement(void) = 0;
+    virtual void EndCollection(void) = 0;
+
 private:
 
     #pragma region Helper data structure for "WriteDictionary()"
 
-    template<typename Key, typename Value>
+    template<typename Key, typename Value, typename PairWriterFunc>
     //Used for "WriteDictionary()", because C++ doesn't like data structures inside a templated function.
     struct KVPDict_Write : public IWritable
     {
         const std::unordered_map<Key, Value>& Dict;
-        DictElementWriter<Key, Value> WriterFunc;
-        void* pData;
+        PairWriterFunc WriterFunc;
 
-        KVPDict_Write(const std::unordered_map<Key, Value>& dict,
-                      DictElementWriter<Key, Value> writerFunc,
-                      void* _pData)
-                : Dict(dict), WriterFunc(writerFunc), pData(_pData)
+        KVPDict_Write(const std::unordered_map<Key, Value>& dict, PairWriterFunc writerFunc)
+                : Dict(dict), WriterFunc(writerFunc)
         { }
 
         virtual void WriteData(DataWriter* writer) const override
@@ -110,7 +145,7 @@ private:
             writer->WriteUInt(Dict.size(), "Number of elements");
             for (auto i = Dict.begin(); i != Dict.end(); ++i)
             {
-                WriterFunc(writer, &i->first, &i->second, pData);
+                WriterFunc(writer, i->first, i->second);
             }
         }
     };
@@ -148,49 +183,83 @@ public:
     virtual void ReadDataStructure(IReadable& outData) = 0;
 
 
-    //A function that resizes a collection to store at least the given number of elements.
-    typedef void(*CollectionResizer)(void* pCollection, unsigned int nElements);
-    //A function that reads the given element of a collection using the given DataReader,
-    //   with optional data passed in.
-    typedef void(*ElementReader)(DataReader* reader, void* pCollection,
-                                 unsigned int elementIndex, void* userData);
+    template<typename Collection, typename ElementReaderFunc>
+    //Reads a collection of some kind of data into "outCollection".
+    //The collection must have "resize()" and "operator[]" (e.x. std::vector).
+    //The reader function is called for each element with the signature
+    //    "void f(DataReader* reader, Element& outElement, unsigned int elementIndex)",
+    //    and it is inlined into the loop instead of being called through a pointer.
+    void ReadCollection(Collection& outCollection, ElementReaderFunc readerFunc)
+    {
+        unsigned int size = BeginCollection();
+        outCollection.resize(size);
+        for (unsigned int i = 0; i < size; ++i)
+        {
+            BeginCollectionElement(i);
+            readerFunc(this, outCollection[i], i);
+            EndCollectionElement();
+        }
+        EndCollection();
+    }
+
+    template<typename T>
+    //Reads a collection that was written with "DataWriter::WriteTrivialCollection()".
+    void ReadTrivialCollection(std::vector<T>& outElements)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "ReadTrivialCollection() only works with trivially-copyable data");
 
-    //Reads a collection of some kind of data into "outData".
-    //TODO: Implement this using templates in the same way that "ReadDictionary" is implemented.
-    virtual void ReadCollection(ElementReader readerFunc, CollectionResizer resizer,
-                                void* pCollection, void* userData = 0) = 0;
+        std::vector<unsigned char> bytes;
+        ReadBytes(bytes);
+        if (bytes.size() % sizeof(T) != 0)
+        {
+            ErrorMessage = "Byte block of size " + std::to_string(bytes.size()) +
+                               " isn't a multiple of the element size " + std::to_string(sizeof(T));
+            throw EXCEPTION_FAILURE;
+        }
 
+        outElements.resize(bytes.size() / sizeof(T));
+        if (!bytes.empty())
+        {
+            memcpy(outElements.data(), bytes.data(), bytes.size());
+        }
+    }
 
-    template<typename Key, typename Value>
-    //Reads a key and value pair.
-    using DictElementReader = void(*)(DataReader* reader, Key* k, Value* v, void* userData);
 
-    template<typename Key, typename Value>
+    template<typename Key, typename Value, typename PairReaderFunc>
     //Reads a set of key-value pairs.
-    void ReadDictionary(std::unordered_map<Key, Value>& toRead,
-                        DictElementReader<Key, Value> pairReader,
-                        void* userData = 0)
+    //The reader function is called for each pair with the signature
+    //    "void f(DataReader* reader, Key& outK, Value& outV)".
+    void ReadDictionary(std::unordered_map<Key, Value>& toRead, PairReaderFunc pairReader)
     {
-        KVPDict_Read<Key, Value> helper(toRead, pairReader, userData);
+        KVPDict_Read<Key, Value, PairReaderFunc> helper(toRead, pairReader);
         ReadDataStructure(helper);
     }
 
+protected:
+
+    //The following functions are used by "ReadCollection()" to navigate the structure of a collection.
+    //Element data is read between "BeginCollectionElement()" and "EndCollectionElement()".
+
+    //Returns the number of elements in the collection.
+    virtual unsigned int BeginCollection(void) = 0;
+    virtual void BeginCollectionElement(unsigned int elementIndex) = 0;
+    virtual void EndCollectionElement(void) = 0;
+    virtual void EndCollection(void) = 0;
+
 private:
 
     #pragma region Helper data structure for "ReadDictionary()"
 
-    template<typename Key, typename Value>
+    template<typename Key, typename Value, typename PairReaderFunc>
     //Used for "ReadDictionary()", because C++ doesn't like data structures inside a templated function.
     struct KVPDict_Read : public IReadable
     {
         std::unordered_map<Key, Value>& Dict;
-        DictElementReader<Key, Value> ReaderFunc;
-        void* pData;
+        PairReaderFunc ReaderFunc;
 
-        KVPDict_Read(std::unordered_map<Key, Value>& dict,
-                     DictElementReader<Key, Value> readerFunc,
-                     void* _pData)
-            : Dict(dict), ReaderFunc(readerFunc), pData(_pData) { }
+        KVPDict_Read(std::unordered_map<Key, Value>& dict, PairReaderFunc readerFunc)
+            : Dict(dict), ReaderFunc(readerFunc) { }
 
         virtual void ReadData(DataReader* reader) override
         {
@@ -203,7 +272,7 @@ private:
             Value v;
             for (unsigned int i = 0; i < nElements; ++i)
             {
-                ReaderFunc(reader, &k, &v, pData);
+                ReaderFunc(reader, k, v);
                 Dict[k] = v;
             }
         }
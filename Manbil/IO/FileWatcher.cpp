@@ -0,0 +1,158 @@
+#include "FileWatcher.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+
+FileWatcher::FileWatcher(void)
+    : inotifyHandle(-1)
+{
+#ifdef __linux__
+    inotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+FileWatcher::~FileWatcher(void)
+{
+#ifdef __linux__
+    if (inotifyHandle >= 0)
+    {
+        close(inotifyHandle);
+    }
+#endif
+}
+
+void FileWatcher::AddFile(const std::string& filePath)
+{
+    for (unsigned int i = 0; i < files.size(); ++i)
+    {
+        if (files[i].Path == filePath)
+        {
+            return;
+        }
+    }
+
+    WatchedFile file;
+    file.Path = filePath;
+    file.LastModified = GetLastModified(filePath);
+    file.FolderWatchID = -1;
+
+    size_t slash = filePath.find_last_of("/\\");
+    if (slash == std::string::npos)
+    {
+        file.Folder = ".";
+        file.Name = filePath;
+    }
+    else
+    {
+        file.Folder = filePath.substr(0, slash);
+        file.Name = filePath.substr(slash + 1);
+    }
+
+#ifdef __linux__
+    if (inotifyHandle >= 0)
+    {
+        //Adding the same folder twice just gives back the same ID.
+        //A file is only reported once it's finished being written or moved into place;
+        //    a newly-created file is still empty, and gets its own close event once it's written.
+        file.FolderWatchID = inotify_add_watch(inotifyHandle, file.Folder.c_str(),
+                                               IN_CLOSE_WRITE | IN_MOVED_TO);
+    }
+#endif
+
+    files.push_back(file);
+}
+void FileWatcher::Clear(void)
+{
+#ifdef __linux__
+    //Re-create the inotify instance to get rid of all the folder watches.
+    if (inotifyHandle >= 0)
+    {
+        close(inotifyHandle);
+        inotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    }
+#endif
+
+    files.clear();
+}
+
+void FileWatcher::GetChangedFiles(std::vector<std::string>& outFiles)
+{
+    std::vector<bool> changed(files.size(), false);
+
+#ifdef __linux__
+    if (inotifyHandle >= 0)
+    {
+        char buffer[4096]
+            __attribute__((aligned(__alignof__(struct inotify_event))));
+        while (true)
+        {
+            ssize_t nBytes = read(inotifyHandle, buffer, sizeof(buffer));
+            if (nBytes <= 0)
+            {
+                break;
+            }
+
+            for (char* ptr = buffer; ptr < buffer + nBytes; )
+            {
+                const inotify_event* event = (const inotify_event*)ptr;
+                ptr += sizeof(inotify_event) + event->len;
+
+                if (event->len == 0)
+                {
+                    continue;
+                }
+                for (unsigned int i = 0; i < files.size(); ++i)
+                {
+                    if (files[i].FolderWatchID == event->wd && files[i].Name == event->name)
+                    {
+                        changed[i] = true;
+                    }
+                }
+            }
+        }
+    }
+#endif
+
+    //Files that aren't watched through inotify are checked by their last-modified time.
+    for (unsigned int i = 0; i < files.size(); ++i)
+    {
+        if (files[i].FolderWatchID < 0)
+        {
+            long long lastModified = GetLastModified(files[i].Path);
+            if (lastModified != files[i].LastModified)
+            {
+                files[i].LastModified = lastModified;
+                changed[i] = true;
+            }
+        }
+
+        if (changed[i])
+        {
+            outFiles.push_back(files[i].Path);
+        }
+    }
+}
+
+long long FileWatcher::GetLastModified(const std::string& filePath)
+{
+#ifdef _WIN32
+    struct _stat info;
+    if (_stat(filePath.c_str(), &info) != 0)
+    {
+        return -1;
+    }
+#else
+    struct stat info;
+    if (stat(filePath.c_str(), &info) != 0)
+    {
+        return -1;
+    }
+#endif
+
+    return (long long)info.st_mtime;
+}
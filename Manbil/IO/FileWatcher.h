@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+//Watches a set of files for changes on disk.
+//On Linux this uses inotify on each file's folder (so that editors which save by replacing
+//    the file are still caught). Everywhere else it compares the files' last-modified times.
+class FileWatcher
+{
+public:
+
+    FileWatcher(void);
+    ~FileWatcher(void);
+
+
+    //Starts watching the given file. Nothing happens if it's already being watched.
+    void AddFile(const std::string& filePath);
+    //Stops watching every file.
+    void Clear(void);
+
+    //Outputs every watched file that changed since the last call to this function
+    //    (or since the file was added). Doesn't block.
+    void GetChangedFiles(std::vector<std::string>& outFilePaths);
+
+
+private:
+
+    struct WatchedFile
+    {
+        std::string Path, Folder, Name;
+        long long LastModified;
+        int FolderWatchID;
+    };
+
+    std::vector<WatchedFile> files;
+
+    //The inotify instance, or -1 if inotify isn't being used.
+    int inotifyHandle;
+
+
+    FileWatcher(const FileWatcher& cpy) = delete;
+    FileWatcher& operator=(const FileWatcher& cpy) = delete;
+
+    static long long GetLastModified(const std::string& filePath);
+};
@@ -201,14 +201,12 @@ IMPL_WRITE(RenderIOAttributes)
     
 
 #pragma warning(disable: 4100)
-    writer->WriteCollection([](DataWriter* writer, const void* elementToWrite,
-                               unsigned int index, void* pData)
-                               {
-                                   AttrWriter write(*((Attr*)elementToWrite));
-                                   writer->WriteDataStructure(write, std::to_string(index));
-                               },
-                               "Attributes", sizeof(Attr), Value.GetAttributes().data(),
-                               Value.GetNumbAttributes());
+    writer->WriteCollection(Value.GetAttributes(),
+                            [](DataWriter* writer, const Attr& attr, unsigned int index)
+                            {
+                                writer->WriteDataStructure(AttrWriter(attr), std::to_string(index));
+                            },
+                            "Attributes");
 
 #pragma warning(default: 4100)
 }
@@ -219,17 +217,11 @@ IMPL_READ(RenderIOAttributes)
     
 #pragma warning(disable: 4100)
     std::vector<Attr> newData;
-    reader->ReadCollection([](DataReader* reader, void* pCollection, unsigned int index, void* pData)
-                           {
-                               std::vector<Attr>* attrs = (std::vector<Attr>*)pCollection;
-                               reader->ReadDataStructure(AttrReader(attrs->operator[](index)));
-                           },
-                           [](void* pCollection, unsigned int newSize)
+    reader->ReadCollection(newData,
+                           [](DataReader* reader, Attr& outAttr, unsigned int index)
                            {
-                               std::vector<Attr>* attrs = (std::vector<Attr>*)pCollection;
-                               attrs->resize(newSize);
-                           },
-                           &newData);
+                               reader->ReadDataStructure(AttrReader(outAttr));
+                           });
 #pragma warning(default: 4100)
 
     Value.SetAttributes(newData);
@@ -386,15 +378,14 @@ IMPL_WRITE(SubroutineDefinition)
     writer->WriteUInt(Value.ReturnValueSize, "Return value size");
     writer->WriteString(ShaderTypeToString(Value.Shader), "Shader type");
 
-    writer->WriteCollection([](DataWriter* writer, const void* elementToWrite,
-                               unsigned int elIndex, void* pData)
+    writer->WriteCollection(Value.Params,
+                            [](DataWriter* writer, const SubroutineDefinition::Parameter& param,
+                               unsigned int elIndex)
                             {
-                                auto& param = *(const SubroutineDefinition::Parameter*)elementToWrite;
                                 writer->WriteDataStructure(SubroutineDefinition_Parameter_Writable(param),
                                                            "Param " + std::to_string(elIndex + 1));
                             },
-                            "Parameters", sizeof(SubroutineDefinition::Parameter),
-                            Value.Params.data(), Value.Params.size());
+                            "Parameters");
 }
 IMPL_READ(SubroutineDefinition)
 {
@@ -405,46 +396,31 @@ IMPL_READ(SubroutineDefinition)
     reader->ReadString(shaderType);
     Value.Shader = ShaderTypeFromString(shaderType);
 
-    reader->ReadCollection([](DataReader* reader, void* pCollection, unsigned int elIndex, void* pData)
+    reader->ReadCollection(Value.Params,
+                           [](DataReader* reader, SubroutineDefinition::Parameter& outParam,
+                              unsigned int elIndex)
                            {
-                               auto collection = (std::vector<SubroutineDefinition::Parameter>*)pCollection;
-                               auto& element = (*collection)[elIndex];
-                               reader->ReadDataStructure(SubroutineDefinition_Parameter_Readable(element));
-                           },
-                           [](void* pCollection, unsigned int newSize)
-                           {
-                               auto collection = (std::vector<SubroutineDefinition::Parameter>*)pCollection;
-                               collection->resize(newSize);
-                           },
-                           &Value.Params);
+                               reader->ReadDataStructure(SubroutineDefinition_Parameter_Readable(outParam));
+                           });
 }
 IMPL_WRITE(UniformValueSubroutine)
 {
     writer->WriteDataStructure(SubroutineDefinition_Writable(Value.Definition), "Signature definition");
-    writer->WriteCollection([](DataWriter* writer, const void* elementToWrite,
-                               unsigned int elIndex, void* pData)
+    writer->WriteCollection(Value.PossibleValues,
+                            [](DataWriter* writer, const std::string& el, unsigned int elIndex)
                             {
-                                const std::string& el = *(const std::string*)elementToWrite;
                                 writer->WriteString(el, "Possible value " + std::to_string(elIndex + 1));
                             },
-                            "Possible values", sizeof(std::string),
-                            Value.PossibleValues.data(), Value.PossibleValues.size());
+                            "Possible values");
 }
 IMPL_READ(UniformValueSubroutine)
 {
     reader->ReadDataStructure(SubroutineDefinition_Readable(Value.Definition));
-    reader->ReadCollection([](DataReader* reader, void* pCollection, unsigned int elIndex, void* pData)
-                           {
-                               auto collection = (std::vector<std::string>*)pCollection;
-                               auto& element = (*collection)[elIndex];
-                               reader->ReadString(element);
-                           },
-                           [](void* pCollection, unsigned int newSize)
+    reader->ReadCollection(Value.PossibleValues,
+                           [](DataReader* reader, std::string& outEl, unsigned int elIndex)
                            {
-                               auto collection = (std::vector<std::string>*)pCollection;
-                               collection->resize(newSize);
-                           },
-                           &Value.PossibleValues);
+                               reader->ReadString(outEl);
+                           });
 
     Value.PossibleValueIDs = std::vector<RenderObjHandle>();
     Value.PossibleValueIDs.resize(Value.PossibleValues.size());
@@ -1,8 +1,10 @@
 #include "XmlSerialization.h"
 
 #include <assert.h>
-
-using namespace tinyxml2;
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <locale.h>
 
 
 
@@ -42,7 +44,7 @@ const unsigned char hexToValue(char hex)
 //Converts byte data into two-digit hex numbers. The hex numbers are combined and output into a string.
 void BytesToHex(const unsigned char* byteData, unsigned int nBytes, std::string& outHex)
 {
-    outHex.reserve(outHex.size() + nBytes);
+    outHex.reserve(outHex.size() + (nBytes * 2));
     for (unsigned int i = 0; i < nBytes; ++i)
     {
         unsigned char data = byteData[i];
@@ -52,17 +54,18 @@ void BytesToHex(const unsigned char* byteData, unsigned int nBytes, std::string&
 }
 //Converts a sequence of two-digit hex numbers into byte data.
 //Outputs the byte data to the end of the given vector.
-void HexToBytes(const std::string& hexData, std::vector<unsigned char>& outBytes, std::string& outError)
+void HexToBytes(const char* hexData, unsigned int nHexDigits,
+                std::vector<unsigned char>& outBytes, std::string& outError)
 {
-    if (hexData.size() % 2 != 0)
+    if (nHexDigits % 2 != 0)
     {
         outError = std::string("Hex string should be filled with two-digit numbers ") +
                         "but it has an odd number of digits!";
         throw XmlReader::EXCEPTION_FAILURE;
     }
 
-    outBytes.reserve(outBytes.size() + (hexData.size() / 2));
-    for (unsigned int i = 0; i < hexData.size(); i += 2)
+    outBytes.reserve(outBytes.size() + (nHexDigits / 2));
+    for (unsigned int i = 0; i < nHexDigits; i += 2)
     {
         unsigned char sixteensPlace = hexToValue(hexData[i]),
                       onesPlace = hexToValue(hexData[i + 1]);
@@ -71,358 +74,878 @@ void HexToBytes(const std::string& hexData, std::vector<unsigned char>& outBytes
 }
 
 
-//Converts a TinyXML error code into an error message.
-std::string TinyXMLErrorToString(XMLError err)
-{
-    switch (err)
-    {
-        case XMLError::XML_NO_ERROR:
-            return "";
-        case XMLError::XML_NO_ATTRIBUTE:
-            return "XML error: no attribute";
-        case XMLError::XML_WRONG_ATTRIBUTE_TYPE:
-            return "XML error: wrong attribute type";
-        case XMLError::XML_ERROR_FILE_NOT_FOUND:
-            return "File not found";
-        case XMLError::XML_ERROR_FILE_COULD_NOT_BE_OPENED:
-            return "File could not be opened";
-        case XMLError::XML_ERROR_FILE_READ_ERROR:
-            return "File could not be read";
-        case XMLError::XML_ERROR_ELEMENT_MISMATCH:
-            return "Element mismatch";
-        case XMLError::XML_ERROR_PARSING_ELEMENT:
-            return "Parsing element";
-        case XMLError::XML_ERROR_PARSING_ATTRIBUTE:
-            return "Parsing attribute";
-        case XMLError::XML_ERROR_IDENTIFYING_TAG:
-            return "Identifying tag";
-        case XMLError::XML_ERROR_PARSING_TEXT:
-            return "Parsing text";
-        case XMLError::XML_ERROR_PARSING_CDATA:
-            return "Parsing CData";
-        case XMLError::XML_ERROR_PARSING_COMMENT:
-            return "Parsing comment";
-        case XMLError::XML_ERROR_PARSING_DECLARATION:
-            return "Parsing declaration";
-        case XMLError::XML_ERROR_PARSING_UNKNOWN:
-            return "Parsing unknown";
-        case XMLError::XML_ERROR_EMPTY_DOCUMENT:
-            return "Empty document";
-        case XMLError::XML_ERROR_MISMATCHED_ELEMENT:
-            return "Mismatched element";
-        case XMLError::XML_ERROR_PARSING:
-            return "Parsing";
-        case XMLError::XML_CAN_NOT_CONVERT_TEXT:
-            return "Cannot convert text";
-        case XMLError::XML_NO_TEXT_NODE:
-            return "No text node";
+//The following stuff parses values out of the XML text, in the style of "std::from_chars":
+//    nothing past the end of the value's text is read, the result doesn't depend on the C locale,
+//    and the whole piece of text must be used.
 
-        default:
-            assert(false);
-            return "Unknown error code " + std::to_string(err);
+bool IsXmlSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+void TrimXmlSpace(const char*& start, const char*& end)
+{
+    while (start != end && IsXmlSpace(*start))
+        start += 1;
+    while (start != end && IsXmlSpace(*(end - 1)))
+        end -= 1;
+}
+
+bool ParseUInt(const char* start, const char* end, unsigned int& outU)
+{
+    TrimXmlSpace(start, end);
+    if (start == end)
+    {
+        return false;
+    }
+
+    unsigned long long value = 0;
+    for (; start != end; ++start)
+    {
+        if (*start < '0' || *start > '9')
+        {
+            return false;
+        }
+
+        value = (value * 10) + (*start - '0');
+        if (value > UINT_MAX)
+        {
+            return false;
+        }
+    }
+
+    outU = (unsigned int)value;
+    return true;
+}
+bool ParseInt(const char* start, const char* end, int& outI)
+{
+    TrimXmlSpace(start, end);
+    if (start == end)
+    {
+        return false;
+    }
+
+    bool isNegative = (*start == '-');
+    if (isNegative || *start == '+')
+    {
+        start += 1;
+    }
+
+    unsigned int magnitude;
+    if (!ParseUInt(start, end, magnitude))
+    {
+        return false;
+    }
+
+    long long value = (isNegative ? -(long long)magnitude : (long long)magnitude);
+    if (value < INT_MIN || value > INT_MAX)
+    {
+        return false;
+    }
+
+    outI = (int)value;
+    return true;
+}
+//"strtod()"/"strtof()" need a null-terminated string and use the C locale's decimal point,
+//    so the text is copied into a buffer (on the stack unless it's very long) with every '.'
+//    replaced by the locale's decimal point. The locale's own decimal point isn't accepted.
+template<typename RealType>
+bool ParseReal(const char* start, const char* end, RealType(*strToReal)(const char*, char**),
+               RealType& outValue)
+{
+    TrimXmlSpace(start, end);
+    if (start == end)
+    {
+        return false;
+    }
+
+    char localePoint = localeconv()->decimal_point[0];
+
+    unsigned int length = (unsigned int)(end - start);
+    char smallBuffer[64];
+    std::string largeBuffer;
+    char* buffer = smallBuffer;
+    if (length >= sizeof(smallBuffer))
+    {
+        largeBuffer.resize(length + 1);
+        buffer = &largeBuffer[0];
     }
+
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        if (start[i] == '.')
+        {
+            buffer[i] = localePoint;
+        }
+        else if (start[i] == localePoint)
+        {
+            return false;
+        }
+        else
+        {
+            buffer[i] = start[i];
+        }
+    }
+    buffer[length] = '\0';
+
+    char* parseEnd;
+    outValue = strToReal(buffer, &parseEnd);
+    return parseEnd == buffer + length;
+}
+bool ParseDouble(const char* start, const char* end, double& outD)
+{
+    return ParseReal(start, end, &strtod, outD);
+}
+bool ParseFloat(const char* start, const char* end, float& outF)
+{
+    return ParseReal(start, end, &strtof, outF);
 }
 
+//Appends the given unicode character to the given UTF-8 string.
+void AppendUTF8(unsigned int codePoint, std::string& outStr)
+{
+    if (codePoint < 0x80)
+    {
+        outStr += (char)codePoint;
+    }
+    else if (codePoint < 0x800)
+    {
+        outStr += (char)(0xC0 | (codePoint >> 6));
+        outStr += (char)(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        outStr += (char)(0xE0 | (codePoint >> 12));
+        outStr += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        outStr += (char)(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        outStr += (char)(0xF0 | (codePoint >> 18));
+        outStr += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+        outStr += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        outStr += (char)(0x80 | (codePoint & 0x3F));
+    }
+}
+//Converts XML text into the string it represents by replacing escaped characters
+//    (e.x. "&amp;") and normalizing newlines.
+//Returns false if an escaped character wasn't valid.
+bool DecodeXmlText(const char* start, const char* end, std::string& outStr)
+{
+    outStr.clear();
+    outStr.reserve(end - start);
+
+    while (start != end)
+    {
+        //Copy over the next run of normal characters.
+        const char* runStart = start;
+        while (start != end && *start != '&' && *start != '\r')
+            start += 1;
+        outStr.append(runStart, start);
+
+        if (start == end)
+        {
+            break;
+        }
+
+        //Normalize "\r\n" and "\r" to "\n".
+        if (*start == '\r')
+        {
+            outStr += '\n';
+            start += 1;
+            if (start != end && *start == '\n')
+            {
+                start += 1;
+            }
+            continue;
+        }
+
+        //Decode the escaped character.
+        const char* entityEnd = start;
+        while (entityEnd != end && *entityEnd != ';')
+            entityEnd += 1;
+        if (entityEnd == end)
+        {
+            return false;
+        }
+
+        const char* entity = start + 1;
+        unsigned int entityLength = entityEnd - entity;
+        if (entityLength == 2 && strncmp(entity, "lt", 2) == 0)
+        {
+            outStr += '<';
+        }
+        else if (entityLength == 2 && strncmp(entity, "gt", 2) == 0)
+        {
+            outStr += '>';
+        }
+        else if (entityLength == 3 && strncmp(entity, "amp", 3) == 0)
+        {
+            outStr += '&';
+        }
+        else if (entityLength == 4 && strncmp(entity, "quot", 4) == 0)
+        {
+            outStr += '"';
+        }
+        else if (entityLength == 4 && strncmp(entity, "apos", 4) == 0)
+        {
+            outStr += '\'';
+        }
+        else if (entityLength > 1 && entity[0] == '#')
+        {
+            unsigned long codePoint;
+            char* parseEnd;
+            if (entity[1] == 'x')
+            {
+                codePoint = strtoul(entity + 2, &parseEnd, 16);
+            }
+            else
+            {
+                codePoint = strtoul(entity + 1, &parseEnd, 10);
+            }
+            if (parseEnd != entityEnd)
+            {
+                return false;
+            }
+
+            AppendUTF8((unsigned int)codePoint, outStr);
+        }
+        else
+        {
+            return false;
+        }
+
+        start = entityEnd + 1;
+    }
+
+    return true;
+}
+
+
 
 XmlWriter::XmlWriter(std::string rootNodeName)
+    : rootName(rootNodeName)
 {
-    currentRoot = doc.NewElement(rootNodeName.c_str());
-    doc.InsertEndChild(currentRoot);
+    output.reserve(1024);
+    StartElement(rootName.c_str());
 }
 
-#include <fstream>
 std::string XmlWriter::SaveData(const std::string& path)
 {
+    //Finish off any elements that are still open.
+    //Don't modify this writer's state, so that more data can still be written after saving.
+    std::string tail;
+    for (unsigned int i = openElements.size(); i > 0; --i)
+    {
+        const std::pair<std::string, bool>& element = openElements[i - 1];
+        if (element.second)
+        {
+            tail += "/>\n";
+        }
+        else
+        {
+            tail.append((i - 1) * 4, ' ');
+            tail += "</";
+            tail += element.first;
+            tail += ">\n";
+        }
+    }
+
     //Create the file, or overwrite it with an empty file.
-    errno = 0;
     FILE* file = fopen(path.c_str(), "w");
     if (file == 0)
     {
         return "The file doesn't exist to be written to, or it cannot be opened.";
     }
-    
+
+    fwrite(output.data(), 1, output.size(), file);
+    fwrite(tail.data(), 1, tail.size(), file);
+    bool failed = (ferror(file) != 0);
     fclose(file);
-    
-    return TinyXMLErrorToString(doc.SaveFile(path.c_str()));
+
+    return (failed ? "Could not write to the file" : "");
+}
+
+
+void XmlWriter::WriteIndent(void)
+{
+    output.append(openElements.size() * 4, ' ');
+}
+void XmlWriter::StartElement(const char* tag)
+{
+    FinishOpeningTag();
+
+    WriteIndent();
+    output += '<';
+    output += tag;
+
+    openElements.push_back(std::make_pair(std::string(tag), true));
+}
+void XmlWriter::FinishOpeningTag(void)
+{
+    if (!openElements.empty() && openElements.back().second)
+    {
+        output += ">\n";
+        openElements.back().second = false;
+    }
+}
+void XmlWriter::EndElement(void)
+{
+    assert(!openElements.empty());
+
+    if (openElements.back().second)
+    {
+        output += "/>\n";
+        openElements.pop_back();
+    }
+    else
+    {
+        std::string tag = openElements.back().first;
+        openElements.pop_back();
+
+        WriteIndent();
+        output += "</";
+        output += tag;
+        output += ">\n";
+    }
+}
+
+void XmlWriter::WriteEscaped(const char* text, unsigned int length)
+{
+    const char* end = text + length;
+    while (text != end)
+    {
+        //Copy over the next run of normal characters.
+        const char* runStart = text;
+        while (text != end && *text != '&' && *text != '<' && *text != '>' &&
+               *text != '"' && *text != '\'')
+        {
+            text += 1;
+        }
+        output.append(runStart, text);
+
+        if (text == end)
+        {
+            break;
+        }
+
+        switch (*text)
+        {
+            case '&': output += "&amp;"; break;
+            case '<': output += "&lt;"; break;
+            case '>': output += "&gt;"; break;
+            case '"': output += "&quot;"; break;
+            case '\'': output += "&apos;"; break;
+            default: assert(false); break;
+        }
+        text += 1;
+    }
+}
+void XmlWriter::WriteAttribute(const char* attrName, const char* value, unsigned int valueLength)
+{
+    assert(!openElements.empty() && openElements.back().second);
+
+    output += ' ';
+    output += attrName;
+    output += "=\"";
+    WriteEscaped(value, valueLength);
+    output += '"';
+}
+void XmlWriter::WriteValueElement(const char* tag, const std::string& name,
+                                  const char* value, unsigned int valueLength)
+{
+    StartElement(tag);
+    WriteAttribute("name", name);
+    WriteAttribute("value", value, valueLength);
+    EndElement();
 }
 
 
 #define IMPL_WRITE_XML_DATA(dataType, dataTypeName, dataTypeString, valueToString) \
     void XmlWriter::Write ## dataTypeName(dataType value, const std::string& name) \
     { \
-        XMLElement* child = doc.NewElement(dataTypeString); \
-        child->SetAttribute("name", name.c_str()); \
-        child->SetAttribute("value", valueToString.c_str()); \
-        currentRoot->InsertEndChild(child); \
+        std::string valueStr = valueToString; \
+        WriteValueElement(dataTypeString, name, valueStr.c_str(), valueStr.size()); \
     }
-IMPL_WRITE_XML_DATA(bool, Bool, "bool", (value ? std::string("true") : std::string("false")))
 IMPL_WRITE_XML_DATA(unsigned char, Byte, "byte", std::to_string((unsigned int)value))
 IMPL_WRITE_XML_DATA(int, Int, "int", std::to_string(value))
 IMPL_WRITE_XML_DATA(unsigned int, UInt, "uint", std::to_string(value))
 IMPL_WRITE_XML_DATA(float, Float, "float", std::to_string(value))
 IMPL_WRITE_XML_DATA(double, Double, "double", std::to_string(value))
-IMPL_WRITE_XML_DATA(const std::string&, String, "string", value)
-
 
+void XmlWriter::WriteBool(bool value, const std::string& name)
+{
+    if (value)
+    {
+        WriteValueElement("bool", name, "true", 4);
+    }
+    else
+    {
+        WriteValueElement("bool", name, "false", 5);
+    }
+}
+void XmlWriter::WriteString(const std::string& value, const std::string& name)
+{
+    WriteValueElement("string", name, value.c_str(), value.size());
+}
 void XmlWriter::WriteBytes(const unsigned char* bytes, unsigned int nBytes, const std::string& name)
 {
-    XMLElement* child = doc.NewElement("byteData");
-    child->SetAttribute("name", name.c_str());
+    StartElement("byteData");
+    WriteAttribute("name", name);
 
-    std::string value;
-    BytesToHex(bytes, nBytes, value);
-    child->SetAttribute("value", value.c_str());
+    //Hex digits never need to be escaped, so write them straight into the output.
+    output += " value=\"";
+    BytesToHex(bytes, nBytes, output);
+    output += '"';
 
-    currentRoot->InsertEndChild(child);
+    EndElement();
 }
 
 
-void XmlWriter::WriteCollection(ElementWriter writerFunc, const std::string& name,
-                                unsigned int bytesPerElement,
-                                const void* collection, unsigned int collectionSize,
-                                void* optionalData)
+void XmlWriter::BeginCollection(const std::string& name, unsigned int nElements)
 {
-    //Create the root of the collection.
-    XMLElement * collectionRoot = doc.NewElement("collection");
-    collectionRoot->SetAttribute("name", name.c_str());
-    currentRoot->InsertEndChild(collectionRoot);
+    std::string sizeStr = std::to_string(nElements);
 
-    //Go through every element and create a child node for it.
-    for (unsigned int i = 0; i < collectionSize; ++i)
-    {
-        //Set up the element's node.
-        XMLElement* collElement = doc.NewElement("element");
-        collElement->SetAttribute("index", std::to_string(i).c_str());
-        collectionRoot->InsertEndChild(collElement);
-
-        //Move into this element's node and write the data.
-        currentRoot = collElement;
-        const void* element = ((const char*)collection) + (i * bytesPerElement);
-        writerFunc(this, element, i, optionalData);
-    }
+    StartElement("collection");
+    WriteAttribute("name", name);
+    WriteAttribute("size", sizeStr);
+}
+void XmlWriter::BeginCollectionElement(unsigned int elementIndex)
+{
+    std::string indexStr = std::to_string(elementIndex);
 
-    //Move out of the current XML element, back into the original "currentRoot".
-    currentRoot = collectionRoot->Parent()->ToElement();
+    StartElement("element");
+    WriteAttribute("index", indexStr);
+}
+void XmlWriter::EndCollectionElement(void)
+{
+    EndElement();
+}
+void XmlWriter::EndCollection(void)
+{
+    EndElement();
 }
 
 void XmlWriter::WriteDataStructure(const IWritable& toSerialize, const std::string& name)
 {
-    //Create the structure's root.
-    XMLElement* dataStructureRoot = doc.NewElement("dataStructure");
-    dataStructureRoot->SetAttribute("name", name.c_str());
-    currentRoot->InsertEndChild(dataStructureRoot);
+    StartElement("dataStructure");
+    WriteAttribute("name", name);
 
-    //Move into that root and write the structure.
-    currentRoot = dataStructureRoot;
     toSerialize.WriteData(this);
 
-    //Move out of that root, back into its parent.
-    currentRoot = dataStructureRoot->Parent()->ToElement();
+    EndElement();
 }
 
 
 
+bool XmlReader::Slice::Equals(const char* str) const
+{
+    return Start != 0 && strncmp(Start, str, Length) == 0 && str[Length] == '\0';
+}
+
+
 XmlReader::XmlReader(const std::string& filePath)
 {
     Reload(filePath, ErrorMessage);
 }
 void XmlReader::Reload(const std::string& filePath, std::string& err)
 {
-    doc.Clear();
+    buffer.clear();
+    openElements.clear();
+    err = "";
 
-    err = TinyXMLErrorToString(doc.LoadFile(filePath.c_str()));
+    //Read the whole file into the buffer, followed by a null terminator.
+    buffer.push_back('\0');
+    pos = buffer.data();
+    next.IsEnd = true;
 
-    currentRoot = 0;
-    currentChild = 0;
+    FILE* file = fopen(filePath.c_str(), "rb");
+    if (file == 0)
+    {
+        err = "File not found, or it could not be opened";
+        return;
+    }
 
-    if (err.empty())
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (fileSize > 0)
     {
-        //Find the root element.
-        for (XMLNode* child = doc.FirstChild(); child != 0; child = child->NextSibling())
+        buffer.resize(fileSize + 1);
+        size_t nRead = fread(buffer.data(), 1, fileSize, file);
+        buffer[nRead] = '\0';
+        if (nRead != (size_t)fileSize)
         {
-            if (child->ToElement() != 0)
-            {
-                currentRoot = child->ToElement();
-                break;
-            }
+            err = "File could not be read";
         }
+    }
+    fclose(file);
+
+    pos = buffer.data();
+    if (!err.empty())
+    {
+        return;
+    }
 
-        //If no element was found, error.
-        if (currentRoot == 0)
+    //Move into the root element.
+    try
+    {
+        PeekNextTag();
+        if (next.IsEnd)
         {
             err = "Couldn't find a root XML element in the document";
             return;
         }
 
-        //Get the first child.
-        currentChild = currentRoot->FirstChildElement();
+        EnterNextElement();
+    }
+    catch (int ex)
+    {
+        assert(ex == EXCEPTION_FAILURE);
+        err = ErrorMessage;
     }
 }
 
 
-//Throws an exception if the "currentChild" field in XML reader doesn't use the given element tag.
-#define XML_READ_ERROR_CHECK(dataTypeStr) \
-    if (currentChild == 0) \
-    { \
-        ErrorMessage = std::string("No more data in the structure '") + \
-                           currentRoot->Attribute("name") + "'"; \
-        throw EXCEPTION_FAILURE; \
-    } \
-    \
-    if (std::string(currentChild->Name()).compare(dataTypeStr) != 0) \
-    { \
-        ErrorMessage = std::string("The next data in this structure '") + \
-                           currentRoot->Attribute("name") + \
-                           "' is the " + currentChild->Name() + " '" + \
-                           currentChild->Attribute("name") + "', not a " + dataTypeStr; \
-        throw EXCEPTION_FAILURE; \
+void XmlReader::PeekNextTag(void)
+{
+    next.IsEnd = false;
+    next.IsSelfClosing = false;
+    next.Name = Slice();
+    next.NameAttr = Slice();
+    next.ValueAttr = Slice();
+    next.SizeAttr = Slice();
+
+    //Skip any text, comments, and declarations before the next tag.
+    while (true)
+    {
+        while (*pos != '\0' && *pos != '<')
+            pos += 1;
+
+        const char* skipTo = 0;
+        if (*pos == '\0')
+        {
+            //The end of the file ends everything.
+            next.IsEnd = true;
+            return;
+        }
+        else if (pos[1] == '?')
+        {
+            skipTo = strstr(pos, "?>");
+        }
+        else if (strncmp(pos, "<!--", 4) == 0)
+        {
+            skipTo = strstr(pos, "-->");
+        }
+        else if (pos[1] == '!')
+        {
+            skipTo = strchr(pos, '>');
+        }
+        else
+        {
+            break;
+        }
+
+        if (skipTo == 0)
+        {
+            pos = &buffer.back();
+        }
+        else
+        {
+            pos = strchr(skipTo, '>') + 1;
+        }
     }
 
-void XmlReader::ReadBool(bool& outB)
+    //Closing tag.
+    if (pos[1] == '/')
+    {
+        const char* tagEnd = strchr(pos, '>');
+        pos = (tagEnd == 0 ? &buffer.back() : tagEnd + 1);
+        next.IsEnd = true;
+        return;
+    }
+
+    //Opening tag. First read the tag's name.
+    pos += 1;
+    const char* nameStart = pos;
+    while (*pos != '\0' && !IsXmlSpace(*pos) && *pos != '/' && *pos != '>')
+        pos += 1;
+    next.Name = Slice(nameStart, pos - nameStart);
+
+    //Next read the attributes.
+    while (true)
+    {
+        while (IsXmlSpace(*pos))
+            pos += 1;
+
+        if (*pos == '>')
+        {
+            pos += 1;
+            return;
+        }
+        if (*pos == '/' && pos[1] == '>')
+        {
+            pos += 2;
+            next.IsSelfClosing = true;
+            return;
+        }
+
+        const char* attrStart = pos;
+        while (*pos != '\0' && *pos != '=' && !IsXmlSpace(*pos) && *pos != '>')
+            pos += 1;
+        Slice attrName(attrStart, pos - attrStart);
+
+        while (IsXmlSpace(*pos))
+            pos += 1;
+        if (*pos != '=')
+        {
+            ErrorMessage = "Invalid attribute '" + attrName.ToString() +
+                               "' in the tag '" + next.Name.ToString() + "'";
+            throw EXCEPTION_FAILURE;
+        }
+        pos += 1;
+        while (IsXmlSpace(*pos))
+            pos += 1;
+
+        char quote = *pos;
+        if (quote != '"' && quote != '\'')
+        {
+            ErrorMessage = "The attribute '" + attrName.ToString() + "' in the tag '" +
+                               next.Name.ToString() + "' doesn't have a quoted value";
+            throw EXCEPTION_FAILURE;
+        }
+        pos += 1;
+
+        const char* valueEnd = strchr(pos, quote);
+        if (valueEnd == 0)
+        {
+            ErrorMessage = "Unexpected end of file in the tag '" + next.Name.ToString() + "'";
+            throw EXCEPTION_FAILURE;
+        }
+        Slice attrValue(pos, valueEnd - pos);
+        pos = valueEnd + 1;
+
+        if (attrName.Equals("name"))
+        {
+            next.NameAttr = attrValue;
+        }
+        else if (attrName.Equals("value"))
+        {
+            next.ValueAttr = attrValue;
+        }
+        else if (attrName.Equals("size"))
+        {
+            next.SizeAttr = attrValue;
+        }
+    }
+}
+void XmlReader::SkipNextElement(void)
 {
-    XML_READ_ERROR_CHECK("bool")
+    assert(!next.IsEnd);
 
-    std::string val = currentChild->Attribute("value");
-    if (val.compare("true") == 0)
+    if (!next.IsSelfClosing)
+    {
+        //The end of the file counts as an end tag, so this loop will always finish.
+        unsigned int depth = 1;
+        while (depth > 0)
+        {
+            PeekNextTag();
+            if (next.IsEnd)
+            {
+                depth -= 1;
+            }
+            else if (!next.IsSelfClosing)
+            {
+                depth += 1;
+            }
+        }
+    }
+
+    PeekNextTag();
+}
+void XmlReader::EnterNextElement(void)
+{
+    assert(!next.IsEnd);
+
+    openElements.push_back(next.NameAttr.Exists() ? next.NameAttr : next.Name);
+
+    //A self-closing element doesn't have any children.
+    if (next.IsSelfClosing)
+    {
+        next.IsEnd = true;
+    }
+    else
+    {
+        PeekNextTag();
+    }
+}
+void XmlReader::ExitElement(void)
+{
+    while (!next.IsEnd)
+    {
+        SkipNextElement();
+    }
+
+    openElements.pop_back();
+    PeekNextTag();
+}
+
+std::string XmlReader::GetCurrentName(void) const
+{
+    return (openElements.empty() ? "" : openElements.back().ToString());
+}
+void XmlReader::CheckNextElement(const char* tag)
+{
+    if (next.IsEnd)
+    {
+        ErrorMessage = "No more data in the structure '" + GetCurrentName() + "'";
+        throw EXCEPTION_FAILURE;
+    }
+
+    if (!next.Name.Equals(tag))
+    {
+        ErrorMessage = "The next data in this structure '" + GetCurrentName() +
+                           "' is the " + next.Name.ToString() + " '" + next.NameAttr.ToString() +
+                           "', not a " + tag;
+        throw EXCEPTION_FAILURE;
+    }
+}
+XmlReader::Slice XmlReader::ReadValue(const char* tag)
+{
+    CheckNextElement(tag);
+
+    Slice value = next.ValueAttr;
+    if (!value.Exists())
+    {
+        ErrorMessage = std::string(tag) + " data '" + next.NameAttr.ToString() +
+                           "' doesn't have a value";
+        throw EXCEPTION_FAILURE;
+    }
+
+    SkipNextElement();
+    return value;
+}
+void XmlReader::ThrowInvalidValue(const char* typeName, Slice value)
+{
+    ErrorMessage = std::string("Invalid ") + typeName + " value of '" + value.ToString() + "'";
+    throw EXCEPTION_FAILURE;
+}
+
+
+void XmlReader::ReadBool(bool& outB)
+{
+    Slice value = ReadValue("bool");
+    if (value.Equals("true"))
     {
-        currentChild = currentChild->NextSiblingElement();
         outB = true;
     }
-    else if (val.compare("false") == 0)
+    else if (value.Equals("false"))
     {
-        currentChild = currentChild->NextSiblingElement();
         outB = false;
     }
     else
     {
-        ErrorMessage = std::string("bool data '") + currentChild->Name() +
-                           "' has an invalid value of '" + currentChild->Attribute("value") + "'";
-        throw EXCEPTION_FAILURE;
+        ThrowInvalidValue("bool", value);
     }
 }
 void XmlReader::ReadString(std::string& outStr)
 {
-    XML_READ_ERROR_CHECK("string")
-
-    outStr = currentChild->Attribute("value");
-    currentChild = currentChild->NextSiblingElement();
+    Slice value = ReadValue("string");
+    if (!DecodeXmlText(value.Start, value.Start + value.Length, outStr))
+    {
+        ThrowInvalidValue("string", value);
+    }
 }
 
 
 //Other implementations of "Read" functions are all nearly identical.
-#define IMPL_XML_READ(dataType, dataTypeName, queryAttributeData, dataTypeStr, preDataType) \
+#define IMPL_XML_READ(dataType, dataTypeName, parseFunc, dataTypeStr, preDataType) \
     void XmlReader::Read ## dataTypeName(dataType & outData) \
     { \
-        XML_READ_ERROR_CHECK(dataTypeStr); \
-        \
-        preDataType value; \
-        ErrorMessage = TinyXMLErrorToString(currentChild-> ## queryAttributeData("value", &value)); \
+        Slice value = ReadValue(dataTypeStr); \
         \
-        if (ErrorMessage.empty()) \
+        preDataType parsed; \
+        if (!parseFunc(value.Start, value.Start + value.Length, parsed)) \
         { \
-            currentChild = currentChild->NextSiblingElement(); \
-            outData = (dataType)value; \
-        } \
-        else \
-        { \
-            ErrorMessage = std::string("Invalid ") + dataTypeStr + " value of '" + \
-                               currentChild->Attribute("value") + ": " + ErrorMessage; \
-            throw EXCEPTION_FAILURE; \
+            ThrowInvalidValue(dataTypeStr, value); \
         } \
+        outData = (dataType)parsed; \
     }
 
-IMPL_XML_READ(unsigned char, Byte, QueryUnsignedAttribute, "byte", unsigned int)
-IMPL_XML_READ(int, Int, QueryIntAttribute, "int", int)
-IMPL_XML_READ(unsigned int, UInt, QueryUnsignedAttribute, "uint", unsigned int)
-IMPL_XML_READ(float, Float, QueryFloatAttribute, "float", float)
-IMPL_XML_READ(double, Double, QueryDoubleAttribute, "double", double)
+IMPL_XML_READ(unsigned char, Byte, ParseUInt, "byte", unsigned int)
+IMPL_XML_READ(int, Int, ParseInt, "int", int)
+IMPL_XML_READ(unsigned int, UInt, ParseUInt, "uint", unsigned int)
+IMPL_XML_READ(float, Float, ParseFloat, "float", float)
+IMPL_XML_READ(double, Double, ParseDouble, "double", double)
 
 void XmlReader::ReadBytes(std::vector<unsigned char>& outBytes)
 {
-    XML_READ_ERROR_CHECK("byteData");
-
-    std::string hexNumbers = currentChild->Attribute("value");
-    currentChild = currentChild->NextSiblingElement();
-
-    HexToBytes(hexNumbers, outBytes, ErrorMessage);
+    Slice value = ReadValue("byteData");
+    HexToBytes(value.Start, value.Length, outBytes, ErrorMessage);
 }
 
-void XmlReader::ReadCollection(ElementReader readerFunc, CollectionResizer resizer,
-                               void* pCollection, void* optionalData)
-{
-    if (currentChild == 0)
-    {
-        ErrorMessage = std::string("No more data in the structure '") +
-                           currentRoot->Attribute("name") + "'";
-        throw EXCEPTION_FAILURE;
-    }
-    
-    if (std::string(currentChild->Name()).compare("collection") != 0)
-    {
-        ErrorMessage = std::string("The next data in this structure '") +
-                           currentRoot->Attribute("name") +
-                           "' is the " + currentChild->Name() + " '" +
-                           currentChild->Attribute("name") + "', not a collection";
-        throw EXCEPTION_FAILURE;
-    }
-    //TODO: Use that XML_READ_ERROR_CHECK macro instead of the above two conditionals.
 
-    //Hold on to the new values of this instance's fields after this operation is done.
-    XMLElement* oldRoot = currentRoot;
-    XMLElement* nextChild = currentChild->NextSiblingElement();
+unsigned int XmlReader::BeginCollection(void)
+{
+    CheckNextElement("collection");
 
-    currentChild = currentChild->FirstChildElement();
+    Slice sizeAttr = next.SizeAttr;
+    EnterNextElement();
 
-    unsigned int index = 0;
-    while (currentChild != 0)
+    //Collections written by XmlWriter store their size.
+    unsigned int nElements;
+    if (sizeAttr.Exists() && ParseUInt(sizeAttr.Start, sizeAttr.Start + sizeAttr.Length, nElements))
     {
-        //Prepare the data to be read.
-        resizer(pCollection, index + 1);
+        return nElements;
+    }
 
-        //Try to read the data.
-        currentRoot = currentChild;
-        XMLElement* oldChild = currentChild;
-        currentChild = currentRoot->FirstChildElement();
-        readerFunc(this, pCollection, index, optionalData);
+    //Otherwise, count the elements and then come back to the first one.
+    const char* firstPos = pos;
+    Tag firstTag = next;
 
-        currentChild = oldChild->NextSiblingElement();
-        index += 1;
+    nElements = 0;
+    while (!next.IsEnd)
+    {
+        nElements += 1;
+        SkipNextElement();
     }
 
-    //Reset this reader's position to the next child after the collection.
-    currentRoot = oldRoot;
-    currentChild = nextChild;
+    pos = firstPos;
+    next = firstTag;
+    return nElements;
 }
-
-void XmlReader::ReadDataStructure(IReadable& toSerialize)
+void XmlReader::BeginCollectionElement(unsigned int elementIndex)
 {
-    //Make sure the structure's root exists.
-    if (currentChild == 0)
+    if (next.IsEnd)
     {
-        ErrorMessage = std::string("No more data in the structure '") +
-                           currentRoot->Attribute("name") + "'";
+        ErrorMessage = "Collection '" + GetCurrentName() + "' ran out of elements at index " +
+                           std::to_string(elementIndex);
         throw EXCEPTION_FAILURE;
     }
-    if (std::string(currentChild->Name()).compare("dataStructure") != 0)
+
+    EnterNextElement();
+}
+void XmlReader::EndCollectionElement(void)
+{
+    ExitElement();
+}
+void XmlReader::EndCollection(void)
+{
+    if (!next.IsEnd)
     {
-        ErrorMessage = std::string("The next data in this structure '") +
-                           currentRoot->Attribute("name") + "' is the " + currentChild->Name() + " '" +
-                           currentChild->Attribute("name") + "', not a 'dataStructure'.";
+        ErrorMessage = "Collection '" + GetCurrentName() +
+                           "' has more elements than its 'size' attribute says";
         throw EXCEPTION_FAILURE;
     }
-    //TODO: Use that XML_READ_ERROR_CHECK macro instead of the above two conditionals.
 
+    ExitElement();
+}
 
-    //Keep hold of this instance's new field data after this function is done.
-    XMLElement* oldRoot = currentRoot;
-    XMLElement* nextChild = currentChild->NextSiblingElement();
+void XmlReader::ReadDataStructure(IReadable& toSerialize)
+{
+    CheckNextElement("dataStructure");
 
-    //Try writing to the structure.
-    currentRoot = currentChild;
-    currentChild = currentRoot->FirstChildElement();
+    EnterNextElement();
     toSerialize.ReadData(this);
-
-    //Move out of that structure's root, back into its parent.
-    currentRoot = oldRoot;
-    currentChild = nextChild;
+    ExitElement();
 }
\ No newline at end of file
@@ -1,21 +1,18 @@
 #pragma once
 
 #include "DataSerialization.h"
-#include "tinyxml2.h"
-
-
-//Converts the given error code into a string.
-std::string TinyXMLErrorToString(tinyxml2::XMLError err);
+#include <utility>
 
 
 //Writes data to XML.
+//The XML text is built up directly in one growing buffer rather than as a tree of nodes.
 class XmlWriter : public DataWriter
 {
 public:
 
     XmlWriter(std::string rootNodeName = "root");
 
-    
+
     //Saves the written data out to a file at the given path.
     //Returns an error message, or the empty string if the data was saved successfully.
     std::string SaveData(const std::string& path);
@@ -29,22 +26,48 @@ public:
     virtual void WriteString(const std::string& value, const std::string& name) override;
     virtual void WriteBytes(const unsigned char* bytes, unsigned int nBytes, const std::string& name) override;
 
-    virtual void WriteCollection(ElementWriter writerFunc, const std::string& name,
-                                 unsigned int bytesPerElement,
-                                 const void* collection, unsigned int collectionSize,
-                                 void* optionalData = 0) override;
-
     virtual void WriteDataStructure(const IWritable& toSerialize, const std::string& name) override;
 
 
+protected:
+
+    virtual void BeginCollection(const std::string& name, unsigned int nElements) override;
+    virtual void BeginCollectionElement(unsigned int elementIndex) override;
+    virtual void EndCollectionElement(void) override;
+    virtual void EndCollection(void) override;
+
+
 private:
 
-    tinyxml2::XMLDocument doc;
-    tinyxml2::XMLElement* currentRoot;
+    //Writes the start of a new element's opening tag, e.x. '<tag'.
+    //The tag is left open so that attributes can be added to it.
+    void StartElement(const char* tag);
+    //Finishes the current opening tag, making the element able to hold children.
+    void FinishOpeningTag(void);
+    //Closes the most recently-started element.
+    void EndElement(void);
+    //Writes a complete element with no children, of the form '<tag name="name" value="value"/>'.
+    void WriteValueElement(const char* tag, const std::string& name, const char* value, unsigned int valueLength);
+
+    //Writes an attribute into the currently-open tag.
+    void WriteAttribute(const char* attrName, const char* value, unsigned int valueLength);
+    void WriteAttribute(const char* attrName, const std::string& value) { WriteAttribute(attrName, value.c_str(), value.size()); }
+    //Writes the given text with any special XML characters escaped.
+    void WriteEscaped(const char* text, unsigned int length);
+    void WriteIndent(void);
+
+    std::string rootName;
+    std::string output;
+
+    //The tag of every element that's currently open, and whether its opening tag is still unfinished
+    //    (i.e. it doesn't have any children yet).
+    std::vector<std::pair<std::string, bool>> openElements;
 };
 
 
 //Reads data from XML.
+//The XML text is read as a stream of tags (a "pull" parser) straight out of the file's buffer
+//    instead of being loaded into a tree of nodes.
 class XmlReader : public DataReader
 {
 public:
@@ -67,15 +90,74 @@ public:
     virtual void ReadString(std::string& outStr) override;
     virtual void ReadBytes(std::vector<unsigned char>& outBytes) override;
 
-    virtual void ReadCollection(ElementReader readerFunc, CollectionResizer resizer,
-                                void* pCollection, void* optionalData = 0) override;
-
     virtual void ReadDataStructure(IReadable& toSerialize) override;
 
 
+protected:
+
+    virtual unsigned int BeginCollection(void) override;
+    virtual void BeginCollectionElement(unsigned int elementIndex) override;
+    virtual void EndCollectionElement(void) override;
+    virtual void EndCollection(void) override;
+
+
 private:
 
-    tinyxml2::XMLDocument doc;
-    tinyxml2::XMLElement *currentRoot,
-                         *currentChild;
-};
\ No newline at end of file
+    //A piece of text inside the XML buffer.
+    struct Slice
+    {
+        const char* Start;
+        unsigned int Length;
+
+        Slice(void) : Start(0), Length(0) { }
+        Slice(const char* start, unsigned int length) : Start(start), Length(length) { }
+
+        bool Exists(void) const { return Start != 0; }
+        bool Equals(const char* str) const;
+        std::string ToString(void) const { return (Start == 0) ? "" : std::string(Start, Length); }
+    };
+
+    //A tag that was read from the XML buffer.
+    struct Tag
+    {
+        //If true, this tag ends the current element (or the file) instead of starting a new one.
+        bool IsEnd;
+        //If true, this is an opening tag that also closes itself, e.x. '<a value="5"/>'.
+        bool IsSelfClosing;
+
+        Slice Name;
+        //The attributes that this reader cares about.
+        Slice NameAttr, ValueAttr, SizeAttr;
+    };
+
+
+    //Reads the next tag after the read position into "next".
+    void PeekNextTag(void);
+    //Skips past the element that "next" starts, including all its children.
+    void SkipNextElement(void);
+    //Moves into the element that "next" starts.
+    void EnterNextElement(void);
+    //Skips the rest of the current element and moves back out into its parent.
+    void ExitElement(void);
+
+    //Throws an exception if "next" isn't the start of an element with the given tag.
+    void CheckNextElement(const char* tag);
+    //Gets the "value" attribute of the next element, which should have the given tag,
+    //    and then moves past that element.
+    Slice ReadValue(const char* tag);
+    //Throws an exception with a message about the given value not being a valid instance of the given type.
+    void ThrowInvalidValue(const char* typeName, Slice value);
+
+    //Gets the name of the element this reader is currently in, for error messages.
+    std::string GetCurrentName(void) const;
+
+
+    //The contents of the file, plus a null terminator.
+    std::vector<char> buffer;
+    //The read position in the buffer, just past the tag in "next".
+    const char* pos;
+    Tag next;
+
+    //The names of the elements that this reader is currently inside of.
+    std::vector<Slice> openElements;
+};
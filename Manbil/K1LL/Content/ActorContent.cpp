@@ -3,15 +3,21 @@
 #include "../../Rendering/Data Nodes/DataNodes.hpp"
 #include "../../Rendering/Data Nodes/ShaderGenerator.h"
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-
 
 namespace
 {
     const std::string uniform_teamColor = "u_teamColor",
                       uniform_playerTex = "u_tex";
+
+    const unsigned int N_PLAYER_MESHES = 5;
+    const unsigned int PLAYER_VERTEX_PARTS = AssetLoader::VP_POS | AssetLoader::VP_UV |
+                                             AssetLoader::VP_NORMAL;
+
+    std::string GetPlayerMeshFile(unsigned int i)
+    {
+        return "Content/Game/Meshes/Players/M" + std::to_string(i) + ".obj";
+    }
+    const std::string PLAYER_TEX_FILE = "Content/Game/Textures/Player.png";
 }
 
 
@@ -26,7 +32,16 @@ ActorContent::ActorContent(void)
 }
 
 
-bool ActorContent::Initialize(std::string& err)
+void ActorContent::AddAssets(AssetLoader& assets)
+{
+    for (unsigned int i = 0; i < N_PLAYER_MESHES; ++i)
+    {
+        assets.AddMesh(GetPlayerMeshFile(i), PLAYER_VERTEX_PARTS);
+    }
+    assets.AddImage(PLAYER_TEX_FILE);
+}
+
+bool ActorContent::Initialize(AssetLoader& assets, std::string& err)
 {
     Destroy();
 
@@ -34,73 +49,26 @@ bool ActorContent::Initialize(std::string& err)
 
     #pragma region Player meshes
 
+    for (unsigned int i = 0; i < N_PLAYER_MESHES; ++i)
     {
-        std::vector<VertexPosUVNormal> vertices;
-        std::vector<unsigned int> indices;
-
-        Assimp::Importer importer;
-        unsigned int flags = aiProcessPreset_TargetRealtime_MaxQuality;
-
-        const unsigned int nMeshes = 5;
-        for (unsigned int i = 0; i < nMeshes; ++i)
+        const AssetLoader::MeshFile* mesh = assets.GetMesh(GetPlayerMeshFile(i),
+                                                           PLAYER_VERTEX_PARTS, err);
+        if (mesh == 0)
         {
-            std::string file = "Content/Game/Meshes/Players/M" + std::to_string(i) + ".obj";
-            const aiScene* scene = importer.ReadFile(file, flags);
-
-            //Load the scene/mesh.
-            if (scene == 0)
-            {
-                err = "Error loading player mesh '" + file + "': " + importer.GetErrorString();
-                return false;
-            }
-            if (scene->mNumMeshes != 1)
-            {
-                err = "Mesh '" + file + "' should only have one mesh!";
-                return false;
-            }
-
-            aiMesh* mesh = scene->mMeshes[0];
-
-
-            //Make sure the mesh is valid.
-            assert(mesh->HasFaces());
-            if (!mesh->HasPositions() || !mesh->HasTextureCoords(0) || !mesh->HasNormals())
-            {
-                err = "Mesh '" + file + "' is missing positions, normals, or UVs!";
-                return false;
-            }
-
-
-            //Populate the vertex/index buffer data.
-            vertices.resize(mesh->mNumVertices);
-            for (unsigned int i = 0; i < mesh->mNumVertices; ++i)
-            {
-                vertices[i].Pos = *(Vector3f*)(&mesh->mVertices[i].x);
-                vertices[i].UV = *(Vector2f*)(&mesh->mTextureCoords[0][i].x);
-                vertices[i].Normal = *(Vector3f*)(&mesh->mNormals[i].x);
-            }
-            indices.resize(mesh->mNumFaces);
-            for (unsigned int i = 0; i < mesh->mNumFaces; ++i)
-            {
-                aiFace& fce = mesh->mFaces[i];
-                if (fce.mNumIndices != 3)
-                {
-                    err = "A face in mesh '" + file + "' has a non-tri face with " +
-                            std::to_string(fce.mNumIndices) + " indices!";
-                    return false;
-                }
-
-                indices.push_back(fce.mIndices[0]);
-                indices.push_back(fce.mIndices[1]);
-                indices.push_back(fce.mIndices[2]);
-            }
-
-            //Create the vertex/index buffers.
-            playerMesh.SubMeshes.push_back(MeshData(false, PT_TRIANGLE_LIST));
-            MeshData& dat = playerMesh.SubMeshes[playerMesh.SubMeshes.size() - 1];
-            dat.SetVertexData(vertices, MeshData::BUF_STATIC, playerVertices);
-            dat.SetIndexData(indices, MeshData::BUF_STATIC);
+            return false;
         }
+
+        //Create the vertex/index buffers.
+        playerMesh.SubMeshes.push_back(MeshData(false, PT_TRIANGLE_LIST));
+        MeshData& dat = playerMesh.SubMeshes[playerMesh.SubMeshes.size() - 1];
+        dat.SetVertexData(mesh->GetVertices<VertexPosUVNormal>(), mesh->GetNVertices(),
+                          MeshData::BUF_STATIC, playerVertices);
+        dat.SetIndexData(mesh->Indices, MeshData::BUF_STATIC);
+
+        //Build the collision hierarchy from the CPU copy of the mesh.
+        playerMeshBVHs.push_back(TriangleBVH());
+        playerMeshBVHs.back().Build(&mesh->GetVertices<VertexPosUVNormal>()[0].Pos, sizeof(VertexPosUVNormal),
+                                    mesh->Indices.data(), mesh->Indices.size() / 3);
     }
 
     #pragma endregion
@@ -108,13 +76,14 @@ bool ActorContent::Initialize(std::string& err)
     #pragma region Player Texture
 
     {
-        const std::string file = "Content/Game/Textures/Player.png";
-        playerTex.Create();
-        if (!playerTex.SetDataFromFile(file, err))
+        const Array2D<Vector4b>* pixels = assets.GetImage(PLAYER_TEX_FILE, err);
+        if (pixels == 0)
         {
-            err = "Error loading '" + file + "': " + err;
             return false;
         }
+
+        playerTex.Create();
+        playerTex.SetColorData(*pixels);
     }
 
     #pragma endregion
@@ -184,6 +153,7 @@ void ActorContent::Destroy(void)
 
 
     CLEAR_ALL(player);
+    playerMeshBVHs.clear();
     playerTex.DeleteIfValid();
     
     CLEAR_ALL(lightAmmo);
@@ -194,6 +164,38 @@ void ActorContent::Destroy(void)
     
     #undef CLEAR_ALL
 }
+bool ActorContent::Reload(AssetLoader& assets, std::string& err)
+{
+    //Build the new content on the side so a failure leaves the old content usable.
+    ActorContent newContent;
+    if (!newContent.Initialize(assets, err))
+    {
+        newContent.Destroy();
+        return false;
+    }
+
+    Destroy();
+
+    #define SWAP_ALL(varNameBase) \
+        std::swap(varNameBase ## Mat, newContent.varNameBase ## Mat); \
+        varNameBase ## Mesh.SubMeshes.swap(newContent.varNameBase ## Mesh.SubMeshes); \
+        varNameBase ## Params.swap(newContent.varNameBase ## Params);
+
+
+    SWAP_ALL(player);
+    playerMeshBVHs.swap(newContent.playerMeshBVHs);
+    std::swap(playerTex, newContent.playerTex);
+
+    SWAP_ALL(lightAmmo);
+    SWAP_ALL(heavyAmmo);
+    SWAP_ALL(specialAmmo);
+    SWAP_ALL(health);
+
+
+    #undef SWAP_ALL
+
+    return true;
+}
 
 void ActorContent::RenderPlayer(Vector2f pos, Vector3f forward, Vector3f color, unsigned int meshIndex,
                                 const RenderInfo& info)
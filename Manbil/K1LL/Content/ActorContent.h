@@ -1,7 +1,9 @@
 #pragma once
 
 #include "../../Rendering/Rendering.hpp"
+#include "../../Math/Higher Math/TriangleBVH.h"
 #include "../Level Info/ItemTypes.h"
+#include "AssetLoader.h"
 
 
 //Contains all 3D content for a match, except for weapons which are in "WeaponContent".
@@ -12,18 +14,27 @@ public:
     static ActorContent Instance;
 
 
-    //Creates/loads all the actor content.
+    //Adds all the files this content needs to the given loader.
+    static void AddAssets(AssetLoader& assets);
+
+    //Creates/loads all the actor content, using the files from the given loader.
     //Returns true if everything was initialized correctly.
     //Outputs an error message and returns false if something failed.
-    bool Initialize(std::string& outErrorMsg);
+    bool Initialize(AssetLoader& assets, std::string& outErrorMsg);
 
     //Destroys/unloads all the actor content.
     //If "Initialize()" hasn't been called, nothing will happen.
     void Destroy(void);
 
+    //Rebuilds all the actor content from the given loader's files.
+    //If something fails, outputs an error message and returns false without touching the current content.
+    bool Reload(AssetLoader& assets, std::string& outErrorMsg);
+
 
     //Gets the number of different available player meshes.
     unsigned int GetNPlayerMeshes(void) const { return playerMesh.SubMeshes.size(); }
+    //Gets the collision hierarchy for the given player mesh, in the mesh's local space.
+    const TriangleBVH& GetPlayerMeshBVH(unsigned int meshIndex) const { return playerMeshBVHs[meshIndex]; }
 
 
     //Renders a player with the given information.
@@ -37,6 +48,7 @@ private:
 
     //The player meshes. Each potential player mesh is a single MeshData instance.
     Mesh playerMesh;
+    std::vector<TriangleBVH> playerMeshBVHs;
     Material* playerMat;
     MTexture2D playerTex;
     UniformDictionary playerParams;
@@ -0,0 +1,500 @@
+#include "AssetLoader.h"
+
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <stdio.h>
+
+#include <SFML/System/Clock.hpp>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+
+namespace
+{
+    #pragma region Baked mesh cache
+
+    //Parsing a mesh with Assimp is slow, so the result is baked into a cache file next to the mesh.
+    //The cache file is a header followed by the vertex floats and then the indices,
+    //    exactly as they're laid out in memory, so loading it is just a couple of reads.
+    //It's only used if it was baked from a source file with the same hash and the same vertex layout.
+
+    const char MESH_CACHE_EXTENSION[] = ".bakedmesh";
+    const unsigned int MESH_CACHE_MAGIC = 0x4853454d, //"MESH" in little-endian.
+                       MESH_CACHE_VERSION = 1;
+
+    struct MeshCacheHeader
+    {
+        unsigned int Magic, Version;
+        unsigned long long SourceHash;
+        unsigned int VertexParts, NFloats, NIndices,
+                     Padding;
+    };
+
+
+    //Reads the whole file at the given path. Returns false if it couldn't be read.
+    bool ReadWholeFile(const std::string& path, std::vector<unsigned char>& outBytes)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == 0)
+        {
+            return false;
+        }
+
+        fseek(file, 0, SEEK_END);
+        long fileSize = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        outBytes.resize(fileSize < 0 ? 0 : fileSize);
+        bool success = (fileSize >= 0) &&
+                       (fread(outBytes.data(), 1, outBytes.size(), file) == outBytes.size());
+        fclose(file);
+        return success;
+    }
+
+    //A 64-bit FNV-1a hash of the given bytes.
+    unsigned long long HashBytes(const std::vector<unsigned char>& bytes)
+    {
+        unsigned long long hash = 14695981039346656037ULL;
+        for (unsigned int i = 0; i < bytes.size(); ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    //Tries to load the given mesh data from the cache.
+    //Returns false if the cache doesn't exist, is stale, can't be read, or doesn't hold a valid mesh.
+    bool TryLoadMeshCache(const std::string& cachePath, unsigned long long sourceHash,
+                          AssetLoader::MeshFile& outData)
+    {
+        FILE* file = fopen(cachePath.c_str(), "rb");
+        if (file == 0)
+        {
+            return false;
+        }
+
+        fseek(file, 0, SEEK_END);
+        long fileSize = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        //The header's counts have to describe exactly the rest of the file,
+        //    and the vertex floats have to split evenly into vertices.
+        MeshCacheHeader header;
+        unsigned int floatsPerVertex = AssetLoader::GetNFloats(outData.VertexParts);
+        bool success = (fread(&header, sizeof(header), 1, file) == 1) &&
+                       header.Magic == MESH_CACHE_MAGIC && header.Version == MESH_CACHE_VERSION &&
+                       header.SourceHash == sourceHash && header.VertexParts == outData.VertexParts &&
+                       fileSize >= 0 &&
+                       (unsigned long long)fileSize ==
+                           sizeof(header) + (sizeof(float) * (unsigned long long)header.NFloats) +
+                                            (sizeof(unsigned int) * (unsigned long long)header.NIndices) &&
+                       floatsPerVertex > 0 && (header.NFloats % floatsPerVertex) == 0;
+        if (success)
+        {
+            outData.Vertices.resize(header.NFloats);
+            outData.Indices.resize(header.NIndices);
+            success = (fread(outData.Vertices.data(), sizeof(float), header.NFloats, file) ==
+                           header.NFloats) &&
+                      (fread(outData.Indices.data(), sizeof(unsigned int), header.NIndices, file) ==
+                           header.NIndices);
+        }
+        fclose(file);
+
+        //Every index has to point to one of the vertices.
+        unsigned int nVertices = (success ? (header.NFloats / floatsPerVertex) : 0);
+        for (unsigned int i = 0; success && i < outData.Indices.size(); ++i)
+        {
+            success = (outData.Indices[i] < nVertices);
+        }
+
+        if (!success)
+        {
+            outData.Vertices.clear();
+            outData.Indices.clear();
+        }
+        return success;
+    }
+    //Bakes the given mesh data into the cache. Returns whether it succeeded.
+    bool SaveMeshCache(const std::string& cachePath, unsigned long long sourceHash,
+                       const AssetLoader::MeshFile& data)
+    {
+        FILE* file = fopen(cachePath.c_str(), "wb");
+        if (file == 0)
+        {
+            return false;
+        }
+
+        MeshCacheHeader header;
+        header.Magic = MESH_CACHE_MAGIC;
+        header.Version = MESH_CACHE_VERSION;
+        header.SourceHash = sourceHash;
+        header.VertexParts = data.VertexParts;
+        header.NFloats = data.Vertices.size();
+        header.NIndices = data.Indices.size();
+        header.Padding = 0;
+
+        bool success = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+                       (fwrite(data.Vertices.data(), sizeof(float), header.NFloats, file) ==
+                            header.NFloats) &&
+                       (fwrite(data.Indices.data(), sizeof(unsigned int), header.NIndices, file) ==
+                            header.NIndices);
+        fclose(file);
+
+        //Don't leave a half-written cache lying around.
+        if (!success)
+        {
+            remove(cachePath.c_str());
+        }
+        return success;
+    }
+
+    #pragma endregion
+}
+
+
+unsigned int AssetLoader::GetNFloats(unsigned int parts)
+{
+    return ((parts & VP_POS) ? 3 : 0) +
+           ((parts & VP_UV) ? 2 : 0) +
+           ((parts & VP_NORMAL) ? 3 : 0) +
+           ((parts & VP_TANGENTS) ? 6 : 0);
+}
+
+
+void AssetLoader::AddMesh(const std::string& filePath, unsigned int vertexParts)
+{
+    MeshEntry* entry = FindMesh(filePath);
+    if (entry == 0)
+    {
+        meshes.push_back(std::unique_ptr<MeshEntry>(new MeshEntry(filePath, vertexParts)));
+    }
+    else
+    {
+        //Every user of a mesh file has to agree on the vertex layout.
+        assert(entry->Data.VertexParts == vertexParts);
+    }
+}
+void AssetLoader::AddImage(const std::string& filePath)
+{
+    if (FindImage(filePath) == 0)
+    {
+        images.push_back(std::unique_ptr<ImageEntry>(new ImageEntry(filePath)));
+    }
+}
+
+void AssetLoader::GetFilePaths(std::vector<std::string>& outPaths) const
+{
+    for (unsigned int i = 0; i < meshes.size(); ++i)
+    {
+        outPaths.push_back(meshes[i]->Path);
+    }
+    for (unsigned int i = 0; i < images.size(); ++i)
+    {
+        outPaths.push_back(images[i]->Path);
+    }
+}
+
+void AssetLoader::LoadAll(ThreadPool& pool)
+{
+    //Meshes go first, since they usually take the longest.
+    std::vector<MeshEntry*> toLoadMeshes;
+    std::vector<ImageEntry*> toLoadImages;
+    for (unsigned int i = 0; i < meshes.size(); ++i)
+    {
+        if (!meshes[i]->IsLoaded)
+        {
+            toLoadMeshes.push_back(meshes[i].get());
+        }
+    }
+    for (unsigned int i = 0; i < images.size(); ++i)
+    {
+        if (!images[i]->IsLoaded)
+        {
+            toLoadImages.push_back(images[i].get());
+        }
+    }
+
+    sf::Clock clock;
+
+    unsigned int nMeshes = toLoadMeshes.size();
+    pool.ParallelFor(nMeshes + toLoadImages.size(), [&](unsigned int i)
+    {
+        if (i < nMeshes)
+        {
+            LoadMeshEntry(*toLoadMeshes[i]);
+        }
+        else
+        {
+            LoadImageEntry(*toLoadImages[i - nMeshes]);
+        }
+    });
+
+    AddTiming("Loading " + std::to_string(nMeshes) + " meshes and " +
+                  std::to_string(toLoadImages.size()) + " images on " +
+                  std::to_string(pool.GetNThreads() + 1) + " threads",
+              clock.getElapsedTime().asSeconds());
+}
+
+bool AssetLoader::LoadAll(std::string& err)
+{
+    for (unsigned int i = 0; i < meshes.size(); ++i)
+    {
+        if (GetMesh(meshes[i]->Path, meshes[i]->Data.VertexParts, err) == 0)
+        {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < images.size(); ++i)
+    {
+        if (GetImage(images[i]->Path, err) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const AssetLoader::MeshFile* AssetLoader::GetMesh(const std::string& filePath, unsigned int vertexParts,
+                                                  std::string& err)
+{
+    MeshEntry* entry = FindMesh(filePath);
+    if (entry == 0)
+    {
+        AddMesh(filePath, vertexParts);
+        entry = meshes[meshes.size() - 1].get();
+    }
+    else if (entry->Data.VertexParts != vertexParts)
+    {
+        err = "Mesh '" + filePath + "' was loaded with a different vertex layout";
+        return 0;
+    }
+
+    if (!entry->IsLoaded)
+    {
+        LoadMeshEntry(*entry);
+    }
+
+    if (!entry->ErrorMsg.empty())
+    {
+        err = entry->ErrorMsg;
+        return 0;
+    }
+    return &entry->Data;
+}
+const Array2D<Vector4b>* AssetLoader::GetImage(const std::string& filePath, std::string& err)
+{
+    ImageEntry* entry = FindImage(filePath);
+    if (entry == 0)
+    {
+        AddImage(filePath);
+        entry = images[images.size() - 1].get();
+    }
+
+    if (!entry->IsLoaded)
+    {
+        LoadImageEntry(*entry);
+    }
+
+    if (!entry->ErrorMsg.empty())
+    {
+        err = entry->ErrorMsg;
+        return 0;
+    }
+    return &entry->Data;
+}
+
+void AssetLoader::AddTiming(const std::string& name, float seconds)
+{
+    timings.push_back(Timing(name, seconds));
+}
+std::string AssetLoader::GetTimingReport(void) const
+{
+    std::vector<Timing> allTimings = timings;
+    for (unsigned int i = 0; i < meshes.size(); ++i)
+    {
+        if (meshes[i]->IsLoaded)
+        {
+            allTimings.push_back(Timing(meshes[i]->Path + (meshes[i]->IsFromCache ? " (baked)" : ""),
+                                        meshes[i]->LoadSeconds));
+        }
+    }
+    for (unsigned int i = 0; i < images.size(); ++i)
+    {
+        if (images[i]->IsLoaded)
+        {
+            allTimings.push_back(Timing(images[i]->Path, images[i]->LoadSeconds));
+        }
+    }
+
+    std::sort(allTimings.begin(), allTimings.end(),
+              [](const Timing& t1, const Timing& t2) { return t1.Seconds > t2.Seconds; });
+
+    std::stringstream report;
+    report << std::fixed << std::setprecision(2);
+    for (unsigned int i = 0; i < allTimings.size(); ++i)
+    {
+        report << std::setw(10) << (allTimings[i].Seconds * 1000.0f) << "ms  " <<
+                  allTimings[i].Name << "\n";
+    }
+    return report.str();
+}
+
+void AssetLoader::Clear(void)
+{
+    meshes.clear();
+    images.clear();
+    timings.clear();
+}
+
+AssetLoader::MeshEntry* AssetLoader::FindMesh(const std::string& filePath)
+{
+    for (unsigned int i = 0; i < meshes.size(); ++i)
+    {
+        if (meshes[i]->Path == filePath)
+        {
+            return meshes[i].get();
+        }
+    }
+    return 0;
+}
+AssetLoader::ImageEntry* AssetLoader::FindImage(const std::string& filePath)
+{
+    for (unsigned int i = 0; i < images.size(); ++i)
+    {
+        if (images[i]->Path == filePath)
+        {
+            return images[i].get();
+        }
+    }
+    return 0;
+}
+
+void AssetLoader::LoadMeshEntry(MeshEntry& entry)
+{
+    sf::Clock clock;
+    entry.IsLoaded = true;
+
+    const std::string& file = entry.Path;
+    unsigned int parts = entry.Data.VertexParts;
+
+    //Try the baked cache first.
+    std::vector<unsigned char> sourceBytes;
+    if (!ReadWholeFile(file, sourceBytes))
+    {
+        entry.ErrorMsg = "Error loading '" + file + "': the file couldn't be read";
+        return;
+    }
+    unsigned long long sourceHash = HashBytes(sourceBytes);
+    std::string cachePath = file + MESH_CACHE_EXTENSION;
+    if (TryLoadMeshCache(cachePath, sourceHash, entry.Data))
+    {
+        entry.IsFromCache = true;
+        entry.LoadSeconds = clock.getElapsedTime().asSeconds();
+        return;
+    }
+
+    //The cache is missing or stale, so parse the mesh with Assimp.
+    //Each thread needs its own importer.
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(file, aiProcessPreset_TargetRealtime_MaxQuality);
+
+    //Make sure the scene is valid.
+    if (scene == 0)
+    {
+        entry.ErrorMsg = "Error loading '" + file + "': " + importer.GetErrorString();
+        return;
+    }
+    if (scene->mNumMeshes != 1)
+    {
+        entry.ErrorMsg = "Mesh '" + file + "' has " + std::to_string(scene->mNumMeshes) +
+                             " meshes in it";
+        return;
+    }
+
+    aiMesh* mesh = scene->mMeshes[0];
+
+    //Make sure the mesh has everything that was asked for.
+    assert(mesh->HasFaces());
+    if (!mesh->HasPositions() ||
+        ((parts & VP_UV) && !mesh->HasTextureCoords(0)) ||
+        ((parts & VP_NORMAL) && !mesh->HasNormals()))
+    {
+        entry.ErrorMsg = "Mesh '" + file + "' is missing positions, normals, or UVs!";
+        return;
+    }
+    if ((parts & VP_TANGENTS) && !mesh->HasTangentsAndBitangents())
+    {
+        entry.ErrorMsg = "Mesh '" + file + "' is missing tangents/bitangents!";
+        return;
+    }
+
+    //Populate the vertex data.
+    std::vector<float>& vertices = entry.Data.Vertices;
+    vertices.resize(mesh->mNumVertices * GetNFloats(parts));
+    float* vert = vertices.data();
+    auto copyFloats = [&vert](const float* src, unsigned int nFloats)
+    {
+        memcpy(vert, src, nFloats * sizeof(float));
+        vert += nFloats;
+    };
+    for (unsigned int i = 0; i < mesh->mNumVertices; ++i)
+    {
+        if (parts & VP_POS)
+        {
+            copyFloats(&mesh->mVertices[i].x, 3);
+        }
+        if (parts & VP_UV)
+        {
+            copyFloats(&mesh->mTextureCoords[0][i].x, 2);
+        }
+        if (parts & VP_NORMAL)
+        {
+            copyFloats(&mesh->mNormals[i].x, 3);
+        }
+        if (parts & VP_TANGENTS)
+        {
+            copyFloats(&mesh->mTangents[i].x, 3);
+            copyFloats(&mesh->mBitangents[i].x, 3);
+        }
+    }
+
+    //Populate the index data.
+    std::vector<unsigned int>& indices = entry.Data.Indices;
+    indices.resize(mesh->mNumFaces * 3);
+    for (unsigned int i = 0; i < mesh->mNumFaces; ++i)
+    {
+        aiFace& fce = mesh->mFaces[i];
+        if (fce.mNumIndices != 3)
+        {
+            entry.ErrorMsg = "A face in mesh '" + file + "' has a non-tri face with " +
+                                 std::to_string(fce.mNumIndices) + " indices!";
+            return;
+        }
+
+        indices[(i * 3)] = fce.mIndices[0];
+        indices[(i * 3) + 1] = fce.mIndices[1];
+        indices[(i * 3) + 2] = fce.mIndices[2];
+    }
+
+    //Bake the result for next time. If that fails, the mesh just gets parsed again next time.
+    SaveMeshCache(cachePath, sourceHash, entry.Data);
+
+    entry.LoadSeconds = clock.getElapsedTime().asSeconds();
+}
+void AssetLoader::LoadImageEntry(ImageEntry& entry)
+{
+    sf::Clock clock;
+    entry.IsLoaded = true;
+
+    if (!MTexture2D::LoadImageFromFile(entry.Path, entry.Data))
+    {
+        entry.ErrorMsg = "Failed to load the image from '" + entry.Path + "'";
+        return;
+    }
+
+    entry.LoadSeconds = clock.getElapsedTime().asSeconds();
+}
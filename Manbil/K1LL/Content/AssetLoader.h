@@ -0,0 +1,142 @@
+#pragma once
+
+#include <memory>
+
+#include "../../Rendering/Rendering.hpp"
+#include "../../Threading/ThreadPool.h"
+
+
+//Loads the raw data from content files (parsing meshes and decoding images) across worker threads.
+//Parsed meshes are baked into a cache file next to the original, which is used instead of
+//    the original as long as the original hasn't changed.
+//The content classes then only have to upload that data to the GPU, which must happen on the main thread.
+//Also records how long each asset took to load.
+class AssetLoader
+{
+public:
+
+    //The parts of a mesh's vertices that can be loaded.
+    //Each vertex is a tightly-packed list of floats, with the parts in the order they're listed here.
+    enum VertexParts
+    {
+        //3 floats.
+        VP_POS = 1,
+        //2 floats.
+        VP_UV = 2,
+        //3 floats.
+        VP_NORMAL = 4,
+        //3 floats for the tangent, then 3 floats for the bitangent.
+        VP_TANGENTS = 8,
+    };
+
+    //Gets the number of floats in a vertex with the given combination of VertexParts flags.
+    static unsigned int GetNFloats(unsigned int vertexParts);
+
+
+    //The data loaded from a mesh file.
+    struct MeshFile
+    {
+        //The VertexParts flags that were loaded.
+        unsigned int VertexParts;
+        //The parts of each vertex, one vertex after another.
+        std::vector<float> Vertices;
+        //Every three indices make a triangle.
+        std::vector<unsigned int> Indices;
+
+
+        unsigned int GetNVertices(void) const { return Vertices.size() / GetNFloats(VertexParts); }
+
+        template<typename VertexType>
+        //Gets the vertices as an array of the given type, which must have the same layout as this data.
+        const VertexType* GetVertices(void) const
+        {
+            assert(sizeof(VertexType) == GetNFloats(VertexParts) * sizeof(float));
+            return (const VertexType*)Vertices.data();
+        }
+    };
+
+
+    //Adds a mesh file to be loaded the next time "LoadAll()" is called.
+    void AddMesh(const std::string& filePath, unsigned int vertexParts);
+    //Adds an image file to be loaded the next time "LoadAll()" is called.
+    void AddImage(const std::string& filePath);
+
+    //Outputs the path of every file that was added to this loader.
+    void GetFilePaths(std::vector<std::string>& outPaths) const;
+
+    //Loads every file that was added and isn't loaded yet, spread across the given pool's threads.
+    //Blocks until everything is finished.
+    void LoadAll(ThreadPool& pool);
+    //Loads every file that was added and isn't loaded yet on this thread.
+    //Outputs an error message and returns false if any file couldn't be loaded.
+    bool LoadAll(std::string& outErrorMsg);
+
+
+    //Gets the data for the given mesh file.
+    //If it wasn't already loaded by "LoadAll()", it is loaded now on this thread.
+    //Outputs an error message and returns 0 if the file couldn't be loaded.
+    const MeshFile* GetMesh(const std::string& filePath, unsigned int vertexParts,
+                            std::string& outErrorMsg);
+    //Gets the pixels of the given image file (with the Y flipped for OpenGL).
+    //If it wasn't already loaded by "LoadAll()", it is loaded now on this thread.
+    //Outputs an error message and returns 0 if the file couldn't be loaded.
+    const Array2D<Vector4b>* GetImage(const std::string& filePath, std::string& outErrorMsg);
+
+
+    //Adds an entry to the timing report for some step that isn't loading a file,
+    //    e.x. uploading a group of content to the GPU.
+    void AddTiming(const std::string& name, float seconds);
+    //Gets a readable report of how long everything took to load, slowest first.
+    std::string GetTimingReport(void) const;
+
+
+    //Throws out all loaded data and timings.
+    void Clear(void);
+
+
+private:
+
+    struct MeshEntry
+    {
+        std::string Path, ErrorMsg;
+        MeshFile Data;
+        bool IsLoaded, IsFromCache;
+        float LoadSeconds;
+
+        MeshEntry(const std::string& path, unsigned int vertexParts)
+            : Path(path), IsLoaded(false), IsFromCache(false), LoadSeconds(0.0f)
+        {
+            Data.VertexParts = vertexParts;
+        }
+    };
+    struct ImageEntry
+    {
+        std::string Path, ErrorMsg;
+        Array2D<Vector4b> Data;
+        bool IsLoaded;
+        float LoadSeconds;
+
+        ImageEntry(const std::string& path)
+            : Path(path), Data(1, 1), IsLoaded(false), LoadSeconds(0.0f) { }
+    };
+    struct Timing
+    {
+        std::string Name;
+        float Seconds;
+
+        Timing(const std::string& name, float seconds) : Name(name), Seconds(seconds) { }
+    };
+
+    //Entries are heap-allocated so that worker threads can safely hold onto them.
+    std::vector<std::unique_ptr<MeshEntry>> meshes;
+    std::vector<std::unique_ptr<ImageEntry>> images;
+    std::vector<Timing> timings;
+
+
+    MeshEntry* FindMesh(const std::string& filePath);
+    ImageEntry* FindImage(const std::string& filePath);
+
+    //These functions only touch the given entry, so they can run on any thread.
+    static void LoadMeshEntry(MeshEntry& entry);
+    static void LoadImageEntry(ImageEntry& entry);
+};
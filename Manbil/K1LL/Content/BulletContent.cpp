@@ -1,9 +1,5 @@
 #include "BulletContent.h"
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-
 #include "../../Rendering/Data Nodes/DataNodes.hpp"
 #include "../../Rendering/Data Nodes/ShaderGenerator.h"
 #include "WeaponConstants.h"
@@ -23,6 +19,28 @@ namespace
 
         B_NUMBER_OF_BULLETS
     };
+
+    const unsigned int BULLET_VERTEX_PARTS = AssetLoader::VP_POS | AssetLoader::VP_UV;
+
+    std::string GetBulletMeshFile(Bullets bullet)
+    {
+        std::string file = "Content/Game/Meshes/Bullets/";
+        switch (bullet)
+        {
+            case B_PUNCHER:
+                return file + "Puncher.obj";
+            case B_TERRIBLE_SHOTGUN:
+                return file + "Terrible Shotgun.obj";
+            case B_SPRAY_N_PRAY:
+                return file + "Spray and Pray.obj";
+            case B_CLUSTER:
+                return file + "Cluster.obj";
+
+            default:
+                assert(false);
+                return file;
+        }
+    }
 }
 
 
@@ -37,7 +55,15 @@ BulletContent::BulletContent(void)
 }
 
 
-bool BulletContent::Initialize(std::string& err)
+void BulletContent::AddAssets(AssetLoader& assets)
+{
+    for (unsigned int i = 0; i < B_NUMBER_OF_BULLETS; ++i)
+    {
+        assets.AddMesh(GetBulletMeshFile((Bullets)i), BULLET_VERTEX_PARTS);
+    }
+}
+
+bool BulletContent::Initialize(AssetLoader& assets, std::string& err)
 {
     typedef VertexPosUV BulletVertex;
     RenderIOAttributes vertIns = BulletVertex::GetVertexAttributes();
@@ -50,85 +76,19 @@ bool BulletContent::Initialize(std::string& err)
         bulletMesh.SubMeshes.push_back(MeshData(false, PT_TRIANGLE_LIST));
     }
 
-    std::vector<BulletVertex> vertices;
-    std::vector<unsigned int> indices;
-
-    Assimp::Importer importer;
-    unsigned int flags = aiProcessPreset_TargetRealtime_MaxQuality;
-
     for (unsigned int i = 0; i < B_NUMBER_OF_BULLETS; ++i)
     {
-        //Get the file for this bullet type.
-        std::string file = "Content/Game/Meshes/Bullets/";
-        switch ((Bullets)i)
-        {
-            case B_PUNCHER:
-                file += "Puncher.obj";
-                break;
-            case B_TERRIBLE_SHOTGUN:
-                file += "Terrible Shotgun.obj";
-                break;
-            case B_SPRAY_N_PRAY:
-                file += "Spray and Pray.obj";
-                break;
-            case B_CLUSTER:
-                file += "Cluster.obj";
-                break;
-
-            default:
-                assert(false);
-        }
-
-        const aiScene* scene = importer.ReadFile(file, flags);
-
-        //Make sure the scene is valid.
-        if (scene == 0)
-        {
-            err = "Error loading '" + file + "': " + importer.GetErrorString();
-            return false;
-        }
-        if (scene->mNumMeshes != 1)
-        {
-            err = "Mesh '" + file + "' has " + std::to_string(scene->mNumMeshes) + " meshes in it";
-            return false;
-        }
-
-        aiMesh* mesh = scene->mMeshes[0];
-
-        //Make sure the mesh is valid.
-        assert(mesh->HasFaces());
-        if (!mesh->HasPositions() || !mesh->HasTextureCoords(0))
+        const AssetLoader::MeshFile* mesh = assets.GetMesh(GetBulletMeshFile((Bullets)i),
+                                                           BULLET_VERTEX_PARTS, err);
+        if (mesh == 0)
         {
-            err = "Mesh '" + file + "' is missing positions or UVs!";
             return false;
         }
 
-        //Populate the vertex/index buffer data.
-        vertices.resize(mesh->mNumVertices);
-        for (unsigned int j = 0; j < mesh->mNumVertices; ++j)
-        {
-            vertices[j].Pos = *(Vector3f*)(&mesh->mVertices[j].x);
-            vertices[j].UV = *(Vector2f*)(&mesh->mTextureCoords[0][j].x);
-        }
-        indices.resize(mesh->mNumFaces * 3);
-        for (unsigned int j = 0; j < mesh->mNumFaces; ++j)
-        {
-            aiFace& fce = mesh->mFaces[j];
-            if (fce.mNumIndices != 3)
-            {
-                err = "A face in mesh '" + file + "' has a non-tri face with " +
-                      std::to_string(fce.mNumIndices) + " indices!";
-                return false;
-            }
-
-            indices[(j * 3)] = fce.mIndices[0];
-            indices[(j * 3) + 1] = fce.mIndices[1];
-            indices[(j * 3) + 2] = fce.mIndices[2];
-        }
-
         //Create the vertex/index buffers.
-        bulletMesh.SubMeshes[i].SetVertexData(vertices, MeshData::BUF_STATIC, vertIns);
-        bulletMesh.SubMeshes[i].SetIndexData(indices, MeshData::BUF_STATIC);
+        bulletMesh.SubMeshes[i].SetVertexData(mesh->GetVertices<BulletVertex>(), mesh->GetNVertices(),
+                                              MeshData::BUF_STATIC, vertIns);
+        bulletMesh.SubMeshes[i].SetIndexData(mesh->Indices, MeshData::BUF_STATIC);
     }
 
     #pragma endregion
@@ -189,11 +149,31 @@ void BulletContent::Destroy(void)
     bulletMesh.CurrentSubMesh = 0;
 
     delete bulletMat;
+    bulletMat = 0;
 
     bulletParams.clear();
 
     defaultTex.DeleteIfValid();
 }
+bool BulletContent::Reload(AssetLoader& assets, std::string& err)
+{
+    //Build the new content on the side so a failure leaves the old content usable.
+    BulletContent newContent;
+    if (!newContent.Initialize(assets, err))
+    {
+        newContent.Destroy();
+        return false;
+    }
+
+    Destroy();
+
+    bulletMesh.SubMeshes.swap(newContent.bulletMesh.SubMeshes);
+    std::swap(bulletMat, newContent.bulletMat);
+    bulletParams.swap(newContent.bulletParams);
+    std::swap(defaultTex, newContent.defaultTex);
+
+    return true;
+}
 
 void BulletContent::RenderPuncherBullet(Vector3f pos, Vector3f dir, const RenderInfo& info)
 {
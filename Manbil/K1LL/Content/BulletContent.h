@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../Rendering/Rendering.hpp"
+#include "AssetLoader.h"
 
 
 class BulletContent
@@ -10,15 +11,22 @@ public:
     static BulletContent Instance;
 
 
-    //Creates/loads all bullet content.
+    //Adds all the files this content needs to the given loader.
+    static void AddAssets(AssetLoader& assets);
+
+    //Creates/loads all bullet content, using the files from the given loader.
     //Returns true if everything was initialized correctly.
     //Outputs an error message and returns false if something failed.
-    bool Initialize(std::string& outErrorMsg);
+    bool Initialize(AssetLoader& assets, std::string& outErrorMsg);
 
     //Destroys/unloads all the bullet content.
     //If "Initialize()" hasn't been called, nothing will happen.
     void Destroy(void);
 
+    //Rebuilds all the bullet content from the given loader's files.
+    //If something fails, outputs an error message and returns false without touching the current content.
+    bool Reload(AssetLoader& assets, std::string& outErrorMsg);
+
 
     void RenderPuncherBullet(Vector3f pos, Vector3f dir, const RenderInfo& info);
 
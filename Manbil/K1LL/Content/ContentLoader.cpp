@@ -1,6 +1,9 @@
 #include "ContentLoader.h"
 
 #include <iostream>
+#include <unordered_map>
+
+#include <SFML/System/Clock.hpp>
 
 #include "LevelConstants.h"
 #include "WeaponConstants.h"
@@ -12,6 +15,127 @@
 #include "BulletContent.h"
 #include "ParticleContent.h"
 #include "PostProcessing.h"
+#include "AssetLoader.h"
+#include "../../IO/FileWatcher.h"
+
+
+namespace
+{
+    //The content that can be reloaded while the game is running.
+    //Other content, like the quality settings, sizes buffers that are already in use.
+    enum ReloadableContent
+    {
+        RC_LEVEL_CONSTANTS,
+        RC_WEAPON_CONSTANTS,
+        RC_MENU,
+        RC_ACTORS,
+        RC_WEAPONS,
+        RC_BULLETS,
+
+        RC_NUMBER_OF_CONTENT,
+    };
+
+    //The content built from each watched file.
+    //This doesn't need edges between the contents themselves: no content reads another content's
+    //    data or the constants while it's being built. The meshes and materials read the constants
+    //    every time they're rendered, so reloading the constants alone is enough.
+    std::unordered_map<std::string, std::vector<ReloadableContent>> fileDependents;
+    FileWatcher contentWatcher;
+
+    const float RELOAD_CHECK_INTERVAL = 0.5f;
+    float timeSinceReloadCheck = 0.0f;
+
+
+    void AddDependency(const std::string& file, ReloadableContent content)
+    {
+        fileDependents[file].push_back(content);
+        contentWatcher.AddFile(file);
+    }
+    void AddDependencies(const AssetLoader& assets, ReloadableContent content)
+    {
+        std::vector<std::string> files;
+        assets.GetFilePaths(files);
+        for (unsigned int i = 0; i < files.size(); ++i)
+        {
+            AddDependency(files[i], content);
+        }
+    }
+    //Sets up the dependencies of every reloadable content on the files it's built from.
+    void WatchContentFiles(void)
+    {
+        AddDependency(LevelConstants::FilePath, RC_LEVEL_CONSTANTS);
+        AddDependency(WeaponConstants::FilePath, RC_WEAPON_CONSTANTS);
+
+        #define ADD_ASSET_DEPENDENCIES(contentClass, content) \
+        { \
+            AssetLoader files; \
+            contentClass::AddAssets(files); \
+            AddDependencies(files, content); \
+        }
+        ADD_ASSET_DEPENDENCIES(MenuContent, RC_MENU)
+        ADD_ASSET_DEPENDENCIES(ActorContent, RC_ACTORS)
+        ADD_ASSET_DEPENDENCIES(WeaponContent, RC_WEAPONS)
+        ADD_ASSET_DEPENDENCIES(BulletContent, RC_BULLETS)
+        #undef ADD_ASSET_DEPENDENCIES
+    }
+
+    template<typename ConstantsType>
+    //Re-reads a set of constants, only replacing the current values if the whole file was read.
+    void ReloadConstants(ConstantsType& constants, std::string& err)
+    {
+        ConstantsType newConstants = constants;
+        newConstants.ReadFromFile(err);
+        if (err.empty())
+        {
+            constants = newConstants;
+        }
+    }
+    //Reloads the given content from its files.
+    void ReloadContent(ReloadableContent content, std::string& err)
+    {
+        //Make sure all the content's files can be loaded before throwing out the old version.
+        AssetLoader assets;
+        #define LOAD_ASSETS(contentClass) \
+            contentClass::AddAssets(assets); \
+            if (!assets.LoadAll(err)) \
+            { \
+                break; \
+            }
+
+        switch (content)
+        {
+            case RC_LEVEL_CONSTANTS:
+                ReloadConstants(LevelConstants::Instance, err);
+                break;
+            case RC_WEAPON_CONSTANTS:
+                ReloadConstants(WeaponConstants::Instance, err);
+                break;
+
+            case RC_MENU:
+                LOAD_ASSETS(MenuContent);
+                MenuContent::Instance.ReloadTextures(assets, err);
+                break;
+            case RC_ACTORS:
+                LOAD_ASSETS(ActorContent);
+                ActorContent::Instance.Reload(assets, err);
+                break;
+            case RC_WEAPONS:
+                LOAD_ASSETS(WeaponContent);
+                WeaponContent::Instance.Reload(assets, err);
+                break;
+            case RC_BULLETS:
+                LOAD_ASSETS(BulletContent);
+                BulletContent::Instance.Reload(assets, err);
+                break;
+
+            default:
+                assert(false);
+                break;
+        }
+
+        #undef LOAD_ASSETS
+    }
+}
 
 
 void ContentLoader::LoadContent(std::string& err)
@@ -55,39 +179,48 @@ void ContentLoader::LoadContent(std::string& err)
     QualitySettings::Instance.Initialize();
 
     //Content.
-    if (!MenuContent::Instance.Initialize(err))
-    {
-        err = "Error loading menu content: " + err;
-        return;
-    }
-    if (!ActorContent::Instance.Initialize(err))
-    {
-        err = "Error loading actor content: " + err;
-        return;
-    }
-    if (!WeaponContent::Instance.Initialize(err))
-    {
-        err = "Error loading weapon content: " + err;
-        return;
-    }
-    if (!BulletContent::Instance.Initialize(err))
-    {
-        err = "Error loading bullet content: " + err;
-        return;
-    }
-    if (!ParticleContent::Instance.Initialize(err))
-    {
-        err = "Error loading particle content: " + err;
-        return;
-    }
-    if (!PostProcessing::Instance.Initialize(err))
+    //First, the content files are all loaded in at once on worker threads.
+    //Then each content class uploads its data to the GPU and creates its materials on this thread.
+
+    AssetLoader assets;
+    MenuContent::AddAssets(assets);
+    ActorContent::AddAssets(assets);
+    WeaponContent::AddAssets(assets);
+    BulletContent::AddAssets(assets);
+
     {
-        err = "Error loading post-processing: " + err;
-        return;
+        ThreadPool pool;
+        assets.LoadAll(pool);
     }
+
+    sf::Clock clock;
+    #define INIT_CONTENT(contentClass, initArgs, contentName) \
+        clock.restart(); \
+        if (!contentClass::Instance.Initialize initArgs) \
+        { \
+            err = "Error loading " contentName ": " + err; \
+            return; \
+        } \
+        assets.AddTiming("Initializing " contentName, clock.getElapsedTime().asSeconds());
+
+    INIT_CONTENT(MenuContent, (assets, err), "menu content")
+    INIT_CONTENT(ActorContent, (assets, err), "actor content")
+    INIT_CONTENT(WeaponContent, (assets, err), "weapon content")
+    INIT_CONTENT(BulletContent, (assets, err), "bullet content")
+    INIT_CONTENT(ParticleContent, (err), "particle content")
+    INIT_CONTENT(PostProcessing, (err), "post-processing")
+
+    #undef INIT_CONTENT
+
+    std::cout << "Content load times:\n" << assets.GetTimingReport() << "\n";
+
+    WatchContentFiles();
 }
 void ContentLoader::DestroyContent(void)
 {
+    contentWatcher.Clear();
+    fileDependents.clear();
+
     PostProcessing::Instance.Destroy();
     ParticleContent::Instance.Destroy();
     BulletContent::Instance.Destroy();
@@ -115,4 +248,51 @@ void ContentLoader::DestroyContent(void)
         char pause;
         std::cin >> pause;
     }
+}
+void ContentLoader::ReloadChangedContent(float elapsedSeconds, std::string& err)
+{
+    timeSinceReloadCheck += elapsedSeconds;
+    if (timeSinceReloadCheck < RELOAD_CHECK_INTERVAL)
+    {
+        return;
+    }
+    timeSinceReloadCheck = 0.0f;
+
+    std::vector<std::string> changedFiles;
+    contentWatcher.GetChangedFiles(changedFiles);
+    if (changedFiles.empty())
+    {
+        return;
+    }
+
+    //Figure out which content needs to be rebuilt, so that content using several changed files
+    //    is only rebuilt once.
+    bool toReload[RC_NUMBER_OF_CONTENT];
+    for (unsigned int i = 0; i < RC_NUMBER_OF_CONTENT; ++i)
+    {
+        toReload[i] = false;
+    }
+    for (unsigned int i = 0; i < changedFiles.size(); ++i)
+    {
+        std::cout << "Content file changed: " << changedFiles[i] << "\n";
+
+        const std::vector<ReloadableContent>& dependents = fileDependents[changedFiles[i]];
+        for (unsigned int j = 0; j < dependents.size(); ++j)
+        {
+            toReload[dependents[j]] = true;
+        }
+    }
+
+    for (unsigned int i = 0; i < RC_NUMBER_OF_CONTENT; ++i)
+    {
+        if (toReload[i])
+        {
+            std::string reloadErr;
+            ReloadContent((ReloadableContent)i, reloadErr);
+            if (!reloadErr.empty())
+            {
+                err += "Error reloading content: " + reloadErr + "\n";
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -11,6 +11,12 @@ public:
     static void LoadContent(std::string& outErrorMsg);
     static void DestroyContent(void);
 
+    //Checks whether any content files were changed on disk, and if so, reloads them in place
+    //    along with any content that's built from them.
+    //Should be called between frames. The files are only actually checked every so often.
+    //Outputs an error message if something failed to reload.
+    static void ReloadChangedContent(float elapsedSeconds, std::string& outErrorMsg);
+
 
 private:
 
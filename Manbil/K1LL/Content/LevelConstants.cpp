@@ -6,6 +6,7 @@
 
 
 LevelConstants LevelConstants::Instance = LevelConstants();
+const std::string LevelConstants::FilePath = "Content/LevelConstants.xml";
 
 
 Vector3f LevelConstants::GetPlayerEyePos(Vector2f pos, Vector3f lookDir) const
@@ -63,7 +64,7 @@ void LevelConstants::SaveToFile(std::string& err) const
     try
     {
         writer.WriteDataStructure(*this, "Data");
-        err = writer.SaveData("Content/LevelConstants.xml");
+        err = writer.SaveData(FilePath);
     }
     catch (int ex)
     {
@@ -73,7 +74,7 @@ void LevelConstants::SaveToFile(std::string& err) const
 }
 void LevelConstants::ReadFromFile(std::string& err)
 {
-    XmlReader reader("Content/LevelConstants.xml");
+    XmlReader reader(FilePath);
 
     err = reader.ErrorMessage;
     if (!err.empty())
@@ -11,6 +11,9 @@ public:
 
     static LevelConstants Instance;
 
+    //The file these constants are stored in.
+    static const std::string FilePath;
+
 
     float CeilingHeight = 5.0f;
 
@@ -4,6 +4,36 @@
 #include "../../Rendering/Data Nodes/DataNodes.hpp"
 
 
+//Calls the given macro with every menu texture and the file it comes from.
+#define FOR_EACH_MENU_TEX(macro) \
+    macro(PageBackground, Background.png) \
+    macro(BackButton, BackButton.png) \
+    macro(TextBoxBackground, TextBoxBackground.png) \
+    \
+    macro(PlayButton, Play Button.png) \
+    macro(OptionsButton, Options Button.png) \
+    macro(EditorButton, Editor Button.png) \
+    macro(QuitButton, Quit Button.png) \
+    \
+    macro(ConfirmDeletePopup, ConfirmDeletePopup.png) \
+    macro(NOTex, NOWithoutBackground.png) \
+    macro(YESTex, YESWithoutBackground.png) \
+    macro(EditLevelTex, EditLevelButton.png) \
+    macro(DeleteLevelTex, DeleteLevelButton.png) \
+    macro(CreateLevelTex, CreateButton.png) \
+    macro(LevelSelectionBoxHighlight, LevelChoiceHighlight.png) \
+    macro(LevelSelectionBoxBackground, LevelChoiceBackground.png) \
+    \
+    macro(FloorTex, LevelEditorFloor.png) \
+    macro(WallTex, Wall.png) \
+    macro(AmmoLightTex, Ammo Light.png) \
+    macro(AmmoHeavyTex, Ammo Heavy.png) \
+    macro(AmmoSpecialTex, Ammo Special.png) \
+    macro(HealthTex, Health.png) \
+    \
+    macro(EditorNoiseTex, GridNoise.png)
+
+
 MenuContent MenuContent::Instance = MenuContent();
 
 MenuContent::MenuContent(void)
@@ -35,54 +65,26 @@ MenuContent::MenuContent(void)
 
 }
 
-bool MenuContent::Initialize(std::string& err)
+void MenuContent::AddAssets(AssetLoader& assets)
 {
-    #pragma region Load textures
-
-    #define CREATE_LOAD(buttonVar, fileName) \
-        buttonVar.Create(); \
-        buttonVar.SetDataFromFile(std::string("Content/Menu/") + #fileName, err); \
-        if (!err.empty()) \
-        { \
-            err = std::string("Error loading ") + #fileName + " tex: " + err; \
-            return false; \
-        }
-    
-
-    CREATE_LOAD(PageBackground, Background.png)
-    CREATE_LOAD(BackButton, BackButton.png)
-    CREATE_LOAD(TextBoxBackground, TextBoxBackground.png)
+    #define ADD_TEX(buttonVar, fileName) assets.AddImage(std::string("Content/Menu/") + #fileName);
+    FOR_EACH_MENU_TEX(ADD_TEX)
+    #undef ADD_TEX
+}
 
-    CREATE_LOAD(PlayButton, Play Button.png)
-    CREATE_LOAD(OptionsButton, Options Button.png)
-    CREATE_LOAD(EditorButton, Editor Button.png)
-    CREATE_LOAD(QuitButton, Quit Button.png)
+bool MenuContent::Initialize(AssetLoader& assets, std::string& err)
+{
+    #pragma region Load textures
 
-    CREATE_LOAD(ConfirmDeletePopup, ConfirmDeletePopup.png)
-    CREATE_LOAD(NOTex, NOWithoutBackground.png)
-    CREATE_LOAD(YESTex, YESWithoutBackground.png)
-    CREATE_LOAD(EditLevelTex, EditLevelButton.png)
-    CREATE_LOAD(DeleteLevelTex, DeleteLevelButton.png)
-    CREATE_LOAD(CreateLevelTex, CreateButton.png)
-    CREATE_LOAD(LevelSelectionBoxHighlight, LevelChoiceHighlight.png)
-    CREATE_LOAD(LevelSelectionBoxBackground, LevelChoiceBackground.png)
+    if (!ReloadTextures(assets, err))
+    {
+        return false;
+    }
 
     Array2D<Vector4b> colors(1, 1, Vector4b((unsigned char)255, 255, 255, 255));
     LevelSelectionSingleElement.Create();
     LevelSelectionSingleElement.SetColorData(colors);
 
-    CREATE_LOAD(FloorTex, LevelEditorFloor.png)
-    CREATE_LOAD(WallTex, Wall.png)
-    CREATE_LOAD(AmmoLightTex, Ammo Light.png)
-    CREATE_LOAD(AmmoHeavyTex, Ammo Heavy.png)
-    CREATE_LOAD(AmmoSpecialTex, Ammo Special.png)
-    CREATE_LOAD(HealthTex, Health.png)
-
-    CREATE_LOAD(EditorNoiseTex, GridNoise.png)
-
-
-    #undef CREATE_LOAD
-
     #pragma endregion
 
     #pragma region Load fonts
@@ -210,6 +212,31 @@ void MenuContent::Destroy(void)
     EditorNoiseTex.DeleteIfValid();
 }
 
+bool MenuContent::ReloadTextures(AssetLoader& assets, std::string& err)
+{
+    //Textures that already exist keep their handle, so anything referencing them stays valid.
+    #define CREATE_LOAD(buttonVar, fileName) \
+    { \
+        const Array2D<Vector4b>* pixels = assets.GetImage(std::string("Content/Menu/") + #fileName, err); \
+        if (pixels == 0) \
+        { \
+            err = std::string("Error loading ") + #fileName + " tex: " + err; \
+            return false; \
+        } \
+        if (!buttonVar.IsValidTexture()) \
+        { \
+            buttonVar.Create(); \
+        } \
+        buttonVar.SetColorData(*pixels); \
+    }
+
+    FOR_EACH_MENU_TEX(CREATE_LOAD)
+
+    #undef CREATE_LOAD
+
+    return true;
+}
+
 MTexture2D* MenuContent::GetPickupTex(ItemTypes pickup)
 {
     switch (pickup)
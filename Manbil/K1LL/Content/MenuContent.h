@@ -4,6 +4,7 @@
 #include "../../Rendering/GUI/GUI Elements/GUILabel.h"
 
 #include "../Level Info/ItemTypes.h"
+#include "AssetLoader.h"
 
 
 //Contains content for menus.
@@ -56,9 +57,17 @@ public:
     Vector2f MainTextFontScale;
 
 
-    bool Initialize(std::string& outErrorMsg);
+    //Adds all the files this content needs to the given loader.
+    static void AddAssets(AssetLoader& assets);
+
+    bool Initialize(AssetLoader& assets, std::string& outErrorMsg);
     void Destroy(void);
 
+    //Reloads the menu textures in place, using the files from the given loader.
+    //The materials and fonts are left alone, since GUI elements hold onto them.
+    //Outputs an error message and returns false if something failed.
+    bool ReloadTextures(AssetLoader& assets, std::string& outErrorMsg);
+
 
     MTexture2D* GetPickupTex(ItemTypes pickup);
 
@@ -339,13 +339,7 @@ bool ParticleContent::Initialize(std::string& outError)
         RandTex.Create(TextureSampleSettings2D(FT_NEAREST, WT_WRAP), false, PS_8U);
         
         Array2D<Vector4f> vals(size, 1);
-        FastRand fr(2351341);
-        Vector2u v;
-        for (v.x = 0; v.x < size; ++v.x)
-        {
-            vals[v] = Vector4f(fr.GetZeroToOne(), fr.GetZeroToOne(),
-                               fr.GetZeroToOne(), fr.GetZeroToOne());
-        }
+        CounterRand(2351341).GetZeroToOnes(0, &vals[Vector2u()].x, size * 4);
         RandTex.SetColorData(vals);
     }
 
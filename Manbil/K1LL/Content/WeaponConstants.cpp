@@ -23,6 +23,7 @@ void WeaponConstants::MaterialParams::ReadData(DataReader* reader)
 
 
 WeaponConstants WeaponConstants::Instance = WeaponConstants();
+const std::string WeaponConstants::FilePath = "Content/WeaponConstants.xml";
 
 
 void WeaponConstants::WriteData(DataWriter* writer) const
@@ -71,7 +72,7 @@ void WeaponConstants::SaveToFile(std::string& err) const
     try
     {
         writer.WriteDataStructure(*this, "Data");
-        err = writer.SaveData("Content/WeaponConstants.xml");
+        err = writer.SaveData(FilePath);
     }
     catch (int ex)
     {
@@ -81,7 +82,7 @@ void WeaponConstants::SaveToFile(std::string& err) const
 }
 void WeaponConstants::ReadFromFile(std::string& err)
 {
-    XmlReader reader("Content/WeaponConstants.xml");
+    XmlReader reader(FilePath);
 
     err = reader.ErrorMessage;
     if (!err.empty())
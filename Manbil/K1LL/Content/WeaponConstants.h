@@ -29,6 +29,9 @@ public:
 
     static WeaponConstants Instance;
 
+    //The file these constants are stored in.
+    static const std::string FilePath;
+
 
     float WeaponLength = 0.19f;
     Vector3f WeaponForward = Vector3f(1.0f, 0.0f, 0.0f);
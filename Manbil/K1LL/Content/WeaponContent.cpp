@@ -2,10 +2,6 @@
 
 #include "WeaponConstants.h"
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-
 
 namespace
 {
@@ -28,6 +24,45 @@ namespace
     };
 
     const Vector3f WEAPON_BASE_DIR(1.0f, 0.0f, 0.0f);
+
+    const unsigned int WEAPON_VERTEX_PARTS = AssetLoader::VP_POS | AssetLoader::VP_UV |
+                                             AssetLoader::VP_NORMAL | AssetLoader::VP_TANGENTS;
+
+    std::string GetWeaponMeshFile(Weapons weapon)
+    {
+        std::string file = "Content/Game/Meshes/Guns/";
+        switch (weapon)
+        {
+            case W_PUNCHER:
+                return file + "Puncher.obj";
+            case W_LIGHTGUN:
+                return file + "Light Gun.obj";
+            case W_PRG:
+                return file + "Perpetual Rail Gun.obj";
+            case W_TERRIBLE_SHOTGUN:
+                return file + "Terrible Shotgun.obj";
+            case W_SPRAY_N_PRAY:
+                return file + "Spray and Pray.obj";
+            case W_CLUSTER:
+                return file + "Cluster.obj";
+            case W_POS:
+                return file + "Personal Orbital Strike.obj";
+
+            default:
+                assert(false);
+                return file;
+        }
+    }
+
+    #define WEAPON_TEX_FILE(name) ("Content/Game/Textures/Weapons/" name ".png")
+    #define FOR_EACH_WEAPON_TEX(macro) \
+        macro(texPuncher, WEAPON_TEX_FILE("Puncher")) \
+        macro(texLightGun, WEAPON_TEX_FILE("LightGun")) \
+        macro(texPRG, WEAPON_TEX_FILE("PerpetualRailGun")) \
+        macro(texPOS, WEAPON_TEX_FILE("POS")) \
+        macro(texSprayNPray, WEAPON_TEX_FILE("SprayAndPray")) \
+        macro(texCluster, WEAPON_TEX_FILE("Cluster")) \
+        macro(texTerribleShotgun, WEAPON_TEX_FILE("Terrible Shotgun"))
 }
 
 
@@ -45,7 +80,19 @@ WeaponContent::WeaponContent(void)
 
 }
 
-bool WeaponContent::Initialize(std::string& err)
+void WeaponContent::AddAssets(AssetLoader& assets)
+{
+    for (unsigned int i = 0; i < W_NUMBER_OF_WEAPONS; ++i)
+    {
+        assets.AddMesh(GetWeaponMeshFile((Weapons)i), WEAPON_VERTEX_PARTS);
+    }
+
+    #define ADD_TEX(var, file) assets.AddImage(file);
+    FOR_EACH_WEAPON_TEX(ADD_TEX)
+    #undef ADD_TEX
+}
+
+bool WeaponContent::Initialize(AssetLoader& assets, std::string& err)
 {
     struct WeaponVertex
     {
@@ -67,102 +114,20 @@ bool WeaponContent::Initialize(std::string& err)
             weaponMesh.SubMeshes.push_back(MeshData(false, PT_TRIANGLE_LIST));
         }
 
-        std::vector<WeaponVertex> vertices;
-        std::vector<unsigned int> indices;
-
-        Assimp::Importer importer;
-        unsigned int flags = aiProcessPreset_TargetRealtime_MaxQuality;
-
         for (unsigned int i = 0; i < W_NUMBER_OF_WEAPONS; ++i)
         {
-            //Get the file of this weapon.
-            std::string file = "Content/Game/Meshes/Guns/";
-            switch ((Weapons)i)
-            {
-                case W_PUNCHER:
-                    file += "Puncher.obj";
-                    break;
-                case W_LIGHTGUN:
-                    file += "Light Gun.obj";
-                    break;
-                case W_PRG:
-                    file += "Perpetual Rail Gun.obj";
-                    break;
-                case W_TERRIBLE_SHOTGUN:
-                    file += "Terrible Shotgun.obj";
-                    break;
-                case W_SPRAY_N_PRAY:
-                    file += "Spray and Pray.obj";
-                    break;
-                case W_CLUSTER:
-                    file += "Cluster.obj";
-                    break;
-                case W_POS:
-                    file += "Personal Orbital Strike.obj";
-                    break;
-
-                default:
-                    assert(false);
-            }
-
-            const aiScene* scene = importer.ReadFile(file, flags);
-
-            //Make sure the scene is valid.
-            if (scene == 0)
-            {
-                err = "Error loading '" + file + "': " + importer.GetErrorString();
-                return false;
-            }
-            if (scene->mNumMeshes != 1)
+            const AssetLoader::MeshFile* mesh = assets.GetMesh(GetWeaponMeshFile((Weapons)i),
+                                                               WEAPON_VERTEX_PARTS, err);
+            if (mesh == 0)
             {
-                err = "Mesh '" + file + "' has " + std::to_string(scene->mNumMeshes) + " meshes in it";
                 return false;
             }
 
-            aiMesh* mesh = scene->mMeshes[0];
-
-            //Make sure the mesh is valid.
-            assert(mesh->HasFaces());
-            if (!mesh->HasPositions() || !mesh->HasTextureCoords(0) || !mesh->HasNormals())
-            {
-                err = "Mesh '" + file + "' is missing positions, normals, or UVs!";
-                return false;
-            }
-            if (!mesh->HasTangentsAndBitangents())
-            {
-                err = "Mesh '" + file + "' is missing tangents/bitangents!";
-                return false;
-            }
-
-            //Populate the vertex/index buffer data.
-            vertices.resize(mesh->mNumVertices);
-            for (unsigned int j = 0; j < mesh->mNumVertices; ++j)
-            {
-                vertices[j].Pos = *(Vector3f*)(&mesh->mVertices[j].x);
-                vertices[j].UV = *(Vector2f*)(&mesh->mTextureCoords[0][j].x);
-                vertices[j].Normal = *(Vector3f*)(&mesh->mNormals[j].x);
-                vertices[j].Tangent = *(Vector3f*)(&mesh->mTangents[j].x);
-                vertices[j].Bitangent = *(Vector3f*)(&mesh->mBitangents[j].x);
-            }
-            indices.resize(mesh->mNumFaces * 3);
-            for (unsigned int j = 0; j < mesh->mNumFaces; ++j)
-            {
-                aiFace& fce = mesh->mFaces[j];
-                if (fce.mNumIndices != 3)
-                {
-                    err = "A face in mesh '" + file + "' has a non-tri face with " +
-                            std::to_string(fce.mNumIndices) + " indices!";
-                    return false;
-                }
-
-                indices[(j * 3)] = fce.mIndices[0];
-                indices[(j * 3) + 1] = fce.mIndices[1];
-                indices[(j * 3) + 2] = fce.mIndices[2];
-            }
-
             //Create the vertex/index buffers.
-            weaponMesh.SubMeshes[i].SetVertexData(vertices, MeshData::BUF_STATIC, weaponVertIns);
-            weaponMesh.SubMeshes[i].SetIndexData(indices, MeshData::BUF_STATIC);
+            weaponMesh.SubMeshes[i].SetVertexData(mesh->GetVertices<WeaponVertex>(),
+                                                  mesh->GetNVertices(),
+                                                  MeshData::BUF_STATIC, weaponVertIns);
+            weaponMesh.SubMeshes[i].SetIndexData(mesh->Indices, MeshData::BUF_STATIC);
         }
     }
 
@@ -172,19 +137,17 @@ bool WeaponContent::Initialize(std::string& err)
 
     {
         #define MAKE_TEX(var, file) \
-            var.Create(); \
-            if (!var.SetDataFromFile(file, err)) \
+        { \
+            const Array2D<Vector4b>* pixels = assets.GetImage(file, err); \
+            if (pixels == 0) \
             { \
-                err = std::string("Error loading '") + file + "': " + err; \
                 return false; \
-            }
-        MAKE_TEX(texPuncher, "Content/Game/Textures/Weapons/Puncher.png")
-        MAKE_TEX(texLightGun, "Content/Game/Textures/Weapons/LightGun.png")
-        MAKE_TEX(texPRG, "Content/Game/Textures/Weapons/PerpetualRailGun.png")
-        MAKE_TEX(texPOS, "Content/Game/Textures/Weapons/POS.png")
-        MAKE_TEX(texSprayNPray, "Content/Game/Textures/Weapons/SprayAndPray.png")
-        MAKE_TEX(texCluster, "Content/Game/Textures/Weapons/Cluster.png")
-        MAKE_TEX(texTerribleShotgun, "Content/Game/Textures/Weapons/Terrible Shotgun.png")
+            } \
+            var.Create(); \
+            var.SetColorData(*pixels); \
+        }
+        FOR_EACH_WEAPON_TEX(MAKE_TEX)
+        #undef MAKE_TEX
     }
 
     #pragma endregion
@@ -270,6 +233,7 @@ void WeaponContent::Destroy(void)
     if (weaponMat != 0)
     {
         delete weaponMat;
+        weaponMat = 0;
     }
 
     texPuncher.DeleteIfValid();
@@ -284,6 +248,32 @@ void WeaponContent::Destroy(void)
     weaponMesh.CurrentSubMesh = 0;
     weaponParams.clear();
 }
+bool WeaponContent::Reload(AssetLoader& assets, std::string& err)
+{
+    //Build the new content on the side so a failure leaves the old content usable.
+    WeaponContent newContent;
+    if (!newContent.Initialize(assets, err))
+    {
+        newContent.Destroy();
+        return false;
+    }
+
+    Destroy();
+
+    weaponMesh.SubMeshes.swap(newContent.weaponMesh.SubMeshes);
+    std::swap(weaponMat, newContent.weaponMat);
+    weaponParams.swap(newContent.weaponParams);
+
+    std::swap(texPuncher, newContent.texPuncher);
+    std::swap(texLightGun, newContent.texLightGun);
+    std::swap(texPRG, newContent.texPRG);
+    std::swap(texPOS, newContent.texPOS);
+    std::swap(texSprayNPray, newContent.texSprayNPray);
+    std::swap(texCluster, newContent.texCluster);
+    std::swap(texTerribleShotgun, newContent.texTerribleShotgun);
+
+    return true;
+}
 
 void WeaponContent::RenderPuncher(Vector3f pos, Vector3f dir, const RenderInfo& info)
 {
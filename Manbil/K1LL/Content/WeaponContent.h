@@ -2,6 +2,7 @@
 
 #include "../../Rendering/Rendering.hpp"
 #include "WeaponConstants.h"
+#include "AssetLoader.h"
 
 
 class WeaponContent
@@ -11,15 +12,22 @@ public:
     static WeaponContent Instance;
 
 
-    //Creates/loads all weapon content.
+    //Adds all the files this content needs to the given loader.
+    static void AddAssets(AssetLoader& assets);
+
+    //Creates/loads all weapon content, using the files from the given loader.
     //Returns true if everything was initialized correctly.
     //Outputs an error message and returns false if something failed.
-    bool Initialize(std::string& outErrorMsg);
+    bool Initialize(AssetLoader& assets, std::string& outErrorMsg);
 
     //Destroys/unloads all the weapon content.
     //If "Initialize()" hasn't been called, nothing will happen.
     void Destroy(void);
 
+    //Rebuilds all the weapon content from the given loader's files.
+    //If something fails, outputs an error message and returns false without touching the current content.
+    bool Reload(AssetLoader& assets, std::string& outErrorMsg);
+
     
     void RenderPuncher(Vector3f pos, Vector3f dir, const RenderInfo& info);
     void RenderLightGun(Vector3f pos, Vector3f dir, const RenderInfo& info);
@@ -19,7 +19,7 @@ ChooseLevelEditor::ChooseLevelEditor(PageManager* manager, std::string& err)
 {
     LevelInfo lvlData;
     BinaryWriter writer(true);
-    writer.WriteDataStructure(lvlData, "Data");
+    lvlData.WriteLevelFile(&writer);
     std::string fullLvlPath = LevelInfo::LevelFilesPath + "Test Level.lvl";
     err = writer.SaveData(fullLvlPath);
     if (!err.empty())
@@ -362,7 +362,7 @@ std::string ChooseLevelEditor::GenerateLevel(void)
     //Create a blank level and write it out to the file.
     LevelInfo lvlData;
     BinaryWriter writer(true);
-    writer.WriteDataStructure(lvlData, "Data");
+    lvlData.WriteLevelFile(&writer);
     std::string fullLvlPath = LevelInfo::LevelFilesPath + lvlName + ".lvl";
     std::string err = writer.SaveData(fullLvlPath);
     if (!err.empty())
@@ -4,6 +4,7 @@
 
 #include "LevelEditor.h"
 #include "../../Game/Level/LevelGraph.h"
+#include "../../../FrameArena.h"
 
 
 #define MC MenuContent::Instance
@@ -69,11 +70,14 @@ void GUILevelPathing::CustomUpdate(float elapsedTime, Vector2f relativeMouse)
         LevelInfo::RoomData& room = lvl.Rooms[roomsToNav - 1];
         LevelInfo::UIntBox rmBnds = lvl.GetBounds(roomsToNav - 1);
 
-        Array2D<BlockTypes> tempRoom(room.Walls.GetWidth(), room.Walls.GetHeight());
-        tempRoom.Fill(levelGrid, -ToV2i(room.MinCornerPos));
+        Array2DView<const BlockTypes> tempRoom = levelGrid.GetView(room.MinCornerPos,
+                                                                   room.Walls.GetDimensions());
+
+        //The temporary lists only need to last for this frame.
+        StdAllocator<Vector2u> frameAllocator(FrameArena::GetThreadArena());
 
         //Get a list of all open end-points of the block.
-        std::vector<Vector2u> openSpaces;
+        std::vector<Vector2u, StdAllocator<Vector2u>> openSpaces(frameAllocator);
         openSpaces.reserve((2 * tempRoom.GetWidth()) + (2 * tempRoom.GetHeight()));
         for (unsigned int x = 0; x < tempRoom.GetWidth(); ++x)
         {
@@ -99,8 +103,8 @@ void GUILevelPathing::CustomUpdate(float elapsedTime, Vector2f relativeMouse)
         }
 
         //Get all combinations of endpoints along the edge of the room.
-        std::vector<Vector4u> openSpacePairs;
-        openSpacePairs.reserve(openSpacePairs.size() * openSpacePairs.size());
+        std::vector<Vector4u, StdAllocator<Vector4u>> openSpacePairs(frameAllocator);
+        openSpacePairs.reserve((openSpaces.size() * (openSpaces.size() - 1)) / 2);
         for (unsigned int i = 0; i < openSpaces.size(); ++i)
         {
             for (unsigned int j = i + 1; j < openSpaces.size(); ++j)
@@ -92,7 +92,7 @@ LevelEditor::LevelEditor(const std::string& levelFileName, PageManager* manager,
     }
     try
     {
-        reader.ReadDataStructure(LevelData);
+        LevelData.ReadLevelFile(&reader);
     }
     catch (int ex)
     {
@@ -542,9 +542,11 @@ void LevelEditor::OnButton_SetSpawn(ItemTypes type)
 }
 void LevelEditor::OnButton_Save(void)
 {
+    LevelData.ComputeRoomVisibility();
+
     BinaryWriter writer(true, sizeof(LevelInfo));
 
-    writer.WriteDataStructure(LevelData, "Data");
+    LevelData.WriteLevelFile(&writer);
 
     std::string err = writer.SaveData(levelFile);
     if (!Assert(err.empty(), "Error saving level '" + levelFile + "'", err))
@@ -558,14 +560,29 @@ void LevelEditor::OnButton_Test(void)
     LevelInfo::UIntBox lvlBnds = LevelData.GetBounds();
     Vector2f playerPos = ToV2f(contextMenu_SelectedGrid - lvlBnds.Min) + Vector2f(0.5f, 0.5f);
 
+    //The rooms may have been changed since the level was loaded.
+    LevelData.ComputeRoomVisibility();
+
     std::string err;
-    Page::Ptr testLvl(new LevelTest(Manager->GetCurrentPage(), Manager, playerPos, err));
+    if (testPage.get() == 0)
+    {
+        testPage = Page::Ptr(new LevelTest(Manager->GetCurrentPage(), Manager, playerPos, err));
+    }
+    else
+    {
+        ((LevelTest*)testPage.get())->Restart(Manager->GetCurrentPage(), playerPos, err);
+    }
+
     if (!Assert(err.empty(), "Error setting up test level", err))
     {
+        testPage.reset();
         return;
     }
 
-    Manager->UpdateCurrentPage(testLvl);
+    //The test page holds onto this editor until it's done, so let go of it in the meantime.
+    Page::Ptr nextPage = testPage;
+    testPage.reset();
+    Manager->UpdateCurrentPage(nextPage);
 }
 void LevelEditor::OnButton_Quit(void)
 {
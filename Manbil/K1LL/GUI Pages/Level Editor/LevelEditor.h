@@ -51,6 +51,9 @@ public:
          OnButton_Test(void),
          OnButton_Quit(void);
 
+    //Called by a test page of this level when the player leaves it, so it can be re-used next time.
+    void OnTestFinished(Page::Ptr test) { testPage = test; }
+
     Vector2f WorldPosToScreen(Vector2f worldPos) const;
     Vector2f WorldSizeToScreen(Vector2f worldSize) const;
     Vector2f ScreenPosToWorld(Vector2f screenPos) const;
@@ -80,6 +83,11 @@ private:
     //The full relative path to the level file being edited.
     std::string levelFile;
 
+    //The last test of this level, which is re-used so that only the rooms that changed get rebuilt.
+    //Only held while this editor is running; the test page holds onto this editor while it's running,
+    //    and the two pages must never hold onto each other at once.
+    Page::Ptr testPage;
+
     EditorStates currentState = ES_IDLE;
     Box2D worldViewBounds;
 
@@ -31,9 +31,10 @@ LevelTest::LevelTest(Page::Ptr editor, PageManager* manager,
         return;
     }
 
-    
-    //Add a player to the level and create his viewport.
-
+    AddPlayer(playerPos, err);
+}
+void LevelTest::AddPlayer(Vector2f playerPos, std::string& err)
+{
     Weapon::Ptr weaps[3] = {
         Lvl.MatchData.LightWeapon(Lvl),
         Lvl.MatchData.HeavyWeapon(Lvl),
@@ -54,6 +55,23 @@ LevelTest::LevelTest(Page::Ptr editor, PageManager* manager,
                                           -(float)Manager->GetWindow()->getSize().y, 0.0f));
 }
 
+void LevelTest::Restart(Page::Ptr editor, Vector2f playerPos, std::string& err)
+{
+    levelEditor = editor;
+    Lvl.UpdateRooms(((LevelEditor*)levelEditor.get())->LevelData);
+
+    //Throw out the old player's viewport before the player it points to.
+    GUIManager.SetRoot(GUIElementPtr());
+
+    Lvl.ResetMatch(err);
+    if (!Assert(err.empty(), "Error resetting the level", err))
+    {
+        return;
+    }
+
+    AddPlayer(playerPos, err);
+}
+
 
 void LevelTest::Update(Vector2i mousePos, float frameSeconds)
 {
@@ -67,7 +85,13 @@ void LevelTest::Update(Vector2i mousePos, float frameSeconds)
 
     if (InputHandler::Values[IM_KEYBOARD_MOUSE].Pause)
     {
-        Manager->UpdateCurrentPage(levelEditor);
+        //Give this page to the editor to re-use next time, and let go of the editor
+        //    so that the two pages don't hold onto each other.
+        Page::Ptr editor = levelEditor;
+        levelEditor.reset();
+
+        ((LevelEditor*)editor.get())->OnTestFinished(Manager->GetCurrentPage());
+        Manager->UpdateCurrentPage(editor);
     }
 
     Page::Update(mousePos, frameSeconds);
@@ -20,6 +20,13 @@ public:
               Vector2f playerStartPos, std::string& outErrorMsg);
 
 
+    //Brings the level up to date with the given editor's changes and starts the match over,
+    //    with a fresh player at the given spot.
+    //Only the parts of the level's geometry that changed are rebuilt.
+    //If there was an error, outputs an error message to the given string.
+    void Restart(Page::Ptr editor, Vector2f playerStartPos, std::string& outErrorMsg);
+
+
     virtual void Update(Vector2i mousePos, float frameSeconds) override;
     virtual void Render(float frameSeconds) override;
     
@@ -34,5 +41,12 @@ private:
     //The amount the mouse wheel has scrolled since last frame.
     int scrollWheel = 0;
 
+    //The editor to go back to when the test is over.
+    //Only held while this page is running; the editor holds onto this page the rest of the time,
+    //    and the two pages must never hold onto each other at once.
     Page::Ptr levelEditor;
+
+
+    //Adds a player at the given spot and creates his viewport.
+    void AddPlayer(Vector2f playerStartPos, std::string& outErrorMsg);
 };
\ No newline at end of file
@@ -69,6 +69,14 @@ void PageManager::OnWorldEnd(void)
 
 void PageManager::UpdateWorld(float frameSeconds)
 {
+    //Pick up any content files that were edited while the game is running.
+    std::string err;
+    ContentLoader::ReloadChangedContent(frameSeconds, err);
+    if (!err.empty())
+    {
+        std::cout << err << "\n";
+    }
+
     //Calculate mouse pos.
     sf::Vector2i screenPos = sf::Mouse::getPosition(*GetWindow());
 
@@ -27,6 +27,11 @@ public:
 
     virtual void Render(float elapsedSeconds, const RenderInfo& info) = 0;
 
+    //Gets a sphere containing everything this actor renders, so it can be skipped when off-screen.
+    //Returns "false" if this actor should always be rendered (e.x. because it covers the whole level).
+    //Default behavior: returns "false".
+    virtual bool GetRenderBounds(Sphere& outBounds) const { return false; }
+
 
 private:
 
@@ -1,8 +1,10 @@
 #include "Level.h"
 
 #include <iostream>
+#include <algorithm>
 
 #include "../../../Math/Higher Math/Geometryf.h"
+#include "../../../FrameArena.h"
 #include "../../Content/LevelConstants.h"
 #include "../Players/Player.h"
 
@@ -14,16 +16,42 @@
 
 Level::Level(const LevelInfo& level, MatchInfo info, std::string& err)
     : BlockGrid(1, 1), NavGraph(BlockGrid), MatchData(info)
+{
+    SetUpRooms(level);
+
+
+    #pragma region Create important Actors
+
+    geometry = new LevelGeometry(this, err);
+    Actors.push_back(ActorPtr(geometry));
+    CreateMatchActors(err);
+
+    #pragma endregion
+}
+void Level::CreateMatchActors(std::string& err)
+{
+    Actors.push_back(PuncherBulletPool::CreatePool(this));
+
+    err = ParticleManager::CreateInstance(this);
+}
+
+void Level::SetUpRooms(const LevelInfo& level)
 {
     LevelInfo::UIntBox bnds = level.GetBounds();
 
     level.GenerateFullLevel(BlockGrid);
 
+    RoomBounds.clear();
+    Spawns.clear();
+
     //Set up the rooms.
     std::vector<RoomNode> tempRooms;
     for (unsigned int i = 0; i < level.Rooms.size(); ++i)
     {
-        RoomBounds.push_back(level.GetBounds(i));
+        LevelInfo::UIntBox roomBnds = level.GetBounds(i);
+        roomBnds.Min -= bnds.Min;
+        roomBnds.Max -= bnds.Min;
+        RoomBounds.push_back(roomBnds);
         
         //Keep track of any spawn points.
         for (Vector2u counter; counter.y < level.Rooms[i].Walls.GetHeight(); ++counter.y)
@@ -40,15 +68,32 @@ Level::Level(const LevelInfo& level, MatchInfo info, std::string& err)
 
     level.GetConnections(RoomGraph);
 
+    if (level.HasRoomVisibility())
+    {
+        RoomVisibility = level.RoomVisibility;
+    }
+    else
+    {
+        level.GetRoomVisibility(RoomVisibility);
+    }
+}
+void Level::UpdateRooms(const LevelInfo& level)
+{
+    SetUpRooms(level);
+    geometry->RebuildChangedRooms();
+}
+void Level::ResetMatch(std::string& err)
+{
+    Players.clear();
+    playerCollision.Clear();
+    timeSinceGameStart = 0.0f;
 
-    #pragma region Create important Actors
+    //Destroy the old actors before making new ones; the particle manager only allows one instance at a time.
+    Actors.erase(std::remove_if(Actors.begin(), Actors.end(),
+                                [this](const ActorPtr& actor) { return actor.get() != geometry; }),
+                 Actors.end());
 
-    Actors.push_back(ActorPtr(new LevelGeometry(this, err)));
-    Actors.push_back(PuncherBulletPool::CreatePool(this));
-    
-    err = ParticleManager::CreateInstance(this);
-
-    #pragma endregion
+    CreateMatchActors(err);
 }
 
 void Level::Update(float elapsed)
@@ -59,6 +104,13 @@ void Level::Update(float elapsed)
     {
         Players[i]->Update(elapsed);
     }
+
+    playerCollision.Clear();
+    for (unsigned int i = 0; i < Players.size(); ++i)
+    {
+        playerCollision.AddCapsule(Players[i]->GetCollision3D());
+    }
+
     for (unsigned int i = 0; i < Actors.size(); ++i)
     {
         if (Actors[i]->Update(elapsed))
@@ -68,17 +120,167 @@ void Level::Update(float elapsed)
         }
     }
 }
-void Level::Render(float elapsed, const RenderInfo& info)
+void Level::Render(float elapsed, const RenderInfo& info, VisibleSet& outVisible)
+{
+    GetVisible(Frustum(info.mVP), info.Cam->GetPosition(), outVisible);
+
+    //The level geometry culls its rooms with the same visible rooms.
+    geometry->SetVisibleRooms(&outVisible.IsRoomVisible);
+
+    for (unsigned int i = 0; i < outVisible.Players.size(); ++i)
+    {
+        outVisible.Players[i]->Render(elapsed, info);
+    }
+    for (unsigned int i = 0; i < outVisible.Actors.size(); ++i)
+    {
+        outVisible.Actors[i]->Render(elapsed, info);
+    }
+
+    geometry->SetVisibleRooms(0);
+}
+void Level::GetVisible(const Frustum& frustum, Vector3f viewerPos, VisibleSet& outVisible) const
 {
+    outVisible.Players.clear();
+    outVisible.Actors.clear();
+    outVisible.NCulled = 0;
+    outVisible.NOccluded = 0;
+
+    GetVisibleRooms(Vector2f(viewerPos.x, viewerPos.y), outVisible.IsRoomVisible);
+
+    FrameArena& arena = FrameArena::GetThreadArena();
+    FrameArena::Scope arenaScope(arena);
+    typedef std::vector<float, StdAllocator<float>> FloatList;
+    typedef std::vector<unsigned int, StdAllocator<unsigned int>> UIntList;
+
+    //Put the bounds of every player, then every actor that has bounds, into one list of spheres.
+    FloatList x((StdAllocator<float>(arena))), y((StdAllocator<float>(arena))),
+              z((StdAllocator<float>(arena))), radius((StdAllocator<float>(arena)));
+    auto addSphere = [&](const Sphere& sphere)
+    {
+        x.push_back(sphere.GetCenter().x);
+        y.push_back(sphere.GetCenter().y);
+        z.push_back(sphere.GetCenter().z);
+        radius.push_back(sphere.Radius);
+    };
+
     for (unsigned int i = 0; i < Players.size(); ++i)
     {
-        Players[i]->Render(elapsed, info);
+        addSphere(Players[i]->GetBroadCollision3D());
     }
+
+    //Remember which sphere each actor got, or "noSphere" if it doesn't have one.
+    const unsigned int noSphere = std::numeric_limits<unsigned int>::max();
+    UIntList actorSpheres((StdAllocator<unsigned int>(arena)));
+    actorSpheres.reserve(Actors.size());
+    Sphere actorBounds(Vector3f(), 0.0f);
     for (unsigned int i = 0; i < Actors.size(); ++i)
     {
-        Actors[i]->Render(elapsed, info);
+        if (Actors[i]->GetRenderBounds(actorBounds))
+        {
+            actorSpheres.push_back((unsigned int)x.size());
+            addSphere(actorBounds);
+        }
+        else
+        {
+            actorSpheres.push_back(noSphere);
+        }
+    }
+
+
+    //Cull the spheres against the frustum, then against the visible rooms.
+    enum Visibility : unsigned char { V_CULLED, V_OCCLUDED, V_VISIBLE };
+    unsigned int nSpheres = (unsigned int)x.size();
+    UIntList visibleSpheres(nSpheres, 0, StdAllocator<unsigned int>(arena));
+    std::vector<Visibility, StdAllocator<Visibility>> sphereVisibility(nSpheres, V_CULLED,
+                                                                       StdAllocator<Visibility>(arena));
+    if (nSpheres > 0)
+    {
+        unsigned int nVisible = frustum.CullSpheres(x.data(), y.data(), z.data(), radius.data(),
+                                                    nSpheres, visibleSpheres.data());
+        for (unsigned int i = 0; i < nVisible; ++i)
+        {
+            unsigned int sphere = visibleSpheres[i];
+            Box2D area(x[sphere] - radius[sphere], x[sphere] + radius[sphere],
+                       y[sphere] - radius[sphere], y[sphere] + radius[sphere]);
+            sphereVisibility[sphere] = (IsInRooms(area, outVisible.IsRoomVisible) ?
+                                            V_VISIBLE : V_OCCLUDED);
+        }
+    }
+
+    auto countSkipped = [&outVisible](Visibility visibility)
+    {
+        if (visibility == V_CULLED)
+        {
+            outVisible.NCulled += 1;
+        }
+        else
+        {
+            outVisible.NOccluded += 1;
+        }
+    };
+    for (unsigned int i = 0; i < Players.size(); ++i)
+    {
+        if (sphereVisibility[i] == V_VISIBLE)
+        {
+            outVisible.Players.push_back(Players[i].get());
+        }
+        else
+        {
+            countSkipped(sphereVisibility[i]);
+        }
+    }
+    for (unsigned int i = 0; i < Actors.size(); ++i)
+    {
+        if (actorSpheres[i] == noSphere || sphereVisibility[actorSpheres[i]] == V_VISIBLE)
+        {
+            outVisible.Actors.push_back(Actors[i].get());
+        }
+        else
+        {
+            countSkipped(sphereVisibility[actorSpheres[i]]);
+        }
+    }
+}
+void Level::GetVisibleRooms(Vector2f viewerPos, std::vector<bool>& outIsRoomVisible) const
+{
+    //The viewer may be in more than one room if they're standing in a doorway.
+    outIsRoomVisible.assign(RoomBounds.size(), false);
+    bool isInAnyRoom = false;
+    for (unsigned int i = 0; i < RoomBounds.size(); ++i)
+    {
+        const LevelInfo::UIntBox& bnds = RoomBounds[i];
+        if (viewerPos.x >= (float)bnds.Min.x && viewerPos.x < (float)(bnds.Max.x + 1) &&
+            viewerPos.y >= (float)bnds.Min.y && viewerPos.y < (float)(bnds.Max.y + 1))
+        {
+            isInAnyRoom = true;
+            for (unsigned int j = 0; j < RoomVisibility[i].size(); ++j)
+            {
+                outIsRoomVisible[RoomVisibility[i][j]] = true;
+            }
+        }
+    }
+
+    if (!isInAnyRoom)
+    {
+        outIsRoomVisible.assign(RoomBounds.size(), true);
     }
 }
+bool Level::IsInRooms(Box2D area, const std::vector<bool>& isRoomIncluded) const
+{
+    for (unsigned int i = 0; i < RoomBounds.size(); ++i)
+    {
+        const LevelInfo::UIntBox& bnds = RoomBounds[i];
+        if (isRoomIncluded[i] &&
+            area.GetXMax() >= (float)bnds.Min.x && area.GetXMin() <= (float)(bnds.Max.x + 1) &&
+            area.GetYMax() >= (float)bnds.Min.y && area.GetYMin() <= (float)(bnds.Max.y + 1))
+        {
+            return true;
+        }
+    }
+
+    //Anything outside of every room is in a wall, so it can't be seen.
+    return false;
+}
 
 bool Level::IsGridPosBlocked(Vector2i gridPos) const
 {
@@ -212,4 +414,13 @@ Level::RaycastResults Level::CastWallRay(Vector3f start, Vector3f dir, Vector3f&
                           start.z + (dir.z * hitT));
         return RR_WALL;
     }
+}
+int Level::CastPlayerRay(Vector3f start, Vector3f dir, float& hitT, float maxT) const
+{
+    CollisionBatch::RayHit hit = playerCollision.CastRay(start, dir, maxT);
+    if (!hit.DidHit)
+        return -1;
+
+    hitT = hit.T;
+    return (int)hit.Shape.Index;
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "../../../Rendering/Basic Rendering/RenderInfo.h"
+#include "../../../Math/Shapes/CollisionBatch.h"
+#include "../../../Math/Shapes/Frustum.h"
+#include "../../../Math/Higher Math/TriangleBVH.h"
 
 #include "../../Level Info/LevelInfo.h"
 #include "LevelGraph.h"
@@ -11,6 +14,7 @@
 
 
 class Player;
+class LevelGeometry;
 
 
 //The game level.
@@ -26,19 +30,70 @@ public:
 
     MatchInfo MatchData;
 
+    //The bounds of each room, in the same grid space as "BlockGrid".
     std::vector<LevelInfo::UIntBox> RoomBounds;
+    //For each room, the rooms that may be visible from inside it. See "LevelInfo::RoomVisibility".
+    std::vector<std::vector<unsigned int>> RoomVisibility;
     std::unordered_map<ItemTypes, std::vector<Vector2u>> Spawns;
 
     std::vector<std::shared_ptr<Player>> Players;
     std::vector<ActorPtr> Actors;
 
+    //The walls, floor, and ceiling as triangles, for ray casts against the actual level geometry.
+    //Built by the "LevelGeometry" actor from the same triangles it renders.
+    TriangleBVH GeometryBVH;
+
+
+    //The players and actors that may be visible from one camera.
+    struct VisibleSet
+    {
+        std::vector<Player*> Players;
+        std::vector<Actor*> Actors;
+
+        //Whether each room may be visible.
+        std::vector<bool> IsRoomVisible;
+
+        //The number of players and actors that were skipped because they were outside the frustum.
+        unsigned int NCulled = 0;
+        //The number of players and actors that were skipped because they were only in rooms
+        //    that can't be seen from the viewer's room.
+        unsigned int NOccluded = 0;
+    };
+
 
     //If there was an error initializing the level, outputs an error message to the given string.
     Level(const LevelInfo& level, MatchInfo info, std::string& errorMsg);
 
 
+    //Updates this level's grid and rooms to match the given level data
+    //    (e.x. after it was changed in the level editor).
+    //Only the geometry of the rooms that actually changed is rebuilt.
+    //Players and actors are left alone.
+    void UpdateRooms(const LevelInfo& level);
+    //Starts the match over: removes every player, resets the game timer,
+    //    and replaces every actor besides the level geometry with fresh copies of the usual ones
+    //    (e.x. so no bullets or particles are left over).
+    //If there was an error re-creating the actors, outputs an error message to the given string.
+    void ResetMatch(std::string& outErrorMsg);
+
     void Update(float elapsed);
-    void Render(float elapsed, const RenderInfo& info);
+
+    //Renders everything that may be visible from the camera in "info".
+    //Outputs what was rendered into "outVisible", which can be kept around between frames
+    //    (e.x. one per viewport) to avoid re-allocating it every time.
+    void Render(float elapsed, const RenderInfo& info, VisibleSet& outVisible);
+
+    //Finds every room, player, and actor that may be visible from the given viewer position
+    //    inside the given frustum.
+    //Actors without render bounds are always counted as visible.
+    //Players and actors keep the same order they have in "Players" and "Actors".
+    void GetVisible(const Frustum& frustum, Vector3f viewerPos, VisibleSet& outVisible) const;
+
+    //Finds whether each room may be visible from the given position.
+    //If the position isn't inside any room, every room is counted as visible.
+    void GetVisibleRooms(Vector2f viewerPos, std::vector<bool>& outIsRoomVisible) const;
+    //Gets whether the given area touches any of the given rooms.
+    bool IsInRooms(Box2D area, const std::vector<bool>& isRoomIncluded) const;
 
     float GetTimeSinceGameStart(void) const { return timeSinceGameStart; }
 
@@ -59,9 +114,28 @@ public:
     //Also returns what kind of surface was hit.
     RaycastResults CastWallRay(Vector3f start, Vector3f dir, Vector3f& hitPos, float& hitT,
                                float maxT = std::numeric_limits<float>::max());
+
+    //Casts the given ray against every player's collision shape.
+    //Returns the index in "Players" of the closest player that was hit, or -1 if nobody was hit.
+    //Outputs the time of the hit into "hitT".
+    int CastPlayerRay(Vector3f start, Vector3f dir, float& hitT,
+                      float maxT = std::numeric_limits<float>::max()) const;
     
 
 private:
 
     float timeSinceGameStart = 0.0f;
+
+    //The actor that renders the level's walls, floor, and ceiling. Owned by "Actors".
+    LevelGeometry* geometry = 0;
+
+    //The collision shape of every player, in the same order as "Players".
+    //Refreshed every update after the players move.
+    CollisionBatch playerCollision;
+
+
+    //Sets up the level grid and everything about the rooms from the given level data.
+    void SetUpRooms(const LevelInfo& level);
+    //Adds the actors every match starts with, other than the level geometry.
+    void CreateMatchActors(std::string& outErrorMsg);
 };
\ No newline at end of file
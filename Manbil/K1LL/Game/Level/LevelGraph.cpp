@@ -28,15 +28,18 @@ float LevelEdge::GetSearchCost(const GraphSearchGoal<LevelNode>& goal) const
     return 1.41421356f;
 }
 
-void LevelGraph::GetConnectedEdges(LevelNode startNode, std::vector<LevelEdge>& outConnections) const
+void LevelGraph::GetConnectedEdges(LevelNode startNode, EdgeList& outConnections) const
 {
-    assert(startNode.x < LevelGrid.GetWidth() &&
-           startNode.y < LevelGrid.GetHeight());
+    Array2DView<const BlockTypes> levelGrid = GetLevelGrid();
+    auto IsFree = [&levelGrid](Vector2u pos) { return levelGrid[pos] != BT_WALL; };
+
+    assert(startNode.x < levelGrid.GetWidth() &&
+           startNode.y < levelGrid.GetHeight());
 
     bool atMinX = (startNode.x == 0),
          atMinY = (startNode.y == 0),
-         atMaxX = (startNode.x == LevelGrid.GetWidth() - 1),
-         atMaxY = (startNode.y == LevelGrid.GetHeight() - 1);
+         atMaxX = (startNode.x == levelGrid.GetWidth() - 1),
+         atMaxY = (startNode.y == levelGrid.GetHeight() - 1);
 
     outConnections.reserve(8);
     if (!atMinX)
@@ -28,19 +28,26 @@ class LevelGraph : public Graph<LevelNode, LevelEdge>
 {
 public:
 
-    const Array2D<BlockTypes>& LevelGrid;
+    //Paths through the given grid, which may be resized after this graph is created.
+    LevelGraph(const Array2D<BlockTypes>& levelGrid) : fullGrid(&levelGrid) { }
+    //Paths through a region of some grid (e.x. a single room) without copying it.
+    LevelGraph(Array2DView<const BlockTypes> region) : fullGrid(0), gridRegion(region) { }
 
 
-    LevelGraph(const Array2D<BlockTypes>& levelGrid) : LevelGrid(levelGrid) { }
+    //Gets the grid this graph paths through.
+    Array2DView<const BlockTypes> GetLevelGrid(void) const
+    {
+        return (fullGrid == 0 ? gridRegion : fullGrid->GetView());
+    }
 
     
-    virtual void GetConnectedEdges(LevelNode startNode,
-                                   std::vector<LevelEdge>& outConnections) const override;
+    virtual void GetConnectedEdges(LevelNode startNode, EdgeList& outConnections) const override;
 
 
 private:
 
-    bool IsFree(Vector2u pos) const { return LevelGrid[pos] != BT_WALL; }
+    const Array2D<BlockTypes>* fullGrid;
+    Array2DView<const BlockTypes> gridRegion;
 };
 
 
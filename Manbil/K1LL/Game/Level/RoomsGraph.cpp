@@ -28,7 +28,7 @@ float RoomEdge::GetSearchCost(const GraphSearchGoal<RoomNode>& goal) const
 }
 
 
-void RoomsGraph::GetConnectedEdges(RoomNode startNode, std::vector<RoomEdge>& outConnections) const
+void RoomsGraph::GetConnectedEdges(RoomNode startNode, EdgeList& outConnections) const
 {
     auto nodeConns = Connections.find(startNode);
     if (nodeConns == Connections.end())
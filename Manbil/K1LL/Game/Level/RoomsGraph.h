@@ -48,7 +48,7 @@ public:
     std::unordered_map<RoomNode, std::vector<RoomNode>, RoomNode> Connections;
 
 
-    virtual void GetConnectedEdges(RoomNode startNode, std::vector<RoomEdge>& outConnections) const override;
+    virtual void GetConnectedEdges(RoomNode startNode, EdgeList& outConnections) const override;
 };
 
 typedef AStarSearch<RoomNode, RoomEdge, GraphSearchGoal<RoomNode>, void*, RoomNode> RoomsGraphPather;
\ No newline at end of file
@@ -22,20 +22,12 @@ bool PuncherBullet::Update(Level* level, float elapsedSeconds)
     Pos += (Velocity * elapsedSeconds);
 
     //See if any players were hit.
-    Box2D lineBnds = Box2D(Mathf::Min(oldPos.x, Pos.x), Mathf::Max(oldPos.x, Pos.x),
-                           Mathf::Min(oldPos.y, Pos.y), Mathf::Max(oldPos.y, Pos.y));
-    for (unsigned int i = 0; i < level->Players.size(); ++i)
+    float playerHitT;
+    int hitPlayer = level->CastPlayerRay(oldPos, Velocity, playerHitT, elapsedSeconds);
+    if (hitPlayer >= 0)
     {
-        Player& player = *level->Players[i];
-        if (player.GetBoundingBox2D().Touches(lineBnds))
-        {
-            auto hitResult = player.GetCollision3D().RayHitCheck(oldPos, Velocity);
-            if (hitResult.DidHitTarget && hitResult.HitT >= 0.0f && hitResult.HitT <= elapsedSeconds)
-            {
-                //TODO: Hurt player.
-                return true;
-            }
-        }
+        //TODO: Hurt player.
+        return true;
     }
 
     //Cast a ray segment from the old position to the new position to see if a wall was hit.
@@ -58,13 +50,13 @@ void PuncherBullet::Render(Level* level, float elapsedSeconds, const RenderInfo&
 #define PUNCH_BUF_SIZE WeaponConstants::Instance.PuncherBufferSize
 
 PuncherBulletPool::PuncherBulletPool(Level* lvl)
-    : Actor(lvl)
+    : Actor(lvl), bufferSize(PUNCH_BUF_SIZE)
 {
-    isAllocated = new bool[PUNCH_BUF_SIZE];
-    bullets = new PuncherBullet[PUNCH_BUF_SIZE];
+    isAllocated = new bool[bufferSize];
+    bullets = new PuncherBullet[bufferSize];
     activeBullets.reserve(16);
     
-    for (unsigned int i = 0; i < PUNCH_BUF_SIZE; ++i)
+    for (unsigned int i = 0; i < bufferSize; ++i)
         isAllocated[i] = false;
 }
 PuncherBulletPool::~PuncherBulletPool(void)
@@ -83,7 +75,7 @@ PuncherBullet* PuncherBulletPool::NewBulletInstance(Vector3f pos, Vector3f veloc
     unsigned int startVal = nextBullet;
     while (isAllocated[nextBullet])
     {
-        nextBullet = (nextBullet + 1) % PUNCH_BUF_SIZE;
+        nextBullet = (nextBullet + 1) % bufferSize;
 
         //If there aren't any bullets left to allocate, crash.
         assert(nextBullet != startVal);
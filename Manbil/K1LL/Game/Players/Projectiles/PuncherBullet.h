@@ -58,6 +58,9 @@ private:
 
 
     //Arrays for bullet allocation.
+    //The size is copied from the weapon constants so it can't change under this pool
+    //    if the constants get reloaded.
+    unsigned int bufferSize;
     bool* isAllocated;
     PuncherBullet* bullets;
 
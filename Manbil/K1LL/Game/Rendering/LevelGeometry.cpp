@@ -1,103 +1,40 @@
 #include "LevelGeometry.h"
 
+#include <SFML/System/Clock.hpp>
+
 #include "../../../Rendering/Primitives/PrimitiveGenerator.h"
 #include "../Level/Level.h"
 
 
-LevelGeometry::LevelGeometry(Level* theLevel, std::string& err)
-    : mat(0), Actor(theLevel)
+namespace
 {
-    const Array2D<BlockTypes>& levelGrid = theLevel->BlockGrid;
-
-    typedef VertexPosNormal MyVert;
-    RenderIOAttributes myVertAttrs = MyVert::GetVertexAttributes();
-
-
-    #pragma region Generate vertices
-
-    std::vector<MyVert> vertices;
-    std::vector<unsigned int> indices;
-
-    float ceilHeight = LevelConstants::Instance.CeilingHeight;
-
-    //For every empty space, build the walls that border it.
-
-#define ADD_WALL(v1, v2, v3, v4, normal) \
-    vertices.push_back(MyVert(v1, normal)); \
-    vertices.push_back(MyVert(v2, normal)); \
-    vertices.push_back(MyVert(v3, normal)); \
-    vertices.push_back(MyVert(v4, normal)); \
-    indices.push_back(vertices.size() - 4); \
-    indices.push_back(vertices.size() - 3); \
-    indices.push_back(vertices.size() - 2); \
-    indices.push_back(vertices.size() - 4); \
-    indices.push_back(vertices.size() - 2); \
-    indices.push_back(vertices.size() - 1);
-
-    Vector2f sizeF = ToV2f(levelGrid.GetDimensions());
-
-    for (Vector2u counter; counter.y < levelGrid.GetHeight(); ++counter.y)
+    //Gets whether a grid cell is empty space that needs walls around it.
+    bool IsOpen(BlockTypes block)
     {
-        for (counter.x = 0; counter.x < levelGrid.GetWidth(); ++counter.x)
-        {
-            assert(levelGrid[counter] != BT_DOORWAY);
+        assert(block != BT_DOORWAY);
+        return block == BT_NONE || block == BT_SPAWN;
+    }
 
-            if (levelGrid[counter] == BT_NONE || levelGrid[counter] == BT_SPAWN)
-            {
-                if (counter.x == 0 || levelGrid[counter.LessX()] == BT_WALL)
-                {
-                    float minY = (float)counter.y,
-                          maxY = minY + 1.0f;
-                    float x = (float)counter.x;
-                    ADD_WALL(Vector3f(x, minY, 0.0f), Vector3f(x, maxY, 0.0f),
-                             Vector3f(x, maxY, ceilHeight), Vector3f(x, minY, ceilHeight),
-                             Vector3f(1.0f, 0.0f, 0.0f))
-                }
-                if (counter.y == 0 || levelGrid[counter.LessY()] == BT_WALL)
-                {
-                    float minX = (float)counter.x,
-                          maxX = minX + 1.0f;
-                    float y = (float)counter.y;
-                    ADD_WALL(Vector3f(minX, y, 0.0f), Vector3f(maxX, y, 0.0f),
-                             Vector3f(maxX, y, ceilHeight), Vector3f(minX, y, ceilHeight),
-                             Vector3f(0.0f, 1.0f, 0.0f))
-                }
-                if (counter.x == levelGrid.GetWidth() - 1 || levelGrid[counter.MoreX()] == BT_WALL)
-                {
-                    float minY = (float)counter.y,
-                          maxY = minY + 1.0f;
-                    float x = (float)(counter.x + 1);
-                    ADD_WALL(Vector3f(x, minY, 0.0f), Vector3f(x, maxY, 0.0f),
-                             Vector3f(x, maxY, ceilHeight), Vector3f(x, minY, ceilHeight),
-                             Vector3f(1.0f, 0.0f, 0.0f))
-                }
-                if (counter.y == levelGrid.GetHeight() - 1 || levelGrid[counter.MoreY()] == BT_WALL)
-                {
-                    float minX = (float)counter.x,
-                          maxX = minX + 1.0f;
-                    float y = (float)(counter.y + 1);
-                    ADD_WALL(Vector3f(minX, y, 0.0f), Vector3f(maxX, y, 0.0f),
-                             Vector3f(maxX, y, ceilHeight), Vector3f(minX, y, ceilHeight),
-                             Vector3f(0.0f, 1.0f, 0.0f))
-                }
-            }
-        }
+    //Gets the area of the level grid that the given room's geometry depends on:
+    //    the room itself plus the cells touching it.
+    LevelInfo::UIntBox GetSourceBounds(const LevelInfo::UIntBox& roomBnds, const Array2D<BlockTypes>& levelGrid)
+    {
+        LevelInfo::UIntBox bnds;
+        bnds.Min = Vector2u((roomBnds.Min.x == 0 ? 0 : roomBnds.Min.x - 1),
+                            (roomBnds.Min.y == 0 ? 0 : roomBnds.Min.y - 1));
+        bnds.Max = Vector2u(Mathf::Min(roomBnds.Max.x + 1, levelGrid.GetWidth() - 1),
+                            Mathf::Min(roomBnds.Max.y + 1, levelGrid.GetHeight() - 1));
+        return bnds;
     }
+}
 
-    //Add the floors/ceiling.
-    ADD_WALL(Vector3f(0.0f, 0.0f, 0.0f), Vector3f(0.0f, sizeF.y, 0.0f),
-             Vector3f(sizeF.x, sizeF.y, 0.0f), Vector3f(sizeF.x, 0.0f, 0.0f),
-             Vector3f(0.0f, 0.0f, 1.0f));
-    ADD_WALL(Vector3f(0.0f, 0.0f, ceilHeight), Vector3f(0.0f, sizeF.y, ceilHeight),
-             Vector3f(sizeF.x, sizeF.y, ceilHeight), Vector3f(sizeF.x, 0.0f, ceilHeight),
-             Vector3f(0.0f, 0.0f, -1.0f));
 
-    //Finally, generate the mesh data buffers.
-    mesh.SubMeshes.push_back(MeshData(false, PrimitiveTypes::PT_TRIANGLE_LIST));
-    mesh.SubMeshes[0].SetVertexData(vertices, MeshData::BUF_STATIC, myVertAttrs);
-    mesh.SubMeshes[0].SetIndexData(indices, MeshData::BUF_STATIC);
+LevelGeometry::LevelGeometry(Level* theLevel, std::string& err)
+    : mat(0), Actor(theLevel)
+{
+    RenderIOAttributes myVertAttrs = MyVert::GetVertexAttributes();
 
-    #pragma endregion
+    RebuildChangedRooms();
 
 
     #pragma region Generate material
@@ -167,5 +104,398 @@ bool LevelGeometry::Update(float elapsedTime)
 }
 void LevelGeometry::Render(float elapsedTime, const RenderInfo& info)
 {
-    mat->Render(info, &mesh, params);
+    //Find the rooms that are both inside the frustum and visible from the camera's room.
+    //The level usually found the visible rooms already.
+    const std::vector<bool>* isVisible = visibleRooms;
+    if (isVisible == 0)
+    {
+        GetLevel()->GetVisibleRooms(info.Cam->GetPosition().XY(), isRoomVisible);
+        isVisible = &isRoomVisible;
+    }
+
+    Frustum frustum(info.mVP);
+    roomsInFrustum.resize(chunks.size());
+    unsigned int nInFrustum = frustum.CullBoxes(roomMinX.data(), roomMinY.data(), roomMinZ.data(),
+                                                roomMaxX.data(), roomMaxY.data(), roomMaxZ.data(),
+                                                (unsigned int)chunks.size(), roomsInFrustum.data());
+
+    //Draw every visible room's chunk in one batch.
+    toRender.clear();
+    for (unsigned int i = 0; i < nInFrustum; ++i)
+    {
+        unsigned int room = roomsInFrustum[i];
+        if ((*isVisible)[room])
+        {
+            toRender.push_back(&chunks[room]->Geometry);
+        }
+    }
+
+    nRoomsRendered = (unsigned int)toRender.size();
+    if (nRoomsRendered > 0)
+    {
+        mat->Render(info, toRender, params);
+    }
+}
+
+unsigned int LevelGeometry::RebuildChangedRooms(void)
+{
+    sf::Clock clock;
+    lastBuild = BuildStats();
+
+    //Rooms may have been added or removed since the last build.
+    unsigned int nRooms = (unsigned int)GetLevel()->RoomBounds.size();
+    bool roomCountChanged = (chunks.size() != nRooms);
+    chunks.resize(nRooms);
+    roomMinX.resize(nRooms);
+    roomMinY.resize(nRooms);
+    roomMinZ.resize(nRooms);
+    roomMaxX.resize(nRooms);
+    roomMaxY.resize(nRooms);
+    roomMaxZ.resize(nRooms);
+
+    for (unsigned int room = 0; room < nRooms; ++room)
+    {
+        if (chunks[room].get() == 0)
+        {
+            chunks[room].reset(new RoomChunk());
+            BuildChunk(room);
+        }
+        else if (IsChunkOutOfDate(room))
+        {
+            BuildChunk(room);
+        }
+    }
+
+    if (lastBuild.NRoomsBuilt > 0 || roomCountChanged)
+    {
+        BuildCollision();
+    }
+
+    for (unsigned int room = 0; room < nRooms; ++room)
+    {
+        const MeshData& meshData = chunks[room]->Geometry.SubMeshes[0];
+        lastBuild.NVertices += meshData.GetNVertices();
+        lastBuild.NIndices += meshData.GetNIndices();
+    }
+    lastBuild.Seconds = clock.getElapsedTime().asSeconds();
+
+    return lastBuild.NRoomsBuilt;
+}
+
+void LevelGeometry::GetSharedAreas(unsigned int room, std::vector<LevelInfo::UIntBox>& outAreas) const
+{
+    const std::vector<LevelInfo::UIntBox>& roomBounds = GetLevel()->RoomBounds;
+    const LevelInfo::UIntBox& bnds = roomBounds[room];
+
+    outAreas.clear();
+    for (unsigned int i = 0; i < room; ++i)
+    {
+        LevelInfo::UIntBox overlap;
+        overlap.Min = Vector2u(Mathf::Max(bnds.Min.x, roomBounds[i].Min.x),
+                               Mathf::Max(bnds.Min.y, roomBounds[i].Min.y));
+        overlap.Max = Vector2u(Mathf::Min(bnds.Max.x, roomBounds[i].Max.x),
+                               Mathf::Min(bnds.Max.y, roomBounds[i].Max.y));
+        if (overlap.Min.x <= overlap.Max.x && overlap.Min.y <= overlap.Max.y)
+        {
+            outAreas.push_back(overlap);
+        }
+    }
+}
+bool LevelGeometry::IsChunkOutOfDate(unsigned int room) const
+{
+    const Array2D<BlockTypes>& levelGrid = GetLevel()->BlockGrid;
+    const RoomChunk& chunk = *chunks[room];
+
+    LevelInfo::UIntBox sourceBnds = GetSourceBounds(GetLevel()->RoomBounds[room], levelGrid);
+    if (sourceBnds.Min != chunk.SourceBounds.Min || sourceBnds.Max != chunk.SourceBounds.Max)
+    {
+        return true;
+    }
+
+    //Adding, removing, or moving an earlier room can change which cells this room owns.
+    std::vector<LevelInfo::UIntBox> sharedAreas;
+    GetSharedAreas(room, sharedAreas);
+    if (sharedAreas.size() != chunk.SharedAreas.size())
+    {
+        return true;
+    }
+    for (unsigned int i = 0; i < sharedAreas.size(); ++i)
+    {
+        if (sharedAreas[i].Min != chunk.SharedAreas[i].Min || sharedAreas[i].Max != chunk.SharedAreas[i].Max)
+        {
+            return true;
+        }
+    }
+
+    for (Vector2u counter; counter.y < chunk.SourceCells.GetHeight(); ++counter.y)
+    {
+        for (counter.x = 0; counter.x < chunk.SourceCells.GetWidth(); ++counter.x)
+        {
+            if (chunk.SourceCells[counter] != levelGrid[counter + sourceBnds.Min])
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+void LevelGeometry::BuildChunk(unsigned int room)
+{
+    const Array2D<BlockTypes>& levelGrid = GetLevel()->BlockGrid;
+    const LevelInfo::UIntBox& bnds = GetLevel()->RoomBounds[room];
+    RoomChunk& chunk = *chunks[room];
+
+    float ceilHeight = LevelConstants::Instance.CeilingHeight;
+
+    //Remember the grid cells this chunk is being built from, to see later whether they've changed.
+    chunk.SourceBounds = GetSourceBounds(bnds, levelGrid);
+    Vector2u sourceSize = chunk.SourceBounds.Max - chunk.SourceBounds.Min + Vector2u(1, 1);
+    chunk.SourceCells.Reset(sourceSize.x, sourceSize.y);
+    chunk.SourceCells.GetView().Fill(levelGrid.GetView(chunk.SourceBounds.Min, sourceSize));
+    GetSharedAreas(room, chunk.SharedAreas);
+
+
+    #pragma region Generate vertices
+
+    std::vector<MyVert>& vertices = buildVertices;
+    std::vector<unsigned int>& indices = buildIndices;
+    vertices.clear();
+    indices.clear();
+
+    //Adds a quad with the given corners, as two triangles sharing the same four vertices.
+    auto addQuad = [&](Vector3f v1, Vector3f v2, Vector3f v3, Vector3f v4, Vector3f normal)
+    {
+        unsigned int first = (unsigned int)vertices.size();
+        vertices.push_back(MyVert(v1, normal));
+        vertices.push_back(MyVert(v2, normal));
+        vertices.push_back(MyVert(v3, normal));
+        vertices.push_back(MyVert(v4, normal));
+
+        indices.push_back(first);
+        indices.push_back(first + 1);
+        indices.push_back(first + 2);
+        indices.push_back(first);
+        indices.push_back(first + 2);
+        indices.push_back(first + 3);
+    };
+
+
+    //Only build the cells this room owns; the rest are built by the rooms they're shared with.
+    Vector2u roomSize = bnds.Max - bnds.Min + Vector2u(1, 1);
+    buildOwnedCells.assign(roomSize.x * roomSize.y, 1);
+    Array2DView<unsigned char> ownedCells(buildOwnedCells.data(), roomSize.x, roomSize.y, roomSize.x);
+    for (unsigned int i = 0; i < chunk.SharedAreas.size(); ++i)
+    {
+        const LevelInfo::UIntBox& shared = chunk.SharedAreas[i];
+        for (Vector2u counter = shared.Min; counter.y <= shared.Max.y; ++counter.y)
+        {
+            for (counter.x = shared.Min.x; counter.x <= shared.Max.x; ++counter.x)
+            {
+                ownedCells[counter - bnds.Min] = 0;
+            }
+        }
+    }
+
+
+    //For every empty space, the walls that border it are built.
+    //Walls along the same grid line are merged into as few quads as possible.
+
+    //First find which sides of each empty space need a wall, as a bit flag for each side.
+    const unsigned char sideFlags[] = { 1, 2, 4, 8 };
+    buildWallSides.assign(roomSize.x * roomSize.y, 0);
+    Array2DView<unsigned char> wallSides(buildWallSides.data(), roomSize.x, roomSize.y, roomSize.x);
+    for (Vector2u counter = bnds.Min; counter.y <= bnds.Max.y; ++counter.y)
+    {
+        for (counter.x = bnds.Min.x; counter.x <= bnds.Max.x; ++counter.x)
+        {
+            if (ownedCells[counter - bnds.Min] != 0 && IsOpen(levelGrid[counter]))
+            {
+                unsigned char& sides = wallSides[counter - bnds.Min];
+                if (counter.x == 0 || levelGrid[counter.LessX()] == BT_WALL)
+                {
+                    sides |= sideFlags[0];
+                }
+                if (counter.x == levelGrid.GetWidth() - 1 || levelGrid[counter.MoreX()] == BT_WALL)
+                {
+                    sides |= sideFlags[1];
+                }
+                if (counter.y == 0 || levelGrid[counter.LessY()] == BT_WALL)
+                {
+                    sides |= sideFlags[2];
+                }
+                if (counter.y == levelGrid.GetHeight() - 1 || levelGrid[counter.MoreY()] == BT_WALL)
+                {
+                    sides |= sideFlags[3];
+                }
+            }
+        }
+    }
+
+    //Now go along every grid line through the room, merging the walls on it.
+    //Walls facing either way along an axis have the same normal, so the walls on both sides
+    //    of a line can be merged together. As a result, no two wall quads ever share a corner
+    //    with the same normal, so there are no vertices left to share between quads.
+    for (unsigned int axis = 0; axis < 2; ++axis)
+    {
+        //Walls facing along X run along Y, and vice-versa.
+        bool facesX = (axis == 0);
+        unsigned int nLines = (facesX ? roomSize.x : roomSize.y) + 1,
+                     nAlong = (facesX ? roomSize.y : roomSize.x);
+        unsigned char nearSide = sideFlags[axis * 2],
+                      farSide = sideFlags[(axis * 2) + 1];
+        Vector3f normal = (facesX ? Vector3f(1.0f, 0.0f, 0.0f) : Vector3f(0.0f, 1.0f, 0.0f));
+
+        for (unsigned int line = 0; line < nLines; ++line)
+        {
+            //A wall on this line is either on the near side of the cell after the line
+            //    or the far side of the cell before it.
+            auto needsWall = [&](unsigned int along) -> bool
+            {
+                return (line < nLines - 1 &&
+                        (wallSides[facesX ? Vector2u(line, along) : Vector2u(along, line)] & nearSide) != 0) ||
+                       (line > 0 &&
+                        (wallSides[facesX ? Vector2u(line - 1, along) : Vector2u(along, line - 1)] & farSide) != 0);
+            };
+
+            for (unsigned int along = 0; along < nAlong; ++along)
+            {
+                if (!needsWall(along))
+                {
+                    continue;
+                }
+
+                //Extend the wall as far as it goes.
+                unsigned int runStart = along;
+                while (along + 1 < nAlong && needsWall(along + 1))
+                {
+                    along += 1;
+                }
+                unsigned int runEnd = along + 1;
+
+                lastBuild.NWallQuads += 1;
+                lastBuild.NUnmergedWallQuads += runEnd - runStart;
+
+                float lineF = (float)((facesX ? bnds.Min.x : bnds.Min.y) + line),
+                      startF = (float)((facesX ? bnds.Min.y : bnds.Min.x) + runStart),
+                      endF = (float)((facesX ? bnds.Min.y : bnds.Min.x) + runEnd);
+                if (facesX)
+                {
+                    addQuad(Vector3f(lineF, startF, 0.0f), Vector3f(lineF, endF, 0.0f),
+                            Vector3f(lineF, endF, ceilHeight), Vector3f(lineF, startF, ceilHeight),
+                            normal);
+                }
+                else
+                {
+                    addQuad(Vector3f(startF, lineF, 0.0f), Vector3f(endF, lineF, 0.0f),
+                            Vector3f(endF, lineF, ceilHeight), Vector3f(startF, lineF, ceilHeight),
+                            normal);
+                }
+            }
+        }
+    }
+
+    //Add the floor/ceiling over the owned cells, as a few large rectangles.
+    //A room that doesn't share any cells gets a single rectangle.
+    //Each rectangle's cells are cleared from "ownedCells" as it's added.
+    for (Vector2u start; start.y < roomSize.y; ++start.y)
+    {
+        for (start.x = 0; start.x < roomSize.x; ++start.x)
+        {
+            if (ownedCells[start] == 0)
+            {
+                continue;
+            }
+
+            //Extend the rectangle along X as far as it goes, then along Y as far as the whole row fits.
+            Vector2u end = start + Vector2u(1, 1);
+            while (end.x < roomSize.x && ownedCells[Vector2u(end.x, start.y)] != 0)
+            {
+                end.x += 1;
+            }
+            bool rowFits = true;
+            while (rowFits && end.y < roomSize.y)
+            {
+                for (unsigned int x = start.x; x < end.x && rowFits; ++x)
+                {
+                    rowFits = (ownedCells[Vector2u(x, end.y)] != 0);
+                }
+                if (rowFits)
+                {
+                    end.y += 1;
+                }
+            }
+
+            for (Vector2u counter = start; counter.y < end.y; ++counter.y)
+            {
+                for (counter.x = start.x; counter.x < end.x; ++counter.x)
+                {
+                    ownedCells[counter] = 0;
+                }
+            }
+
+            Vector2f rectMin = ToV2f(bnds.Min + start),
+                     rectMax = ToV2f(bnds.Min + end);
+            addQuad(Vector3f(rectMin.x, rectMin.y, 0.0f), Vector3f(rectMin.x, rectMax.y, 0.0f),
+                    Vector3f(rectMax.x, rectMax.y, 0.0f), Vector3f(rectMax.x, rectMin.y, 0.0f),
+                    Vector3f(0.0f, 0.0f, 1.0f));
+            addQuad(Vector3f(rectMin.x, rectMin.y, ceilHeight), Vector3f(rectMin.x, rectMax.y, ceilHeight),
+                    Vector3f(rectMax.x, rectMax.y, ceilHeight), Vector3f(rectMax.x, rectMin.y, ceilHeight),
+                    Vector3f(0.0f, 0.0f, -1.0f));
+        }
+    }
+
+    #pragma endregion
+
+
+    //Generate the mesh data buffers.
+    if (chunk.Geometry.SubMeshes.size() == 0)
+    {
+        chunk.Geometry.SubMeshes.push_back(MeshData(true, PrimitiveTypes::PT_TRIANGLE_LIST));
+    }
+    MeshData& meshData = chunk.Geometry.SubMeshes[0];
+    meshData.SetVertexData(vertices, MeshData::BUF_STATIC, MyVert::GetVertexAttributes());
+    meshData.SetIndexData(indices, MeshData::BUF_STATIC);
+
+    Vector2f minF = ToV2f(bnds.Min),
+             maxF = ToV2f(bnds.Max + Vector2u(1, 1));
+    roomMinX[room] = minF.x;
+    roomMinY[room] = minF.y;
+    roomMinZ[room] = 0.0f;
+    roomMaxX[room] = maxF.x;
+    roomMaxY[room] = maxF.y;
+    roomMaxZ[room] = ceilHeight;
+
+    lastBuild.NRoomsBuilt += 1;
+}
+void LevelGeometry::BuildCollision(void)
+{
+    //Put every chunk's triangles together into one mesh.
+    std::vector<Vector3f> positions;
+    std::vector<unsigned int> indices;
+    for (unsigned int room = 0; room < chunks.size(); ++room)
+    {
+        const MeshData& meshData = chunks[room]->Geometry.SubMeshes[0];
+        const MyVert* vertices = meshData.GetVertexData<MyVert>();
+        const unsigned int* chunkIndices = meshData.GetIndexData();
+
+        unsigned int firstVertex = (unsigned int)positions.size();
+        for (unsigned int i = 0; i < meshData.GetNVertices(); ++i)
+        {
+            positions.push_back(vertices[i].Pos);
+        }
+        for (unsigned int i = 0; i < meshData.GetNIndices(); ++i)
+        {
+            indices.push_back(firstVertex + chunkIndices[i]);
+        }
+    }
+
+    if (indices.size() == 0)
+    {
+        GetLevel()->GeometryBVH.Clear();
+    }
+    else
+    {
+        GetLevel()->GeometryBVH.Build(positions.data(), indices.data(), (unsigned int)indices.size() / 3);
+    }
 }
\ No newline at end of file
@@ -1,16 +1,37 @@
 #pragma once
 
+#include <memory>
+
 #include "../../../Rendering/Rendering.hpp"
 
 #include "../Actor.h"
-#include "../../Level Info/RoomInfo.h"
+#include "../../Level Info/LevelInfo.h"
 
 
 //Generates and renders the walls, ceiling, and floor.
+//The geometry is split into one chunk per room, each with its own vertex/index buffers,
+//    so that rooms can be culled and rebuilt independently of each other.
 class LevelGeometry : public Actor
 {
 public:
 
+    //Information about the last time any room geometry was built.
+    struct BuildStats
+    {
+        //The number of rooms that were (re)built.
+        unsigned int NRoomsBuilt = 0;
+        //The number of wall quads in the rooms that were built after merging walls along the same line,
+        //    and the number there would have been with one quad per grid cell.
+        unsigned int NWallQuads = 0,
+                     NUnmergedWallQuads = 0;
+        //The total number of vertices/indices in every room's geometry afterwards.
+        unsigned int NVertices = 0,
+                     NIndices = 0;
+        //The time it took to build the rooms' geometry and the collision hierarchy.
+        float Seconds = 0.0f;
+    };
+
+
     LevelGeometry(Level* theLevel, std::string& outErrorMsg);
     ~LevelGeometry(void);
 
@@ -19,9 +40,77 @@ public:
     virtual void Render(float elapsedTime, const RenderInfo& info) override;
 
 
+    //Rebuilds the geometry of every room whose grid cells (or the cells around them)
+    //    changed since it was last built, along with the level's collision hierarchy.
+    //Should be called after the level's "BlockGrid" and "RoomBounds" change.
+    //Returns the number of rooms that were rebuilt.
+    unsigned int RebuildChangedRooms(void);
+
+
+    //Sets which rooms are visible from the camera that's about to be rendered
+    //    (e.x. from "Level::GetVisible()"), so that "Render()" doesn't have to find them again.
+    //The list must stay alive until this is called again with 0,
+    //    after which "Render()" goes back to finding the visible rooms itself.
+    void SetVisibleRooms(const std::vector<bool>* isRoomVisible) { visibleRooms = isRoomVisible; }
+
+    //Gets the number of rooms that were drawn the last time this actor was rendered.
+    unsigned int GetNRoomsRenderedLastFrame(void) const { return nRoomsRendered; }
+    const BuildStats& GetLastBuildStats(void) const { return lastBuild; }
+
+
 private:
 
+    typedef VertexPosNormal MyVert;
+
+    //The geometry for one room.
+    struct RoomChunk
+    {
+        //The area of the level grid this chunk was built from:
+        //    the room's bounds plus one extra cell around them, since the walls along the room's edges
+        //    depend on the cells just outside it.
+        LevelInfo::UIntBox SourceBounds;
+        Array2D<BlockTypes> SourceCells;
+        //The parts of the room that overlap rooms earlier in the level's list (e.x. a shared edge).
+        //Like "LevelInfo::GetRoom()", the earliest room owns those cells and is the only one
+        //    that builds their geometry, so nothing is drawn twice.
+        std::vector<LevelInfo::UIntBox> SharedAreas;
+
+        //Keeps a local copy of its mesh data, for building the collision hierarchy.
+        Mesh Geometry;
+
+        RoomChunk(void) : SourceCells(1, 1) { }
+    };
+
+
     Material* mat;
-    Mesh mesh;
     UniformDictionary params;
-};
\ No newline at end of file
+
+    //One chunk for every room in the level, in the same order as the level's rooms.
+    std::vector<std::unique_ptr<RoomChunk>> chunks;
+    //The bounds of each room's geometry, stored as separate arrays for "Frustum::CullBoxes()".
+    std::vector<float> roomMinX, roomMinY, roomMinZ, roomMaxX, roomMaxY, roomMaxZ;
+
+    BuildStats lastBuild;
+
+    //Scratch space used when rendering.
+    const std::vector<bool>* visibleRooms = 0;
+    std::vector<bool> isRoomVisible;
+    std::vector<unsigned int> roomsInFrustum;
+    std::vector<const Mesh*> toRender;
+    unsigned int nRoomsRendered = 0;
+
+    //Scratch space used when building rooms.
+    std::vector<MyVert> buildVertices;
+    std::vector<unsigned int> buildIndices;
+    std::vector<unsigned char> buildWallSides, buildOwnedCells;
+
+
+    //Finds the parts of the given room that belong to rooms earlier in the level's list.
+    void GetSharedAreas(unsigned int room, std::vector<LevelInfo::UIntBox>& outAreas) const;
+    //Gets whether the given room's chunk needs to be rebuilt to match the level grid.
+    bool IsChunkOutOfDate(unsigned int room) const;
+    //Regenerates the given room's chunk from the level grid.
+    void BuildChunk(unsigned int room);
+    //Rebuilds the level's collision hierarchy out of every chunk's triangles.
+    void BuildCollision(void);
+};
@@ -201,7 +201,7 @@ unsigned int ParticleManager::Burst(unsigned int nParticles, ParticleMaterial* m
     float texelStart = (float)startX * texelSize,
           texelEnd = (float)(startX + nParticles - 1) * texelSize;
     ParticleContent::Instance.SetBurstPassParams(mat->BurstParams, texelStart, texelEnd,
-                                                 randVals.GetZeroToOne(), sourceVel);
+                                                 randVals.GetZeroToOne(nRandValsUsed++), sourceVel);
     DrawingQuad::GetInstance()->Render(rInfo, mat->BurstParams, *mat->BurstMat);
     bursts.push_back(ParticleBurst(mat, lifetime, startX, nParticles));
 
@@ -330,7 +330,7 @@ bool ParticleManager::Update(ParticleBurst& burst, const RenderInfo& info,
     ParticleContent::Instance.SetUpdatePassParams(burst.Mat->UpdateParams,
                                                   (float)burst.StartPixel * texelSize,
                                                   (float)endPixel * texelSize,
-                                                  randVals.GetZeroToOne(), frameLength,
+                                                  randVals.GetZeroToOne(nRandValsUsed++), frameLength,
                                                   &particleData1[renderFrom], &particleData2[renderFrom]);
 
     Viewport(burst.StartPixel, 0, burst.NParticles, 1).Use();
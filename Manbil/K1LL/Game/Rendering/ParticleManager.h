@@ -82,7 +82,8 @@ private:
                     particleData2[2];
     unsigned int currentRenderTo = 0;
 
-    FastRand randVals;
+    CounterRand randVals;
+    unsigned int nRandValsUsed = 0;
 
     //Used to directly copy particle data between the textures.
     Material* copyParticleDataMat;
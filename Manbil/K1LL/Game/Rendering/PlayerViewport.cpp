@@ -80,7 +80,7 @@ void PlayerViewport::Render(float frameSeconds, const RenderInfo& screenRenderIn
     cam.GetPerspectiveProjection(projM);
 
     RenderInfo worldRenderInfo(Lvl.GetTimeSinceGameStart(), &cam, &viewM, &projM);
-    Lvl.Render(frameSeconds, worldRenderInfo);
+    Lvl.Render(frameSeconds, worldRenderInfo, visible);
 
     worldRendTarg.DisableDrawingInto();
 
@@ -32,9 +32,14 @@ public:
 
     virtual void Render(float elapsedTime, const RenderInfo& info) override;
 
+    //Gets the players and actors that were rendered into this viewport last frame.
+    const Level::VisibleSet& GetLastVisible(void) const { return visible; }
+
 
 private:
 
+    Level::VisibleSet visible;
+
     RenderTarget worldRendTarg;
     MTexture2D worldRendColor, worldRendDepth;
 };
\ No newline at end of file
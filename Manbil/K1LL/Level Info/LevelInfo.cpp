@@ -331,6 +331,257 @@ void LevelInfo::GetConnections(RoomsGraph& outGraph) const
     }
 }
 
+namespace
+{
+    const float epsilon = 0.0001f;
+
+    //A doorway between two rooms, which can be seen through.
+    //Stored as the line segment running down the middle of the doorway's grid cells,
+    //    since any line of sight through the doorway has to cross that segment.
+    //The segment runs so that the room it leads into is on its left side.
+    struct Portal
+    {
+        unsigned int ID, ToRoom;
+        Vector2f Start, End;
+        Portal(unsigned int id, unsigned int toRoom, Vector2f start, Vector2f end)
+            : ID(id), ToRoom(toRoom), Start(start), End(end) { }
+    };
+
+    //A piece of a portal's segment that can be seen through, facing the same way as the portal.
+    struct Window
+    {
+        Vector2f Start, End;
+        Window(Vector2f start, Vector2f end) : Start(start), End(end) { }
+        Window Reversed(void) const { return Window(End, Start); }
+
+        //Gets whether this window covers the given window along the same portal.
+        bool Contains(const Window& other) const
+        {
+            Vector2f dir = End - Start;
+            float invLenSqr = 1.0f / dir.LengthSquared(),
+                  t1 = (other.Start - Start).Dot(dir) * invLenSqr,
+                  t2 = (other.End - Start).Dot(dir) * invLenSqr;
+            return t1 >= -epsilon && t1 <= 1.0f + epsilon &&
+                   t2 >= -epsilon && t2 <= 1.0f + epsilon;
+        }
+    };
+
+    //A window that was already looked through from a piece of one of the starting room's portals.
+    struct LookedThrough
+    {
+        unsigned int SourcePortal;
+        Window Source, View;
+        LookedThrough(unsigned int sourcePortal, Window source, Window view)
+            : SourcePortal(sourcePortal), Source(source), View(view) { }
+    };
+
+
+    //Gets the distance of the given point from the line through "a" and "b".
+    //Positive if the point is on the left side of the line, negative if on the right side.
+    float GetSide(Vector2f a, Vector2f b, Vector2f point)
+    {
+        Vector2f dir = b - a;
+        return ((dir.x * (point.y - a.y)) - (dir.y * (point.x - a.x))) / dir.Length();
+    }
+    //Cuts off the part of the given window that isn't at least "minSide" to the left of the line
+    //    through "a" and "b". Returns "false" if nothing is left.
+    //If "a" and "b" are the same point, the window is left alone.
+    bool ClipToLeft(Vector2f a, Vector2f b, float minSide, Window& window)
+    {
+        if (a.DistanceSquared(b) < epsilon * epsilon)
+            return true;
+
+        float side1 = GetSide(a, b, window.Start) - minSide,
+              side2 = GetSide(a, b, window.End) - minSide;
+        if (side1 < 0.0f && side2 < 0.0f)
+            return false;
+
+        if (side1 < 0.0f)
+            window.Start += (window.End - window.Start) * (side1 / (side1 - side2));
+        else if (side2 < 0.0f)
+            window.End += (window.Start - window.End) * (side2 / (side2 - side1));
+        return true;
+    }
+    //Narrows "target" down to the part that a straight line from "source" through "window" could reach.
+    //All three should face the same way, with "source" behind "window".
+    //Returns "false" if none of it can be reached.
+    bool ClipToView(const Window& source, const Window& window, Window& target)
+    {
+        //The target has to be in front of the window, and between the two lines
+        //    that cross from each side of the source to the opposite side of the window.
+        return ClipToLeft(window.Start, window.End, epsilon, target) &&
+               ClipToLeft(source.Start, window.End, -epsilon, target) &&
+               ClipToLeft(window.Start, source.End, -epsilon, target) &&
+               target.Start.DistanceSquared(target.End) > epsilon * epsilon;
+    }
+
+    //Marks every room that can be seen from a piece of one of the starting room's portals ("source")
+    //    by looking through a window into the given room.
+    //The source and window are narrowed down at each step to the parts that a single straight line
+    //    could pass through, so the search only goes as far as a line of sight could.
+    //"lookedThrough" stores, for each portal, the source and window pieces it was already looked through with,
+    //    so that the same view isn't searched more than once.
+    void FindVisibleRooms(unsigned int room, unsigned int sourcePortal, Window source, Window window,
+                          unsigned int depth, const std::vector<std::vector<Portal>>& roomPortals,
+                          std::vector<std::vector<LookedThrough>>& lookedThrough,
+                          std::vector<bool>& outIsVisible)
+    {
+        //A straight line can't pass through the same room twice.
+        if (depth >= roomPortals.size())
+            return;
+
+        for (unsigned int i = 0; i < roomPortals[room].size(); ++i)
+        {
+            const Portal& portal = roomPortals[room][i];
+
+            //Find the part of the portal that can be seen, then the part of the source it can be seen from.
+            //This also makes sure the portal is in front of the window, so that portals are always passed
+            //    through in order and the search never turns back.
+            //Looking back from the portal works the same way with everything facing backwards.
+            Window nextWindow(portal.Start, portal.End),
+                   nextSource = source;
+            if (!ClipToView(source, window, nextWindow) ||
+                !ClipToLeft(nextWindow.End, nextWindow.Start, epsilon, nextSource) ||
+                (depth > 1 && !ClipToView(nextWindow.Reversed(), window.Reversed(), nextSource)))
+            {
+                continue;
+            }
+
+            //Skip this view if it's covered by one that was already searched.
+            std::vector<LookedThrough>& previous = lookedThrough[portal.ID];
+            bool isCovered = false;
+            for (unsigned int j = 0; !isCovered && j < previous.size(); ++j)
+            {
+                isCovered = previous[j].SourcePortal == sourcePortal &&
+                            previous[j].Source.Contains(nextSource) &&
+                            previous[j].View.Contains(nextWindow);
+            }
+            if (isCovered)
+                continue;
+            previous.push_back(LookedThrough(sourcePortal, nextSource, nextWindow));
+
+            outIsVisible[portal.ToRoom] = true;
+            FindVisibleRooms(portal.ToRoom, sourcePortal, nextSource, nextWindow, depth + 1,
+                             roomPortals, lookedThrough, outIsVisible);
+        }
+    }
+}
+void LevelInfo::GetRoomVisibility(std::vector<std::vector<unsigned int>>& outVisibility) const
+{
+    outVisibility.clear();
+    outVisibility.resize(Rooms.size());
+    if (Rooms.size() == 0)
+    {
+        return;
+    }
+
+    //Use the full level grid to find the open spaces along the borders between rooms.
+    UIntBox bnds = GetBounds();
+    Array2D<BlockTypes> levelGrid(1, 1);
+    GenerateFullLevel(levelGrid, bnds);
+    auto isOpen = [&](Vector2u worldPos) { return levelGrid[worldPos - bnds.Min] != BT_WALL; };
+
+
+    #pragma region Find the portals out of each room
+
+    std::vector<std::vector<Portal>> roomPortals(Rooms.size());
+    unsigned int nPortals = 0;
+    std::vector<unsigned int> bordering;
+    for (unsigned int i = 0; i < Rooms.size(); ++i)
+    {
+        UIntBox thisBnds = GetBounds(i);
+
+        bordering.clear();
+        GetBorderingRooms(i, bordering);
+        for (unsigned int j = 0; j < bordering.size(); ++j)
+        {
+            UIntBox otherBnds = GetBounds(bordering[j]);
+
+            //Rooms that border each other share a row or column of grid cells.
+            //Each unbroken run of open cells along it is a portal.
+            bool isVertical = (thisBnds.Min.x == otherBnds.Max.x || thisBnds.Max.x == otherBnds.Min.x);
+            bool isOtherBefore = (isVertical ?
+                                      (thisBnds.Min.x == otherBnds.Max.x) :
+                                      (thisBnds.Min.y == otherBnds.Max.y));
+            unsigned int sharedLine = (isVertical ?
+                                           (isOtherBefore ? thisBnds.Min.x : thisBnds.Max.x) :
+                                           (isOtherBefore ? thisBnds.Min.y : thisBnds.Max.y));
+            unsigned int start = (isVertical ?
+                                      Mathf::Max(thisBnds.Min.y, otherBnds.Min.y) :
+                                      Mathf::Max(thisBnds.Min.x, otherBnds.Min.x)),
+                         end = (isVertical ?
+                                    Mathf::Min(thisBnds.Max.y, otherBnds.Max.y) :
+                                    Mathf::Min(thisBnds.Max.x, otherBnds.Max.x));
+
+            for (unsigned int k = start; k <= end; ++k)
+            {
+                auto cellAt = [&](unsigned int along)
+                {
+                    return (isVertical ? Vector2u(sharedLine, along) : Vector2u(along, sharedLine));
+                };
+                if (!isOpen(cellAt(k)))
+                    continue;
+
+                unsigned int runStart = k;
+                while (k + 1 <= end && isOpen(cellAt(k + 1)))
+                    k += 1;
+
+                //Make the portal's segment run with the other room on its left.
+                float middle = (float)sharedLine + 0.5f;
+                Vector2f first = (isVertical ?
+                                      Vector2f(middle, (float)runStart) :
+                                      Vector2f((float)runStart, middle)),
+                         last = (isVertical ?
+                                     Vector2f(middle, (float)(k + 1)) :
+                                     Vector2f((float)(k + 1), middle));
+                if (isVertical != isOtherBefore)
+                    roomPortals[i].push_back(Portal(nPortals, bordering[j], last, first));
+                else
+                    roomPortals[i].push_back(Portal(nPortals, bordering[j], first, last));
+                nPortals += 1;
+            }
+        }
+    }
+
+    #pragma endregion
+
+
+    //Search outward from each room through every portal that can be seen through.
+    std::vector<std::vector<LookedThrough>> lookedThrough(nPortals);
+    std::vector<std::vector<bool>> isVisible(Rooms.size(), std::vector<bool>(Rooms.size(), false));
+    for (unsigned int i = 0; i < Rooms.size(); ++i)
+    {
+        for (unsigned int j = 0; j < nPortals; ++j)
+        {
+            lookedThrough[j].clear();
+        }
+
+        isVisible[i][i] = true;
+        for (unsigned int j = 0; j < roomPortals[i].size(); ++j)
+        {
+            //Everything in front of the portal can be seen from somewhere on it.
+            const Portal& portal = roomPortals[i][j];
+            Window portalWindow(portal.Start, portal.End);
+            isVisible[i][portal.ToRoom] = true;
+            FindVisibleRooms(portal.ToRoom, portal.ID, portalWindow, portalWindow, 1,
+                             roomPortals, lookedThrough, isVisible[i]);
+        }
+    }
+
+    //A line of sight works both ways, so only count rooms that were found from both ends.
+    //The search may let through a few extra rooms in one direction, but never misses one.
+    for (unsigned int i = 0; i < Rooms.size(); ++i)
+    {
+        for (unsigned int j = 0; j < Rooms.size(); ++j)
+        {
+            if (isVisible[i][j] && isVisible[j][i])
+            {
+                outVisibility[i].push_back(j);
+            }
+        }
+    }
+}
+
 void LevelInfo::GenerateFullLevel(Array2D<BlockTypes>& outLevel, UIntBox bnds) const
 {
     outLevel.Reset(bnds.Max.x - bnds.Min.x + 1, bnds.Max.y - bnds.Min.y + 1, BT_WALL);
@@ -389,10 +640,11 @@ void LevelInfo::WriteData(DataWriter* writer) const
     writer->WriteFloat(MaxDistToTeam1, "Max dist to team 1's room");
     writer->WriteFloat(MaxDistToTeam2, "Max dist to team 2's room");
 
-    writer->WriteCollection([](DataWriter* writer, const void* toWrite, unsigned int i, void* p)
+    writer->WriteCollection(Rooms,
+                            [](DataWriter* writer, const RoomData& room, unsigned int i)
                             {
-                                writer->WriteDataStructure(*(const RoomData*)toWrite, "Room");
-                            }, "Rooms", sizeof(RoomData), Rooms.data(), Rooms.size());
+                                writer->WriteDataStructure(room, "Room");
+                            }, "Rooms");
 }
 void LevelInfo::ReadData(DataReader* reader)
 {
@@ -402,15 +654,45 @@ void LevelInfo::ReadData(DataReader* reader)
     reader->ReadFloat(MaxDistToTeam1);
     reader->ReadFloat(MaxDistToTeam2);
     
-    reader->ReadCollection([](DataReader* reader, void* pCollection, unsigned int i, void* p)
+    reader->ReadCollection(Rooms,
+                           [](DataReader* reader, RoomData& outRoom, unsigned int i)
                            {
-                               std::vector<RoomData>& infos = *(std::vector<RoomData>*)pCollection;
-                               reader->ReadDataStructure(infos[i]);
-                           },
-                           [](void* pCollection, unsigned int newSize)
-                           {
-                               std::vector<RoomData>& infos = *(std::vector<RoomData>*)pCollection;
-                               infos.resize(newSize);
-                           },
-                           &Rooms);
+                               reader->ReadDataStructure(outRoom);
+                           });
+}
+
+void LevelInfo::WriteLevelFile(DataWriter* writer) const
+{
+    writer->WriteDataStructure(*this, "Data");
+    writer->WriteCollection(RoomVisibility,
+                            [](DataWriter* writer, const std::vector<unsigned int>& visible, unsigned int i)
+                            {
+                                writer->WriteTrivialCollection(visible.data(), (unsigned int)visible.size(),
+                                                               "Visible rooms");
+                            }, "Room visibility");
+}
+void LevelInfo::ReadLevelFile(DataReader* reader)
+{
+    reader->ReadDataStructure(*this);
+
+    //Levels saved before room visibility existed end here, so generate it for them instead.
+    try
+    {
+        reader->ReadCollection(RoomVisibility,
+                               [](DataReader* reader, std::vector<unsigned int>& outVisible, unsigned int i)
+                               {
+                                   reader->ReadTrivialCollection(outVisible);
+                               });
+    }
+    catch (int ex)
+    {
+        assert(ex == DataReader::EXCEPTION_FAILURE);
+        reader->ErrorMessage.clear();
+        RoomVisibility.clear();
+    }
+
+    if (!HasRoomVisibility())
+    {
+        ComputeRoomVisibility();
+    }
 }
\ No newline at end of file
@@ -70,6 +70,13 @@ struct LevelInfo : public ISerializable
     unsigned int Team1Base = 0,
                  Team2Base = 0;
 
+    //For each room, the indices of every room that may be visible from somewhere inside it
+    //    (including itself), sorted in ascending order.
+    //Found by looking through the doorways between rooms with "ComputeRoomVisibility()",
+    //    which should be called again whenever the rooms change.
+    //Not part of "WriteData()"/"ReadData()"; it's stored by "WriteLevelFile()" instead.
+    std::vector<std::vector<unsigned int>> RoomVisibility;
+
 
     //Gets whether the given area is completely devoid of rooms.
     bool IsAreaFree(Vector2u start, Vector2u end, bool allowRoomEdges) const;
@@ -93,6 +100,17 @@ struct LevelInfo : public ISerializable
     //Calculates room connections.
     void GetConnections(RoomsGraph& outGraph) const;
 
+    //Gets whether "RoomVisibility" has an entry for every room.
+    //Note that it may still be out of date if rooms were moved since it was computed.
+    bool HasRoomVisibility(void) const { return RoomVisibility.size() == Rooms.size(); }
+    //Calculates which rooms may be visible from inside each room, in the same format as "RoomVisibility".
+    //A room is counted as visible from another if a straight line could pass
+    //    through the doorways between them, one after another. Walls inside the rooms are ignored,
+    //    so this may report more rooms than are actually visible, but never fewer.
+    void GetRoomVisibility(std::vector<std::vector<unsigned int>>& outVisibility) const;
+    //Regenerates "RoomVisibility" from the rooms' layouts.
+    void ComputeRoomVisibility(void) { GetRoomVisibility(RoomVisibility); }
+
     //Generates a full level grid with this level's rooms.
     //Uses the given bounds as the level grid's bounds. Assumes they're big enough to fit every room.
     void GenerateFullLevel(Array2D<BlockTypes>& outLevel, UIntBox levelBnds) const;
@@ -101,6 +119,15 @@ struct LevelInfo : public ISerializable
     void GenerateFullLevel(Array2D<BlockTypes>& outLevel) const { GenerateFullLevel(outLevel, GetBounds()); }
 
 
+    //Writes out this level followed by its room visibility.
+    //Room visibility is kept outside of the level's own data structure
+    //    so that level files saved before it existed can still be read.
+    void WriteLevelFile(DataWriter* writer) const;
+    //Reads in a level written by "WriteLevelFile()".
+    //If the file doesn't have room visibility, it's computed instead.
+    //Throws "DataReader::EXCEPTION_FAILURE" if the level itself couldn't be read.
+    void ReadLevelFile(DataReader* reader);
+
     virtual void WriteData(DataWriter* writer) const override;
     virtual void ReadData(DataReader* reader) override;
 };
\ No newline at end of file
@@ -4,24 +4,19 @@
 void RoomCollection::WriteData(DataWriter* writer) const
 {
     writer->WriteCollection(
-                [](DataWriter* writer, const void* toWrite, unsigned int i, void* pData)
+                Rooms,
+                [](DataWriter* writer, const RoomInfo& room, unsigned int i)
                 {
-                    writer->WriteDataStructure(*(const RoomInfo*)toWrite, "Room");
+                    writer->WriteDataStructure(room, "Room");
                 },
-                "Rooms", sizeof(RoomInfo), Rooms.data(), Rooms.size());
+                "Rooms");
 }
 void RoomCollection::ReadData(DataReader* reader)
 {
     reader->ReadCollection(
-                [](DataReader* reader, void* pCollection, unsigned int i, void* pData)
+                Rooms,
+                [](DataReader* reader, RoomInfo& outRoom, unsigned int i)
                 {
-                    auto& coll = *(std::vector<RoomInfo>*)pCollection;
-                    reader->ReadDataStructure(coll[i]);
-                },
-                [](void* pCollection, unsigned int newSize)
-                {
-                    auto& coll = *(std::vector<RoomInfo>*)pCollection;
-                    coll.resize(newSize);
-                },
-                &Rooms);
+                    reader->ReadDataStructure(outRoom);
+                });
 }
\ No newline at end of file
@@ -1,65 +1,283 @@
 #include "BumpmapToNormalmap.h"
 
-void BumpmapToNormalmap::Convert(const Array2D<float>& heightmap, float heightScale,
-                                 bool normalizeRange, Array2D<Vector3f>& normals)
+#include <assert.h>
+#include "../../Threading/ThreadPool.h"
+
+
+//Use SSE to compute four pixels at once if the target supports it.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+    #define BUMPMAP_USE_SSE
+    #include <xmmintrin.h>
+#endif
+
+
+namespace
 {
-    if (normals.GetWidth() != heightmap.GetWidth() ||
-        normals.GetHeight() != heightmap.GetHeight())
+    //Roughly how many pixels each thread grabs at once when splitting up rows.
+    const unsigned int PIXELS_PER_CHUNK = 8192;
+    //Rows are computed in segments of this many pixels, so the results fit in small buffers on the stack.
+    const unsigned int SEGMENT_SIZE = 256;
+
+
+#ifdef BUMPMAP_USE_SSE
+    //Four floats, with the same operators the filters use on a single float.
+    struct Float4
     {
-        normals.Resize(heightmap.GetWidth(), heightmap.GetHeight(), Vector3f());
-    }
+        __m128 V;
+
+        Float4(void) { }
+        Float4(__m128 v) : V(v) { }
+        Float4(float f) : V(_mm_set1_ps(f)) { }
+
+        Float4 operator+(Float4 f) const { return _mm_add_ps(V, f.V); }
+        Float4 operator-(Float4 f) const { return _mm_sub_ps(V, f.V); }
+        Float4 operator*(Float4 f) const { return _mm_mul_ps(V, f.V); }
+        Float4 operator/(Float4 f) const { return _mm_div_ps(V, f.V); }
+    };
+    inline Float4 Sqrt(Float4 f) { return _mm_sqrt_ps(f.V); }
+#endif
+    inline float Sqrt(float f) { return sqrtf(f); }
 
 
-    //Go through every point on the bumpmap and find its normal.
-    Vector3f base, first, second;
-    for (Vector2u loc(0, 0); loc.y < heightmap.GetHeight(); ++loc.y)
+    //The filters, written once for both single floats and "Float4".
+    //Each one takes in the scaled heights around a pixel ("n" is the row before it, "s" is the row after it,
+    //    "w" is the pixel before it, "e" is the pixel after it) and outputs the normalized normal.
+
+    struct TrianglesFilter
     {
-        base.y = (float)loc.y;
+        template<typename Real>
+        //Doesn't use the corners.
+        static void GetNormal(Real, Real n, Real, Real w, Real c, Real e, Real, Real s, Real,
+                              Real& outX, Real& outY, Real& outZ)
+        {
+            //The normal of the triangle made with the previous neighbors is
+            //    "Normalize(w - c, n - c, 1)", and the one made with the next neighbors is
+            //    "Normalize(c - e, c - s, 1)".
+            Real one(1.0f);
+            Real x1 = w - c, y1 = n - c,
+                 x2 = c - e, y2 = c - s;
+            Real invLen1 = one / Sqrt((x1 * x1) + (y1 * y1) + one),
+                 invLen2 = one / Sqrt((x2 * x2) + (y2 * y2) + one);
 
-        for (loc.x = 0; loc.x < heightmap.GetWidth(); ++loc.x)
+            Real x = (x1 * invLen1) + (x2 * invLen2),
+                 y = (y1 * invLen1) + (y2 * invLen2),
+                 z = invLen1 + invLen2;
+            Real invLen = one / Sqrt((x * x) + (y * y) + (z * z));
+            outX = x * invLen;
+            outY = y * invLen;
+            outZ = z * invLen;
+        }
+    };
+    struct CentralDifferenceFilter
+    {
+        template<typename Real>
+        //Doesn't use the corners or the center.
+        static void GetNormal(Real, Real n, Real, Real w, Real, Real e, Real, Real s, Real,
+                              Real& outX, Real& outY, Real& outZ)
+        {
+            Real one(1.0f), half(0.5f);
+            Real x = (w - e) * half,
+                 y = (n - s) * half;
+            Real invLen = one / Sqrt((x * x) + (y * y) + one);
+            outX = x * invLen;
+            outY = y * invLen;
+            outZ = invLen;
+        }
+    };
+    struct SobelFilter
+    {
+        template<typename Real>
+        //Doesn't use the center.
+        static void GetNormal(Real nw, Real n, Real ne, Real w, Real, Real e, Real sw, Real s, Real se,
+                              Real& outX, Real& outY, Real& outZ)
         {
-            base.x = (float)loc.x;
+            Real one(1.0f), two(2.0f), eighth(0.125f);
+            Real x = ((nw + (two * w) + sw) - (ne + (two * e) + se)) * eighth,
+                 y = ((nw + (two * n) + ne) - (sw + (two * s) + se)) * eighth;
+            Real invLen = one / Sqrt((x * x) + (y * y) + one);
+            outX = x * invLen;
+            outY = y * invLen;
+            outZ = invLen;
+        }
+    };
 
-            base.z = heightScale * heightmap[loc];
 
+    template<typename Filter>
+    //Computes the normals for the pixels from "xStart" to "xEnd" in a row of the bumpmap.
+    //"before" and "after" are the rows on either side of it (wrapped around).
+    //The normals are output starting at index 0.
+    void ComputeRowSegment(const float* before, const float* row, const float* after,
+                           unsigned int width, unsigned int xStart, unsigned int xEnd, float heightScale,
+                           float* outX, float* outY, float* outZ)
+    {
+        //Computes a single pixel, wrapping around the bumpmap's edges.
+        auto computePixel = [&](unsigned int x)
+        {
+            unsigned int lessX = (x == 0 ? width - 1 : x - 1),
+                         moreX = (x == width - 1 ? 0 : x + 1);
+            unsigned int i = x - xStart;
+            Filter::GetNormal(heightScale * before[lessX], heightScale * before[x], heightScale * before[moreX],
+                              heightScale * row[lessX], heightScale * row[x], heightScale * row[moreX],
+                              heightScale * after[lessX], heightScale * after[x], heightScale * after[moreX],
+                              outX[i], outY[i], outZ[i]);
+        };
 
-            //Get the two normals that define this point's normal and average them together.
+        unsigned int x = xStart;
 
-            Vector3f sum;
-            Vector2i locI = ToV2i(loc);
+#ifdef BUMPMAP_USE_SSE
+        //Pixels that don't wrap around can be done four at a time.
+        if (x == 0 && x < xEnd)
+        {
+            computePixel(x);
+            x += 1;
+        }
+        Float4 scale(heightScale);
+        for (; x + 4 < width && x + 4 <= xEnd; x += 4)
+        {
+            Float4 nw, n, ne, w, c, e, sw, s, se;
+            nw = scale * Float4(_mm_loadu_ps(before + x - 1));
+            n = scale * Float4(_mm_loadu_ps(before + x));
+            ne = scale * Float4(_mm_loadu_ps(before + x + 1));
+            w = scale * Float4(_mm_loadu_ps(row + x - 1));
+            c = scale * Float4(_mm_loadu_ps(row + x));
+            e = scale * Float4(_mm_loadu_ps(row + x + 1));
+            sw = scale * Float4(_mm_loadu_ps(after + x - 1));
+            s = scale * Float4(_mm_loadu_ps(after + x));
+            se = scale * Float4(_mm_loadu_ps(after + x + 1));
 
-            first = Vector3f(base.x - 1.0f, base.y,
-                             heightScale * heightmap[ToV2u(heightmap.Wrap(locI.LessX()))]);
-            second = Vector3f(base.x, base.y - 1.0f,
-                              heightScale * heightmap[ToV2u(heightmap.Wrap(locI.LessY()))]);
+            Float4 nX, nY, nZ;
+            Filter::GetNormal(nw, n, ne, w, c, e, sw, s, se, nX, nY, nZ);
 
-            Vector3f tempSum = (first - base).Normalized().Cross((second - base).Normalized()).Normalized();
-            if (tempSum.z < 0.0f)
-                tempSum = -tempSum;
+            unsigned int i = x - xStart;
+            _mm_storeu_ps(outX + i, nX.V);
+            _mm_storeu_ps(outY + i, nY.V);
+            _mm_storeu_ps(outZ + i, nZ.V);
+        }
+#endif
 
-            sum += tempSum;
+        for (; x < xEnd; ++x)
+            computePixel(x);
+    }
 
+    typedef void(*RowSegmentFunc)(const float* before, const float* row, const float* after,
+                                  unsigned int width, unsigned int xStart, unsigned int xEnd,
+                                  float heightScale, float* outX, float* outY, float* outZ);
+    RowSegmentFunc GetRowSegmentFunc(BumpmapToNormalmap::Filters filter)
+    {
+        switch (filter)
+        {
+            case BumpmapToNormalmap::F_TRIANGLES:
+                return &ComputeRowSegment<TrianglesFilter>;
+            case BumpmapToNormalmap::F_CENTRAL_DIFFERENCE:
+                return &ComputeRowSegment<CentralDifferenceFilter>;
+            case BumpmapToNormalmap::F_SOBEL:
+                return &ComputeRowSegment<SobelFilter>;
 
-            first = Vector3f(base.x + 1.0f, base.y,
-                             heightScale * heightmap[ToV2u(heightmap.Wrap(locI.MoreX()))]);
-            second = Vector3f(base.x, base.y + 1.0f,
-                              heightScale * heightmap[ToV2u(heightmap.Wrap(locI.MoreY()))]);
+            default:
+                assert(false);
+                return &ComputeRowSegment<TrianglesFilter>;
+        }
+    }
 
-            tempSum = (first - base).Normalized().Cross((second - base).Normalized()).Normalized();
-            if (tempSum.z < 0.0f)
-                tempSum = -tempSum;
 
-            sum += tempSum;
+    template<typename Func>
+    //Computes the normals for the given region of the bumpmap, row by row.
+    //For every segment of a row, calls "output(unsigned int regionY, unsigned int regionX,
+    //    const float* normalXs, const float* normalYs, const float* normalZs, unsigned int count)".
+    void ComputeRegion(const Array2D<float>& heightmap, float heightScale,
+                       Vector2u regionStart, Vector2u regionSize,
+                       BumpmapToNormalmap::Filters filter, ThreadPool* threads, Func output)
+    {
+        unsigned int width = heightmap.GetWidth(),
+                     height = heightmap.GetHeight();
+        assert(regionStart.x + regionSize.x <= width && regionStart.y + regionSize.y <= height);
 
-            sum.Normalize();
+        RowSegmentFunc rowFunc = GetRowSegmentFunc(filter);
+        auto doRow = [&](unsigned int regionY)
+        {
+            unsigned int y = regionStart.y + regionY;
+            const float* row = &heightmap[Vector2u(0, y)];
+            const float* before = &heightmap[Vector2u(0, (y == 0 ? height - 1 : y - 1))];
+            const float* after = &heightmap[Vector2u(0, (y == height - 1 ? 0 : y + 1))];
 
-            //Pack the normal into the range [0, 1] if necessary.
-            if (normalizeRange)
+            float xs[SEGMENT_SIZE], ys[SEGMENT_SIZE], zs[SEGMENT_SIZE];
+            for (unsigned int regionX = 0; regionX < regionSize.x; regionX += SEGMENT_SIZE)
             {
-                sum = (sum * 0.5f) + Vector3f(0.5f, 0.5f, 0.5f);
+                unsigned int count = Mathf::Min(SEGMENT_SIZE, regionSize.x - regionX);
+                unsigned int x = regionStart.x + regionX;
+                rowFunc(before, row, after, width, x, x + count, heightScale, xs, ys, zs);
+                output(regionY, regionX, xs, ys, zs, count);
             }
+        };
+
+        if (threads == 0)
+        {
+            for (unsigned int y = 0; y < regionSize.y; ++y)
+                doRow(y);
+        }
+        else
+        {
+            threads->ParallelFor(regionSize.y, doRow,
+                                 Mathf::Max(1U, PIXELS_PER_CHUNK / Mathf::Max(1U, regionSize.x)));
+        }
+    }
+}
+
+
+void BumpmapToNormalmap::Convert(const Array2D<float>& heightmap, float heightScale,
+                                 bool normalizeRange, Array2D<Vector3f>& normals,
+                                 Filters filter, ThreadPool* threads)
+{
+    if (normals.GetWidth() != heightmap.GetWidth() ||
+        normals.GetHeight() != heightmap.GetHeight())
+    {
+        normals.Reset(heightmap.GetWidth(), heightmap.GetHeight());
+    }
 
-            normals[loc] = sum;
+    float packScale = (normalizeRange ? 0.5f : 1.0f),
+          packOffset = (normalizeRange ? 0.5f : 0.0f);
+    ComputeRegion(heightmap, heightScale, Vector2u(), heightmap.GetDimensions(), filter, threads,
+                  [&normals, packScale, packOffset](unsigned int y, unsigned int x,
+                                                    const float* xs, const float* ys, const float* zs,
+                                                    unsigned int count)
+    {
+        Vector3f* outRow = &normals[Vector2u(x, y)];
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            outRow[i] = Vector3f((xs[i] * packScale) + packOffset,
+                                 (ys[i] * packScale) + packOffset,
+                                 (zs[i] * packScale) + packOffset);
         }
+    });
+}
+void BumpmapToNormalmap::Convert(const Array2D<float>& heightmap, float heightScale,
+                                 Array2D<Vector4b>& outPixels,
+                                 Filters filter, ThreadPool* threads)
+{
+    if (outPixels.GetWidth() != heightmap.GetWidth() ||
+        outPixels.GetHeight() != heightmap.GetHeight())
+    {
+        outPixels.Reset(heightmap.GetWidth(), heightmap.GetHeight());
     }
-}
\ No newline at end of file
+
+    ConvertRegion(heightmap, heightScale, Vector2u(), outPixels, filter, threads);
+}
+void BumpmapToNormalmap::ConvertRegion(const Array2D<float>& heightmap, float heightScale,
+                                       Vector2u regionStart, Array2D<Vector4b>& outPixels,
+                                       Filters filter, ThreadPool* threads)
+{
+    ComputeRegion(heightmap, heightScale, regionStart, outPixels.GetDimensions(), filter, threads,
+                  [&outPixels](unsigned int y, unsigned int x,
+                               const float* xs, const float* ys, const float* zs,
+                               unsigned int count)
+    {
+        Vector4b* outRow = &outPixels[Vector2u(x, y)];
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            outRow[i] = Vector4b((xs[i] * 0.5f) + 0.5f,
+                                 (ys[i] * 0.5f) + 0.5f,
+                                 (zs[i] * 0.5f) + 0.5f,
+                                 1.0f);
+        }
+    });
+}
@@ -2,14 +2,72 @@
 
 #include "../../Math/LowerMath.hpp"
 
-//Calculates a normal map for the given bumpmap.
+class ThreadPool;
+
+
+//Calculates a normal map for the given bumpmap. The bumpmap wraps around at its edges.
+//Rows are computed four pixels at a time with SSE if the target supports it,
+//    and they're split across a thread pool if one is given.
 class BumpmapToNormalmap
 {
 public:
-    
+
+    //The different ways to compute a normal from the heights around it.
+    enum Filters
+    {
+        //Averages the normals of the triangles made with the neighbors before and after it.
+        F_TRIANGLES,
+        //Uses the slope between the neighbors on either side.
+        F_CENTRAL_DIFFERENCE,
+        //Uses a 3x3 Sobel filter, which smooths out small bumps.
+        F_SOBEL,
+    };
+
+
     //If "normalizeRange" is true, each normal's X, Y, and Z values will be remapped
     //    from [-1, 1] to [0, 1] for packing into a texture.
     //Resizes "outNormals" if they aren't the same size as "heightmap" already.
     static void Convert(const Array2D<float>& heightmap, float heightScale,
-                        bool normalizeRange, Array2D<Vector3f>& outNormals);
-};
\ No newline at end of file
+                        bool normalizeRange, Array2D<Vector3f>& outNormals,
+                        Filters filter = F_TRIANGLES, ThreadPool* threads = 0);
+    //Outputs the normals packed into texture colors (remapped to [0, 1], with an alpha of 1),
+    //    ready to be passed into "MTexture2D::SetColorData()".
+    //Resizes "outPixels" if they aren't the same size as "heightmap" already.
+    static void Convert(const Array2D<float>& heightmap, float heightScale,
+                        Array2D<Vector4b>& outPixels,
+                        Filters filter = F_TRIANGLES, ThreadPool* threads = 0);
+
+    //Outputs packed normals (like the above function) for the part of the bumpmap
+    //    starting at "regionStart" that's the same size as "outPixels".
+    static void ConvertRegion(const Array2D<float>& heightmap, float heightScale,
+                              Vector2u regionStart, Array2D<Vector4b>& outPixels,
+                              Filters filter = F_TRIANGLES, ThreadPool* threads = 0);
+
+
+    //The default width/height of the tiles in "ConvertTiled()".
+    static const unsigned int DEFAULT_TILE_SIZE = 512;
+
+    //A function with signature "void OnTile(Vector2u tileStart, const Array2D<Vector4b>& tilePixels)".
+    template<typename TileFunc>
+    //Computes packed normals one tile at a time, for bumpmaps too big to hold all the normals at once.
+    //Calls "onTile" on this thread with each finished tile (e.x. to pass into "MTexture2D::UpdateColorData()").
+    //Tiles along the right and bottom edges may be smaller than the tile size.
+    static void ConvertTiled(const Array2D<float>& heightmap, float heightScale, TileFunc onTile,
+                             unsigned int tileSize = DEFAULT_TILE_SIZE,
+                             Filters filter = F_TRIANGLES, ThreadPool* threads = 0)
+    {
+        Array2D<Vector4b> tile(tileSize, tileSize);
+        for (Vector2u start(0, 0); start.y < heightmap.GetHeight(); start.y += tileSize)
+        {
+            for (start.x = 0; start.x < heightmap.GetWidth(); start.x += tileSize)
+            {
+                Vector2u end(Mathf::Min(start.x + tileSize, heightmap.GetWidth()),
+                             Mathf::Min(start.y + tileSize, heightmap.GetHeight()));
+                tile.Reset(end.x - start.x, end.y - start.y);
+
+                ConvertRegion(heightmap, heightScale, start, tile, filter, threads);
+                onTile(start, (const Array2D<Vector4b>&)tile);
+            }
+        }
+    }
+};
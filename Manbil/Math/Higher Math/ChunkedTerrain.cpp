@@ -0,0 +1,318 @@
+#include "ChunkedTerrain.h"
+
+#include <assert.h>
+
+
+unsigned int ChunkedTerrain::GetNVerticesPerSide(unsigned int chunkSize, unsigned int lod)
+{
+    return (chunkSize >> lod) + 1;
+}
+
+
+ChunkedTerrain::ChunkedTerrain(const Generator2D& _heightGenerator, ThreadPool& _workers,
+                               unsigned int _chunkSize, unsigned int _nLODs,
+                               unsigned int cacheBudgetBytes)
+    : heightGenerator(_heightGenerator), workers(_workers),
+      chunkSize(_chunkSize), nLODs(_nLODs), nextVersion(0), nBuilding(0),
+      cacheSize(0), cacheBudget(cacheBudgetBytes)
+{
+    assert(heightGenerator.CanSample());
+    assert(chunkSize > 0 && (chunkSize & (chunkSize - 1)) == 0);
+    assert(nLODs > 0 && (1U << (nLODs - 1)) <= chunkSize);
+}
+ChunkedTerrain::~ChunkedTerrain(void)
+{
+    //The mesh jobs reference this instance, so wait for them to finish.
+    std::unique_lock<std::mutex> lock(buildLock);
+    buildFinished.wait(lock, [this]() { return nBuilding == 0; });
+}
+
+Vector2i ChunkedTerrain::GetChunk(Vector2f worldPos) const
+{
+    return Vector2i((int)floorf(worldPos.x / (float)chunkSize),
+                    (int)floorf(worldPos.y / (float)chunkSize));
+}
+unsigned int ChunkedTerrain::GetDesiredLOD(Vector2i chunk, Vector2f viewerPos) const
+{
+    Vector2f chunkCenter(((float)chunk.x + 0.5f) * (float)chunkSize,
+                         ((float)chunk.y + 0.5f) * (float)chunkSize);
+    float lod = floorf(chunkCenter.Distance(viewerPos) / LODDistance);
+    return (unsigned int)Mathf::Clamp(lod, 0.0f, (float)(nLODs - 1));
+}
+
+void ChunkedTerrain::Update(Vector2f viewerPos)
+{
+    //Find the chunks that should be loaded, and the LOD each one should use.
+    std::unordered_map<Vector2i, unsigned int, Vector2i> desiredLODs;
+    Vector2i centerChunk = GetChunk(viewerPos);
+    int radius = (int)ceilf(ViewDistance / (float)chunkSize);
+    Vector2i chunk;
+    for (chunk.y = centerChunk.y - radius; chunk.y <= centerChunk.y + radius; ++chunk.y)
+    {
+        for (chunk.x = centerChunk.x - radius; chunk.x <= centerChunk.x + radius; ++chunk.x)
+        {
+            Vector2f chunkCenter(((float)chunk.x + 0.5f) * (float)chunkSize,
+                                 ((float)chunk.y + 0.5f) * (float)chunkSize);
+            if (chunkCenter.Distance(viewerPos) <= ViewDistance)
+                desiredLODs[chunk] = GetDesiredLOD(chunk, viewerPos);
+        }
+    }
+
+    //Unload the chunks that are out of range.
+    for (auto it = loadedChunks.begin(); it != loadedChunks.end();)
+    {
+        if (desiredLODs.find(it->first) == desiredLODs.end())
+        {
+            unloadedChunks.push_back(it->first);
+            it = loadedChunks.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    //Start building meshes for any chunks that are new or whose LOD changed.
+    //A chunk's mesh also depends on its neighbors' LODs, since its edges are snapped to theirs.
+    const Vector2i neighborOffsets[E_COUNT] = { Vector2i(-1, 0), Vector2i(1, 0),
+                                                Vector2i(0, -1), Vector2i(0, 1) };
+    for (auto it = desiredLODs.begin(); it != desiredLODs.end(); ++it)
+    {
+        ChunkMesh meshInfo;
+        meshInfo.Chunk = it->first;
+        meshInfo.LOD = it->second;
+        for (unsigned int edge = 0; edge < E_COUNT; ++edge)
+        {
+            auto neighbor = desiredLODs.find(it->first + neighborOffsets[edge]);
+            meshInfo.NeighborLODs[edge] = (neighbor == desiredLODs.end() ?
+                                               meshInfo.LOD :
+                                               neighbor->second);
+        }
+
+        auto loaded = loadedChunks.find(it->first);
+        if (loaded != loadedChunks.end() &&
+            loaded->second.LOD == meshInfo.LOD &&
+            std::equal(meshInfo.NeighborLODs, meshInfo.NeighborLODs + E_COUNT,
+                       loaded->second.NeighborLODs))
+        {
+            continue;
+        }
+
+        //If the chunk was unloaded and came back before anybody noticed, it doesn't need to be unloaded.
+        if (loaded == loadedChunks.end())
+        {
+            auto unloaded = std::find(unloadedChunks.begin(), unloadedChunks.end(), it->first);
+            if (unloaded != unloadedChunks.end())
+                unloadedChunks.erase(unloaded);
+        }
+
+        LoadedChunk& chunkData = loadedChunks[it->first];
+        chunkData.LOD = meshInfo.LOD;
+        std::copy(meshInfo.NeighborLODs, meshInfo.NeighborLODs + E_COUNT, chunkData.NeighborLODs);
+        chunkData.Version = nextVersion;
+        nextVersion += 1;
+
+        {
+            std::lock_guard<std::mutex> lock(buildLock);
+            nBuilding += 1;
+        }
+        unsigned int version = chunkData.Version;
+        float heightScale = HeightScale;
+        workers.AddJob([this, meshInfo, version, heightScale]()
+        {
+            BuiltMesh built;
+            built.Version = version;
+            built.Mesh = meshInfo;
+            BuildMesh(built.Mesh, heightScale);
+
+            std::lock_guard<std::mutex> lock(buildLock);
+            builtMeshes.push_back(std::move(built));
+            nBuilding -= 1;
+            buildFinished.notify_all();
+        });
+    }
+}
+
+void ChunkedTerrain::TakeFinishedMeshes(std::vector<ChunkMesh>& outMeshes)
+{
+    std::vector<BuiltMesh> finished;
+    {
+        std::lock_guard<std::mutex> lock(buildLock);
+        finished.swap(builtMeshes);
+    }
+
+    for (unsigned int i = 0; i < finished.size(); ++i)
+    {
+        auto loaded = loadedChunks.find(finished[i].Mesh.Chunk);
+        if (loaded != loadedChunks.end() && loaded->second.Version == finished[i].Version)
+            outMeshes.push_back(std::move(finished[i].Mesh));
+    }
+}
+void ChunkedTerrain::TakeUnloadedChunks(std::vector<Vector2i>& outChunks)
+{
+    outChunks.insert(outChunks.end(), unloadedChunks.begin(), unloadedChunks.end());
+    unloadedChunks.clear();
+}
+
+bool ChunkedTerrain::IsBuilding(void) const
+{
+    std::lock_guard<std::mutex> lock(buildLock);
+    return nBuilding > 0;
+}
+
+
+std::shared_ptr<const Array2D<float>> ChunkedTerrain::GetHeightmap(Vector2i chunk)
+{
+    {
+        std::lock_guard<std::mutex> lock(cacheLock);
+        auto found = cache.find(chunk);
+        if (found != cache.end())
+        {
+            cacheLRU.splice(cacheLRU.begin(), cacheLRU, found->second.LRUPos);
+            return found->second.Heights;
+        }
+    }
+
+    //Generate the heightmap without holding the lock so other threads can use the cache.
+    //Neighboring chunks sample the same positions along their shared edge,
+    //    so their heightmaps line up exactly.
+    unsigned int size = chunkSize + 3;
+    std::shared_ptr<Array2D<float>> heights(new Array2D<float>(size, size));
+    heightGenerator.SampleGrid(*heights,
+                               Vector2f((float)(chunk.x * (int)chunkSize) - 1.0f,
+                                        (float)(chunk.y * (int)chunkSize) - 1.0f),
+                               Vector2f(1.0f, 1.0f));
+
+    std::lock_guard<std::mutex> lock(cacheLock);
+
+    //Another thread may have generated the same heightmap in the meantime.
+    auto found = cache.find(chunk);
+    if (found != cache.end())
+    {
+        cacheLRU.splice(cacheLRU.begin(), cacheLRU, found->second.LRUPos);
+        return found->second.Heights;
+    }
+
+    cacheLRU.push_front(chunk);
+    CachedHeightmap& cached = cache[chunk];
+    cached.Heights = heights;
+    cached.LRUPos = cacheLRU.begin();
+    cacheSize += size * size * sizeof(float);
+    TrimCache();
+
+    return heights;
+}
+void ChunkedTerrain::SetCacheBudget(unsigned int newBudgetBytes)
+{
+    std::lock_guard<std::mutex> lock(cacheLock);
+    cacheBudget = newBudgetBytes;
+    TrimCache();
+}
+unsigned int ChunkedTerrain::GetCacheSize(void) const
+{
+    std::lock_guard<std::mutex> lock(cacheLock);
+    return cacheSize;
+}
+void ChunkedTerrain::TrimCache(void)
+{
+    //Always keep the most-recently-used heightmap, even if it alone is over budget.
+    //Meshes that are still being built hold onto their heightmap, so it's safe to drop it here.
+    unsigned int heightmapBytes = (chunkSize + 3) * (chunkSize + 3) * sizeof(float);
+    while (cacheSize > cacheBudget && cacheLRU.size() > 1)
+    {
+        cache.erase(cacheLRU.back());
+        cacheLRU.pop_back();
+        cacheSize -= heightmapBytes;
+    }
+}
+
+
+void ChunkedTerrain::BuildMesh(ChunkMesh& outMesh, float heightScale)
+{
+    std::shared_ptr<const Array2D<float>> heights = GetHeightmap(outMesh.Chunk);
+    const Array2D<float>& heightmap = *heights;
+
+    unsigned int step = 1U << outMesh.LOD;
+    unsigned int nVerts = GetNVerticesPerSide(chunkSize, outMesh.LOD);
+    int lastVal = (int)chunkSize;
+
+    //Gets the height at the given position in the chunk, at full detail.
+    //The heightmap has a one-value border, so positions from -1 to chunkSize + 1 are valid.
+    auto getHeight = [&heightmap, heightScale](int x, int y)
+    {
+        return heightScale * heightmap[Vector2u((unsigned int)(x + 1), (unsigned int)(y + 1))];
+    };
+    //Gets the height at the given position along an edge whose neighbor uses the given LOD.
+    //If the neighbor has less detail, the height is interpolated between its vertices.
+    auto getEdgeHeight = [&getHeight](int x, int y, int alongEdge, bool edgeIsAlongY,
+                                      unsigned int neighborLOD)
+    {
+        int neighborStep = 1 << neighborLOD;
+        int before = (alongEdge / neighborStep) * neighborStep;
+        if (before == alongEdge)
+            return getHeight(x, y);
+
+        float t = (float)(alongEdge - before) / (float)neighborStep;
+        return (edgeIsAlongY ?
+                    Mathf::Lerp(getHeight(x, before), getHeight(x, before + neighborStep), t) :
+                    Mathf::Lerp(getHeight(before, y), getHeight(before + neighborStep, y), t));
+    };
+
+    Vector2f worldOffset((float)(outMesh.Chunk.x * (int)chunkSize),
+                         (float)(outMesh.Chunk.y * (int)chunkSize));
+    float invChunkSize = 1.0f / (float)chunkSize;
+
+    outMesh.Vertices.resize(nVerts * nVerts);
+    unsigned int vertIndex = 0;
+    for (unsigned int yI = 0; yI < nVerts; ++yI)
+    {
+        int y = (int)(yI * step);
+        for (unsigned int xI = 0; xI < nVerts; ++xI)
+        {
+            int x = (int)(xI * step);
+
+            //Snap the edges to any lower-detail neighbors.
+            float height;
+            if (x == 0 && outMesh.NeighborLODs[E_LESS_X] > outMesh.LOD)
+                height = getEdgeHeight(x, y, y, true, outMesh.NeighborLODs[E_LESS_X]);
+            else if (x == lastVal && outMesh.NeighborLODs[E_MORE_X] > outMesh.LOD)
+                height = getEdgeHeight(x, y, y, true, outMesh.NeighborLODs[E_MORE_X]);
+            else if (y == 0 && outMesh.NeighborLODs[E_LESS_Y] > outMesh.LOD)
+                height = getEdgeHeight(x, y, x, false, outMesh.NeighborLODs[E_LESS_Y]);
+            else if (y == lastVal && outMesh.NeighborLODs[E_MORE_Y] > outMesh.LOD)
+                height = getEdgeHeight(x, y, x, false, outMesh.NeighborLODs[E_MORE_Y]);
+            else
+                height = getHeight(x, y);
+
+            Vertex& vert = outMesh.Vertices[vertIndex];
+            vert.Pos = Vector3f(worldOffset.x + (float)x, worldOffset.y + (float)y, height);
+            vert.UV = Vector2f((float)x * invChunkSize, (float)y * invChunkSize);
+
+            //Normals always come from the full-detail heightmap,
+            //    so they match across chunks no matter what LOD each chunk is at.
+            vert.Normal = Vector3f(getHeight(x - 1, y) - getHeight(x + 1, y),
+                                   getHeight(x, y - 1) - getHeight(x, y + 1),
+                                   2.0f).Normalized();
+
+            vertIndex += 1;
+        }
+    }
+
+    //Use the same triangle layout as "Terrain".
+    outMesh.Indices.reserve(6 * (nVerts - 1) * (nVerts - 1));
+    for (unsigned int yI = 1; yI < nVerts; ++yI)
+    {
+        for (unsigned int xI = 1; xI < nVerts; ++xI)
+        {
+            vertIndex = xI + (yI * nVerts);
+
+            outMesh.Indices.push_back(vertIndex);
+            outMesh.Indices.push_back(vertIndex - 1 - nVerts);
+            outMesh.Indices.push_back(vertIndex - 1);
+
+            outMesh.Indices.push_back(vertIndex);
+            outMesh.Indices.push_back(vertIndex - nVerts);
+            outMesh.Indices.push_back(vertIndex - 1 - nVerts);
+        }
+    }
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <list>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include "../Noise Generation/BasicGenerators.h"
+#include "../../Threading/ThreadPool.h"
+
+
+//A terrain too large to keep in memory, split into square chunks that are generated on demand.
+//Each chunk's heightmap is sampled from a noise generator and kept in an LRU cache with a memory budget.
+//Chunk meshes are built on worker threads at a level of detail based on their distance from the viewer.
+//Where a chunk borders a lower-detail chunk, the vertices along that edge are snapped onto
+//    the neighbor's coarser edge so that there are no cracks between them.
+//Like "Terrain", X and Y are the ground plane and Z is the height.
+class ChunkedTerrain
+{
+public:
+
+    struct Vertex
+    {
+        Vector3f Pos;
+        //One texture repeat per chunk.
+        Vector2f UV;
+        Vector3f Normal;
+    };
+
+    //The sides of a chunk, used to index its neighbors.
+    enum Edges
+    {
+        E_LESS_X = 0,
+        E_MORE_X,
+        E_LESS_Y,
+        E_MORE_Y,
+
+        E_COUNT,
+    };
+
+    //A finished chunk mesh, ready to be uploaded to the GPU.
+    struct ChunkMesh
+    {
+        Vector2i Chunk;
+        //0 = full detail, 1 = every other heightmap value, 2 = every fourth value, etc.
+        unsigned int LOD;
+        //The LOD of each neighboring chunk when this mesh was built, indexed by the "Edges" enum.
+        unsigned int NeighborLODs[E_COUNT];
+
+        std::vector<Vertex> Vertices;
+        //Every three indices make a triangle.
+        std::vector<unsigned int> Indices;
+    };
+
+
+    //Gets the number of vertices along each side of a chunk mesh at the given LOD.
+    static unsigned int GetNVerticesPerSide(unsigned int chunkSize, unsigned int lod);
+
+
+    //The generator must support "Sample()", and it must outlive this terrain.
+    //"chunkSize" is the number of heightmap cells along each side of a chunk; it must be a power of two.
+    //"nLODs" is the number of levels of detail; the lowest one must still fit in a chunk.
+    ChunkedTerrain(const Generator2D& heightGenerator, ThreadPool& workers,
+                   unsigned int chunkSize = 64, unsigned int nLODs = 4,
+                   unsigned int cacheBudgetBytes = 32 * 1024 * 1024);
+    //Waits for any meshes that are still being built.
+    ~ChunkedTerrain(void);
+
+
+    //The scale for the terrain's height. Changing it only affects meshes built afterwards.
+    float HeightScale = 1.0f;
+    //Chunks whose centers are within this distance of the viewer are kept loaded.
+    float ViewDistance = 512.0f;
+    //The distance from the viewer covered by each level of detail.
+    float LODDistance = 128.0f;
+
+
+    unsigned int GetChunkSize(void) const { return chunkSize; }
+    unsigned int GetNLODs(void) const { return nLODs; }
+
+    //Gets the chunk containing the given position.
+    Vector2i GetChunk(Vector2f worldPos) const;
+
+
+    //Figures out which chunks should be loaded around the given position and at which LODs,
+    //    then starts building the meshes that changed on the worker threads.
+    //Should be called from the same thread as "TakeFinishedMeshes()".
+    void Update(Vector2f viewerPos);
+
+    //Outputs every chunk mesh that finished building since the last call,
+    //    skipping any that were replaced by a newer mesh or unloaded in the meantime.
+    //Each one replaces any mesh already output for the same chunk.
+    void TakeFinishedMeshes(std::vector<ChunkMesh>& outMeshes);
+    //Outputs every chunk that was unloaded since the last call.
+    //Any meshes output for them should be thrown out.
+    void TakeUnloadedChunks(std::vector<Vector2i>& outChunks);
+
+    //Gets whether any chunk meshes are still being built.
+    bool IsBuilding(void) const;
+
+
+    //Gets the heightmap for the given chunk, generating it if it isn't already cached.
+    //The heightmap has a one-value border around the chunk's own (chunkSize + 1)^2 values,
+    //    so that normals can be calculated at the chunk's edges.
+    //Can be called from any thread.
+    std::shared_ptr<const Array2D<float>> GetHeightmap(Vector2i chunk);
+
+    unsigned int GetCacheBudget(void) const { return cacheBudget; }
+    //Changes the cache's memory budget, throwing out heightmaps if it's now over budget.
+    void SetCacheBudget(unsigned int newBudgetBytes);
+    //Gets how much memory the cached heightmaps are using.
+    unsigned int GetCacheSize(void) const;
+
+
+private:
+
+    //A chunk that's currently loaded.
+    struct LoadedChunk
+    {
+        unsigned int LOD;
+        unsigned int NeighborLODs[E_COUNT];
+        //The version of the most recently requested mesh.
+        unsigned int Version;
+    };
+    //A mesh built on a worker thread, along with the chunk version it was built for.
+    struct BuiltMesh
+    {
+        unsigned int Version;
+        ChunkMesh Mesh;
+    };
+    //A cached heightmap, along with its place in the least-recently-used list.
+    struct CachedHeightmap
+    {
+        std::shared_ptr<const Array2D<float>> Heights;
+        std::list<Vector2i>::iterator LRUPos;
+    };
+
+
+    const Generator2D& heightGenerator;
+    ThreadPool& workers;
+    unsigned int chunkSize, nLODs;
+
+    //Only touched by the thread calling "Update()".
+    std::unordered_map<Vector2i, LoadedChunk, Vector2i> loadedChunks;
+    std::vector<Vector2i> unloadedChunks;
+    //Every mesh request gets a new version, so that meshes from older requests
+    //    (even for a chunk that was since unloaded and loaded again) can be thrown out.
+    unsigned int nextVersion;
+
+    //Results from the worker threads.
+    std::vector<BuiltMesh> builtMeshes;
+    unsigned int nBuilding;
+    mutable std::mutex buildLock;
+    std::condition_variable buildFinished;
+
+    //The heightmap cache. The front of the list is the most-recently-used heightmap.
+    std::unordered_map<Vector2i, CachedHeightmap, Vector2i> cache;
+    std::list<Vector2i> cacheLRU;
+    unsigned int cacheSize, cacheBudget;
+    mutable std::mutex cacheLock;
+
+
+    ChunkedTerrain(const ChunkedTerrain& cpy) = delete;
+    ChunkedTerrain& operator=(const ChunkedTerrain& cpy) = delete;
+
+    //Gets the LOD that a chunk should use when the viewer is at the given position.
+    unsigned int GetDesiredLOD(Vector2i chunk, Vector2f viewerPos) const;
+
+    //Throws out the least-recently-used heightmaps until the cache is within its budget.
+    //The cache must already be locked.
+    void TrimCache(void);
+
+    //Builds the mesh for the given chunk. Runs on a worker thread.
+    void BuildMesh(ChunkMesh& outMesh, float heightScale);
+};
@@ -0,0 +1,217 @@
+#include "Geometryf.h"
+
+
+//Use SSE to work on four triangles/vertices at once if the target supports it.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+    #define GEOMETRYF_USE_SSE
+    #include <xmmintrin.h>
+#endif
+
+
+namespace
+{
+    //How many triangles/vertices each thread grabs at once.
+    const unsigned int ELEMENTS_PER_CHUNK = 4096;
+
+
+    //Splits up the range [0, count) into chunks and calls "func(start, end)" on each one,
+    //    across the given threads if they exist.
+    template<typename Func>
+    void ForEachChunk(unsigned int count, ThreadPool* threads, Func func)
+    {
+        if (threads == 0)
+        {
+            func(0U, count);
+        }
+        else
+        {
+            unsigned int nChunks = (count + ELEMENTS_PER_CHUNK - 1) / ELEMENTS_PER_CHUNK;
+            threads->ParallelFor(nChunks, [&](unsigned int chunk)
+            {
+                unsigned int start = chunk * ELEMENTS_PER_CHUNK;
+                func(start, Mathf::Min(count, start + ELEMENTS_PER_CHUNK));
+            });
+        }
+    }
+
+    //Computes the cross product of the edges of each triangle from "start" to "end",
+    //    which is the triangle's normal scaled by twice its area.
+    void GetTriangleNormals(const float* posX, const float* posY, const float* posZ,
+                            const unsigned int* indices, unsigned int start, unsigned int end,
+                            float* outX, float* outY, float* outZ)
+    {
+        unsigned int tri = start;
+
+#ifdef GEOMETRYF_USE_SSE
+        //Gather the positions of four triangles' vertices into SSE registers.
+        for (; tri + 4 <= end; tri += 4)
+        {
+            const unsigned int* i = &indices[tri * 3];
+            #define GATHER(component, vert) \
+                _mm_setr_ps(component[i[vert]], component[i[3 + vert]], \
+                            component[i[6 + vert]], component[i[9 + vert]])
+
+            __m128 x1 = GATHER(posX, 0), y1 = GATHER(posY, 0), z1 = GATHER(posZ, 0);
+            __m128 e1X = _mm_sub_ps(GATHER(posX, 1), x1),
+                   e1Y = _mm_sub_ps(GATHER(posY, 1), y1),
+                   e1Z = _mm_sub_ps(GATHER(posZ, 1), z1),
+                   e2X = _mm_sub_ps(GATHER(posX, 2), x1),
+                   e2Y = _mm_sub_ps(GATHER(posY, 2), y1),
+                   e2Z = _mm_sub_ps(GATHER(posZ, 2), z1);
+
+            #undef GATHER
+
+            _mm_storeu_ps(&outX[tri], _mm_sub_ps(_mm_mul_ps(e1Y, e2Z), _mm_mul_ps(e1Z, e2Y)));
+            _mm_storeu_ps(&outY[tri], _mm_sub_ps(_mm_mul_ps(e1Z, e2X), _mm_mul_ps(e1X, e2Z)));
+            _mm_storeu_ps(&outZ[tri], _mm_sub_ps(_mm_mul_ps(e1X, e2Y), _mm_mul_ps(e1Y, e2X)));
+        }
+#endif
+
+        for (; tri < end; ++tri)
+        {
+            const unsigned int* i = &indices[tri * 3];
+            Vector3f p1(posX[i[0]], posY[i[0]], posZ[i[0]]);
+            Vector3f norm = (Vector3f(posX[i[1]], posY[i[1]], posZ[i[1]]) - p1).Cross(
+                                Vector3f(posX[i[2]], posY[i[2]], posZ[i[2]]) - p1);
+            outX[tri] = norm.x;
+            outY[tri] = norm.y;
+            outZ[tri] = norm.z;
+        }
+    }
+
+    //Normalizes each vector from "start" to "end", leaving vectors of length 0 alone.
+    void NormalizeAll(float* x, float* y, float* z, unsigned int start, unsigned int end)
+    {
+        unsigned int i = start;
+
+#ifdef GEOMETRYF_USE_SSE
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 vX = _mm_loadu_ps(&x[i]),
+                   vY = _mm_loadu_ps(&y[i]),
+                   vZ = _mm_loadu_ps(&z[i]);
+            __m128 lenSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vX, vX), _mm_mul_ps(vY, vY)),
+                                       _mm_mul_ps(vZ, vZ));
+
+            //Zero-length vectors are divided by 1 instead.
+            __m128 isZero = _mm_cmpeq_ps(lenSqr, _mm_setzero_ps());
+            __m128 len = _mm_or_ps(_mm_andnot_ps(isZero, _mm_sqrt_ps(lenSqr)),
+                                   _mm_and_ps(isZero, _mm_set1_ps(1.0f)));
+
+            _mm_storeu_ps(&x[i], _mm_div_ps(vX, len));
+            _mm_storeu_ps(&y[i], _mm_div_ps(vY, len));
+            _mm_storeu_ps(&z[i], _mm_div_ps(vZ, len));
+        }
+#endif
+
+        for (; i < end; ++i)
+        {
+            float lenSqr = (x[i] * x[i]) + (y[i] * y[i]) + (z[i] * z[i]);
+            if (lenSqr > 0.0f)
+            {
+                float len = sqrtf(lenSqr);
+                x[i] /= len;
+                y[i] /= len;
+                z[i] /= len;
+            }
+        }
+    }
+}
+
+
+void Geometryf::VertexTriangles::Build(unsigned int nVertices, const unsigned int* indices,
+                                       unsigned int nIndices)
+{
+    unsigned int nTriangles = nIndices / 3;
+
+    //Count the triangles using each vertex, then turn the counts into starting offsets.
+    Starts.assign(nVertices + 1, 0);
+    for (unsigned int i = 0; i < nTriangles * 3; ++i)
+    {
+        assert(indices[i] < nVertices);
+        Starts[indices[i] + 1] += 1;
+    }
+    for (unsigned int vert = 0; vert < nVertices; ++vert)
+        Starts[vert + 1] += Starts[vert];
+
+    //Fill in each vertex's triangles, using a copy of the offsets as the next free spot for each vertex.
+    Triangles.resize(nTriangles * 3);
+    std::vector<unsigned int> nextSpot(Starts.begin(), Starts.end() - 1);
+    for (unsigned int i = 0; i < nTriangles * 3; ++i)
+    {
+        Triangles[nextSpot[indices[i]]] = i / 3;
+        nextSpot[indices[i]] += 1;
+    }
+}
+
+void Geometryf::CalculateNormals(const float* posX, const float* posY, const float* posZ,
+                                 float* outNormX, float* outNormY, float* outNormZ, unsigned int nVertices,
+                                 const unsigned int* indices, unsigned int nIndices,
+                                 ThreadPool* threads, const VertexTriangles* adjacency)
+{
+    unsigned int nTriangles = nIndices / 3;
+    if (nTriangles == 0)
+    {
+        for (unsigned int vert = 0; vert < nVertices; ++vert)
+            outNormX[vert] = outNormY[vert] = outNormZ[vert] = 0.0f;
+        return;
+    }
+
+    //Compute the triangle normals.
+    std::vector<float> triNormals(nTriangles * 3);
+    float *triX = &triNormals[0],
+          *triY = triX + nTriangles,
+          *triZ = triY + nTriangles;
+    ForEachChunk(nTriangles, threads, [&](unsigned int start, unsigned int end)
+    {
+        GetTriangleNormals(posX, posY, posZ, indices, start, end, triX, triY, triZ);
+    });
+
+    //Without threads or a pre-built adjacency, it's fastest to just add each triangle's normal
+    //    onto its vertices.
+    if (threads == 0 && adjacency == 0)
+    {
+        for (unsigned int vert = 0; vert < nVertices; ++vert)
+            outNormX[vert] = outNormY[vert] = outNormZ[vert] = 0.0f;
+        for (unsigned int tri = 0; tri < nTriangles; ++tri)
+        {
+            for (unsigned int i = tri * 3; i < (tri * 3) + 3; ++i)
+            {
+                outNormX[indices[i]] += triX[tri];
+                outNormY[indices[i]] += triY[tri];
+                outNormZ[indices[i]] += triZ[tri];
+            }
+        }
+        NormalizeAll(outNormX, outNormY, outNormZ, 0, nVertices);
+        return;
+    }
+
+    //Otherwise, have each vertex gather its triangles' normals.
+    VertexTriangles tempAdjacency;
+    if (adjacency == 0)
+    {
+        tempAdjacency.Build(nVertices, indices, nIndices);
+        adjacency = &tempAdjacency;
+    }
+    assert(adjacency->GetNVertices() == nVertices);
+
+    ForEachChunk(nVertices, threads, [&](unsigned int start, unsigned int end)
+    {
+        const unsigned int *starts = &adjacency->Starts[0],
+                           *tris = (adjacency->Triangles.empty() ? 0 : &adjacency->Triangles[0]);
+        for (unsigned int vert = start; vert < end; ++vert)
+        {
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            for (unsigned int i = starts[vert]; i < starts[vert + 1]; ++i)
+            {
+                x += triX[tris[i]];
+                y += triY[tris[i]];
+                z += triZ[tris[i]];
+            }
+            outNormX[vert] = x;
+            outNormY[vert] = y;
+            outNormZ[vert] = z;
+        }
+        NormalizeAll(outNormX, outNormY, outNormZ, start, end);
+    });
+}
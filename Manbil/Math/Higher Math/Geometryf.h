@@ -1,6 +1,9 @@
 #pragma once
 
+#include <vector>
+#include <assert.h>
 #include "../Lower Math/Vectors.h"
+#include "../../Threading/ThreadPool.h"
 
 
 //TODO: Move into Lower Math system.
@@ -148,7 +151,8 @@ public:
 			   l1ToL2 = l2 - l1;
         float ab2 = l1ToL2.Dot(l1ToL2),
               ap_ab = l1ToSeparatePoint.Dot(l1ToL2),
-			  t = ap_ab / ab2;
+              //If the "line" is just a point, that point is the closest one.
+			  t = (ab2 > 0.0f ? (ap_ab / ab2) : 0.0f);
 		if (!isLineInfinite)
 		{
             if (t < 0.0f)
@@ -183,24 +187,11 @@ public:
                                                        Vector secondLine_1, Vector secondLine_2,
                                                        bool areLinesInfinite)
 	{
-		//TODO: Verify.
-
-		//Googled this algorithm. Only vaguely remember the reasoning behind it,
-        //    but it just uses some basic vector math.
-
 		Vector p0 = firstLine_1,
                q0 = secondLine_1,
 			   u = firstLine_2 - firstLine_1,
 			   v = secondLine_2 - secondLine_1;
 
-		//If the lines are parallel, their distance is constant.
-        //Just use the midpoints of the given lines.
-        if (u == v || u == -v)
-        {
-            return ClosestValues<Vector>((p0 + firstLine_2) * 0.5f,
-                                         (q0 + secondLine_2) * 0.5f);
-        }
-
 		Vector w0 = p0 - q0;
 		float a = u.Dot(u),
 			  b = u.Dot(v),
@@ -209,14 +200,27 @@ public:
 			  e = v.Dot(w0);
 
 		float denominator = (a * c) - (b * b);
-		float sc = ((b * e) - (c * d)) / denominator,
-			  tc = ((a * e) - (b * d)) / denominator;
+        float sc, tc;
 
-		if (!areLinesInfinite)
+		if (areLinesInfinite)
 		{
-			sc = Mathf::Clamp(sc, 0.0f, 1.0f);
-            tc = Mathf::Clamp(tc, 0.0f, 1.0f);
+            //If the lines are parallel, their distance is constant, so any point on the first line works.
+            sc = (denominator > 0.0f ? ((b * e) - (c * d)) / denominator : 0.0f);
+            tc = (denominator > 0.0f ?
+                      ((a * e) - (b * d)) / denominator :
+                      (c > 0.0f ? e / c : 0.0f));
 		}
+        else
+        {
+            //Clamping both line values separately doesn't give the closest points on the segments.
+            //Instead, clamp the first one, then find the closest point on the second segment to it,
+            //    then find the closest point on the first segment to that.
+            sc = (denominator > 0.0f ?
+                      Mathf::Clamp(((b * e) - (c * d)) / denominator, 0.0f, 1.0f) :
+                      0.0f);
+            tc = (c > 0.0f ? Mathf::Clamp(((b * sc) + e) / c, 0.0f, 1.0f) : 0.0f);
+            sc = (a > 0.0f ? Mathf::Clamp(((b * tc) - d) / a, 0.0f, 1.0f) : 0.0f);
+        }
 
 		return ClosestValues<Vector>(p0 + (u * sc), q0 + (v * tc));
 	}
@@ -247,6 +251,109 @@ public:
 
 
 
+    //Which triangles use each vertex of an indexed triangle mesh.
+    //Lets values be gathered from the triangles onto each vertex in parallel,
+    //    since each vertex only reads from its own triangles.
+    struct VertexTriangles
+    {
+        //The triangles using vertex "i" are "Triangles[Starts[i]]" up to (but not including)
+        //    "Triangles[Starts[i + 1]]".
+        std::vector<unsigned int> Starts, Triangles;
+
+        unsigned int GetNVertices(void) const { return (Starts.empty() ? 0 : (unsigned int)Starts.size() - 1); }
+
+        //Finds the triangles that use each vertex. Every three indices make a triangle.
+        void Build(unsigned int nVertices, const unsigned int* indices, unsigned int nIndices);
+    };
+
+
+    template<typename VertexType, typename NormalGetter, typename PosGetter, typename FlipChecker>
+    //Calculates smooth normals for a collection of triangles.
+    //Each vertex's normal is the average of the normals of the triangles using it,
+    //    weighted by their area.
+    //Takes in a getter for a reference to a vertex's normal, a getter for a vertex's position,
+    //    and a function that takes a triangle's (non-normalized) normal and its first vertex
+    //    and returns whether the normal is facing the wrong way.
+    //Vertices that aren't used by any triangle get a normal of 0.
+    //If "threads" isn't 0, the work is split up across its threads.
+    //If "adjacency" isn't 0, it is used instead of being built from the indices every time;
+    //    it's about as slow to build as the normals are to compute, so keep it around
+    //    if the same triangles will have their normals calculated many times.
+    static void CalculateNormals(VertexType* vertices, unsigned int nVertices,
+                                 const unsigned int* indices, unsigned int nIndices,
+                                 NormalGetter getNormal, PosGetter getPos, FlipChecker shouldFlipNormal,
+                                 ThreadPool* threads = 0, const VertexTriangles* adjacency = 0)
+    {
+        unsigned int nTriangles = nIndices / 3;
+
+        //The cross product of a triangle's edges is its normal, scaled by twice its area.
+        auto getTriangleNormal = [&](unsigned int tri) -> Vector3f
+        {
+            const unsigned int* triIndices = &indices[tri * 3];
+            const VertexType& v1 = vertices[triIndices[0]];
+            Vector3f p1 = getPos(v1);
+            Vector3f norm = (getPos(vertices[triIndices[1]]) - p1).Cross(getPos(vertices[triIndices[2]]) - p1);
+            return (shouldFlipNormal(norm, v1) ? -norm : norm);
+        };
+        auto normalizeSafe = [](Vector3f& v)
+        {
+            float lenSqr = v.LengthSquared();
+            if (lenSqr > 0.0f)
+                v /= sqrtf(lenSqr);
+        };
+
+        //Without threads or a pre-built adjacency, it's fastest to just add each triangle's normal
+        //    onto its vertices.
+        if (threads == 0 && adjacency == 0)
+        {
+            for (unsigned int vert = 0; vert < nVertices; ++vert)
+                getNormal(vertices[vert]) = Vector3f();
+            for (unsigned int tri = 0; tri < nTriangles; ++tri)
+            {
+                Vector3f norm = getTriangleNormal(tri);
+                getNormal(vertices[indices[tri * 3]]) += norm;
+                getNormal(vertices[indices[(tri * 3) + 1]]) += norm;
+                getNormal(vertices[indices[(tri * 3) + 2]]) += norm;
+            }
+            for (unsigned int vert = 0; vert < nVertices; ++vert)
+                normalizeSafe(getNormal(vertices[vert]));
+            return;
+        }
+
+        //Otherwise, compute every triangle's normal, then have each vertex gather its triangles' normals.
+        VertexTriangles tempAdjacency;
+        if (adjacency == 0)
+        {
+            tempAdjacency.Build(nVertices, indices, nIndices);
+            adjacency = &tempAdjacency;
+        }
+        assert(adjacency->GetNVertices() == nVertices);
+
+        std::vector<Vector3f> triNormals(nTriangles);
+        auto doTriangle = [&](unsigned int tri) { triNormals[tri] = getTriangleNormal(tri); };
+        auto doVertex = [&](unsigned int vert)
+        {
+            Vector3f sum;
+            for (unsigned int i = adjacency->Starts[vert]; i < adjacency->Starts[vert + 1]; ++i)
+                sum += triNormals[adjacency->Triangles[i]];
+            normalizeSafe(sum);
+            getNormal(vertices[vert]) = sum;
+        };
+
+        const unsigned int ELEMENTS_PER_CHUNK = 4096;
+        if (threads == 0)
+        {
+            for (unsigned int tri = 0; tri < nTriangles; ++tri)
+                doTriangle(tri);
+            for (unsigned int vert = 0; vert < nVertices; ++vert)
+                doVertex(vert);
+        }
+        else
+        {
+            threads->ParallelFor(nTriangles, doTriangle, ELEMENTS_PER_CHUNK);
+            threads->ParallelFor(nVertices, doVertex, ELEMENTS_PER_CHUNK);
+        }
+    }
     template<typename VertexType>
     //Calculates normals for a collection of triangles.
     //Takes in a function that finds whether a given normal for a given vertex is facing the wrong way,
@@ -260,33 +367,9 @@ public:
                                                          void* pData),
                                  void* pData = 0)
     {
-        //Start all normals at 0.0f.
-        for (unsigned int vert = 0; vert < nVertices; ++vert)
-            getNormal(vertices[vert]) = Vector3f();
-
-        //Get the normals for each triangle.
-        for (unsigned int tri = 0; tri < nIndices; tri += 3)
-        {
-            VertexType& v1 = vertices[indices[tri]],
-                        v2 = vertices[indices[(tri + 1)]],
-                        v3 = vertices[indices[(tri + 2)]];
-            Vector3f v_1_2 = getPos(v1) - getPos(v2),
-                     v_1_3 = getPos(v1) - getPos(v3);
-            Vector3f norm = v_1_2.Normalized().Cross(v_1_3.Normalized());
-
-            if (shouldFlipNormal(norm, v1, pData))
-            {
-                norm = -norm;
-            }
-
-            getNormal(v1) += norm;
-            getNormal(v2) += norm;
-            getNormal(v3) += norm;
-        }
-
-        //Get the average of each vertex's normals.
-        for (unsigned int vert = 0; vert < nVertices; ++vert)
-            getNormal(vertices[vert]).Normalize();
+        CalculateNormals(vertices, nVertices, indices, nIndices, getNormal, getPos,
+                         [shouldFlipNormal, pData](const Vector3f& normal, const VertexType& vert)
+                             { return shouldFlipNormal(normal, vert, pData); });
     }
     template<typename VertexType>
     static void CalculateNormals(VertexType* vertices, unsigned int nVertices,
@@ -296,9 +379,22 @@ public:
                                                          void* pData),
                                  void* pData = 0)
     {
-        CalculateNormals<VertexType>(vertices, nVertices, indices, nIndices,
-                                     [](VertexType& vert) -> Vector3f& { return vert.Normal; },
-                                     [](const VertexType& vert) -> Vector3f { return vert.Pos; },
-                                     shouldFlipNormal, pData);
+        CalculateNormals(vertices, nVertices, indices, nIndices,
+                         [](VertexType& vert) -> Vector3f& { return vert.Normal; },
+                         [](const VertexType& vert) -> Vector3f { return vert.Pos; },
+                         [shouldFlipNormal, pData](const Vector3f& normal, const VertexType& vert)
+                             { return shouldFlipNormal(normal, vert, pData); });
     }
+
+    //Calculates smooth normals for a collection of triangles whose vertex positions are stored
+    //    as a separate array for each component, outputting the normals the same way.
+    //Each vertex's normal is the average of the normals of the triangles using it,
+    //    weighted by their area. Vertices that aren't used by any triangle get a normal of 0.
+    //Faster than the other versions, since it can use SSE to work on four triangles/vertices at once.
+    //If "threads" isn't 0, the work is split up across its threads.
+    //If "adjacency" isn't 0, it is used instead of being built from the indices every time.
+    static void CalculateNormals(const float* posX, const float* posY, const float* posZ,
+                                 float* outNormX, float* outNormY, float* outNormZ, unsigned int nVertices,
+                                 const unsigned int* indices, unsigned int nIndices,
+                                 ThreadPool* threads = 0, const VertexTriangles* adjacency = 0);
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "../LowerMath.hpp"
+#include "Geometryf.h"
 
 
 //Represents a rectangular terrain with a heightmap of floats.
@@ -49,6 +50,7 @@ public:
     //    4) The scale for the terrain's height
     //    5) The LOD level of the terrain (0 = full detail, 1 = 1/4 detail, 2 = 1/8 detail, etc.)
     //Assumes the region can be split down to the given level of detail.
+    //Lower levels of detail just skip over heightmap values, so they don't need any extra memory.
     void GenerateTriangles(std::vector<VertexType>& outVerts, std::vector<unsigned int>& outIndices,
                            Vector3f*(*vertPosGetter)(VertexType& vert),
                            Vector2f*(*vertUVGetter)(VertexType& vert),
@@ -58,66 +60,6 @@ public:
     {
         assert(outVerts.size() == 0);
         assert(outIndices.size() == 0);
-
-        //If the LOD level isn't 0, calculate a lower-detail terrain and generate triangles for it.
-        if (zoomOut != 0)
-        {
-            Vector2u fullSize = bottomRight - topLeft + Vector2u(1, 1);
-            unsigned int skippedVerts = Mathf::IntPow(2, zoomOut) - 1;
-            
-            //Calculate the size of the lower-detail terrain and make sure it can be constructed.
-            Vector2u outSize = GetNVertices(fullSize, zoomOut);
-            assert(outSize.x > 1 && outSize.y > 1);
-
-            
-            //Fill in the lower-detail heightmap.
-
-            Terrain smallerTerr(outSize);
-            Vector2u lodLoc(0, 0);
-            Vector2u terrainLoc = topLeft;
-
-            while (terrainLoc.y <= bottomRight.y)
-            {
-                terrainLoc.x = topLeft.x;
-                lodLoc.x = 0;
-
-                while (terrainLoc.x <= bottomRight.x)
-                {
-                    smallerTerr[lodLoc] = heightmap[terrainLoc];
-
-                    terrainLoc.x += skippedVerts + 1;
-                    lodLoc.x += 1;
-                }
-
-                terrainLoc.y += skippedVerts + 1;
-                lodLoc.y += 1;
-            }
-
-
-            //Generate the triangles.
-            float scalePos = powf(2.0f, (float)zoomOut);
-            Vector3f translatePos(ToV2f(topLeft), 0.0f);
-            unsigned int startIndex = outVerts.size();
-            smallerTerr.GenerateTriangles(outVerts, outIndices,
-                                          vertPosGetter, vertUVGetter, vertNormalGetter,
-                                          Vector2u(0, 0),
-                                          Vector2u(smallerTerr.GetWidth(), smallerTerr.GetHeight()),
-                                          heightScale);
-
-            //Remap the vertices to fit the correct region of space.
-            Vector3f scalePos3(scalePos, scalePos, 1.0f);
-            for (unsigned int i = startIndex; i < outVerts.size(); ++i)
-            {
-                Vector3f* vPos = vertPosGetter(outVerts[i]);
-                vPos->MultiplyComponents(scalePos3);
-                *vPos += translatePos;
-            }
-
-            return;
-        }
-
-
-        //Otherwise, level of detail is 0 (full), so generate the terrain like normal.
         assert(topLeft.x <= bottomRight.x && topLeft.y <= bottomRight.y);
 
         topLeft = topLeft.Clamp(Vector2u(0, 0),
@@ -125,21 +67,23 @@ public:
         bottomRight = bottomRight.Clamp(Vector2u(0, 0),
                                         Vector2u(GetWidth() - 1, GetHeight() - 1));
 
-        Vector2u areaSize = bottomRight - topLeft + Vector2u(1, 1);
+        //Each level of detail skips every other vertex of the level above it.
+        unsigned int step = (unsigned int)Mathf::IntPow(2, zoomOut);
+        Vector2u areaSize = GetNVertices(bottomRight - topLeft + Vector2u(1, 1), zoomOut);
+        assert(areaSize.x > 0 && areaSize.y > 0);
+
+        outVerts.resize(areaSize.x * areaSize.y);
+        outIndices.reserve(GetNIndices(bottomRight - topLeft + Vector2u(1, 1), zoomOut));
 
         Vector2f texCoordIncrement(1.0f / (float)GetWidth(),
                                    1.0f / (float)GetHeight());
-        unsigned int vertIndex = outVerts.size();
-        Vector2f posF;
-        for (Vector2u pos(0, topLeft.y); pos.y <= bottomRight.y; ++pos.y)
+        unsigned int vertIndex = 0;
+        for (Vector2u local(0, 0); local.y < areaSize.y; ++local.y)
         {
-            posF.y = (float)pos.y;
-
-            for (pos.x = topLeft.x; pos.x <= bottomRight.x; ++pos.x)
+            for (local.x = 0; local.x < areaSize.x; ++local.x)
             {
-                posF.x = (float)pos.x;
-
-                outVerts.insert(outVerts.end(), VertexType());
+                Vector2u pos = topLeft + (local * step);
+                Vector2f posF((float)pos.x, (float)pos.y);
 
                 //Output position and texture coordinates.
                 *(vertPosGetter(outVerts[vertIndex])) = Vector3f(posF.x, posF.y,
@@ -147,21 +91,9 @@ public:
                 *(vertUVGetter(outVerts[vertIndex])) = Vector2f(texCoordIncrement.x * posF.x,
                                                                 texCoordIncrement.y * posF.y);
 
-                //Calculate normals and indices if this vertex isn't on the top/left borders.
-                if (pos.x > 0 && pos.y > 0)
+                //Output indices if this vertex isn't on the top/left borders.
+                if (local.x > 0 && local.y > 0)
                 {
-                    if (vertNormalGetter != 0)
-                    {
-                        Vector3f lessX = *vertPosGetter(outVerts[vertIndex - 1]),
-                                 lessY = *vertPosGetter(outVerts[vertIndex - areaSize.x]),
-                                 toLessX = (lessX - *vertPosGetter(outVerts[vertIndex])).Normalized(),
-                                 toLessY = (lessY - *vertPosGetter(outVerts[vertIndex])).Normalized();
-                        Vector3f* vNorm = vertNormalGetter(outVerts[vertIndex]);
-                        *vNorm = toLessX.Cross(toLessY);
-                        if (vNorm->z < 0.0f)
-                            *vNorm = -(*vNorm);
-                    }
-
                     outIndices.insert(outIndices.end(), vertIndex);
                     outIndices.insert(outIndices.end(), vertIndex - 1 - areaSize.x);
                     outIndices.insert(outIndices.end(), vertIndex - 1);
@@ -174,63 +106,18 @@ public:
                 vertIndex += 1;
             }
         }
-        
-        
-        //Calculate the normals that couldn't be calculated normally (the ones on the top/left borders).
-
-        if (vertNormalGetter == 0)
-            return;
-
-        //First, the top-left corner.
-        if (topLeft.x == 0 && topLeft.y == 0)
-        {
-            Vector3f moreX = *vertPosGetter(outVerts[1]),
-                     moreY = *vertPosGetter(outVerts[GetWidth()]),
-                     toMoreX = (moreX - *vertPosGetter(outVerts[0])).Normalized(),
-                     toMoreY = (moreY - *vertPosGetter(outVerts[0])).Normalized();
-            Vector3f* vNorm = vertNormalGetter(outVerts[0]);
-            *vNorm = toMoreX.Cross(toMoreY);
-            if (vNorm->z < 0.0f)
-                *vNorm = -(*vNorm);
-        }
 
-        //Next, the left edge.
-        if (topLeft.x == 0)
-        {
-            for (unsigned int y = Mathf::Max<unsigned int>(topLeft.y, 1); y <= bottomRight.y; ++y)
-            {
-                vertIndex = y * areaSize.x;
 
-                Vector3f moreX = *vertPosGetter(outVerts[vertIndex + 1]),
-                         lessY = *vertPosGetter(outVerts[vertIndex - areaSize.x]),
-                         toMoreX = (moreX - *vertPosGetter(outVerts[vertIndex])).Normalized(),
-                         toLessY = (lessY - *vertPosGetter(outVerts[vertIndex])).Normalized();
-                
-                Vector3f* vNorm = vertNormalGetter(outVerts[vertIndex]);
-                *vNorm = toLessY.Cross(toMoreX);
-                if (vNorm->z < 0.0f)
-                    *vNorm = -(*vNorm);
-            }
-        }
+        //Calculate smooth normals from the triangles, making sure they all face upwards.
 
-        //Finally, the top edge.
-        if (topLeft.y == 0)
-        {
-            for (unsigned int x = Mathf::Max<unsigned int>(topLeft.x, 1); x <= bottomRight.x; ++x)
-            {
-                vertIndex = x;
+        if (vertNormalGetter == 0 || areaSize.x < 2 || areaSize.y < 2)
+            return;
 
-                Vector3f lessX = *vertPosGetter(outVerts[vertIndex - 1]),
-                         moreY = *vertPosGetter(outVerts[vertIndex + areaSize.x]),
-                         toLessX = (lessX - *vertPosGetter(outVerts[vertIndex])).Normalized(),
-                         toMoreY = (moreY - *vertPosGetter(outVerts[vertIndex])).Normalized();
-                
-                Vector3f* vNorm = vertNormalGetter(outVerts[vertIndex]);
-                *vNorm = toMoreY.Cross(toLessX);
-                if (vNorm->z < 0.0f)
-                    *vNorm = -*(vNorm);
-            }
-        }
+        Geometryf::CalculateNormals(outVerts.data(), (unsigned int)outVerts.size(),
+                                    outIndices.data(), (unsigned int)outIndices.size(),
+                                    [vertNormalGetter](VertexType& v) -> Vector3f& { return *vertNormalGetter(v); },
+                                    [vertPosGetter](const VertexType& v) { return *vertPosGetter(const_cast<VertexType&>(v)); },
+                                    [](const Vector3f& norm, const VertexType&) { return norm.z < 0.0f; });
     }
     //"VertexType" is the class of vertex. It must have a default constructor.
     template<typename VertexType>
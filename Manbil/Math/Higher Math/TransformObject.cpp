@@ -32,16 +32,7 @@ void TransformObject::SetRotation(Vector3f eulerAngleAmounts)
 
 void TransformObject::GetWorldTransform(Matrix4f & outM) const
 {
-    //TODO: Figure out the math for making one matrix instead of multiplying the pos, rot, and scale matrices.
-
-	Matrix4f posM, rotM, scaleM;
-	GetTranslationMatrix(posM);
-	GetRotationMatrix(rotM);
-	GetScaleMatrix(scaleM);
-
-	Matrix4f ret = Matrix4f::Multiply(posM, rotM, scaleM);
-
-	outM.Set(ret);
+    outM.SetAsTransform(pos, rot, scale);
 }
 
 void TransformObject::CalculateNewDirVectors(void)
@@ -0,0 +1,203 @@
+#include "TransformObjectTree.h"
+
+#include <algorithm>
+
+
+namespace
+{
+    //The value for "no index" in the per-node arrays.
+    const unsigned int NO_INDEX = TransformObjectTree::INVALID_NODE;
+}
+
+
+TransformObjectTree::NodeID TransformObjectTree::AddNode(const TransformObject& localTransform, NodeID parent)
+{
+    //Re-use a freed ID if one exists.
+    NodeID id;
+    if (freeIDs.empty())
+    {
+        id = (NodeID)idToIndex.size();
+        idToIndex.push_back(NO_INDEX);
+    }
+    else
+    {
+        id = freeIDs.back();
+        freeIDs.pop_back();
+    }
+
+    //The new node goes at the end of the arrays, which is always after its parent.
+    idToIndex[id] = (unsigned int)ids.size();
+    ids.push_back(id);
+    parents.push_back(parent == INVALID_NODE ? NO_INDEX : GetIndex(parent));
+    locals.push_back(localTransform);
+    localMatrices.push_back(Matrix4f());
+    worldMatrices.push_back(Matrix4f());
+    changeFlags.push_back(CF_LOCAL);
+
+    anyChanged = true;
+    return id;
+}
+void TransformObjectTree::RemoveNode(NodeID node)
+{
+    //Descendants can only be found by scanning forward if every parent is before its children.
+    if (needsSorting)
+        Sort();
+
+    unsigned int index = GetIndex(node);
+
+    //Every node after this one whose parent is being removed is also removed.
+    //Give each remaining node its new index.
+    std::vector<unsigned int> oldIndexToNewIndex(ids.size());
+    for (unsigned int i = 0; i < index; ++i)
+        oldIndexToNewIndex[i] = i;
+    oldIndexToNewIndex[index] = NO_INDEX;
+
+    unsigned int newCount = index;
+    for (unsigned int i = index + 1; i < ids.size(); ++i)
+    {
+        if (parents[i] != NO_INDEX && oldIndexToNewIndex[parents[i]] == NO_INDEX)
+        {
+            oldIndexToNewIndex[i] = NO_INDEX;
+        }
+        else
+        {
+            oldIndexToNewIndex[i] = newCount;
+            newCount += 1;
+        }
+    }
+
+    //Free up the removed nodes' IDs.
+    for (unsigned int i = index; i < ids.size(); ++i)
+    {
+        if (oldIndexToNewIndex[i] == NO_INDEX)
+        {
+            idToIndex[ids[i]] = NO_INDEX;
+            freeIDs.push_back(ids[i]);
+        }
+    }
+
+    Rearrange(oldIndexToNewIndex, newCount);
+}
+
+TransformObjectTree::NodeID TransformObjectTree::GetParent(NodeID node) const
+{
+    unsigned int parentIndex = parents[GetIndex(node)];
+    return (parentIndex == NO_INDEX ? INVALID_NODE : ids[parentIndex]);
+}
+void TransformObjectTree::SetParent(NodeID node, NodeID newParent)
+{
+    unsigned int index = GetIndex(node),
+                 parentIndex = (newParent == INVALID_NODE ? NO_INDEX : GetIndex(newParent));
+
+    //Make sure the new parent isn't a descendant of the node.
+#ifndef NDEBUG
+    for (unsigned int i = parentIndex; i != NO_INDEX; i = parents[i])
+        assert(i != index);
+#endif
+
+    parents[index] = parentIndex;
+    if (parentIndex != NO_INDEX && parentIndex > index)
+        needsSorting = true;
+
+    //The node's world matrix has to be recomputed.
+    changeFlags[index] |= CF_LOCAL;
+    anyChanged = true;
+}
+
+TransformObject& TransformObjectTree::EditLocalTransform(NodeID node)
+{
+    unsigned int index = GetIndex(node);
+    changeFlags[index] |= CF_LOCAL;
+    anyChanged = true;
+    return locals[index];
+}
+
+void TransformObjectTree::UpdateMatrices(void)
+{
+    if (needsSorting)
+        Sort();
+
+    //Parents are always updated before their children, so a node's world matrix needs
+    //    to be recomputed if its local transform changed or its parent's world matrix just changed.
+    for (unsigned int i = 0; i < ids.size(); ++i)
+    {
+        unsigned char flags = changeFlags[i];
+        unsigned int parent = parents[i];
+
+        bool worldChanged = (flags & CF_LOCAL) != 0 ||
+                            (parent != NO_INDEX && (changeFlags[parent] & CF_WORLD) != 0);
+
+        if ((flags & CF_LOCAL) != 0)
+        {
+            locals[i].GetWorldTransform(localMatrices[i]);
+        }
+        if (worldChanged)
+        {
+            if (parent == NO_INDEX)
+                worldMatrices[i] = localMatrices[i];
+            else
+                worldMatrices[i] = Matrix4f::Multiply(worldMatrices[parent], localMatrices[i]);
+        }
+
+        changeFlags[i] = (worldChanged ? CF_WORLD : 0);
+    }
+
+    anyChanged = false;
+}
+
+void TransformObjectTree::Sort(void)
+{
+    //Sort the nodes by their depth in the tree, keeping the current order for nodes of the same depth.
+    std::vector<unsigned int> depths(ids.size());
+    for (unsigned int i = 0; i < ids.size(); ++i)
+    {
+        unsigned int depth = 0;
+        for (unsigned int parent = parents[i]; parent != NO_INDEX; parent = parents[parent])
+            depth += 1;
+        depths[i] = depth;
+    }
+
+    std::vector<unsigned int> sortedIndices(ids.size());
+    for (unsigned int i = 0; i < sortedIndices.size(); ++i)
+        sortedIndices[i] = i;
+    std::stable_sort(sortedIndices.begin(), sortedIndices.end(),
+                     [&depths](unsigned int a, unsigned int b) { return depths[a] < depths[b]; });
+
+    std::vector<unsigned int> oldIndexToNewIndex(ids.size());
+    for (unsigned int i = 0; i < sortedIndices.size(); ++i)
+        oldIndexToNewIndex[sortedIndices[i]] = i;
+
+    Rearrange(oldIndexToNewIndex, (unsigned int)ids.size());
+    needsSorting = false;
+}
+void TransformObjectTree::Rearrange(const std::vector<unsigned int>& oldIndexToNewIndex, unsigned int newCount)
+{
+    std::vector<NodeID> newIDs(newCount);
+    std::vector<unsigned int> newParents(newCount);
+    std::vector<TransformObject> newLocals(newCount);
+    std::vector<Matrix4f> newLocalMatrices(newCount), newWorldMatrices(newCount);
+    std::vector<unsigned char> newChangeFlags(newCount);
+
+    for (unsigned int i = 0; i < ids.size(); ++i)
+    {
+        unsigned int newI = oldIndexToNewIndex[i];
+        if (newI == NO_INDEX)
+            continue;
+
+        newIDs[newI] = ids[i];
+        newParents[newI] = (parents[i] == NO_INDEX ? NO_INDEX : oldIndexToNewIndex[parents[i]]);
+        newLocals[newI] = locals[i];
+        newLocalMatrices[newI] = localMatrices[i];
+        newWorldMatrices[newI] = worldMatrices[i];
+        newChangeFlags[newI] = changeFlags[i];
+
+        idToIndex[ids[i]] = newI;
+    }
+
+    ids.swap(newIDs);
+    parents.swap(newParents);
+    locals.swap(newLocals);
+    localMatrices.swap(newLocalMatrices);
+    worldMatrices.swap(newWorldMatrices);
+    changeFlags.swap(newChangeFlags);
+}
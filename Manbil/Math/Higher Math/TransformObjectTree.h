@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include "TransformObject.h"
+
+
+//A hierarchy of transforms. Each node's world matrix is its local transform followed by
+//    its parent's world matrix.
+//The nodes are stored in flat arrays with every parent before its children,
+//    so all the world matrices can be updated in one pass.
+//Matrices are cached, and only the nodes that changed (and their descendants) are recomputed.
+class TransformObjectTree
+{
+public:
+
+    //Identifies a node. Stays the same while the node exists, even when the arrays are rearranged.
+    typedef unsigned int NodeID;
+    //Represents "no node", e.x. the parent of a root node.
+    static const NodeID INVALID_NODE = 0xffffffff;
+
+
+    //Gets the number of nodes in this tree.
+    unsigned int GetNNodes(void) const { return (unsigned int)ids.size(); }
+    //Gets whether the given node exists.
+    bool Exists(NodeID node) const { return node < idToIndex.size() && idToIndex[node] != INVALID_NODE; }
+
+
+    //Adds a new node as a child of the given node (or as a root if the parent is "INVALID_NODE").
+    NodeID AddNode(const TransformObject& localTransform, NodeID parent = INVALID_NODE);
+    //Removes the given node along with all its descendants.
+    void RemoveNode(NodeID node);
+
+    NodeID GetParent(NodeID node) const;
+    //Moves the given node (and its descendants) to a new parent (or to a root if it's "INVALID_NODE").
+    //The new parent must not be a descendant of the node.
+    void SetParent(NodeID node, NodeID newParent);
+
+
+    const TransformObject& GetLocalTransform(NodeID node) const { return locals[GetIndex(node)]; }
+    //Gets the given node's local transform so that it can be changed,
+    //    marking the node's matrices (and its descendants' matrices) as needing to be recomputed.
+    TransformObject& EditLocalTransform(NodeID node);
+    void SetLocalTransform(NodeID node, const TransformObject& newTransform) { EditLocalTransform(node) = newTransform; }
+
+
+    //Recomputes the matrices of any nodes that changed since the last update.
+    void UpdateMatrices(void);
+
+    //Gets the given node's local transform matrix, updating the tree's matrices first if necessary.
+    //The reference stays valid until nodes are added, removed, or re-parented.
+    const Matrix4f& GetLocalMatrix(NodeID node) { UpdateIfChanged(); return localMatrices[GetIndex(node)]; }
+    //Gets the given node's world transform matrix, updating the tree's matrices first if necessary.
+    //The reference stays valid until nodes are added, removed, or re-parented.
+    const Matrix4f& GetWorldMatrix(NodeID node) { UpdateIfChanged(); return worldMatrices[GetIndex(node)]; }
+
+
+private:
+
+    enum ChangeFlags : unsigned char
+    {
+        //The node's local transform changed since the last update.
+        CF_LOCAL = 1,
+        //The node's world matrix changed during the most recent update.
+        CF_WORLD = 2,
+    };
+
+
+    //The per-node arrays, all in the same order (every parent before its children).
+
+    std::vector<NodeID> ids;
+    //The index of each node's parent, or "INVALID_NODE" for root nodes.
+    std::vector<unsigned int> parents;
+    std::vector<TransformObject> locals;
+    std::vector<Matrix4f> localMatrices, worldMatrices;
+    //A combination of the "ChangeFlags" for each node.
+    std::vector<unsigned char> changeFlags;
+
+    //Maps each node ID to its index in the arrays, or "INVALID_NODE" if the ID isn't in use.
+    std::vector<unsigned int> idToIndex;
+    //IDs that were freed up by removing nodes.
+    std::vector<NodeID> freeIDs;
+
+    //Whether any local transform changed since the last update.
+    bool anyChanged = false;
+    //Whether a node was moved under a parent that comes after it in the arrays.
+    bool needsSorting = false;
+
+
+    unsigned int GetIndex(NodeID node) const { assert(Exists(node)); return idToIndex[node]; }
+
+    void UpdateIfChanged(void) { if (anyChanged || needsSorting) UpdateMatrices(); }
+
+    //Rearranges the arrays so that every parent is before its children again.
+    void Sort(void);
+    //Moves the element at each index to the given new index, for every per-node array.
+    void Rearrange(const std::vector<unsigned int>& oldIndexToNewIndex, unsigned int newCount);
+};
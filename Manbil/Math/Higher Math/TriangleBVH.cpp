@@ -0,0 +1,768 @@
+#include "TriangleBVH.h"
+
+#include <atomic>
+#include <algorithm>
+#include "../../Threading/ThreadPool.h"
+
+
+//Use SSE to trace four rays at once if the target supports it.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+    #define TRIANGLEBVH_USE_SSE
+    #include <xmmintrin.h>
+    #include <string.h>
+#endif
+
+
+namespace
+{
+    //The number of bins the triangles are sorted into along each axis when looking for the best split.
+    const unsigned int N_BINS = 16;
+    //Leaves with more triangles than this are always split.
+    const unsigned int MAX_LEAF_SIZE = 8;
+    //The cost of visiting a branch, relative to the cost of testing a triangle.
+    const float TRAVERSAL_COST = 1.0f;
+    //Past this depth, nodes are split in half by triangle count instead of by the surface area heuristic.
+    //This keeps the tree shallow enough for the traversal stack.
+    const unsigned int MAX_HEURISTIC_DEPTH = 32;
+    //The number of nodes that can be waiting on the traversal stack.
+    const unsigned int STACK_SIZE = 64;
+    //Nodes with at least this many triangles have their children built in parallel.
+    const unsigned int MIN_PARALLEL_TRIANGLES = 4096;
+    //Roughly how many triangles/rays each thread grabs at once.
+    const unsigned int TRIANGLES_PER_CHUNK = 4096,
+                       PACKETS_PER_CHUNK = 64;
+
+    //The box tests treat the far side of each box as this much farther away than it really is,
+    //    so that rounding error can't cull a box whose triangle is hit right on the box's edge.
+    //Without it, a single ray and a packet could find different triangles at the same distance,
+    //    since a packet keeps a box alive as long as any of its rays hits it.
+    const float BOX_T_PADDING = 1.00001f;
+
+    const float INF = std::numeric_limits<float>::infinity();
+    const unsigned int NO_CHILD = 0xffffffff;
+
+
+    struct Bounds
+    {
+        Vector3f Min, Max;
+
+        Bounds(void) : Min(INF, INF, INF), Max(-INF, -INF, -INF) { }
+
+        void Add(Vector3f p)
+        {
+            Min = Vector3f(Mathf::Min(Min.x, p.x), Mathf::Min(Min.y, p.y), Mathf::Min(Min.z, p.z));
+            Max = Vector3f(Mathf::Max(Max.x, p.x), Mathf::Max(Max.y, p.y), Mathf::Max(Max.z, p.z));
+        }
+        void Add(const Bounds& b) { Add(b.Min); Add(b.Max); }
+
+        //Gets half the surface area of these bounds, or 0 if they're empty.
+        float GetHalfArea(void) const
+        {
+            Vector3f size = Max - Min;
+            if (size.x < 0.0f)
+                return 0.0f;
+            return (size.x * size.y) + (size.y * size.z) + (size.z * size.x);
+        }
+    };
+
+    //A node of the tree while it's being built.
+    struct BuildNode
+    {
+        Bounds Box;
+        //The triangles in this node are "triangleOrder[First]" through "triangleOrder[First + Count - 1]".
+        unsigned int First, Count;
+        //The index of the first child. The second child is right after it.
+        unsigned int Children;
+        unsigned int SplitAxis;
+    };
+
+    //Builds the tree one node at a time, splitting up big subtrees across threads.
+    struct Builder
+    {
+        const std::vector<Bounds>& TriangleBounds;
+        const std::vector<Vector3f>& Centroids;
+        std::vector<unsigned int>& TriangleOrder;
+        std::vector<BuildNode>& Nodes;
+        std::atomic<unsigned int>& NNodes;
+        ThreadPool* Threads;
+
+
+        //Splits the given node (if it's worth splitting), then builds its children.
+        void Build(unsigned int nodeIndex, unsigned int depth)
+        {
+            BuildNode& node = Nodes[nodeIndex];
+            node.Children = NO_CHILD;
+
+            Bounds centroidBounds;
+            for (unsigned int i = node.First; i < node.First + node.Count; ++i)
+            {
+                node.Box.Add(TriangleBounds[TriangleOrder[i]]);
+                centroidBounds.Add(Centroids[TriangleOrder[i]]);
+            }
+
+            if (node.Count <= 1)
+                return;
+
+            //Find the best split, then sort the triangles into either side of it.
+            unsigned int splitAxis, splitBin;
+            bool useHeuristic = (depth < MAX_HEURISTIC_DEPTH) &&
+                                FindBestSplit(node, centroidBounds, splitAxis, splitBin);
+            unsigned int nFirstChild;
+            if (useHeuristic)
+            {
+                if (splitBin == N_BINS)
+                    return;
+
+                float binMin = centroidBounds.Min[splitAxis],
+                      binScale = N_BINS / (centroidBounds.Max[splitAxis] - binMin);
+                const std::vector<Vector3f>& centroids = Centroids;
+                unsigned int* firstTri = &TriangleOrder[node.First];
+                unsigned int* middleTri =
+                    std::partition(firstTri, firstTri + node.Count,
+                                   [&centroids, splitAxis, splitBin, binMin, binScale](unsigned int tri)
+                                   {
+                                       return GetBin(centroids[tri][splitAxis], binMin, binScale) < splitBin;
+                                   });
+                nFirstChild = (unsigned int)(middleTri - firstTri);
+            }
+            else
+            {
+                if (node.Count <= MAX_LEAF_SIZE)
+                    return;
+
+                //Split the triangles in half along the longest axis.
+                Vector3f size = centroidBounds.Max - centroidBounds.Min;
+                splitAxis = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+                nFirstChild = node.Count / 2;
+                const std::vector<Vector3f>& centroids = Centroids;
+                std::nth_element(TriangleOrder.begin() + node.First,
+                                 TriangleOrder.begin() + node.First + nFirstChild,
+                                 TriangleOrder.begin() + node.First + node.Count,
+                                 [&centroids, splitAxis](unsigned int a, unsigned int b)
+                                 {
+                                     return centroids[a][splitAxis] < centroids[b][splitAxis];
+                                 });
+            }
+
+            //Make the children.
+            unsigned int children = NNodes.fetch_add(2);
+            node.Children = children;
+            node.SplitAxis = splitAxis;
+            Nodes[children].First = node.First;
+            Nodes[children].Count = nFirstChild;
+            Nodes[children + 1].First = node.First + nFirstChild;
+            Nodes[children + 1].Count = node.Count - nFirstChild;
+
+            if (Threads != 0 && node.Count >= MIN_PARALLEL_TRIANGLES)
+            {
+                Threads->ParallelFor(2, [this, children, depth](unsigned int i) { Build(children + i, depth + 1); });
+            }
+            else
+            {
+                Build(children, depth + 1);
+                Build(children + 1, depth + 1);
+            }
+        }
+
+        static unsigned int GetBin(float centroid, float binMin, float binScale)
+        {
+            return Mathf::Min(N_BINS - 1, (unsigned int)((centroid - binMin) * binScale));
+        }
+
+        //Finds the best place to split the given node using the surface area heuristic.
+        //Outputs the axis and the first bin on the far side of the split,
+        //    or "N_BINS" if the node is better off as a leaf.
+        //Returns false if the triangles can't be split into bins at all.
+        bool FindBestSplit(const BuildNode& node, const Bounds& centroidBounds,
+                           unsigned int& outAxis, unsigned int& outBin) const
+        {
+            float bestCost = std::numeric_limits<float>::max();
+            bool foundAny = false;
+
+            for (unsigned int axis = 0; axis < 3; ++axis)
+            {
+                float binMin = centroidBounds.Min[axis],
+                      extent = centroidBounds.Max[axis] - binMin;
+                if (extent <= 0.0f)
+                    continue;
+                float binScale = N_BINS / extent;
+
+                //Put each triangle into a bin.
+                Bounds binBounds[N_BINS];
+                unsigned int binCounts[N_BINS] = { 0 };
+                for (unsigned int i = node.First; i < node.First + node.Count; ++i)
+                {
+                    unsigned int tri = TriangleOrder[i],
+                                 bin = GetBin(Centroids[tri][axis], binMin, binScale);
+                    binBounds[bin].Add(TriangleBounds[tri]);
+                    binCounts[bin] += 1;
+                }
+
+                //Sweep from the far end to get the area/count of everything past each split,
+                //    then sweep from the near end to get the cost of each split.
+                float areasAfter[N_BINS];
+                unsigned int countsAfter[N_BINS];
+                Bounds after;
+                unsigned int countAfter = 0;
+                for (unsigned int bin = N_BINS - 1; bin > 0; --bin)
+                {
+                    after.Add(binBounds[bin]);
+                    countAfter += binCounts[bin];
+                    areasAfter[bin] = after.GetHalfArea();
+                    countsAfter[bin] = countAfter;
+                }
+
+                Bounds before;
+                unsigned int countBefore = 0;
+                for (unsigned int bin = 1; bin < N_BINS; ++bin)
+                {
+                    before.Add(binBounds[bin - 1]);
+                    countBefore += binCounts[bin - 1];
+                    if (countBefore == 0 || countsAfter[bin] == 0)
+                        continue;
+
+                    float cost = (before.GetHalfArea() * countBefore) + (areasAfter[bin] * countsAfter[bin]);
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        outAxis = axis;
+                        outBin = bin;
+                        foundAny = true;
+                    }
+                }
+            }
+
+            if (!foundAny)
+                return false;
+
+            //Compare the split's cost to the cost of just testing every triangle in a leaf.
+            float nodeArea = node.Box.GetHalfArea();
+            float splitCost = TRAVERSAL_COST + (nodeArea > 0.0f ? (bestCost / nodeArea) : 0.0f);
+            if (node.Count <= MAX_LEAF_SIZE && splitCost >= (float)node.Count)
+                outBin = N_BINS;
+            return true;
+        }
+    };
+
+
+    //Gets the value to multiply by instead of dividing by the given ray direction component.
+    //A huge value is used in place of infinity for 0, since "0 * infinity" is NaN
+    //    when the ray starts exactly on a box's face.
+    inline float GetInverseDir(float dirComponent)
+    {
+        return (dirComponent == 0.0f ? 1.0e30f : (1.0f / dirComponent));
+    }
+    inline Vector3f GetInverseDir(Vector3f dir)
+    {
+        return Vector3f(GetInverseDir(dir.x), GetInverseDir(dir.y), GetInverseDir(dir.z));
+    }
+
+    //Finds whether the given ray passes through the given box somewhere from 0 to "maxT".
+    inline bool RayHitsBox(Vector3f rayStart, Vector3f invRayDir, Vector3f boxMin, Vector3f boxMax,
+                           float maxT)
+    {
+        float t1 = (boxMin.x - rayStart.x) * invRayDir.x,
+              t2 = (boxMax.x - rayStart.x) * invRayDir.x;
+        float enterT = Mathf::Min(t1, t2),
+              exitT = Mathf::Max(t1, t2);
+
+        t1 = (boxMin.y - rayStart.y) * invRayDir.y;
+        t2 = (boxMax.y - rayStart.y) * invRayDir.y;
+        enterT = Mathf::Max(enterT, Mathf::Min(t1, t2));
+        exitT = Mathf::Min(exitT, Mathf::Max(t1, t2));
+
+        t1 = (boxMin.z - rayStart.z) * invRayDir.z;
+        t2 = (boxMax.z - rayStart.z) * invRayDir.z;
+        enterT = Mathf::Max(enterT, Mathf::Min(t1, t2));
+        exitT = Mathf::Min(exitT, Mathf::Max(t1, t2));
+
+        exitT *= BOX_T_PADDING;
+        return enterT <= exitT && exitT >= 0.0f && enterT <= (maxT * BOX_T_PADDING);
+    }
+
+    //Tests the given ray against the given triangle (its first vertex and two edges).
+    //Outputs the "t" value and barycentric coordinates of the hit if it's between 0 and "maxT".
+    inline bool RayHitsTriangle(Vector3f rayStart, Vector3f rayDir,
+                                Vector3f vertex, Vector3f edge1, Vector3f edge2, float maxT,
+                                float& outT, float& outU, float& outV)
+    {
+        //Moller-Trumbore algorithm.
+        Vector3f p = rayDir.Cross(edge2);
+        float determinant = edge1.Dot(p);
+        if (determinant == 0.0f)
+            return false;
+        float invDeterminant = 1.0f / determinant;
+
+        Vector3f toStart = rayStart - vertex;
+        float u = toStart.Dot(p) * invDeterminant;
+        if (u < 0.0f || u > 1.0f)
+            return false;
+
+        Vector3f q = toStart.Cross(edge1);
+        float v = rayDir.Dot(q) * invDeterminant;
+        if (v < 0.0f || (u + v) > 1.0f)
+            return false;
+
+        float t = edge2.Dot(q) * invDeterminant;
+        if (t < 0.0f || t > maxT)
+            return false;
+
+        outT = t;
+        outU = u;
+        outV = v;
+        return true;
+    }
+}
+
+
+void TriangleBVH::Build(const void* vertexPositions, unsigned int vertexStride,
+                        const unsigned int* indices, unsigned int nTriangles,
+                        ThreadPool* threads)
+{
+    Clear();
+    if (nTriangles == 0)
+        return;
+
+    const unsigned char* vertexBytes = (const unsigned char*)vertexPositions;
+    auto getVertex = [vertexBytes, vertexStride, indices](unsigned int i) -> Vector3f
+    {
+        return *(const Vector3f*)(vertexBytes + (indices[i] * vertexStride));
+    };
+
+    //Get each triangle's bounds and center.
+    std::vector<Bounds> triangleBounds(nTriangles);
+    std::vector<Vector3f> centroids(nTriangles);
+    auto doTriangle = [&](unsigned int tri)
+    {
+        Bounds& bounds = triangleBounds[tri];
+        bounds.Add(getVertex(tri * 3));
+        bounds.Add(getVertex((tri * 3) + 1));
+        bounds.Add(getVertex((tri * 3) + 2));
+        centroids[tri] = (bounds.Min + bounds.Max) * 0.5f;
+    };
+    if (threads == 0)
+    {
+        for (unsigned int tri = 0; tri < nTriangles; ++tri)
+            doTriangle(tri);
+    }
+    else
+    {
+        threads->ParallelFor(nTriangles, doTriangle, TRIANGLES_PER_CHUNK);
+    }
+
+    //Build the tree. A binary tree with one triangle per leaf has "2n - 1" nodes,
+    //    so that's the most nodes it could need.
+    std::vector<unsigned int> triangleOrder(nTriangles);
+    for (unsigned int i = 0; i < nTriangles; ++i)
+        triangleOrder[i] = i;
+
+    std::vector<BuildNode> buildNodes((nTriangles * 2) - 1);
+    std::atomic<unsigned int> nBuildNodes(1);
+    buildNodes[0].First = 0;
+    buildNodes[0].Count = nTriangles;
+
+    Builder builder = { triangleBounds, centroids, triangleOrder, buildNodes, nBuildNodes, threads };
+    builder.Build(0, 0);
+
+
+    //Flatten the tree in depth-first order, so that every branch's first child comes right after it.
+    nodes.reserve(nBuildNodes);
+    struct StackEntry { unsigned int BuildNodeIndex, ParentIndex; };
+    std::vector<StackEntry> toFlatten;
+    StackEntry root = { 0, NO_CHILD };
+    toFlatten.push_back(root);
+    while (!toFlatten.empty())
+    {
+        StackEntry entry = toFlatten.back();
+        toFlatten.pop_back();
+
+        const BuildNode& buildNode = buildNodes[entry.BuildNodeIndex];
+        unsigned int nodeIndex = (unsigned int)nodes.size();
+
+        //The node on the stack is a second child if it has a parent.
+        if (entry.ParentIndex != NO_CHILD)
+            nodes[entry.ParentIndex].Offset = nodeIndex;
+
+        Node node;
+        node.Min = buildNode.Box.Min;
+        node.Max = buildNode.Box.Max;
+        if (buildNode.Children == NO_CHILD)
+        {
+            node.Offset = buildNode.First;
+            node.NTriangles = (unsigned short)buildNode.Count;
+            node.SplitAxis = 0;
+            nodes.push_back(node);
+        }
+        else
+        {
+            node.Offset = NO_CHILD;
+            node.NTriangles = 0;
+            node.SplitAxis = (unsigned short)buildNode.SplitAxis;
+            nodes.push_back(node);
+
+            StackEntry second = { buildNode.Children + 1, nodeIndex },
+                       first = { buildNode.Children, NO_CHILD };
+            toFlatten.push_back(second);
+            toFlatten.push_back(first);
+        }
+    }
+
+    //Store the triangles in the order the leaves use them.
+    triangles.resize(nTriangles * 3);
+    triangleIndices = triangleOrder;
+    for (unsigned int i = 0; i < nTriangles; ++i)
+    {
+        unsigned int tri = triangleOrder[i];
+        Vector3f v1 = getVertex(tri * 3),
+                 v2 = getVertex((tri * 3) + 1),
+                 v3 = getVertex((tri * 3) + 2);
+        triangles[i * 3] = v1;
+        triangles[(i * 3) + 1] = v2 - v1;
+        triangles[(i * 3) + 2] = v3 - v1;
+    }
+}
+void TriangleBVH::Clear(void)
+{
+    nodes.clear();
+    triangles.clear();
+    triangleIndices.clear();
+}
+
+Box3D TriangleBVH::GetBounds(void) const
+{
+    assert(!nodes.empty());
+    return Box3D(nodes[0].Min.x, nodes[0].Max.x,
+                 nodes[0].Min.y, nodes[0].Max.y,
+                 nodes[0].Min.z, nodes[0].Max.z);
+}
+
+
+TriangleBVH::RayHit TriangleBVH::CastRay(Vector3f rayStart, Vector3f rayDir, float maxT) const
+{
+    RayHit hit;
+    if (nodes.empty())
+        return hit;
+
+    Vector3f invRayDir = GetInverseDir(rayDir);
+    float closestT = maxT;
+
+    unsigned int stack[STACK_SIZE];
+    unsigned int stackSize = 0;
+    unsigned int nodeIndex = 0;
+    while (true)
+    {
+        const Node& node = nodes[nodeIndex];
+        if (RayHitsBox(rayStart, invRayDir, node.Min, node.Max, closestT))
+        {
+            if (node.IsLeaf())
+            {
+                for (unsigned int i = node.Offset; i < node.Offset + node.NTriangles; ++i)
+                {
+                    //Hits at the same distance go to the triangle with the lowest index,
+                    //    so the result doesn't depend on the order the tree is walked in.
+                    float t, u, v;
+                    if (RayHitsTriangle(rayStart, rayDir, triangles[i * 3], triangles[(i * 3) + 1],
+                                        triangles[(i * 3) + 2], closestT, t, u, v) &&
+                        (t < closestT || !hit.DidHit || triangleIndices[i] < hit.Triangle))
+                    {
+                        closestT = t;
+                        hit.DidHit = true;
+                        hit.Triangle = triangleIndices[i];
+                        hit.T = t;
+                        hit.U = u;
+                        hit.V = v;
+                    }
+                }
+            }
+            else
+            {
+                //Visit the child on the near side of the split first.
+                assert(stackSize < STACK_SIZE);
+                if (rayDir[node.SplitAxis] >= 0.0f)
+                {
+                    stack[stackSize++] = node.Offset;
+                    nodeIndex += 1;
+                }
+                else
+                {
+                    stack[stackSize++] = nodeIndex + 1;
+                    nodeIndex = node.Offset;
+                }
+                continue;
+            }
+        }
+
+        if (stackSize == 0)
+            break;
+        nodeIndex = stack[--stackSize];
+    }
+
+    return hit;
+}
+bool TriangleBVH::HitsAnything(Vector3f rayStart, Vector3f rayDir, float maxT) const
+{
+    if (nodes.empty())
+        return false;
+
+    Vector3f invRayDir = GetInverseDir(rayDir);
+
+    unsigned int stack[STACK_SIZE];
+    unsigned int stackSize = 0;
+    unsigned int nodeIndex = 0;
+    while (true)
+    {
+        const Node& node = nodes[nodeIndex];
+        if (RayHitsBox(rayStart, invRayDir, node.Min, node.Max, maxT))
+        {
+            if (node.IsLeaf())
+            {
+                for (unsigned int i = node.Offset; i < node.Offset + node.NTriangles; ++i)
+                {
+                    float t, u, v;
+                    if (RayHitsTriangle(rayStart, rayDir, triangles[i * 3], triangles[(i * 3) + 1],
+                                        triangles[(i * 3) + 2], maxT, t, u, v))
+                    {
+                        return true;
+                    }
+                }
+            }
+            else
+            {
+                assert(stackSize < STACK_SIZE);
+                stack[stackSize++] = node.Offset;
+                nodeIndex += 1;
+                continue;
+            }
+        }
+
+        if (stackSize == 0)
+            return false;
+        nodeIndex = stack[--stackSize];
+    }
+}
+
+
+#pragma region Ray packets
+
+#ifdef TRIANGLEBVH_USE_SSE
+
+namespace
+{
+    //A 3D vector with four values for each component.
+    struct Vector3f4
+    {
+        __m128 X, Y, Z;
+
+        Vector3f4(void) { }
+        Vector3f4(__m128 x, __m128 y, __m128 z) : X(x), Y(y), Z(z) { }
+        Vector3f4(Vector3f v) : X(_mm_set1_ps(v.x)), Y(_mm_set1_ps(v.y)), Z(_mm_set1_ps(v.z)) { }
+        Vector3f4(const Vector3f* v)
+            : X(_mm_setr_ps(v[0].x, v[1].x, v[2].x, v[3].x)),
+              Y(_mm_setr_ps(v[0].y, v[1].y, v[2].y, v[3].y)),
+              Z(_mm_setr_ps(v[0].z, v[1].z, v[2].z, v[3].z)) { }
+
+        Vector3f4 operator-(const Vector3f4& v) const
+        {
+            return Vector3f4(_mm_sub_ps(X, v.X), _mm_sub_ps(Y, v.Y), _mm_sub_ps(Z, v.Z));
+        }
+        __m128 Dot(const Vector3f4& v) const
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(X, v.X), _mm_mul_ps(Y, v.Y)), _mm_mul_ps(Z, v.Z));
+        }
+        Vector3f4 Cross(const Vector3f4& v) const
+        {
+            return Vector3f4(_mm_sub_ps(_mm_mul_ps(Y, v.Z), _mm_mul_ps(Z, v.Y)),
+                             _mm_sub_ps(_mm_mul_ps(Z, v.X), _mm_mul_ps(X, v.Z)),
+                             _mm_sub_ps(_mm_mul_ps(X, v.Y), _mm_mul_ps(Y, v.X)));
+        }
+    };
+
+
+    //Does the same thing as "RayHitsBox()" for four rays at once.
+    //Returns a mask of which rays hit.
+    inline __m128 RaysHitBox(const Vector3f4& rayStarts, const Vector3f4& invRayDirs,
+                             Vector3f boxMin, Vector3f boxMax, __m128 maxTs)
+    {
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(boxMin.x), rayStarts.X), invRayDirs.X),
+               t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(boxMax.x), rayStarts.X), invRayDirs.X);
+        __m128 enterT = _mm_min_ps(t1, t2),
+               exitT = _mm_max_ps(t1, t2);
+
+        t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(boxMin.y), rayStarts.Y), invRayDirs.Y);
+        t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(boxMax.y), rayStarts.Y), invRayDirs.Y);
+        enterT = _mm_max_ps(enterT, _mm_min_ps(t1, t2));
+        exitT = _mm_min_ps(exitT, _mm_max_ps(t1, t2));
+
+        t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(boxMin.z), rayStarts.Z), invRayDirs.Z);
+        t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(boxMax.z), rayStarts.Z), invRayDirs.Z);
+        enterT = _mm_max_ps(enterT, _mm_min_ps(t1, t2));
+        exitT = _mm_min_ps(exitT, _mm_max_ps(t1, t2));
+
+        const __m128 padding = _mm_set1_ps(BOX_T_PADDING);
+        exitT = _mm_mul_ps(exitT, padding);
+        return _mm_and_ps(_mm_and_ps(_mm_cmple_ps(enterT, exitT),
+                                     _mm_cmpge_ps(exitT, _mm_setzero_ps())),
+                          _mm_cmple_ps(enterT, _mm_mul_ps(maxTs, padding)));
+    }
+}
+
+void TriangleBVH::CastRayPacket(const Vector3f* rayStarts, const Vector3f* rayDirs, RayHit* outHits,
+                                float maxT) const
+{
+    Vector3f4 starts(rayStarts),
+              dirs(rayDirs);
+    Vector3f invRayDirs[4] = { GetInverseDir(rayDirs[0]), GetInverseDir(rayDirs[1]),
+                               GetInverseDir(rayDirs[2]), GetInverseDir(rayDirs[3]) };
+    Vector3f4 invDirs(invRayDirs);
+
+    const __m128 zero = _mm_setzero_ps(),
+                 one = _mm_set1_ps(1.0f);
+    __m128 closestTs = _mm_set1_ps(maxT),
+           hitUs = zero,
+           hitVs = zero,
+           didHit = zero;
+    __m128i hitTriangles = _mm_setzero_si128();
+
+    unsigned int stack[STACK_SIZE];
+    unsigned int stackSize = 0;
+    unsigned int nodeIndex = 0;
+    while (true)
+    {
+        const Node& node = nodes[nodeIndex];
+        if (_mm_movemask_ps(RaysHitBox(starts, invDirs, node.Min, node.Max, closestTs)) != 0)
+        {
+            if (node.IsLeaf())
+            {
+                for (unsigned int i = node.Offset; i < node.Offset + node.NTriangles; ++i)
+                {
+                    //Same as "RayHitsTriangle()".
+                    Vector3f4 vertex(triangles[i * 3]),
+                              edge1(triangles[(i * 3) + 1]),
+                              edge2(triangles[(i * 3) + 2]);
+
+                    Vector3f4 p = dirs.Cross(edge2);
+                    __m128 determinant = edge1.Dot(p);
+                    __m128 invDeterminant = _mm_div_ps(one, determinant);
+
+                    Vector3f4 toStart = starts - vertex;
+                    __m128 u = _mm_mul_ps(toStart.Dot(p), invDeterminant);
+                    Vector3f4 q = toStart.Cross(edge1);
+                    __m128 v = _mm_mul_ps(dirs.Dot(q), invDeterminant),
+                           t = _mm_mul_ps(edge2.Dot(q), invDeterminant);
+
+                    __m128 isHit = _mm_and_ps(_mm_cmpneq_ps(determinant, zero),
+                                              _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+                    isHit = _mm_and_ps(isHit, _mm_and_ps(_mm_cmpge_ps(v, zero),
+                                                         _mm_cmple_ps(_mm_add_ps(u, v), one)));
+                    isHit = _mm_and_ps(isHit, _mm_and_ps(_mm_cmpge_ps(t, zero),
+                                                         _mm_cmple_ps(t, closestTs)));
+
+                    //Only take the hit if it's closer, if it's the first hit,
+                    //    or if it's at the same distance as the last hit but has a lower triangle index
+                    //    (the same as "CastRay()").
+                    //The only hits left at this point are no farther than the closest one so far.
+                    __m128i triangle = _mm_set1_epi32((int)triangleIndices[i]);
+                    __m128 isLowerIndex = _mm_castsi128_ps(_mm_cmplt_epi32(triangle, hitTriangles));
+                    isHit = _mm_and_ps(isHit, _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(t, closestTs),
+                                                                  _mm_cmpeq_ps(didHit, zero)),
+                                                        isLowerIndex));
+                    if (_mm_movemask_ps(isHit) == 0)
+                        continue;
+
+                    #define TRIANGLEBVH_SELECT(mask, ifTrue, ifFalse) \
+                        _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse))
+                    closestTs = TRIANGLEBVH_SELECT(isHit, t, closestTs);
+                    hitUs = TRIANGLEBVH_SELECT(isHit, u, hitUs);
+                    hitVs = TRIANGLEBVH_SELECT(isHit, v, hitVs);
+                    hitTriangles = _mm_castps_si128(TRIANGLEBVH_SELECT(isHit, _mm_castsi128_ps(triangle),
+                                                                       _mm_castsi128_ps(hitTriangles)));
+                    didHit = _mm_or_ps(didHit, isHit);
+                    #undef TRIANGLEBVH_SELECT
+                }
+            }
+            else
+            {
+                //Visit the near child first, going by the first ray's direction.
+                assert(stackSize < STACK_SIZE);
+                if (rayDirs[0][node.SplitAxis] >= 0.0f)
+                {
+                    stack[stackSize++] = node.Offset;
+                    nodeIndex += 1;
+                }
+                else
+                {
+                    stack[stackSize++] = nodeIndex + 1;
+                    nodeIndex = node.Offset;
+                }
+                continue;
+            }
+        }
+
+        if (stackSize == 0)
+            break;
+        nodeIndex = stack[--stackSize];
+    }
+
+    float ts[4], us[4], vs[4];
+    unsigned int tris[4];
+    _mm_storeu_ps(ts, closestTs);
+    _mm_storeu_ps(us, hitUs);
+    _mm_storeu_ps(vs, hitVs);
+    _mm_storeu_si128((__m128i*)tris, hitTriangles);
+    int hitMask = _mm_movemask_ps(didHit);
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        outHits[i] = RayHit();
+        if ((hitMask & (1 << i)) != 0)
+        {
+            outHits[i].DidHit = true;
+            outHits[i].Triangle = tris[i];
+            outHits[i].T = ts[i];
+            outHits[i].U = us[i];
+            outHits[i].V = vs[i];
+        }
+    }
+}
+
+#else
+
+void TriangleBVH::CastRayPacket(const Vector3f* rayStarts, const Vector3f* rayDirs, RayHit* outHits,
+                                float maxT) const
+{
+    for (unsigned int i = 0; i < 4; ++i)
+        outHits[i] = CastRay(rayStarts[i], rayDirs[i], maxT);
+}
+
+#endif
+
+void TriangleBVH::CastRays(const Vector3f* rayStarts, const Vector3f* rayDirs, RayHit* outHits,
+                           unsigned int nRays, float maxT, ThreadPool* threads) const
+{
+    if (nodes.empty())
+    {
+        for (unsigned int i = 0; i < nRays; ++i)
+            outHits[i] = RayHit();
+        return;
+    }
+
+    unsigned int nPackets = nRays / 4;
+    auto doPacket = [this, rayStarts, rayDirs, outHits, maxT](unsigned int packet)
+    {
+        CastRayPacket(rayStarts + (packet * 4), rayDirs + (packet * 4), outHits + (packet * 4), maxT);
+    };
+    if (threads == 0)
+    {
+        for (unsigned int packet = 0; packet < nPackets; ++packet)
+            doPacket(packet);
+    }
+    else
+    {
+        threads->ParallelFor(nPackets, doPacket, PACKETS_PER_CHUNK);
+    }
+
+    //Do the leftover rays one at a time.
+    for (unsigned int i = nPackets * 4; i < nRays; ++i)
+        outHits[i] = CastRay(rayStarts[i], rayDirs[i], maxT);
+}
+
+#pragma endregion
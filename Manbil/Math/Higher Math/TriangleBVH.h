@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include "../Shapes/Boxes.h"
+
+class ThreadPool;
+
+
+//A bounding volume hierarchy over a static triangle mesh, for fast ray casts against real geometry
+//    (picking, hitscan weapons, line of sight, etc).
+//Built with the surface area heuristic, and stored as a flat array of nodes in depth-first order
+//    so that traversal mostly walks forward through memory.
+class TriangleBVH
+{
+public:
+
+    //The result of casting a ray into the mesh.
+    struct RayHit
+    {
+        bool DidHit;
+        //The index of the triangle that was hit, in the same order as the triangles it was built from.
+        unsigned int Triangle;
+        //The hit position is [ray start] + ([ray direction] * T).
+        float T;
+        //The barycentric coordinates of the hit position:
+        //    [first vertex] * (1 - U - V) + [second vertex] * U + [third vertex] * V.
+        float U, V;
+
+        RayHit(void) : DidHit(false), Triangle(0), T(0.0f), U(0.0f), V(0.0f) { }
+    };
+
+
+    //Builds this hierarchy from the given triangles, replacing whatever it had before.
+    //Every three indices make a triangle.
+    //If "threads" isn't 0, large parts of the tree are built in parallel on its threads.
+    void Build(const Vector3f* positions, const unsigned int* indices, unsigned int nTriangles,
+               ThreadPool* threads = 0)
+    {
+        Build(positions, sizeof(Vector3f), indices, nTriangles, threads);
+    }
+    //Builds this hierarchy from the given triangles, replacing whatever it had before.
+    //"vertexPositions" points to the first vertex's position, and each vertex's position is
+    //    "vertexStride" bytes after the previous one's, so the positions can be read straight out of
+    //    an array of vertices (e.x. a "MeshData" instance's local copy of its vertex data).
+    //Every three indices make a triangle.
+    //If "threads" isn't 0, large parts of the tree are built in parallel on its threads.
+    void Build(const void* vertexPositions, unsigned int vertexStride,
+               const unsigned int* indices, unsigned int nTriangles,
+               ThreadPool* threads = 0);
+
+    //Removes all triangles from this hierarchy.
+    void Clear(void);
+
+
+    unsigned int GetNTriangles(void) const { return (unsigned int)triangleIndices.size(); }
+    unsigned int GetNNodes(void) const { return (unsigned int)nodes.size(); }
+
+    //Gets the bounds of every triangle in this hierarchy.
+    //Assumes the hierarchy isn't empty.
+    Box3D GetBounds(void) const;
+
+
+    //Finds the closest triangle hit by the given ray, looking only at "t" values from 0 to "maxT".
+    //The ray's direction doesn't have to be normalized. Triangles are hit from either side.
+    RayHit CastRay(Vector3f rayStart, Vector3f rayDir,
+                   float maxT = std::numeric_limits<float>::infinity()) const;
+    //Finds whether the given ray hits any triangle at a "t" value from 0 to "maxT".
+    //Faster than "CastRay()", since it stops as soon as any hit is found.
+    bool HitsAnything(Vector3f rayStart, Vector3f rayDir,
+                      float maxT = std::numeric_limits<float>::infinity()) const;
+
+    //Casts many rays at once, outputting the closest hit for each one into "outHits".
+    //The rays are traced in packets of four that travel through the tree together,
+    //    which is fastest when rays next to each other in the arrays point in similar directions.
+    //If "threads" isn't 0, the packets are split up across its threads.
+    void CastRays(const Vector3f* rayStarts, const Vector3f* rayDirs, RayHit* outHits, unsigned int nRays,
+                  float maxT = std::numeric_limits<float>::infinity(), ThreadPool* threads = 0) const;
+
+
+private:
+
+    //A node in the tree. Each node is 32 bytes.
+    struct Node
+    {
+        Vector3f Min;
+        //For leaves, the index of the first triangle in "triangles".
+        //For branches, the index of the second child. The first child is always right after this node.
+        unsigned int Offset;
+        Vector3f Max;
+        //The number of triangles in this leaf, or 0 if this is a branch.
+        unsigned short NTriangles;
+        //For branches, the axis that the children were split along.
+        unsigned short SplitAxis;
+
+        bool IsLeaf(void) const { return NTriangles > 0; }
+    };
+
+    std::vector<Node> nodes;
+    //Each triangle's first vertex followed by its two edges coming out of that vertex,
+    //    in the order that the leaves reference them.
+    std::vector<Vector3f> triangles;
+    //The original index of each triangle in "triangles".
+    std::vector<unsigned int> triangleIndices;
+
+
+    //Casts the four rays starting at the given index.
+    void CastRayPacket(const Vector3f* rayStarts, const Vector3f* rayDirs, RayHit* outHits, float maxT) const;
+};
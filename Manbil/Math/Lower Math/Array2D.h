@@ -1,14 +1,148 @@
 #pragma once
 
+#include <new>
+#include <type_traits>
+#include <assert.h>
+#include <string.h>
 #include "Vectors.h"
+#include "../../MemoryAllocator.h"
 
 #pragma warning(disable: 4018)
 
 
+//Controls how an Array2D or Array3D stores its elements.
+struct ArrayStorage
+{
+    //Where the elements' memory comes from. 0 means the normal heap.
+    MemoryAllocator* Allocator;
+    //The alignment (in bytes) of the first element.
+    //The element type's own alignment is used instead if it's bigger.
+    unsigned int Alignment;
+    //Each row's length is padded up to a multiple of this many elements,
+    //    so that every row starts aligned (e.x. 4 for rows of floats that are processed with SSE).
+    //1 means no padding. Only Array2D uses this.
+    unsigned int RowMultiple;
+
+    explicit ArrayStorage(MemoryAllocator* allocator = 0,
+                          unsigned int alignment = MemoryAllocator::DEFAULT_ALIGNMENT,
+                          unsigned int rowMultiple = 1)
+        : Allocator(allocator), Alignment(alignment), RowMultiple(rowMultiple) { }
+
+    MemoryAllocator& GetAllocator(void) const { return (Allocator == 0 ? MemoryAllocator::GetHeap() : *Allocator); }
+};
+
+
+//The type of item in the span. May be const.
+template<class ArrayType>
+//A contiguous run of elements, e.x. one row of an Array2D.
+//Can be used in a range-based "for" loop.
+struct ArraySpan
+{
+    ArrayType* Start;
+    unsigned int Count;
+
+    ArraySpan(ArrayType* start, unsigned int count) : Start(start), Count(count) { }
+
+    ArrayType& operator[](unsigned int i) const { assert(i < Count); return Start[i]; }
+
+    ArrayType* begin(void) const { return Start; }
+    ArrayType* end(void) const { return Start + Count; }
+};
+
+
+//The type of item in the view. Make it const for a read-only view.
+template<class ArrayType>
+//A non-owning window onto a rectangular region of an Array2D (or any other grid of elements
+//    stored as rows), so that code can work on part of an array without copying it.
+//Only valid until the array it looks at is resized or destroyed.
+class Array2DView
+{
+public:
+
+    //Creates an empty view.
+    Array2DView(void) : first(0), width(0), height(0), rowStride(0) { }
+    //Creates a view of a grid whose rows are "rowStride" elements apart.
+    Array2DView(ArrayType* firstElement, unsigned int _width, unsigned int _height, unsigned int _rowStride)
+        : first(firstElement), width(_width), height(_height), rowStride(_rowStride)
+    {
+        assert(rowStride >= width || height <= 1);
+    }
+    //Allows a read-only view to be made from a writable one.
+    template<class OtherType>
+    Array2DView(const Array2DView<OtherType>& other)
+        : first(other.GetFirst()), width(other.GetWidth()), height(other.GetHeight()),
+          rowStride(other.GetRowStride()) { }
+
+
+    ArrayType& operator[](Vector2u l) const { return first[GetIndex(l.x, l.y)]; }
+
+
+    unsigned int GetWidth(void) const { return width; }
+    unsigned int GetHeight(void) const { return height; }
+    Vector2u GetDimensions(void) const { return Vector2u(width, height); }
+    //Gets the distance (in elements) between the start of each row.
+    unsigned int GetRowStride(void) const { return rowStride; }
+    //Gets the element at (0, 0).
+    ArrayType* GetFirst(void) const { return first; }
+
+    //Gets the offset (in elements) of the given position from the first element.
+    unsigned int GetIndex(unsigned int x, unsigned int y) const
+    {
+        assert(x < width && y < height);
+        return x + (y * rowStride);
+    }
+
+    //Gets the elements in the given row.
+    ArraySpan<ArrayType> GetRow(unsigned int y) const
+    {
+        assert(y < height);
+        return ArraySpan<ArrayType>(first + (y * rowStride), width);
+    }
+
+    //Gets a view of a rectangular region of this view.
+    Array2DView<ArrayType> GetSubView(Vector2u topLeft, Vector2u size) const
+    {
+        assert(topLeft.x + size.x <= width && topLeft.y + size.y <= height);
+        return Array2DView<ArrayType>(first + (topLeft.x + (topLeft.y * rowStride)),
+                                      size.x, size.y, rowStride);
+    }
+
+
+    //Sets every element in this view to the given value.
+    void Fill(const ArrayType& value) const
+    {
+        for (unsigned int y = 0; y < height; ++y)
+            for (ArrayType& element : GetRow(y))
+                element = value;
+    }
+    //Copies the given view's elements into this one. Assumes they're the same size.
+    template<class OtherType>
+    void Fill(const Array2DView<OtherType>& toCopy) const
+    {
+        assert(width == toCopy.GetWidth() && height == toCopy.GetHeight());
+        for (unsigned int y = 0; y < height; ++y)
+        {
+            ArraySpan<ArrayType> row = GetRow(y);
+            ArraySpan<OtherType> otherRow = toCopy.GetRow(y);
+            for (unsigned int x = 0; x < width; ++x)
+                row.Start[x] = otherRow.Start[x];
+        }
+    }
+
+
+private:
+
+    ArrayType* first;
+    unsigned int width, height, rowStride;
+};
+
+
 //The type of item this array contains. Should generally be trivially-copiable/assignable.
 template<class ArrayType>
-//Wraps a contiguous heap-allocated one-dimensional array
-//    so it can be treated like a two-dimensional array.
+//Wraps an aligned one-dimensional array so it can be treated like a two-dimensional array.
+//Each row is stored contiguously, and rows are "GetRowStride()" elements apart;
+//    unless the array was given an "ArrayStorage" with a "RowMultiple" above 1,
+//    there's no padding and the whole array is contiguous.
 //The most cache-efficient way to loop through this array is through
 //    the Y in the outer loop and then the X in the inner loop.
 class Array2D
@@ -16,56 +150,64 @@ class Array2D
 public:
 
 	//Creates a new Array2D without initializing any of the values.
-	Array2D(unsigned int aWidth, unsigned int aHeight)
+	Array2D(unsigned int aWidth, unsigned int aHeight, const ArrayStorage& _storage = ArrayStorage())
+        : width(aWidth), height(aHeight), storage(_storage), arrayVals(0)
 	{
-		width = aWidth;
-		height = aHeight;
-
-		arrayVals = new ArrayType[width * height];
+        Allocate();
 	}
-    Array2D(unsigned int aWidth, unsigned int aHeight, const ArrayType & defaultValue)
+    Array2D(unsigned int aWidth, unsigned int aHeight, const ArrayType & defaultValue,
+            const ArrayStorage& _storage = ArrayStorage())
+        : width(aWidth), height(aHeight), storage(_storage), arrayVals(0)
 	{
-		width = aWidth;
-		height = aHeight;
-
-		arrayVals = new ArrayType[width * height];
-
-        for (unsigned int i = 0; i < width * height; ++i)
-		{
-			arrayVals[i] = defaultValue;
-		}
+        Allocate();
+        Fill(defaultValue);
 	}
 
-    //Move semantics.
-    Array2D(Array2D&& toMove) : arrayVals(0) { *this = std::move(toMove); }
-    Array2D& operator=(Array2D&& toMove)
+    //Copying uses the same storage options as the array being copied.
+    Array2D(const Array2D<ArrayType>& cpy)
+        : width(cpy.width), height(cpy.height), storage(cpy.storage), arrayVals(0)
+    {
+        Allocate();
+        CopyRows(cpy.arrayVals, cpy.rowStride, arrayVals, rowStride, width, height, false);
+    }
+    Array2D& operator=(const Array2D<ArrayType>& cpy)
     {
-        if (arrayVals != 0)
+        if (this != &cpy)
         {
-            delete[] arrayVals;
+            Reset(cpy.width, cpy.height);
+            CopyRows(cpy.arrayVals, cpy.rowStride, arrayVals, rowStride, width, height, false);
         }
+        return *this;
+    }
+
+    //Move semantics.
+    Array2D(Array2D&& toMove) : width(0), height(0), rowStride(0), arrayVals(0) { *this = std::move(toMove); }
+    Array2D& operator=(Array2D&& toMove)
+    {
+        if (this == &toMove)
+            return *this;
+
+        Deallocate();
 
         width = toMove.width;
         height = toMove.height;
+        rowStride = toMove.rowStride;
+        storage = toMove.storage;
         arrayVals = toMove.arrayVals;
 
         toMove.width = 0;
         toMove.height = 0;
+        toMove.rowStride = 0;
         toMove.arrayVals = 0;
 
         return *this;
     }
 
     Array2D(void) = delete;
-    Array2D(const Array2D<ArrayType>& cpy) = delete;
-    Array2D & operator=(const Array2D<ArrayType>& other) = delete;
 
 	~Array2D(void)
 	{
-        if (arrayVals != 0)
-        {
-		    delete[] arrayVals;
-        }
+        Deallocate();
 	}
 
 
@@ -80,22 +222,55 @@ public:
     //Gets the size of this array along each axis.
     Vector2u GetDimensions(void) const { return Vector2u(width, height); }
 
+    //Gets the distance (in elements) between the start of each row.
+    unsigned int GetRowStride(void) const { return rowStride; }
+    //Gets whether the rows have no padding between them,
+    //    so the whole array is one contiguous block of "GetNumbElements()" elements.
+    bool IsContiguous(void) const { return rowStride == width || height <= 1; }
+    //Gets the options this array was created with.
+    const ArrayStorage& GetStorage(void) const { return storage; }
+
+
+    //Gets the elements in the given row.
+    ArraySpan<ArrayType> GetRow(unsigned int y) { return GetView().GetRow(y); }
+    //Gets the elements in the given row.
+    ArraySpan<const ArrayType> GetRow(unsigned int y) const { return GetView().GetRow(y); }
+
+    //Gets a view of this whole array.
+    Array2DView<ArrayType> GetView(void)
+    {
+        return Array2DView<ArrayType>(arrayVals, width, height, rowStride);
+    }
+    //Gets a view of this whole array.
+    Array2DView<const ArrayType> GetView(void) const
+    {
+        return Array2DView<const ArrayType>(arrayVals, width, height, rowStride);
+    }
+    //Gets a view of a rectangular region of this array.
+    Array2DView<ArrayType> GetView(Vector2u topLeft, Vector2u size) { return GetView().GetSubView(topLeft, size); }
+    //Gets a view of a rectangular region of this array.
+    Array2DView<const ArrayType> GetView(Vector2u topLeft, Vector2u size) const { return GetView().GetSubView(topLeft, size); }
+
 
     //Resets this array to the given size and leaves its elements uninitialized.
-    //If the total number of elements doesn't change, then nothing is allocated or un-allocated
-    //    and the elements keep their values.
+    //If the total number of elements (including row padding) doesn't change,
+    //    then nothing is allocated or un-allocated and the elements keep their values.
     void Reset(unsigned int _width, unsigned int _height)
 	{
-        //Only resize if the current array does not have the same number of elements.
-        if ((width * height) != (_width * _height))
+        //Only re-allocate if the current array does not have the same number of elements.
+        if ((rowStride * height) != (GetPaddedWidth(_width) * _height))
         {
-            assert(arrayVals != 0);
-            delete[] arrayVals;
-            arrayVals = new ArrayType[_width * _height];
+            Deallocate();
+            width = _width;
+            height = _height;
+            Allocate();
+        }
+        else
+        {
+            width = _width;
+            height = _height;
+            rowStride = GetPaddedWidth(_width);
         }
-
-        width = _width;
-        height = _height;
 	}
     //Resets this array to the given size and initializes all elements to the given value.
     void Reset(unsigned int _width, unsigned int _height, const ArrayType& newValues)
@@ -108,12 +283,12 @@ public:
     //Gets the array index for the given position.
     unsigned int GetIndex(unsigned int x, unsigned int y) const
     {
-        return x + (y * width);
+        return x + (y * rowStride);
     }
     //Gets the location in this array that corresponds to the given array index.
     Vector2u GetLocation(unsigned int index) const
     {
-        return Vector2u(index % width, index / width);
+        return Vector2u(index % rowStride, index / rowStride);
     }
 
 
@@ -185,7 +360,7 @@ public:
 	//Fills every element with the given value.
 	void Fill(const ArrayType& value)
 	{
-        for (unsigned int i = 0; i < width * height; ++i)
+        for (unsigned int i = 0; i < rowStride * height; ++i)
 			arrayVals[i] = value;
 	}
     //Copies the given array into this one. The given array may be offset a certain amount.
@@ -219,13 +394,10 @@ public:
     //Assumes that the size of this array matches with the given one.
     //If "useMemcpy" is true, this array will have its exact binary data copied quickly using memcpy.
     //Otherwise, each element will be set using its assignment operator.
+    //The given elements are assumed to be contiguous, with no row padding.
     void Fill(const ArrayType* values, bool useMemcpy)
     {
-        if (useMemcpy)
-            memcpy(arrayVals, values, width * height * sizeof(ArrayType));
-
-        else for (unsigned int i = 0; i < (width * height); ++i)
-            arrayVals[i] = values[i];
+        CopyRows(values, width, arrayVals, rowStride, width, height, useMemcpy);
     }
 
     //A function with signature "void GetValue(Vector2u index, ArrayType* outNewValue)".
@@ -257,7 +429,8 @@ public:
         {
             case 0:
                 outArray.Reset(width, height);
-                outArray.Fill(arrayVals, useFastCopy);
+                CopyRows(arrayVals, rowStride, outArray.arrayVals, outArray.rowStride,
+                         width, height, useFastCopy);
                 break;
 
             case 1:
@@ -299,8 +472,7 @@ public:
         if (width != newWidth || height != newHeight)
         {
             //Create a copy of this array.
-            Array2D<ArrayType> cpy(width, height);
-            cpy.Fill(arrayVals, true);
+            Array2D<ArrayType> cpy(*this);
 
             //Resize this array and fill it with the old values.
             Reset(newWidth, newHeight, defaultVal);
@@ -310,30 +482,80 @@ public:
 
 
     //Gets a pointer to the first element in this array.
+    //Each row is "GetRowStride()" elements after the previous one.
     const ArrayType* GetArray(void) const { return arrayVals; }
     //Gets a pointer to the first element in this array.
+    //Each row is "GetRowStride()" elements after the previous one.
     ArrayType* GetArray(void) { return arrayVals; }
     
     //Copies this array into the given one using "memcpy", which is as fast as possible.
-    //Assumes the given array is the same size as this one.
+    //Assumes the given array is the same size as this one, with no row padding.
     void MemCopyInto(ArrayType* outValues) const
     {
-        memcpy(outValues, arrayVals, width * height * sizeof(ArrayType));
+        CopyRows(arrayVals, rowStride, outValues, width, width, height, true);
     }
     //Copies this array into the given one using the assignment operator for each value.
-    //Assumes it is the same size as this array.
+    //Assumes it is the same size as this array, with no row padding.
     //Use this instead of "MemCopyInto" if the items are too complex to just copy their byte-data over.
 	void CopyInto(ArrayType* outValues) const
 	{
-        for (unsigned int i = 0; i < width * height; ++i)
-			outValues[i] = arrayVals[i];
+        CopyRows(arrayVals, rowStride, outValues, width, width, height, false);
 	}
 
 
 private:
 
-    unsigned int width, height;
+    unsigned int width, height, rowStride;
+    ArrayStorage storage;
 	ArrayType* arrayVals;
+
+
+    //Gets the row stride for the given width, given this array's storage options.
+    unsigned int GetPaddedWidth(unsigned int _width) const
+    {
+        unsigned int multiple = Mathf::Max(1U, storage.RowMultiple);
+        return ((_width + multiple - 1) / multiple) * multiple;
+    }
+
+    //Allocates and default-constructs the elements for this array's current size.
+    void Allocate(void)
+    {
+        rowStride = GetPaddedWidth(width);
+        size_t nElements = (size_t)rowStride * height,
+               alignment = Mathf::Max((size_t)storage.Alignment,
+                                      (size_t)std::alignment_of<ArrayType>::value);
+
+        arrayVals = (ArrayType*)storage.GetAllocator().Allocate(nElements * sizeof(ArrayType), alignment);
+        for (size_t i = 0; i < nElements; ++i)
+            new (&arrayVals[i]) ArrayType;
+    }
+    //Destroys and un-allocates this array's elements.
+    void Deallocate(void)
+    {
+        if (arrayVals == 0)
+            return;
+
+        for (size_t i = 0; i < (size_t)rowStride * height; ++i)
+            arrayVals[i].~ArrayType();
+        storage.GetAllocator().Deallocate(arrayVals);
+        arrayVals = 0;
+    }
+
+    //Copies a grid of elements from one place to another, one row at a time.
+    static void CopyRows(const ArrayType* src, unsigned int srcStride, ArrayType* dest, unsigned int destStride,
+                         unsigned int _width, unsigned int _height, bool useMemcpy)
+    {
+        for (unsigned int y = 0; y < _height; ++y)
+        {
+            const ArrayType* srcRow = src + (y * srcStride);
+            ArrayType* destRow = dest + (y * destStride);
+
+            if (useMemcpy)
+                memcpy(destRow, srcRow, _width * sizeof(ArrayType));
+            else for (unsigned int x = 0; x < _width; ++x)
+                destRow[x] = srcRow[x];
+        }
+    }
 };
 
 #pragma warning(default: 4018)
\ No newline at end of file
@@ -1,13 +1,13 @@
 #pragma once
 
-#include "Vectors.h"
+#include "Array2D.h"
 
 #pragma warning(disable: 4018)
 
 
 //The type of item this array contains. Should generally be trivially-copiable/assignable.
 template<class ArrayType>
-//Wraps a contiguous heap-allocated one-dimensional array so it can be treated like
+//Wraps a contiguous, aligned one-dimensional array so it can be treated like
 //    a three-dimensional array.
 //The most cache-efficient way to loop through this array is through
 //    the Z in the outer loop, then the Y in the middle loop, and then the X in the inner loop.
@@ -16,40 +16,51 @@ class Array3D
 public:
 
 	//Creates a new Array3D without initializing any of the values.
-	Array3D(unsigned int aWidth, unsigned int aHeight, unsigned int aDepth)
+    //The storage's "RowMultiple" is ignored; Array3D rows are never padded.
+	Array3D(unsigned int aWidth, unsigned int aHeight, unsigned int aDepth,
+            const ArrayStorage& _storage = ArrayStorage())
+        : width(aWidth), height(aHeight), depth(aDepth), storage(_storage), arrayVals(0)
 	{
-		width = aWidth;
-		height = aHeight;
-        depth = aDepth;
-
-		arrayVals = new ArrayType[width * height * depth];
+        Allocate();
 	}
-    Array3D(unsigned int aWidth, unsigned int aHeight, unsigned int aDepth, const ArrayType& defaultValue)
+    Array3D(unsigned int aWidth, unsigned int aHeight, unsigned int aDepth, const ArrayType& defaultValue,
+            const ArrayStorage& _storage = ArrayStorage())
+        : width(aWidth), height(aHeight), depth(aDepth), storage(_storage), arrayVals(0)
 	{
-		width = aWidth;
-        height = aHeight;
-        depth = aDepth;
-
-		arrayVals = new ArrayType[width * height * depth];
-
-        for (unsigned int i = 0; i < width * height * depth; ++i)
-		{
-			arrayVals[i] = defaultValue;
-		}
+        Allocate();
+        Fill(defaultValue);
 	}
 
-    //Move semantics
-    Array3D(Array3D&& toMove) : arrayVals(0) { *this = std::move(toMove); }
-    Array3D& operator=(Array3D&& toMove)
+    //Copying uses the same storage options as the array being copied.
+    Array3D(const Array3D<ArrayType>& cpy)
+        : width(cpy.width), height(cpy.height), depth(cpy.depth), storage(cpy.storage), arrayVals(0)
+    {
+        Allocate();
+        cpy.CopyInto(arrayVals);
+    }
+    Array3D& operator=(const Array3D<ArrayType>& cpy)
     {
-        if (arrayVals != 0)
+        if (this != &cpy)
         {
-            delete[] arrayVals;
+            Reset(cpy.width, cpy.height, cpy.depth);
+            cpy.CopyInto(arrayVals);
         }
+        return *this;
+    }
+
+    //Move semantics
+    Array3D(Array3D&& toMove) : width(0), height(0), depth(0), arrayVals(0) { *this = std::move(toMove); }
+    Array3D& operator=(Array3D&& toMove)
+    {
+        if (this == &toMove)
+            return *this;
+
+        Deallocate();
 
         width = toMove.width;
         height = toMove.height;
         depth = toMove.depth;
+        storage = toMove.storage;
         arrayVals = toMove.arrayVals;
 
         toMove.width = 0;
@@ -61,12 +72,10 @@ public:
     }
 
     Array3D(void) = delete;
-    Array3D(const Array3D<ArrayType>& cpy) = delete;
-    Array3D & operator=(const Array3D<ArrayType>& other) = delete;
 
     ~Array3D(void)
 	{
-		delete[] arrayVals;
+        Deallocate();
 	}
 
 
@@ -82,6 +91,22 @@ public:
     unsigned int GetDepth(void) const { return depth; }
     //Gets the size of this array along each axis.
     Vector3u GetDimensions(void) const { return Vector3u(width, height, depth); }
+    //Gets the options this array was created with.
+    const ArrayStorage& GetStorage(void) const { return storage; }
+
+
+    //Gets a view of the given Z slice of this array.
+    Array2DView<ArrayType> GetSlice(unsigned int z)
+    {
+        assert(z < depth);
+        return Array2DView<ArrayType>(&arrayVals[GetIndex(0, 0, z)], width, height, width);
+    }
+    //Gets a view of the given Z slice of this array.
+    Array2DView<const ArrayType> GetSlice(unsigned int z) const
+    {
+        assert(z < depth);
+        return Array2DView<const ArrayType>(&arrayVals[GetIndex(0, 0, z)], width, height, width);
+    }
 
 
     //Resets this array to the given size and leaves its elements uninitialized.
@@ -91,21 +116,25 @@ public:
 	{
         if ((width * height * depth) != (_width * _height * _depth))
         {
-            assert(arrayVals != 0);
-            delete[] arrayVals;
-            arrayVals = new ArrayType[_width * _height * _depth];
+            Deallocate();
+            width = _width;
+            height = _height;
+            depth = _depth;
+            Allocate();
+        }
+        else
+        {
+            width = _width;
+            height = _height;
+            depth = _depth;
         }
-
-        width = _width;
-        height = _height;
-        depth = _depth;
 	}
     //Resets this array to the given size, and initializes all elements to the given value.
     void Reset(unsigned int _width, unsigned int _height, unsigned int _depth,
                const ArrayType& newValues)
 	{
 		Reset(_width, _height, _depth);
-        Fill(newValues)
+        Fill(newValues);
 	}
     
 
@@ -117,7 +146,7 @@ public:
     //Gets the location in this array that corresponds to the given index.
     Vector3u GetLocation(unsigned int index) const
     {
-        return Vector3u(index % width, index / width, index / (width * height));
+        return Vector3u(index % width, (index / width) % height, index / (width * height));
     }
 
 
@@ -138,7 +167,7 @@ public:
     //Clamps the given index to be inside the range of allowable indices for this array.
     Vector3f Clamp(Vector3f in) const
     {
-        return Vector3f(Mathf::Clamp<float>(in.x, 0.0f, GetWidth - 1),
+        return Vector3f(Mathf::Clamp<float>(in.x, 0.0f, GetWidth() - 1),
                         Mathf::Clamp<float>(in.y, 0.0f, GetHeight() - 1),
                         Mathf::Clamp<float>(in.z, 0.0f, GetDepth() - 1));
     }
@@ -159,7 +188,7 @@ public:
     //Wraps the given index around the range of allowable indices for this array.
     Vector3u Wrap(Vector3u in) const
     {
-        return Vector3u(in.x % GetWidth(), in.y % GetHeight(), inZ % GetDepth());
+        return Vector3u(in.x % GetWidth(), in.y % GetHeight(), in.z % GetDepth());
     }
     //Wraps the given index around the range of allowable indices for this array.
     Vector3f Wrap(Vector3f in) const
@@ -171,9 +200,9 @@ public:
         while (in.y < 0.0f) in.y += fDims.y;
         while (in.z < 0.0f) in.z += fDims.z;
 
-        in.x %= GetWidth();
-        in.y %= GetHeight();
-        in.z %= GetDepth();
+        in.x = fmodf(in.x, fDims.x);
+        in.y = fmodf(in.y, fDims.y);
+        in.z = fmodf(in.z, fDims.z);
 
         return in;
     }
@@ -207,29 +236,29 @@ public:
     {
         Vector3i offsetLoc;
 
-        for (Vector3u loc; loc.z < depth; ++loc.z)
+        for (Vector3u loc; loc.z < toCopy.depth; ++loc.z)
         {
             offsetLoc.z = (int)loc.z + copyOffset.z;
 
             if (offsetLoc.z < 0)
                 continue;
-            if (offsetLoc.z >= depth)
+            if (offsetLoc.z >= (int)depth)
                 break;
 
-            for (loc.y = 0; loc.y < height; ++loc.y)
+            for (loc.y = 0; loc.y < toCopy.height; ++loc.y)
             {
                 offsetLoc.y = (int)loc.y + copyOffset.y;
 
                 if (offsetLoc.y < 0)
                     continue;
-                if (offsetLoc.y >= height)
+                if (offsetLoc.y >= (int)height)
                     break;
 
-                for (loc.x = 0; loc.x < width; ++loc.x)
+                for (loc.x = 0; loc.x < toCopy.width; ++loc.x)
                 {
                     offsetLoc.x = (int)loc.x + copyOffset.x;
 
-                    if (offsetLoc.x >= width)
+                    if (offsetLoc.x >= (int)width)
                         break;
 
                     if (offsetLoc.x >= 0)
@@ -245,9 +274,9 @@ public:
     void Fill(const ArrayType* values, bool useMemcpy)
     {
         if (useMemcpy)
-            memcpy(arrayVals, values, width * height * sizeof(ArrayType));
+            memcpy(arrayVals, values, width * height * depth * sizeof(ArrayType));
 
-        else for (unsigned int i = 0; i < (width * height); ++i)
+        else for (unsigned int i = 0; i < (width * height * depth); ++i)
             arrayVals[i] = values[i];
     }
 
@@ -269,15 +298,14 @@ public:
     void Resize(unsigned int newWidth, unsigned int newHeight, unsigned int newDepth,
                 const ArrayType& defaultVal)
     {
-        if (width != newWi || height != newHeight || depth != newDepth)
+        if (width != newWidth || height != newHeight || depth != newDepth)
         {
-            //Create a new version of this array with the new values.
-            Array3D<ArrayType> newArr(newWidth, newHeight, newDepth);
-            newArr.Fill(*this, defaultVal);
+            //Create a copy of this array.
+            Array3D<ArrayType> cpy(*this);
 
-            //Fill this array with those values.
-            Reset(newWidth, newHeight, newDepth);
-            Fill(newArr, defaultValue);
+            //Resize this array and fill it with the old values.
+            Reset(newWidth, newHeight, newDepth, defaultVal);
+            Fill(cpy);
         }
     }
 
@@ -305,7 +333,32 @@ public:
 private:
 
     unsigned int width, height, depth;
+    ArrayStorage storage;
 	ArrayType* arrayVals;
+
+
+    //Allocates and default-constructs the elements for this array's current size.
+    void Allocate(void)
+    {
+        size_t nElements = (size_t)width * height * depth,
+               alignment = Mathf::Max((size_t)storage.Alignment,
+                                      (size_t)std::alignment_of<ArrayType>::value);
+
+        arrayVals = (ArrayType*)storage.GetAllocator().Allocate(nElements * sizeof(ArrayType), alignment);
+        for (size_t i = 0; i < nElements; ++i)
+            new (&arrayVals[i]) ArrayType;
+    }
+    //Destroys and un-allocates this array's elements.
+    void Deallocate(void)
+    {
+        if (arrayVals == 0)
+            return;
+
+        for (size_t i = 0; i < (size_t)width * height * depth; ++i)
+            arrayVals[i].~ArrayType();
+        storage.GetAllocator().Deallocate(arrayVals);
+        arrayVals = 0;
+    }
 };
 
 #pragma warning(default: 4018)
\ No newline at end of file
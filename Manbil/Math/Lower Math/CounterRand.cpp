@@ -0,0 +1,157 @@
+#include "CounterRand.h"
+
+
+//Use SSE2 to compute four counters at once if the target supports it.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+    #define COUNTERRAND_USE_SSE
+    #include <emmintrin.h>
+#endif
+
+
+namespace
+{
+    //The constants from the Philox paper.
+    const unsigned int MULTIPLIER_0 = 0xD2511F53,
+                       MULTIPLIER_1 = 0xCD9E8D57;
+    const unsigned int KEY_BUMP_0 = 0x9E3779B9,
+                       KEY_BUMP_1 = 0xBB67AE85;
+    const unsigned int N_ROUNDS = 10;
+
+
+    inline void MulHiLo(unsigned int a, unsigned int b, unsigned int& outHi, unsigned int& outLo)
+    {
+        unsigned long long product = (unsigned long long)a * (unsigned long long)b;
+        outHi = (unsigned int)(product >> 32);
+        outLo = (unsigned int)product;
+    }
+
+    void Philox(unsigned int counter[4], unsigned int key0, unsigned int key1)
+    {
+        for (unsigned int round = 0; round < N_ROUNDS; ++round)
+        {
+            unsigned int hi0, lo0, hi1, lo1;
+            MulHiLo(MULTIPLIER_0, counter[0], hi0, lo0);
+            MulHiLo(MULTIPLIER_1, counter[2], hi1, lo1);
+
+            counter[0] = hi1 ^ counter[1] ^ key0;
+            counter[1] = lo1;
+            counter[2] = hi0 ^ counter[3] ^ key1;
+            counter[3] = lo0;
+
+            key0 += KEY_BUMP_0;
+            key1 += KEY_BUMP_1;
+        }
+    }
+
+
+#ifdef COUNTERRAND_USE_SSE
+    //Does the same thing as "MulHiLo()" on four values at once.
+    inline void MulHiLo4(__m128i a, __m128i b, __m128i& outHi, __m128i& outLo)
+    {
+        //"_mm_mul_epu32" only multiplies the even elements, so do the odd ones separately.
+        __m128i evens = _mm_mul_epu32(a, b),
+                odds = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        __m128i lowHalves = _mm_set_epi32(0, -1, 0, -1),
+                highHalves = _mm_set_epi32(-1, 0, -1, 0);
+        outLo = _mm_or_si128(_mm_and_si128(evens, lowHalves), _mm_slli_epi64(odds, 32));
+        outHi = _mm_or_si128(_mm_srli_epi64(evens, 32), _mm_and_si128(odds, highHalves));
+    }
+
+    //Does the same thing as "Philox()" on four counters at once.
+    //"c0" through "c3" each hold one element of the four counters.
+    void Philox4(__m128i& c0, __m128i& c1, __m128i& c2, __m128i& c3,
+                 unsigned int key0, unsigned int key1)
+    {
+        const __m128i multiplier0 = _mm_set1_epi32((int)MULTIPLIER_0),
+                      multiplier1 = _mm_set1_epi32((int)MULTIPLIER_1);
+        for (unsigned int round = 0; round < N_ROUNDS; ++round)
+        {
+            __m128i hi0, lo0, hi1, lo1;
+            MulHiLo4(multiplier0, c0, hi0, lo0);
+            MulHiLo4(multiplier1, c2, hi1, lo1);
+
+            c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32((int)key0));
+            c1 = lo1;
+            c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32((int)key1));
+            c3 = lo0;
+
+            key0 += KEY_BUMP_0;
+            key1 += KEY_BUMP_1;
+        }
+    }
+
+    //Does the same thing as "CounterRand::ToZeroToOne()" on four values at once.
+    inline __m128 ToZeroToOne4(__m128i bits)
+    {
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(bits, 8)),
+                          _mm_set1_ps(1.0f / 16777216.0f));
+    }
+#endif
+}
+
+
+Vector4u CounterRand::Sample(Vector4u counter) const
+{
+    unsigned int values[4] = { counter.x, counter.y, counter.z, counter.w };
+    Philox(values, Key.x, Key.y);
+    return Vector4u(values[0], values[1], values[2], values[3]);
+}
+Vector4f CounterRand::SampleZeroToOne(Vector4u counter) const
+{
+    Vector4u bits = Sample(counter);
+    return Vector4f(ToZeroToOne(bits.x), ToZeroToOne(bits.y),
+                    ToZeroToOne(bits.z), ToZeroToOne(bits.w));
+}
+
+void CounterRand::GetZeroToOnes(unsigned int firstIndex, float* outValues, unsigned int nValues,
+                                unsigned int stream) const
+{
+    unsigned int index = firstIndex,
+                 endIndex = firstIndex + nValues;
+
+    //Outputs the values from a single counter that are inside the range of indices.
+    auto doCounter = [&]()
+    {
+        Vector4u bits = Sample(Vector4u(index / 4, stream, 0, 0));
+        do
+        {
+            *outValues = ToZeroToOne(bits[index % 4]);
+            outValues += 1;
+            index += 1;
+        } while (index % 4 != 0 && index != endIndex);
+    };
+
+    //Do the values before the first full counter one at a time.
+    if (index % 4 != 0 && index != endIndex)
+        doCounter();
+
+#ifdef COUNTERRAND_USE_SSE
+    //Do four full counters at a time.
+    const __m128i counterOffsets = _mm_set_epi32(3, 2, 1, 0);
+    for (; endIndex - index >= 16; index += 16)
+    {
+        __m128i c0 = _mm_add_epi32(_mm_set1_epi32((int)(index / 4)), counterOffsets),
+                c1 = _mm_set1_epi32((int)stream),
+                c2 = _mm_setzero_si128(),
+                c3 = _mm_setzero_si128();
+        Philox4(c0, c1, c2, c3, Key.x, Key.y);
+
+        //Each register holds one element from each of the four counters;
+        //    transpose them so that each register holds the four elements of one counter.
+        __m128 counter0 = ToZeroToOne4(c0),
+               counter1 = ToZeroToOne4(c1),
+               counter2 = ToZeroToOne4(c2),
+               counter3 = ToZeroToOne4(c3);
+        _MM_TRANSPOSE4_PS(counter0, counter1, counter2, counter3);
+
+        _mm_storeu_ps(outValues, counter0);
+        _mm_storeu_ps(outValues + 4, counter1);
+        _mm_storeu_ps(outValues + 8, counter2);
+        _mm_storeu_ps(outValues + 12, counter3);
+        outValues += 16;
+    }
+#endif
+
+    while (index != endIndex)
+        doCounter();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Vectors.h"
+
+
+//A counter-based PRNG (the "Philox4x32-10" generator from "Parallel Random Numbers: As Easy as 1, 2, 3").
+//Unlike "FastRand", it doesn't have any state that changes; every output is a function of
+//    a 128-bit counter and this generator's 64-bit key.
+//This means any value can be computed directly without computing the ones before it,
+//    so work can be split across threads (by giving each thread a range of counters)
+//    and still get the exact same results as a single thread.
+//The counter can be a position (e.x. "Vector4u(x, y, z, 0)") to get random values for that position,
+//    or it can be an index into a stream of values (see "GetInt()" and "GetZeroToOne()").
+class CounterRand
+{
+public:
+
+    //Converts 32 random bits into a float in the range [0, 1).
+    //Uses the top 24 bits, so every output is evenly spaced and equally likely.
+    static float ToZeroToOne(unsigned int bits) { return (float)(bits >> 8) * (1.0f / 16777216.0f); }
+
+
+    //Generators with different keys give unrelated values for the same counters.
+    Vector2u Key;
+
+
+    CounterRand(unsigned int seed = 1234567, unsigned int seed2 = 0) : Key(seed, seed2) { }
+
+
+    //Gets four random 32-bit values for the given counter.
+    Vector4u Sample(Vector4u counter) const;
+    //Gets four random values in the range [0, 1) for the given counter.
+    Vector4f SampleZeroToOne(Vector4u counter) const;
+
+
+    //The below functions treat this generator as a stream of random values.
+    //The value at "index" comes from the counter "(index / 4, stream, 0, 0)".
+    //Different streams are unrelated to each other.
+
+    unsigned int GetInt(unsigned int index, unsigned int stream = 0) const
+    {
+        return Sample(Vector4u(index / 4, stream, 0, 0))[index % 4];
+    }
+    float GetZeroToOne(unsigned int index, unsigned int stream = 0) const
+    {
+        return ToZeroToOne(GetInt(index, stream));
+    }
+
+    //Fills "outValues" with "GetZeroToOne(i, stream)" for each index i from "firstIndex" onward.
+    //Uses SSE2 to compute four counters at once if the target supports it; the results are the same either way.
+    //To split a large batch across threads, give each thread its own range of indices.
+    void GetZeroToOnes(unsigned int firstIndex, float* outValues, unsigned int nValues,
+                       unsigned int stream = 0) const;
+};
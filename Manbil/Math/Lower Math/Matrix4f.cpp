@@ -11,142 +11,112 @@
 
 
 
-//Smaller matrices are used in finding the determinant/inverse of a 4x4 matrix.
-#pragma region Smaller matrices
+//Use SSE to do four elements at once if the target supports it.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+    #define MATRIX4F_USE_SSE
+    #include <xmmintrin.h>
+#endif
 
-class Matrix2f
+
+namespace
 {
-public:
+    const float IDENTITY_VALUES[4][4] =
+    {
+        { 1.0f, 0.0f, 0.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, 1.0f, 0.0f },
+        { 0.0f, 0.0f, 0.0f, 1.0f },
+    };
 
-    Matrix2f(void) { SetFunc([](Vector2u l, float* fOut) { *fOut = 0.0f; }); }
-	Matrix2f(const float copy3_3[][3], Vector2u ignoreRowAndColumn)
-	{
-        SetFunc([copy3_3, ignoreRowAndColumn](Vector2u l, float* fOut)
-		{
-			if (l.x >= ignoreRowAndColumn.x)
-			{
-				l.x += 1;
-			}
-			if (l.y >= ignoreRowAndColumn.y)
-			{
-				l.y += 1;
-			}
-
-			*fOut = copy3_3[l.y][l.x];
-		});
-	}
-	
-	float& operator[](Vector2u l) { return values[l.y][l.x]; }
-	const float& operator[](Vector2u l) const { return values[l.y][l.x]; }
-	
-    void Set(float fillValue)
+
+#ifdef MATRIX4F_USE_SSE
+    //The matrices aren't guaranteed to be 16-byte aligned, so rows are loaded/stored with unaligned ops.
+    //On aligned data, these are as fast as the aligned versions.
+
+    inline __m128 LoadRow(const float* row) { return _mm_loadu_ps(row); }
+    inline void StoreRow(float* row, __m128 val) { _mm_storeu_ps(row, val); }
+
+    //Computes one row of "lhs * rhs", given that row of "lhs" and the rows of "rhs".
+    //The sums happen in the same order as the scalar version, so the results are identical.
+    inline __m128 MultiplyRow(const float* lhsRow, __m128 rhs0, __m128 rhs1, __m128 rhs2, __m128 rhs3)
     {
-        SetFunc([fillValue](Vector2u l, float* fOut)
-        {
-            *fOut = fillValue;
-        });
+        __m128 sum = _mm_mul_ps(_mm_set1_ps(lhsRow[0]), rhs0);
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(lhsRow[1]), rhs1));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(lhsRow[2]), rhs2));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(lhsRow[3]), rhs3));
+        return sum;
     }
-    void Set(const Matrix2f& toCopy)
+
+    //Computes "matrix * (x, y, z, w)", given the columns of the matrix.
+    inline __m128 MultiplyVector(__m128 col0, __m128 col1, __m128 col2, __m128 col3,
+                                 float x, float y, float z, float w)
     {
-        memcpy(values, toCopy.values, sizeof(float) * 4);
+        __m128 sum = _mm_mul_ps(col0, _mm_set1_ps(x));
+        sum = _mm_add_ps(sum, _mm_mul_ps(col1, _mm_set1_ps(y)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(col2, _mm_set1_ps(z)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(col3, _mm_set1_ps(w)));
+        return sum;
     }
-	
-	template<typename Func>
-    void SetFunc(Func evaluator)
-	{
-        for (Vector2u loc; loc.y < 2; ++loc.y)
-            for (loc.x = 0; loc.x < 2; ++loc.x)
-                evaluator(loc, &values[loc.y][loc.x]);
-	}
-
-	float GetDeterminant(void) const
-	{
-		return (El(0, 0) * El(1, 1)) - (El(1, 0) * El(0, 1));
-	}
-
-private:
 
-	float values[2][2];
-};
-class Matrix3f
-{
-public:
-
-	Matrix3f(void) { SetFunc([](Vector2u l, float* fOut) { *fOut = 0.0f; }); }
-	Matrix3f(const float copy4_4[][4], Vector2u ignoreRowAndColumn)
-	{
-		SetFunc([&copy4_4, ignoreRowAndColumn](Vector2u l, float* fOut)
-		{
-			if (l.x >= ignoreRowAndColumn.x)
-			{
-				l.x += 1;
-			}
-			if (l.y >= ignoreRowAndColumn.y)
-			{
-				l.y += 1;
-			}
-
-			*fOut = copy4_4[l.y][l.x];
-		});
-	}
+    #define MATRIX4F_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+    #define MATRIX4F_SWIZZLE(a, x, y, z, w) MATRIX4F_SHUFFLE(a, a, x, y, z, w)
 
-	float& operator[](Vector2u l) { return values[l.y][l.x]; }
-	const float& operator[](Vector2u l) const { return values[l.y][l.x]; }
+    //Helpers for the inverse, which splits the matrix into four 2x2 matrices.
+    //Each 2x2 matrix is stored in one register as (m00, m01, m10, m11).
 
-	void Set(float fillValue)
+    //Computes "A * B".
+    inline __m128 Mat2Mul(__m128 a, __m128 b)
     {
-        SetFunc([fillValue](Vector2u l, float* fOut) { *fOut = fillValue; });
+        return _mm_add_ps(_mm_mul_ps(a, MATRIX4F_SWIZZLE(b, 0, 3, 0, 3)),
+                          _mm_mul_ps(MATRIX4F_SWIZZLE(a, 1, 0, 3, 2), MATRIX4F_SWIZZLE(b, 2, 1, 2, 1)));
     }
-	void Set(const Matrix3f& toCopy)
+    //Computes "Adjugate(A) * B".
+    inline __m128 Mat2AdjMul(__m128 a, __m128 b)
     {
-        SetFunc([toCopy](Vector2u l, float* fOut)
-        {
-            *fOut = toCopy[l];
-        });
+        return _mm_sub_ps(_mm_mul_ps(MATRIX4F_SWIZZLE(a, 3, 3, 0, 0), b),
+                          _mm_mul_ps(MATRIX4F_SWIZZLE(a, 1, 1, 2, 2), MATRIX4F_SWIZZLE(b, 2, 3, 0, 1)));
     }
-	
-	template<typename Func>
-	void SetFunc(Func evaluator)
+    //Computes "A * Adjugate(B)".
+    inline __m128 Mat2MulAdj(__m128 a, __m128 b)
     {
-        for (Vector2u loc; loc.y < 3; ++loc.y)
-            for (loc.x = 0; loc.x < 3; ++loc.x)
-                evaluator(loc, &values[loc.y][loc.x]);
-	}
-
-	float GetDeterminant(void) const
-	{
-		//Use a recursive algorithm by splitting this matrix into smaller 2x2 matrices.
-		
-		//For this algorithm, we can freely choose any row/column to use in computing the determinant.
-		//Here, we chose the top row.
-
-		bool negative = false;
-		Vector2u l(0, 0);
-		float determinant = 0.0f;
-        float value;
-
-		for (l.x = 0; l.x < 3; ++l.x)
-		{
-			value = operator[](l);
-
-			if (value != 0.0f)
-			{
-				determinant += value * (negative ? -1 : 1) * Matrix2f(values, l).GetDeterminant();
-			}
-
-			negative = !negative;
-		}
-
-		return determinant;
-	}
-
-private:
+        return _mm_sub_ps(_mm_mul_ps(a, MATRIX4F_SWIZZLE(b, 3, 0, 3, 0)),
+                          _mm_mul_ps(MATRIX4F_SWIZZLE(a, 1, 0, 3, 2), MATRIX4F_SWIZZLE(b, 2, 1, 2, 1)));
+    }
+#endif
 
-	float values[3][3];
-};
 
-#pragma endregion
+    //The 2x2 determinants from the top two rows and bottom two rows of a matrix.
+    //Both the determinant and the inverse are built from these.
+    struct SubDeterminants
+    {
+        float S0, S1, S2, S3, S4, S5,
+              C0, C1, C2, C3, C4, C5;
 
+        SubDeterminants(const Matrix4f& mat)
+        {
+            #define M(row, col) (mat[Vector2u(col, row)])
+            S0 = (M(0, 0) * M(1, 1)) - (M(1, 0) * M(0, 1));
+            S1 = (M(0, 0) * M(1, 2)) - (M(1, 0) * M(0, 2));
+            S2 = (M(0, 0) * M(1, 3)) - (M(1, 0) * M(0, 3));
+            S3 = (M(0, 1) * M(1, 2)) - (M(1, 1) * M(0, 2));
+            S4 = (M(0, 1) * M(1, 3)) - (M(1, 1) * M(0, 3));
+            S5 = (M(0, 2) * M(1, 3)) - (M(1, 2) * M(0, 3));
+
+            C5 = (M(2, 2) * M(3, 3)) - (M(3, 2) * M(2, 3));
+            C4 = (M(2, 1) * M(3, 3)) - (M(3, 1) * M(2, 3));
+            C3 = (M(2, 1) * M(3, 2)) - (M(3, 1) * M(2, 2));
+            C2 = (M(2, 0) * M(3, 3)) - (M(3, 0) * M(2, 3));
+            C1 = (M(2, 0) * M(3, 2)) - (M(3, 0) * M(2, 2));
+            C0 = (M(2, 0) * M(3, 1)) - (M(3, 0) * M(2, 1));
+            #undef M
+        }
+
+        float GetDeterminant(void) const
+        {
+            return (S0 * C5) - (S1 * C4) + (S2 * C3) + (S3 * C2) - (S4 * C1) + (S5 * C0);
+        }
+    };
+}
 
 
 bool Matrix4f::operator==(const Matrix4f& other) const
@@ -161,6 +131,9 @@ bool Matrix4f::operator==(const Matrix4f& other) const
 Matrix4f Matrix4f::Multiply(Matrix4f const& lhs, Matrix4f const& rhs)
 {
 	Matrix4f ret;
+#ifdef MATRIX4F_USE_SSE
+    MultiplyMany(lhs, &rhs, &ret, 1);
+#else
     ret.SetFunc([&lhs, &rhs](Vector2u loc, float* fOut)
     {
         *fOut = (ElMat(0, loc.y, lhs) * ElMat(loc.x, 0, rhs)) +
@@ -168,12 +141,45 @@ Matrix4f Matrix4f::Multiply(Matrix4f const& lhs, Matrix4f const& rhs)
                 (ElMat(2, loc.y, lhs) * ElMat(loc.x, 2, rhs)) +
                 (ElMat(3, loc.y, lhs) * ElMat(loc.x, 3, rhs));
     });
+#endif
 	return ret;
 }
+void Matrix4f::MultiplyMany(const Matrix4f& lhs, const Matrix4f* rhs, Matrix4f* outResults, unsigned int count)
+{
+#ifdef MATRIX4F_USE_SSE
+    //Copy "lhs" in case it's one of the outputs.
+    float lhsValues[4][4];
+    memcpy(lhsValues, lhs.values, sizeof(float) * 16);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        __m128 rhs0 = LoadRow(rhs[i].values[0]),
+               rhs1 = LoadRow(rhs[i].values[1]),
+               rhs2 = LoadRow(rhs[i].values[2]),
+               rhs3 = LoadRow(rhs[i].values[3]);
+        StoreRow(outResults[i].values[0], MultiplyRow(lhsValues[0], rhs0, rhs1, rhs2, rhs3));
+        StoreRow(outResults[i].values[1], MultiplyRow(lhsValues[1], rhs0, rhs1, rhs2, rhs3));
+        StoreRow(outResults[i].values[2], MultiplyRow(lhsValues[2], rhs0, rhs1, rhs2, rhs3));
+        StoreRow(outResults[i].values[3], MultiplyRow(lhsValues[3], rhs0, rhs1, rhs2, rhs3));
+    }
+#else
+    Matrix4f lhsCopy = lhs;
+    for (unsigned int i = 0; i < count; ++i)
+        outResults[i] = Multiply(lhsCopy, rhs[i]);
+#endif
+}
 
 Vector4f Matrix4f::Multiply(Matrix4f const& lhs, Vector4f const& rhs)
 {
 	Vector4f ret;
+#ifdef MATRIX4F_USE_SSE
+    __m128 col0 = LoadRow(lhs.values[0]),
+           col1 = LoadRow(lhs.values[1]),
+           col2 = LoadRow(lhs.values[2]),
+           col3 = LoadRow(lhs.values[3]);
+    _MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+    StoreRow(&ret.x, MultiplyVector(col0, col1, col2, col3, rhs.x, rhs.y, rhs.z, rhs.w));
+#else
 	ret.x = (ElMat(0, 0, lhs) * rhs.x) + (ElMat(1, 0, lhs) * rhs.y) +
             (ElMat(2, 0, lhs) * rhs.z) + (ElMat(3, 0, lhs) * rhs.w);
     ret.y = (ElMat(0, 1, lhs) * rhs.x) + (ElMat(1, 1, lhs) * rhs.y) +
@@ -182,6 +188,7 @@ Vector4f Matrix4f::Multiply(Matrix4f const& lhs, Vector4f const& rhs)
             (ElMat(2, 2, lhs) * rhs.z) + (ElMat(3, 2, lhs) * rhs.w);
     ret.w = (ElMat(0, 3, lhs) * rhs.x) + (ElMat(1, 3, lhs) * rhs.y) +
             (ElMat(2, 3, lhs) * rhs.z) + (ElMat(3, 3, lhs) * rhs.w);
+#endif
 	return ret;
 }
 
@@ -191,13 +198,58 @@ Vector3f Matrix4f::Apply(Vector3f v) const
     float iW = 1.0f / val.w;
     return Vector3f(val.x * iW, val.y * iW, val.z * iW);
 }
+void Matrix4f::TransformPoints(const Vector3f* points, Vector3f* outPoints, unsigned int count) const
+{
+#ifdef MATRIX4F_USE_SSE
+    __m128 col0 = LoadRow(values[0]),
+           col1 = LoadRow(values[1]),
+           col2 = LoadRow(values[2]),
+           col3 = LoadRow(values[3]);
+    _MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Vector3f p = points[i];
+        float result[4];
+        StoreRow(result, MultiplyVector(col0, col1, col2, col3, p.x, p.y, p.z, 1.0f));
 
-void Matrix4f::SetAsIdentity(void)
+        float iW = 1.0f / result[3];
+        outPoints[i] = Vector3f(result[0] * iW, result[1] * iW, result[2] * iW);
+    }
+#else
+    for (unsigned int i = 0; i < count; ++i)
+        outPoints[i] = Apply(points[i]);
+#endif
+}
+void Matrix4f::TransformDirections(const Vector3f* directions, Vector3f* outDirections,
+                                   unsigned int count) const
 {
-    SetFunc([](Vector2u l, float* fOut)
+#ifdef MATRIX4F_USE_SSE
+    __m128 col0 = LoadRow(values[0]),
+           col1 = LoadRow(values[1]),
+           col2 = LoadRow(values[2]),
+           col3 = LoadRow(values[3]);
+    _MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+
+    for (unsigned int i = 0; i < count; ++i)
     {
-        *fOut = (l.x == l.y ? 1.0f : 0.0f);
-    });
+        Vector3f d = directions[i];
+        float result[4];
+        StoreRow(result, MultiplyVector(col0, col1, col2, col3, d.x, d.y, d.z, 0.0f));
+        outDirections[i] = Vector3f(result[0], result[1], result[2]);
+    }
+#else
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Vector4f result = Multiply(*this, Vector4f(directions[i], 0.0f));
+        outDirections[i] = Vector3f(result.x, result.y, result.z);
+    }
+#endif
+}
+
+void Matrix4f::SetAsIdentity(void)
+{
+    memcpy(values, IDENTITY_VALUES, sizeof(float) * 16);
 }
 void Matrix4f::SetAsScale(Vector3f scaleDimensions)
 {
@@ -277,6 +329,20 @@ void Matrix4f::SetAsRotation(const Quaternion& rot)
     El(0, 2) = 2.0f * (xz - wy);     El(1, 2) = 2.0f * (yz + wx);     El(2, 2) = (w2 - x2 - y2 + z2);  El(3, 2) = 0.0f;
     El(0, 3) = 0.0f;                 El(1, 3) = 0.0f;                 El(2, 3) = 0.0f;                 El(3, 3) = 1.0f;
 }
+void Matrix4f::SetAsTransform(Vector3f pos, const Quaternion& rot, Vector3f scale)
+{
+    //Equivalent to "Multiply(translation, rotation, scale)", without the extra multiplications.
+    SetAsRotation(rot);
+    for (unsigned int y = 0; y < 3; ++y)
+    {
+        values[y][0] *= scale.x;
+        values[y][1] *= scale.y;
+        values[y][2] *= scale.z;
+    }
+    El(3, 0) = pos.x;
+    El(3, 1) = pos.y;
+    El(3, 2) = pos.z;
+}
 void Matrix4f::SetAsTranslation(Vector3f pos)
 {
 	SetAsIdentity();
@@ -333,155 +399,127 @@ void Matrix4f::SetAsWVP(const Matrix4f& projM, const Matrix4f& camM, const Matri
 
 float Matrix4f::GetDeterminant(void) const
 {
-	//Use a recursive algorithm for finding it by splitting the matrix into smaller matrices.
-
-	//For this algorithm, we can freely choose which row/column to use for computing the determinant.
-	//The bottom row is the most likely to have a lot of zeros, so we use it to simplify computing.
-
-	bool negative = true;
-	Vector2u l(0, 3);
-	float determinant = 0.0f;
-    float value;
-	Matrix3f temp;
-
-	for (l.x = 0; l.x < 4; ++l.x)
-	{
-		value = operator[](l);
-
-		//This is an expensive operation, so don't bother doing it if it will come out to 0 anyway.
-		if (value != 0.0f)
-		{
-			temp = Matrix3f(values, l);
-			determinant += value * (negative ? -1 : 1) * temp.GetDeterminant();
-		}
-
-		negative = !negative;
-	}
-
-	return determinant;
+    return SubDeterminants(*this).GetDeterminant();
 }
 Matrix4f Matrix4f::GetInverse(void) const
 {
 	Matrix4f ret;
 
-	// Compute the reciprocal determinant
-	float det = GetDeterminant();
-	if(det == 0.0f) 
+#ifdef MATRIX4F_USE_SSE
+
+    //Split the matrix into four 2x2 matrices:
+    //    | A B |
+    //    | C D |
+    //and compute the inverse block-wise.
+    __m128 row0 = LoadRow(values[0]),
+           row1 = LoadRow(values[1]),
+           row2 = LoadRow(values[2]),
+           row3 = LoadRow(values[3]);
+    __m128 a = _mm_movelh_ps(row0, row1),
+           b = _mm_movehl_ps(row1, row0),
+           c = _mm_movelh_ps(row2, row3),
+           d = _mm_movehl_ps(row3, row2);
+
+    //The determinants of A, B, C, and D.
+    __m128 subDets = _mm_sub_ps(_mm_mul_ps(MATRIX4F_SHUFFLE(row0, row2, 0, 2, 0, 2),
+                                           MATRIX4F_SHUFFLE(row1, row3, 1, 3, 1, 3)),
+                                _mm_mul_ps(MATRIX4F_SHUFFLE(row0, row2, 1, 3, 1, 3),
+                                           MATRIX4F_SHUFFLE(row1, row3, 0, 2, 0, 2)));
+    __m128 detA = MATRIX4F_SWIZZLE(subDets, 0, 0, 0, 0),
+           detB = MATRIX4F_SWIZZLE(subDets, 1, 1, 1, 1),
+           detC = MATRIX4F_SWIZZLE(subDets, 2, 2, 2, 2),
+           detD = MATRIX4F_SWIZZLE(subDets, 3, 3, 3, 3);
+
+    __m128 adjD_C = Mat2AdjMul(d, c),
+           adjA_B = Mat2AdjMul(a, b);
+
+    //The adjugates of the four blocks of the inverse.
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Mul(b, adjD_C)),
+           w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Mul(c, adjA_B)),
+           y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MulAdj(d, adjA_B)),
+           z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MulAdj(a, adjD_C));
+
+    //The full determinant is "|A||D| + |B||C| - trace(Adj(A)B * Adj(D)C)".
+    __m128 trace = _mm_mul_ps(adjA_B, MATRIX4F_SWIZZLE(adjD_C, 0, 2, 1, 3));
+    trace = _mm_add_ps(trace, MATRIX4F_SWIZZLE(trace, 2, 3, 0, 1));
+    trace = _mm_add_ps(trace, MATRIX4F_SWIZZLE(trace, 1, 0, 3, 2));
+    __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+    if (_mm_cvtss_f32(det) == 0.0f)
+    {
+        ret.Set(Mathf::NaN);
+        return ret;
+    }
+
+    __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+    x = _mm_mul_ps(x, invDet);
+    y = _mm_mul_ps(y, invDet);
+    z = _mm_mul_ps(z, invDet);
+    w = _mm_mul_ps(w, invDet);
+
+    //Turn the adjugates back into the blocks while storing them.
+    StoreRow(ret.values[0], MATRIX4F_SHUFFLE(x, y, 3, 1, 3, 1));
+    StoreRow(ret.values[1], MATRIX4F_SHUFFLE(x, y, 2, 0, 2, 0));
+    StoreRow(ret.values[2], MATRIX4F_SHUFFLE(z, w, 3, 1, 3, 1));
+    StoreRow(ret.values[3], MATRIX4F_SHUFFLE(z, w, 2, 0, 2, 0));
+
+#else
+
+    SubDeterminants sub(*this);
+	float det = sub.GetDeterminant();
+	if (det == 0.0f)
 	{
 		ret.Set(Mathf::NaN);
 		return ret;
 	}
+	float invDet = 1.0f / det;
 
-	float invdet = 1.0f / det;
-
-    //There's no simple, efficient way to do this :(.
-	ElMat(0, 0, ret) = invdet * ((El(1, 1) * El(2, 2) * El(3, 3)) +
-						         (El(2, 1) * El(3, 2) * El(1, 3)) +
-								 (El(3, 1) * El(1, 2) * El(2, 3)) -
-								 (El(1, 1) * El(3, 2) * El(2, 3)) -
-								 (El(2, 1) * El(1, 2) * El(3, 3)) -
-								 (El(3, 1) * El(2, 2) * El(1, 3)));
-	ElMat(1, 0, ret) = invdet * ((El(1, 0) * El(3, 2) * El(2, 3)) +
-								 (El(2, 0) * El(1, 2) * El(3, 3)) +
-							     (El(3, 0) * El(2, 2) * El(1, 3)) - 
-								 (El(1, 0) * El(2, 2) * El(3, 3)) - 
-								 (El(2, 0) * El(3, 2) * El(1, 3)) - 
-								 (El(3, 0) * El(1, 2) * El(2, 3)));
-	ElMat(2, 0, ret) = invdet * ((El(1, 0) * El(2, 1) * El(3, 3)) + 
-								 (El(2, 0) * El(3, 1) * El(1, 3)) + 
-								 (El(3, 0) * El(1, 1) * El(2, 3)) - 
-								 (El(0, 1) * El(3, 1) * El(2, 3)) - 
-								 (El(2, 0) * El(1, 1) * El(3, 3)) - 
-								 (El(3, 0) * El(2, 1) * El(1, 3)));
-    ElMat(3, 0, ret) = invdet * ((El(1, 0) * El(3, 1) * El(2, 2)) +
-								 (El(2, 0) * El(1, 1) * El(3, 2)) + 
-								 (El(3, 0) * El(2, 1) * El(1, 2)) - 
-								 (El(1, 0) * El(2, 1) * El(3, 2)) - 
-								 (El(2, 0) * El(3, 1) * El(1, 2)) - 
-								 (El(3, 0) * El(1, 1) * El(2, 2)));
-    ElMat(0, 1, ret) = invdet * ((El(0, 1) * El(3, 2) * El(2, 3)) +
-								 (El(2, 1) * El(0, 2) * El(3, 3)) + 
-								 (El(3, 1) * El(2, 2) * El(0, 3)) - 
-								 (El(0, 1) * El(2, 2) * El(3, 3)) - 
-								 (El(2, 1) * El(3, 2) * El(0, 3)) - 
-								 (El(3, 1) * El(0, 2) * El(2, 3)));
-    ElMat(1, 1, ret) = invdet * ((El(0, 0) * El(2, 2) * El(3, 3)) +
-								 (El(2, 0) * El(3, 2) * El(0, 3)) + 
-								 (El(3, 0) * El(0, 2) * El(2, 3)) - 
-								 (El(0, 0) * El(3, 2) * El(2, 3)) - 
-								 (El(2, 0) * El(0, 2) * El(3, 3)) - 
-								 (El(3, 0) * El(2, 2) * El(0, 3)));
-    ElMat(2, 1, ret) = invdet * ((El(0, 0) * El(3, 1) * El(2, 3)) +
-								 (El(2, 0) * El(0, 1) * El(3, 3)) + 
-								 (El(3, 0) * El(2, 1) * El(0, 3)) - 
-								 (El(0, 0) * El(2, 1) * El(3, 3)) - 
-								 (El(2, 0) * El(3, 1) * El(0, 3)) - 
-								 (El(3, 0) * El(0, 1) * El(2, 3)));
-    ElMat(3, 1, ret) = invdet * ((El(0, 0) * El(2, 1) * El(3, 2)) +
-								 (El(2, 0) * El(3, 1) * El(0, 2)) + 
-								 (El(3, 0) * El(0, 1) * El(2, 2)) - 
-								 (El(0, 0) * El(3, 1) * El(2, 2)) - 
-								 (El(2, 0) * El(0, 1) * El(3, 2)) - 
-								 (El(3, 0) * El(2, 1) * El(0, 2)));
-    ElMat(0, 2, ret) = invdet * ((El(0, 1) * El(1, 2) * El(3, 3)) +
-								 (El(1, 1) * El(3, 2) * El(0, 3)) + 
-								 (El(3, 1) * El(0, 2) * El(1, 3)) - 
-								 (El(0, 1) * El(3, 2) * El(1, 3)) - 
-								 (El(1, 1) * El(0, 2) * El(3, 3)) - 
-								 (El(3, 1) * El(1, 2) * El(0, 3)));
-    ElMat(1, 2, ret) = invdet * ((El(0, 0) * El(3, 2) * El(1, 3)) +
-								 (El(1, 0) * El(0, 2) * El(3, 3)) + 
-								 (El(3, 0) * El(1, 2) * El(0, 3)) - 
-								 (El(0, 0) * El(1, 2) * El(3, 3)) - 
-								 (El(1, 0) * El(3, 2) * El(0, 3)) - 
-								 (El(3, 0) * El(0, 2) * El(1, 3)));
-    ElMat(2, 2, ret) = invdet * ((El(0, 0) * El(1, 1) * El(3, 3)) +
-								 (El(1, 0) * El(3, 1) * El(0, 3)) + 
-								 (El(3, 0) * El(0, 1) * El(1, 3)) -
-								 (El(0, 0) * El(3, 1) * El(1, 3)) - 
-								 (El(1, 0) * El(0, 1) * El(3, 3)) - 
-								 (El(3, 0) * El(1, 1) * El(0, 3)));
-    ElMat(3, 2, ret) = invdet * ((El(0, 0) * El(3, 1) * El(1, 2)) +
-								 (El(1, 0) * El(0, 1) * El(3, 2)) + 
-								 (El(3, 0) * El(1, 1) * El(0, 2)) - 
-								 (El(0, 0) * El(1, 1) * El(3, 2)) - 
-								 (El(1, 0) * El(3, 1) * El(0, 2)) - 
-								 (El(3, 0) * El(0, 1) * El(1, 2)));
-    ElMat(0, 3, ret) = invdet * ((El(0, 1) * El(2, 2) * El(1, 3)) +
-								 (El(1, 1) * El(0, 2) * El(2, 3)) + 
-								 (El(2, 1) * El(1, 2) * El(0, 3)) - 
-								 (El(0, 1) * El(1, 2) * El(2, 3)) - 
-								 (El(1, 1) * El(2, 2) * El(0, 3)) - 
-								 (El(2, 1) * El(0, 2) * El(1, 3)));
-    ElMat(1, 3, ret) = invdet * ((El(0, 0) * El(1, 2) * El(2, 3)) +
-								 (El(1, 0) * El(2, 2) * El(0, 3)) + 
-								 (El(2, 0) * El(0, 2) * El(1, 3)) - 
-								 (El(0, 0) * El(2, 2) * El(1, 3)) - 
-								 (El(1, 0) * El(0, 2) * El(2, 3)) - 
-								 (El(2, 0) * El(1, 2) * El(0, 3)));
-    ElMat(2, 3, ret) = invdet * ((El(0, 0) * El(2, 1) * El(1, 3)) +
-								 (El(1, 0) * El(0, 1) * El(2, 3)) + 
-								 (El(2, 0) * El(1, 1) * El(0, 3)) - 
-								 (El(0, 0) * El(1, 1) * El(2, 3)) - 
-								 (El(1, 0) * El(2, 1) * El(0, 3)) - 
-								 (El(2, 0) * El(0, 1) * El(1, 3)));
-    ElMat(3, 3, ret) = invdet * ((El(0, 0) * El(1, 1) * El(2, 2)) +
-								 (El(1, 0) * El(2, 1) * El(0, 2)) + 
-								 (El(2, 0) * El(0, 1) * El(1, 2)) - 
-								 (El(0, 0) * El(2, 1) * El(1, 2)) - 
-								 (El(1, 0) * El(0, 1) * El(2, 2)) - 
-								 (El(2, 0) * El(1, 1) * El(0, 2))); 
+    #define M(row, col) (values[row][col])
+    ret.values[0][0] = ((M(1, 1) * sub.C5) - (M(1, 2) * sub.C4) + (M(1, 3) * sub.C3)) * invDet;
+    ret.values[0][1] = (-(M(0, 1) * sub.C5) + (M(0, 2) * sub.C4) - (M(0, 3) * sub.C3)) * invDet;
+    ret.values[0][2] = ((M(3, 1) * sub.S5) - (M(3, 2) * sub.S4) + (M(3, 3) * sub.S3)) * invDet;
+    ret.values[0][3] = (-(M(2, 1) * sub.S5) + (M(2, 2) * sub.S4) - (M(2, 3) * sub.S3)) * invDet;
+
+    ret.values[1][0] = (-(M(1, 0) * sub.C5) + (M(1, 2) * sub.C2) - (M(1, 3) * sub.C1)) * invDet;
+    ret.values[1][1] = ((M(0, 0) * sub.C5) - (M(0, 2) * sub.C2) + (M(0, 3) * sub.C1)) * invDet;
+    ret.values[1][2] = (-(M(3, 0) * sub.S5) + (M(3, 2) * sub.S2) - (M(3, 3) * sub.S1)) * invDet;
+    ret.values[1][3] = ((M(2, 0) * sub.S5) - (M(2, 2) * sub.S2) + (M(2, 3) * sub.S1)) * invDet;
+
+    ret.values[2][0] = ((M(1, 0) * sub.C4) - (M(1, 1) * sub.C2) + (M(1, 3) * sub.C0)) * invDet;
+    ret.values[2][1] = (-(M(0, 0) * sub.C4) + (M(0, 1) * sub.C2) - (M(0, 3) * sub.C0)) * invDet;
+    ret.values[2][2] = ((M(3, 0) * sub.S4) - (M(3, 1) * sub.S2) + (M(3, 3) * sub.S0)) * invDet;
+    ret.values[2][3] = (-(M(2, 0) * sub.S4) + (M(2, 1) * sub.S2) - (M(2, 3) * sub.S0)) * invDet;
+
+    ret.values[3][0] = (-(M(1, 0) * sub.C3) + (M(1, 1) * sub.C1) - (M(1, 2) * sub.C0)) * invDet;
+    ret.values[3][1] = ((M(0, 0) * sub.C3) - (M(0, 1) * sub.C1) + (M(0, 2) * sub.C0)) * invDet;
+    ret.values[3][2] = (-(M(3, 0) * sub.S3) + (M(3, 1) * sub.S1) - (M(3, 2) * sub.S0)) * invDet;
+    ret.values[3][3] = ((M(2, 0) * sub.S3) - (M(2, 1) * sub.S1) + (M(2, 2) * sub.S0)) * invDet;
+    #undef M
+
+#endif
 
 	return ret;
 }
 Matrix4f Matrix4f::GetTranspose(void) const
 {
-	Matrix4f ret, thisM = *this;
+	Matrix4f ret;
 
-	ret.SetFunc([&thisM](Vector2u l, float* fOut)
+#ifdef MATRIX4F_USE_SSE
+    __m128 row0 = LoadRow(values[0]),
+           row1 = LoadRow(values[1]),
+           row2 = LoadRow(values[2]),
+           row3 = LoadRow(values[3]);
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+    StoreRow(ret.values[0], row0);
+    StoreRow(ret.values[1], row1);
+    StoreRow(ret.values[2], row2);
+    StoreRow(ret.values[3], row3);
+#else
+	ret.SetFunc([this](Vector2u l, float* fOut)
 	{
-		*fOut = thisM[Vector2u(l.y, l.x)];
+		*fOut = values[l.x][l.y];
 	});
+#endif
 
 	return ret;
 }
\ No newline at end of file
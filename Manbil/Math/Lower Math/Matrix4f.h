@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstring>
+
 #include "Vectors.h"
 
 
@@ -8,6 +10,7 @@ class Quaternion;
 #pragma warning(disable: 4100)
 
 //A pre-multiplied matrix (in other words it is used like "Matrix * Vector" instead of "Vector * Matrix").
+//Multiplication, inversion, and transformation use SSE if the target supports it.
 class Matrix4f
 {
 public:
@@ -15,6 +18,10 @@ public:
    
     //Gets a new matrix whose transform is equivalent to "rhs" transform followed by "lhs" transform.
     static Matrix4f Multiply(const Matrix4f& lhs, const Matrix4f& rhs);
+    //Multiplies "lhs" by each of the given matrices (e.x. a view-projection matrix by many world matrices),
+    //    which is faster than multiplying them one at a time.
+    //The outputs may be the same as the inputs.
+    static void MultiplyMany(const Matrix4f& lhs, const Matrix4f* rhs, Matrix4f* outResults, unsigned int count);
     //Pre-multiplies the given matrix by a Vector4f (essentially a 1x4 matrix).
     static Vector4f Multiply(const Matrix4f& lhs, const Vector4f& rhs);
     //Gets a new matrix whose transform is equivalent to "three" transform
@@ -63,6 +70,12 @@ public:
 	//Transforms the given vector using this matrix.
 	Vector3f Apply(Vector3f v) const;
 
+    //Transforms each of the given points like "Apply()". The outputs may be the same as the inputs.
+    void TransformPoints(const Vector3f* points, Vector3f* outPoints, unsigned int count) const;
+    //Transforms each of the given directions, ignoring this matrix's translation.
+    //The outputs may be the same as the inputs.
+    void TransformDirections(const Vector3f* directions, Vector3f* outDirections, unsigned int count) const;
+
 
     void SetAsIdentity(void);
     void SetAsScale(Vector3f scaleDimensions);
@@ -74,6 +87,8 @@ public:
     //First by Y axis, then by X, then by Z.
     void SetAsRotateXYZ(Vector3f eulerAngles);
     void SetAsRotation(const Quaternion& rot);
+    //Creates a matrix that scales, then rotates, then translates.
+    void SetAsTransform(Vector3f pos, const Quaternion& rot, Vector3f scale);
     void SetAsTranslation(Vector3f pos);
     //Creates a matrix that rotates space so that "target" is pointing along the Z
     //    and "up" is pointing along the Y.
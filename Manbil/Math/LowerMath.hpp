@@ -4,4 +4,5 @@
 #include "Lower Math/Array2D.h"
 #include "Lower Math/Array3D.h"
 #include "Lower Math/Interval.h"
+#include "Lower Math/CounterRand.h"
 #include "Lower Math/Quaternion.h"
\ No newline at end of file
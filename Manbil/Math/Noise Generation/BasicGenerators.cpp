@@ -1,5 +1,12 @@
 #include "BasicGenerators.h"
 
+#include "NoiseTiling.h"
+
+
+//The number of positions each thread grabs at once in "SampleMany()".
+const unsigned int SAMPLE_CHUNK_SIZE = 1024;
+
+
 namespace NoiseAnalysis2D
 {
 	MinMax GetMinAndMax(const Noise2D & nse)
@@ -69,4 +76,81 @@ namespace NoiseAnalysis3D
 
         return avg / (float)size;
     }
-}
\ No newline at end of file
+}
+
+
+void Generator2D::SampleMany(const Vector2f* positions, float* outValues, unsigned int nPositions) const
+{
+    assert(CanSample());
+
+    auto sampleAt = [&](unsigned int i) { outValues[i] = Sample(positions[i]); };
+    if (Threads == 0)
+    {
+        for (unsigned int i = 0; i < nPositions; ++i)
+        {
+            sampleAt(i);
+        }
+    }
+    else
+    {
+        Threads->ParallelFor(nPositions, sampleAt, SAMPLE_CHUNK_SIZE);
+    }
+}
+void Generator2D::SampleGrid(Noise2D& outNoise, Vector2f origin, Vector2f spacing) const
+{
+    assert(CanSample());
+
+    NoiseTiling::ForEachTile(outNoise.GetDimensions(), Threads,
+                             [&](unsigned int, Vector2u start, Vector2u end)
+    {
+        Vector2u loc;
+        for (loc.y = start.y; loc.y < end.y; ++loc.y)
+        {
+            for (loc.x = start.x; loc.x < end.x; ++loc.x)
+            {
+                outNoise[loc] = Sample(Vector2f(origin.x + (spacing.x * (float)loc.x),
+                                                origin.y + (spacing.y * (float)loc.y)));
+            }
+        }
+    });
+}
+
+void Generator3D::SampleMany(const Vector3f* positions, float* outValues, unsigned int nPositions) const
+{
+    assert(CanSample());
+
+    auto sampleAt = [&](unsigned int i) { outValues[i] = Sample(positions[i]); };
+    if (Threads == 0)
+    {
+        for (unsigned int i = 0; i < nPositions; ++i)
+        {
+            sampleAt(i);
+        }
+    }
+    else
+    {
+        Threads->ParallelFor(nPositions, sampleAt, SAMPLE_CHUNK_SIZE);
+    }
+}
+void Generator3D::SampleGrid(Noise3D& outNoise, Vector3f origin, Vector3f spacing) const
+{
+    assert(CanSample());
+
+    NoiseTiling::ForEachTile(outNoise.GetDimensions(), Threads,
+                             [&](unsigned int, Vector3u start, Vector3u end)
+    {
+        Vector3u loc;
+        for (loc.z = start.z; loc.z < end.z; ++loc.z)
+        {
+            for (loc.y = start.y; loc.y < end.y; ++loc.y)
+            {
+                for (loc.x = start.x; loc.x < end.x; ++loc.x)
+                {
+                    outNoise[loc] = Sample(Vector3f(origin.x + (spacing.x * (float)loc.x),
+                                                    origin.y + (spacing.y * (float)loc.y),
+                                                    origin.z + (spacing.z * (float)loc.z)));
+                }
+            }
+        }
+    });
+}
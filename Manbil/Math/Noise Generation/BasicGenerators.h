@@ -2,10 +2,13 @@
 
 #include "../LowerMath.hpp"
 
+class ThreadPool;
+
 typedef Array2D<float> Noise2D;
 typedef Array3D<float> Noise3D;
 
 //TODO: All generators have an "offset" and use their FastRand math based only on coordinate hashing/generator seed.
+//    Generators that support "Sample()" already do this for single points.
 
 //******************************************************************************************
 //All noise values in this generation system are assumed to generate values between 0 and 1.
@@ -30,10 +33,29 @@ struct Generator2D
 {
 public:
 
+    //If this isn't 0, generators that support it will split their work across this pool's threads.
+    //The generated noise is the same no matter how many threads the pool has.
+    ThreadPool* Threads = 0;
+
+
     virtual ~Generator2D(void) { }
 
 	//The "generate noise" function. Given the coordinates of the noise, gives a noise value.
 	virtual void Generate(Noise2D & outNoise) const = 0;
+
+    //Gets whether this generator can compute single points of noise with "Sample()".
+    virtual bool CanSample(void) const { return false; }
+    //Computes the noise value at the given position (in the same units as the pixels of generated noise).
+    //The value only depends on the position and this generator's settings,
+    //    so separately-sampled pieces of noise line up seamlessly.
+    //Should only be called if "CanSample()" returns true.
+    virtual float Sample(Vector2f pos) const { assert(false); return 0.0f; }
+
+    //Samples each of the given positions, spreading the work across "Threads" if it's set.
+    void SampleMany(const Vector2f* positions, float* outValues, unsigned int nPositions) const;
+    //Fills the given noise by sampling a grid of positions, starting at "origin"
+    //    and moving "spacing" units for each pixel. Uses "Threads" if it's set.
+    void SampleGrid(Noise2D& outNoise, Vector2f origin, Vector2f spacing) const;
 };
 
 
@@ -44,10 +66,12 @@ public:
 	float FlatValue;
 	FlatNoise2D(float flatValue = 0.0f) : FlatValue(flatValue) { }
 	virtual void Generate(Noise2D & outNoise) const override { outNoise.Fill(FlatValue); }
+    virtual bool CanSample(void) const override { return true; }
+    virtual float Sample(Vector2f pos) const override { return FlatValue; }
 };
 
 
-//Generates random noise using a fast PRNG.
+//Generates random noise using a counter-based PRNG, with each pixel's position as the counter.
 struct WhiteNoise2D : public Generator2D
 {
 public:
@@ -56,14 +80,25 @@ public:
 	WhiteNoise2D(int seed = 12345, Vector2i seedOffset = Vector2i()) : Seed(seed), SeedOffset(seedOffset) { }
 	virtual void Generate(Noise2D & outNoise) const override
     {
-        int seed = Seed;
+        CounterRand rand((unsigned int)Seed);
         Vector2i offset = SeedOffset;
-        outNoise.FillFunc([seed, offset](Vector2u loc, float * fOut)
+        outNoise.FillFunc([&rand, offset](Vector2u loc, float * fOut)
         {
-            Vector3i seed(ToV2i(loc) + offset, seed);
-           *fOut = FastRand(seed.GetHashCode()).GetZeroToOne();
+            *fOut = GetValue(rand, ToV2i(loc) + offset);
         });
     }
+    virtual bool CanSample(void) const override { return true; }
+    //Every position inside the same pixel gets the same value.
+    virtual float Sample(Vector2f pos) const override
+    {
+        Vector2i pixel((int)floorf(pos.x), (int)floorf(pos.y));
+        return GetValue(CounterRand((unsigned int)Seed), pixel + SeedOffset);
+    }
+private:
+    static float GetValue(const CounterRand& rand, Vector2i pixel)
+    {
+        return CounterRand::ToZeroToOne(rand.Sample(Vector4u((unsigned int)pixel.x, (unsigned int)pixel.y, 0, 0)).x);
+    }
 };
 
 
@@ -87,11 +122,30 @@ namespace NoiseAnalysis3D
 struct Generator3D
 {
 public:
+
+    //If this isn't 0, generators that support it will split their work across this pool's threads.
+    //The generated noise is the same no matter how many threads the pool has.
+    ThreadPool* Threads = 0;
+
     
     virtual ~Generator3D(void) { }
 
     //The "generate noise" function. Given the coordinates of the noise, gives a noise value.
     virtual void Generate(Noise3D & outNoise) const = 0;
+
+    //Gets whether this generator can compute single points of noise with "Sample()".
+    virtual bool CanSample(void) const { return false; }
+    //Computes the noise value at the given position (in the same units as the pixels of generated noise).
+    //The value only depends on the position and this generator's settings,
+    //    so separately-sampled pieces of noise line up seamlessly.
+    //Should only be called if "CanSample()" returns true.
+    virtual float Sample(Vector3f pos) const { assert(false); return 0.0f; }
+
+    //Samples each of the given positions, spreading the work across "Threads" if it's set.
+    void SampleMany(const Vector3f* positions, float* outValues, unsigned int nPositions) const;
+    //Fills the given noise by sampling a grid of positions, starting at "origin"
+    //    and moving "spacing" units for each pixel. Uses "Threads" if it's set.
+    void SampleGrid(Noise3D& outNoise, Vector3f origin, Vector3f spacing) const;
 };
 
 
@@ -102,10 +156,12 @@ public:
     float FlatValue;
     FlatNoise3D(float flatValue = 0.0f) : FlatValue(flatValue) { }
     virtual void Generate(Noise3D & outNoise) const override { outNoise.Fill(FlatValue); }
+    virtual bool CanSample(void) const override { return true; }
+    virtual float Sample(Vector3f pos) const override { return FlatValue; }
 };
 
 
-//Generates random noise using a fast PRNG.
+//Generates random noise using a counter-based PRNG, with each pixel's position as the counter.
 struct WhiteNoise3D : public Generator3D
 {
 public:
@@ -114,14 +170,26 @@ public:
 	WhiteNoise3D(int seed = 12345, Vector3i seedOffset = Vector3i()) : Seed(seed), SeedOffset(seedOffset) { }
 	virtual void Generate(Noise3D & outNoise) const override
     {
-        int seed = Seed;
+        CounterRand rand((unsigned int)Seed);
         Vector3i offset = SeedOffset;
-        outNoise.FillFunc([seed, offset](Vector3u loc, float * fOut)
+        outNoise.FillFunc([&rand, offset](Vector3u loc, float * fOut)
         {
-            Vector4i seed(ToV3i(loc) + offset, seed);
-           *fOut = FastRand(seed.GetHashCode()).GetZeroToOne();
+            *fOut = GetValue(rand, ToV3i(loc) + offset);
         });
     }
+    virtual bool CanSample(void) const override { return true; }
+    //Every position inside the same pixel gets the same value.
+    virtual float Sample(Vector3f pos) const override
+    {
+        Vector3i pixel((int)floorf(pos.x), (int)floorf(pos.y), (int)floorf(pos.z));
+        return GetValue(CounterRand((unsigned int)Seed), pixel + SeedOffset);
+    }
+private:
+    static float GetValue(const CounterRand& rand, Vector3i pixel)
+    {
+        return CounterRand::ToZeroToOne(rand.Sample(Vector4u((unsigned int)pixel.x, (unsigned int)pixel.y,
+                                                             (unsigned int)pixel.z, 0)).x);
+    }
 };
 
 
@@ -23,6 +23,26 @@ void ColorGradient::GetColors(Vector4f* outColors, const float* inValues, unsign
         outColors[i] = GetColorWOErrorChecking(inValues[i]);
     }
 }
+Vector4b ColorGradient::PackColor(Vector4f col)
+{
+    col = Vector4f(Mathf::Clamp(col.x * 255.0f, 0.0f, 255.0f), Mathf::Clamp(col.y * 255.0f, 0.0f, 255.0f),
+                   Mathf::Clamp(col.z * 255.0f, 0.0f, 255.0f), Mathf::Clamp(col.w * 255.0f, 0.0f, 255.0f));
+    return Vector4b((unsigned char)Mathf::RoundToInt(col.x),
+                    (unsigned char)Mathf::RoundToInt(col.y),
+                    (unsigned char)Mathf::RoundToInt(col.z),
+                    (unsigned char)Mathf::RoundToInt(col.w));
+}
+void ColorGradient::GetLookupTable(Vector4b* outTable, unsigned int nEntries) const
+{
+    assert(nEntries > 1);
+    CheckErrors();
+
+    float increment = 1.0f / (float)(nEntries - 1);
+    for (unsigned int i = 0; i < nEntries; ++i)
+    {
+        outTable[i] = PackColor(GetColorWOErrorChecking((float)i * increment));
+    }
+}
 Vector4f ColorGradient::GetColorWOErrorChecking(float f) const
 {
     f = Mathf::Clamp(f, OrderedNodes[0].Position, OrderedNodes[OrderedNodes.size() - 1].Position);
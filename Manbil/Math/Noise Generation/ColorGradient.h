@@ -19,6 +19,12 @@ public:
 	void GetColors(Vector4f * outColors, const float * noiseValues, unsigned int numbElements) const;
 	Vector4f GetColor(float value) const { CheckErrors(); return GetColorWOErrorChecking(value); }
 
+    //Converts a color from this gradient to a packed color, rounding to the nearest byte value.
+    static Vector4b PackColor(Vector4f color);
+    //Bakes this gradient into a lookup table of packed colors for "nEntries" evenly-spaced values,
+    //    from 0 at the first entry to 1 at the last entry.
+    void GetLookupTable(Vector4b * outTable, unsigned int nEntries) const;
+
 private:
 
 	void CheckErrors(void) const;
@@ -2,87 +2,92 @@
 
 #include <vector>
 #include <assert.h>
+#include "../../Threading/ThreadPool.h"
 
 
-void DiamondSquare::IterateAlgorithm(unsigned int size, Vector2u topLeft,
-                                     Interval* variances, Noise2D& noise) const
+namespace
 {
-    assert(size > 0);
-
-	Interval var = variances[0];
-	unsigned int halfSize = size / 2;
-	float f, f2;
-	
-	Vector2u tl = topLeft,
-			 tm = tl + Vector2u(halfSize, 0),
-			 tr = tl + Vector2u(size - 1, 0),
-			 l = topLeft + Vector2u(0, halfSize),
-			 m = l + Vector2u(halfSize, 0),
-			 r = l + Vector2u(size - 1, 0),
-			 bl = topLeft + Vector2u(0, size - 1),
-			 bm = bl + Vector2u(halfSize, 0),
-			 br = bl + Vector2u(size - 1, 0);
-
-
-	//"Diamond" part of the algorithm.
-	if (Mathf::IsNaN(noise[m]))
-	{
-		f = noise[tl] + noise[tr] + noise[bl] + noise[br];
-		f *= 0.25f;
-		f2 = var.RandomInsideRange(FastRand(Vector3i((int)m.x, (int)m.y, Seed).GetHashCode()));
-
-		noise[m] = f + f2;
-	}
-
-	//"Square" part of the algorithm.
-
-	//Left point.
-	if (Mathf::IsNaN(noise[l]))
-	{
-		f = (noise[tl] + noise[bl]) * 0.5f;
-        f2 = var.RandomInsideRange(FastRand(Vector3i((int)l.x, (int)l.y, Seed).GetHashCode()));
-		noise[l] = f + f2;
-	}
-
-	//Top point.
-	if (Mathf::IsNaN(noise[tm]))
-	{
-		f = (noise[tl] + noise[tr]) * 0.5f;
-        f2 = var.RandomInsideRange(FastRand(Vector3i((int)tm.x, (int)tm.y, Seed).GetHashCode()));
-		noise[tm] = f + f2;
-	}
-
-	//Right point.
-	if (Mathf::IsNaN(noise[r]))
-	{
-		f = (noise[tr] + noise[br]) * 0.5f;
-        f2 = var.RandomInsideRange(FastRand(Vector3i((int)r.x, (int)r.y, Seed).GetHashCode()));
-		noise[r] = f + f2;
-	}
-
-	//Bottom point.
-	if (Mathf::IsNaN(noise[bm]))
-	{
-		f = (noise[bl] + noise[br]) * 0.5f;
-        f2 = var.RandomInsideRange(FastRand(Vector3i((int)bm.x, (int)bm.y, Seed).GetHashCode()));
-		noise[bm] = f + f2;
-	}
-
-
-	//Recursive calls.
-	if (size > 3)
-	{
-		size = ((size - 1) / 2) + 1;
+    //Roughly how many noise values each thread grabs at once when splitting up rows.
+    const unsigned int VALUES_PER_CHUNK = 16384;
+}
 
-		variances = &variances[1];
 
-		IterateAlgorithm(size, tl, variances, noise);
-		IterateAlgorithm(size, tm, variances, noise);
-		IterateAlgorithm(size, l, variances, noise);
-		IterateAlgorithm(size, m, variances, noise);
-	}
+void DiamondSquare::IterateLevel(Noise2D& noise, unsigned int squareSize, Interval var) const
+{
+    unsigned int noiseSize = noise.GetWidth(),
+                 halfSize = squareSize / 2;
+    int seed = Seed;
+
+    auto getRandomOffset = [var, seed](unsigned int x, unsigned int y)
+    {
+        FastRand fr(Vector3i((int)x, (int)y, seed).GetHashCode());
+        return var.RandomInsideRange(fr);
+    };
+
+    //Every point in this level is halfway between points from the previous levels and only depends on them,
+    //    so the points can be filled in any order and the rows can be split across threads.
+    //Even rows have the midpoints of the squares' top/bottom edges.
+    //Odd rows have the squares' centers and the midpoints of their left/right edges.
+    unsigned int nRows = ((noiseSize - 1) / halfSize) + 1;
+    auto doRow = [&](unsigned int rowI)
+    {
+        unsigned int y = rowI * halfSize;
+        float* row = &noise[Vector2u(0, y)];
+        float f;
+
+        if (rowI % 2 == 0)
+        {
+            //"Square" part of the algorithm: top/bottom points.
+            for (unsigned int x = halfSize; x < noiseSize; x += squareSize)
+            {
+                if (Mathf::IsNaN(row[x]))
+                {
+                    f = (row[x - halfSize] + row[x + halfSize]) * 0.5f;
+                    row[x] = f + getRandomOffset(x, y);
+                }
+            }
+        }
+        else
+        {
+            const float* above = &noise[Vector2u(0, y - halfSize)];
+            const float* below = &noise[Vector2u(0, y + halfSize)];
+
+            //"Diamond" part of the algorithm.
+            for (unsigned int x = halfSize; x < noiseSize; x += squareSize)
+            {
+                if (Mathf::IsNaN(row[x]))
+                {
+                    f = above[x - halfSize] + above[x + halfSize] +
+                        below[x - halfSize] + below[x + halfSize];
+                    f *= 0.25f;
+                    row[x] = f + getRandomOffset(x, y);
+                }
+            }
+
+            //"Square" part of the algorithm: left/right points.
+            for (unsigned int x = 0; x < noiseSize; x += squareSize)
+            {
+                if (Mathf::IsNaN(row[x]))
+                {
+                    f = (above[x] + below[x]) * 0.5f;
+                    row[x] = f + getRandomOffset(x, y);
+                }
+            }
+        }
+    };
+
+    if (Threads == 0)
+    {
+        for (unsigned int i = 0; i < nRows; ++i)
+            doRow(i);
+    }
+    else
+    {
+        unsigned int valuesPerRow = (noiseSize / squareSize) + 1;
+        Threads->ParallelFor(nRows, doRow, Mathf::Max(1U, VALUES_PER_CHUNK / valuesPerRow));
+    }
 }
-void DiamondSquare::Generate(Noise2D& noise) const
+void DiamondSquare::GenerateSquare(Noise2D& noise) const
 {
     assert(noise.GetWidth() == noise.GetHeight());
 
@@ -106,7 +111,7 @@ void DiamondSquare::Generate(Noise2D& noise) const
 	}
 	//If there aren't enough hard-coded variances, add the default variance.
 	unsigned int steps = (unsigned int)Mathf::RoundToInt(Mathf::Log(noiseSize, 2.0f)) + 1;
-	for (unsigned int i = steps - variances.size(); i > 0; --i)
+	while (variances.size() < steps)
 		variances.insert(variances.end(), DefaultVariance);
 
 
@@ -120,6 +125,35 @@ void DiamondSquare::Generate(Noise2D& noise) const
 	if (Mathf::IsNaN(noise[Vector2u(noiseSize - 1, noiseSize - 1)]))
 		noise[Vector2u(noiseSize - 1, noiseSize - 1)] = StartingCornerValues;
 
-    //Start the iteration algorithm.
-	IterateAlgorithm(noiseSize, Vector2u(), variances.data(), noise);
-}
\ No newline at end of file
+    //Go through each level of detail, from the whole noise down to squares of 3x3 points.
+    unsigned int level = 0;
+    for (unsigned int squareSize = noiseSize - 1; squareSize > 1; squareSize /= 2)
+    {
+        IterateLevel(noise, squareSize, variances[level]);
+        level += 1;
+    }
+}
+void DiamondSquare::Generate(Noise2D& noise) const
+{
+    //Find the smallest square that fits the noise.
+    unsigned int largestSide = Mathf::Max(noise.GetWidth(), noise.GetHeight()),
+                 squareSize = 1;
+    while (squareSize + 1 < largestSide)
+        squareSize *= 2;
+
+    if (noise.GetWidth() == squareSize + 1 && noise.GetHeight() == squareSize + 1)
+    {
+        GenerateSquare(noise);
+        return;
+    }
+
+    //Pad the noise out to that square, keeping any values that were already seeded.
+    Noise2D padded(squareSize + 1, squareSize + 1, Mathf::NaN);
+    for (unsigned int y = 0; y < noise.GetHeight(); ++y)
+        memcpy(&padded[Vector2u(0, y)], &noise[Vector2u(0, y)], noise.GetWidth() * sizeof(float));
+
+    GenerateSquare(padded);
+
+    for (unsigned int y = 0; y < noise.GetHeight(); ++y)
+        memcpy(&noise[Vector2u(0, y)], &padded[Vector2u(0, y)], noise.GetWidth() * sizeof(float));
+}
@@ -19,8 +19,13 @@ struct DiamondSquareStep
 //Generates random 2D noise using the Diamond-Square algorithm.
 //The noise array should be pre-filled with NaN; any values that aren't NaN will be left alone.
 //This allows the user to seed values to effect the this algorithm.
-//The noise array that uses this generator must be a square whose sides are one more than a power of two.
-class DiamondSquare : Generator2D
+//The algorithm works on a square whose sides are one more than a power of two.
+//    Noise of any other size is padded out to the next such square, and the starting corner values
+//    go in the padded square's corners.
+//Each level of detail is done in one pass that's split across "Threads" if it's set.
+//    The random values are hashed from each point's position and the seed,
+//    so the noise is the same no matter how many threads are used.
+class DiamondSquare : public Generator2D
 {
 public:
 
@@ -45,5 +50,9 @@ public:
 
 private:
 
-	void DiamondSquare::IterateAlgorithm(unsigned int size, Vector2u topLeft, Interval* variances, Array2D<float>& noise) const;
+    //Runs the algorithm on the given noise, which must be a square whose sides are one more than a power of two.
+    void GenerateSquare(Noise2D& noise) const;
+    //Fills in the points in the given level of the algorithm (0 = the center of the whole noise).
+    //Every square in the level has sides of "squareSize + 1" points.
+    void IterateLevel(Noise2D& noise, unsigned int squareSize, Interval variance) const;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "LayeredOctave.h"
 
+#include "NoiseTiling.h"
+
 LayeredOctave2D::LayeredOctave2D(unsigned int numbOctaves, const float octaveWeights[], const Generator2D *const*const octaves)
 {
 	Octaves = numbOctaves;
@@ -36,15 +38,35 @@ void LayeredOctave2D::Generate(Array2D<float> & outNoiseArray) const
         noises[i]->Generate(*tempNoiseArray);
 
         //Weight it and add it to the "out" array.
-        for (loc.y = 0; loc.y < outNoiseArray.GetHeight(); ++loc.y)
-            for (loc.x = 0; loc.x < outNoiseArray.GetWidth(); ++loc.x)
-                outNoiseArray[loc] += (*tempNoiseArray)[loc] * OctaveStrengths[i];
+        float strength = OctaveStrengths[i];
+        NoiseTiling::ForEachTile(outNoiseArray.GetDimensions(), Threads,
+                                 [&](unsigned int, Vector2u start, Vector2u end)
+        {
+            Vector2u loc;
+            for (loc.y = start.y; loc.y < end.y; ++loc.y)
+                for (loc.x = start.x; loc.x < end.x; ++loc.x)
+                    outNoiseArray[loc] += (*tempNoiseArray)[loc] * strength;
+        });
     }
 
 	//Clean up.
 	delete tempNoiseArray;
 }
 
+bool LayeredOctave2D::CanSample(void) const
+{
+    for (unsigned int i = 0; i < Octaves; ++i)
+        if (!noises[i]->CanSample())
+            return false;
+    return true;
+}
+float LayeredOctave2D::Sample(Vector2f pos) const
+{
+    float val = 0.0f;
+    for (unsigned int i = 0; i < Octaves; ++i)
+        val += noises[i]->Sample(pos) * OctaveStrengths[i];
+    return val;
+}
 
 
 LayeredOctave3D::LayeredOctave3D(unsigned int numbOctaves, const float octaveWeights[], const Generator3D *const*const octaves)
@@ -76,16 +98,36 @@ void LayeredOctave3D::Generate(Array3D<float> & outNoiseArray) const
     //Add successive octave noise into the "out" array.
     outNoiseArray.Fill(0.0f);
     unsigned int i;
-    Vector3u loc;
     for (i = 0; i < Octaves; ++i)
     {
         //Put the octave into the temp array.
         noises[i]->Generate(tempNoiseArray);
 
         //Weight it and add it to the "out" array.
-        for (loc.z = 0; loc.z < outNoiseArray.GetDepth(); ++loc.z)
-            for (loc.y = 0; loc.y < outNoiseArray.GetHeight(); ++loc.y)
-                for (loc.x = 0; loc.x < outNoiseArray.GetWidth(); ++loc.x)
-                    outNoiseArray[loc] += (tempNoiseArray)[loc] * OctaveStrengths[i];
+        float strength = OctaveStrengths[i];
+        NoiseTiling::ForEachTile(outNoiseArray.GetDimensions(), Threads,
+                                 [&](unsigned int, Vector3u start, Vector3u end)
+        {
+            Vector3u loc;
+            for (loc.z = start.z; loc.z < end.z; ++loc.z)
+                for (loc.y = start.y; loc.y < end.y; ++loc.y)
+                    for (loc.x = start.x; loc.x < end.x; ++loc.x)
+                        outNoiseArray[loc] += tempNoiseArray[loc] * strength;
+        });
     }
-}
\ No newline at end of file
+}
+
+bool LayeredOctave3D::CanSample(void) const
+{
+    for (unsigned int i = 0; i < Octaves; ++i)
+        if (!noises[i]->CanSample())
+            return false;
+    return true;
+}
+float LayeredOctave3D::Sample(Vector3f pos) const
+{
+    float val = 0.0f;
+    for (unsigned int i = 0; i < Octaves; ++i)
+        val += noises[i]->Sample(pos) * OctaveStrengths[i];
+    return val;
+}
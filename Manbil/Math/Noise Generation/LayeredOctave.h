@@ -5,6 +5,8 @@
 
 
 //A noise Generator that overlays multiple Generators on top of each other with different weights.
+//The octaves are generated one after another, each using its own "Threads" pool;
+//    this generator's pool is used to add them together.
 class LayeredOctave2D : public Generator2D
 {
 public:
@@ -17,6 +19,10 @@ public:
 	//Generates the layered noise and puts it into the given array.
 	virtual void Generate(Noise2D & outNoiseArray) const override;
 
+    //Can only sample if every octave can.
+    virtual bool CanSample(void) const override;
+    virtual float Sample(Vector2f pos) const override;
+
 private:
 
 	Generator2D ** noises;
@@ -26,6 +32,8 @@ private:
 
 
 //A noise Generator that overlays multiple Generators on top of each other with different weights.
+//The octaves are generated one after another, each using its own "Threads" pool;
+//    this generator's pool is used to add them together.
 class LayeredOctave3D : public Generator3D
 {
 public:
@@ -38,6 +46,10 @@ public:
     //Generates the layered noise and puts it into the given array.
     virtual void Generate(Noise3D & outNoiseArray) const override;
 
+    //Can only sample if every octave can.
+    virtual bool CanSample(void) const override;
+    virtual float Sample(Vector3f pos) const override;
+
 private:
 
     Generator3D ** noises;
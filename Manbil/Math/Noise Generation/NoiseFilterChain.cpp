@@ -0,0 +1,509 @@
+#include "NoiseFilterChain.h"
+
+#include <assert.h>
+#include "../../Threading/ThreadPool.h"
+
+
+namespace
+{
+    //Roughly how many noise values each thread grabs at once when splitting up rows.
+    const unsigned int VALUES_PER_CHUNK = 16384;
+
+
+    template<typename Func>
+    //Runs "func(unsigned int row)" for every row, spread across the given pool if it isn't 0.
+    void ForEachRow(unsigned int nRows, unsigned int rowLength, ThreadPool* pool, Func func)
+    {
+        if (pool == 0)
+        {
+            for (unsigned int i = 0; i < nRows; ++i)
+            {
+                func(i);
+            }
+        }
+        else
+        {
+            pool->ParallelFor(nRows, func, Mathf::Max(1U, VALUES_PER_CHUNK / Mathf::Max(1U, rowLength)));
+        }
+    }
+
+
+    //The value added by the "Noise" filter, matching "NoiseFilterer2D::Noise()".
+    inline float GetNoiseOffset(Vector2u loc, int seed, float amount)
+    {
+        FastRand fr(Vector3i((int)loc.x, (int)loc.y, seed).GetHashCode());
+        return amount * fr.GetZeroToOne();
+    }
+    //The value added by the "Noise" filter, matching "NoiseFilterer3D::Noise()".
+    inline float GetNoiseOffset(Vector3u loc, int seed, float amount)
+    {
+        FastRand fr(Vector4i(loc.x, loc.y, loc.z, seed).GetHashCode());
+        return amount * (-1.0f + (2.0f * fr.GetZeroToOne()));
+    }
+
+    inline void ClampRow(float* row, unsigned int count)
+    {
+        for (unsigned int x = 0; x < count; ++x)
+            row[x] = Mathf::Clamp(row[x], 0.0f, 1.0f);
+    }
+
+    template<typename PositionType>
+    //Runs each of the given filters, in order, over a row of noise.
+    //None of the filters can be a "Smooth" filter.
+    //"rowStart" is the position of the first value in the row; the rest are along the X axis.
+    void ApplyStages(const NoiseFilterStage<PositionType>* stages, unsigned int nStages,
+                     float* row, PositionType rowStart, unsigned int count)
+    {
+        typedef NoiseFilterStage<PositionType> Stage;
+
+        for (unsigned int i = 0; i < nStages; ++i)
+        {
+            const Stage& stage = stages[i];
+            PositionType loc = rowStart;
+
+            switch (stage.Type)
+            {
+                case Stage::ST_REMAP:
+                    //Remapping doesn't clamp.
+                    for (unsigned int x = 0; x < count; ++x)
+                        row[x] = stage.OldVals.MapValue(stage.NewVals, row[x]);
+                    continue;
+
+                case Stage::ST_REFLECT: {
+                    Interval zeroToOne = Interval::GetZeroToOne();
+                    for (unsigned int x = 0; x < count; ++x)
+                        row[x] = zeroToOne.Reflect(row[x]);
+                    } break;
+
+                case Stage::ST_UP_CONTRAST:
+                    for (unsigned int x = 0; x < count; ++x)
+                    {
+                        float val = row[x];
+                        for (unsigned int pass = 0; pass < stage.Passes; ++pass)
+                            val = (stage.IsQuintic ? Mathf::Supersmooth(val) : Mathf::Smooth(val));
+                        row[x] = val;
+                    }
+                    break;
+
+                case Stage::ST_SET:
+                    for (unsigned int x = 0; x < count; ++x)
+                        row[x] = stage.Value1;
+                    break;
+
+                case Stage::ST_MIN:
+                    for (unsigned int x = 0; x < count; ++x)
+                        row[x] = Mathf::Min(row[x], stage.Value1);
+                    break;
+                case Stage::ST_MAX:
+                    for (unsigned int x = 0; x < count; ++x)
+                        row[x] = Mathf::Max(row[x], stage.Value1);
+                    break;
+                case Stage::ST_CLAMP:
+                    for (unsigned int x = 0; x < count; ++x)
+                        row[x] = Mathf::Clamp(row[x], stage.Value1, stage.Value2);
+                    break;
+
+                case Stage::ST_NOISE:
+                    for (unsigned int x = 0; x < count; ++x, ++loc.x)
+                        row[x] += GetNoiseOffset(loc, stage.Seed, stage.Value1);
+                    break;
+
+                case Stage::ST_INCREASE:
+                    for (unsigned int x = 0; x < count; ++x)
+                        row[x] += stage.Value1;
+                    break;
+
+                case Stage::ST_CUSTOM:
+                    for (unsigned int x = 0; x < count; ++x, ++loc.x)
+                        row[x] = stage.CustomFunction(loc, row[x], stage.CustomData);
+                    break;
+
+                default:
+                    assert(false);
+                    break;
+            }
+
+            //Every filter except remapping keeps the noise within 0-1, like NoiseFilterer does.
+            ClampRow(row, count);
+        }
+    }
+
+    template<typename StageList>
+    //Gets the index of the next "Smooth" filter at or after the given one,
+    //    or the number of filters if there aren't any more.
+    unsigned int FindNextSmooth(const StageList& stages, unsigned int start)
+    {
+        for (unsigned int i = start; i < stages.size(); ++i)
+            if (stages[i].Type == StageList::value_type::ST_SMOOTH)
+                return i;
+        return stages.size();
+    }
+
+    //Outputs the sum of each value in the row with its neighbors along the X axis.
+    void SumAlongX(const float* row, float* outSums, unsigned int count)
+    {
+        if (count == 1)
+        {
+            outSums[0] = row[0];
+            return;
+        }
+
+        outSums[0] = row[0] + row[1];
+        for (unsigned int x = 1; x < count - 1; ++x)
+            outSums[x] = row[x - 1] + row[x] + row[x + 1];
+        outSums[count - 1] = row[count - 2] + row[count - 1];
+    }
+
+    //The number of valid positions from "i - 1" to "i + 1".
+    inline unsigned int GetNNeighbors(unsigned int i, unsigned int size)
+    {
+        return 1 + (i > 0 ? 1 : 0) + (i < size - 1 ? 1 : 0);
+    }
+
+    //Outputs the sum of the given rows ("before" and "after" may be 0 if they're past the edge).
+    void SumRows(const float* before, const float* row, const float* after,
+                 float* outSums, unsigned int count)
+    {
+        for (unsigned int x = 0; x < count; ++x)
+            outSums[x] = row[x];
+        if (before != 0)
+            for (unsigned int x = 0; x < count; ++x)
+                outSums[x] += before[x];
+        if (after != 0)
+            for (unsigned int x = 0; x < count; ++x)
+                outSums[x] += after[x];
+    }
+
+    //Finishes smoothing a row of noise, given the neighborhood sums of the rows
+    //    before it, next to it, and after it along the last axis
+    //    ("before" and "after" may be 0 if they're past the edge).
+    //"nOtherAxisNeighbors" is the number of values in the neighborhood
+    //    on the axes other than X, including the row itself.
+    //"noNeighborsValue" is used if a value doesn't have any neighbors at all.
+    void FinishSmoothing(float* row, const float* before, const float* sums, const float* after,
+                         unsigned int count, unsigned int nOtherAxisNeighbors, float noNeighborsValue)
+    {
+        for (unsigned int x = 0; x < count; ++x)
+        {
+            float sum = sums[x];
+            if (before != 0)
+                sum += before[x];
+            if (after != 0)
+                sum += after[x];
+
+            unsigned int nNeighbors = (nOtherAxisNeighbors * GetNNeighbors(x, count)) - 1;
+            float average = (nNeighbors == 0 ?
+                                noNeighborsValue :
+                                ((sum - row[x]) / (float)nNeighbors));
+            row[x] = Mathf::Clamp(average, 0.0f, 1.0f);
+        }
+    }
+}
+
+
+#pragma region TwoD Noise
+
+typedef NoiseFilterChain2D NFC2;
+
+NFC2& NFC2::RemapValues(Interval oldVals, Interval newVals)
+{
+    Stage s(Stage::ST_REMAP);
+    s.OldVals = oldVals;
+    s.NewVals = newVals;
+    stages.push_back(s);
+    return *this;
+}
+NFC2& NFC2::ReflectValues(void)
+{
+    stages.push_back(Stage(Stage::ST_REFLECT));
+    return *this;
+}
+NFC2& NFC2::UpContrast(NoiseFilterer2D::UpContrastPowers power, unsigned int passes)
+{
+    Stage s(Stage::ST_UP_CONTRAST);
+    s.IsQuintic = (power == NoiseFilterer2D::QUINTIC);
+    s.Passes = passes;
+    stages.push_back(s);
+    return *this;
+}
+NFC2& NFC2::Flatten(float flatValue)
+{
+    Stage s(Stage::ST_SET);
+    s.Value1 = flatValue;
+    stages.push_back(s);
+    return *this;
+}
+NFC2& NFC2::Min(float minValue)
+{
+    Stage s(Stage::ST_MIN);
+    s.Value1 = minValue;
+    stages.push_back(s);
+    return *this;
+}
+NFC2& NFC2::Max(float maxValue)
+{
+    Stage s(Stage::ST_MAX);
+    s.Value1 = maxValue;
+    stages.push_back(s);
+    return *this;
+}
+NFC2& NFC2::Clamp(float minValue, float maxValue)
+{
+    Stage s(Stage::ST_CLAMP);
+    s.Value1 = minValue;
+    s.Value2 = maxValue;
+    stages.push_back(s);
+    return *this;
+}
+NFC2& NFC2::Smooth(void)
+{
+    stages.push_back(Stage(Stage::ST_SMOOTH));
+    return *this;
+}
+NFC2& NFC2::Noise(float amount, int seed)
+{
+    Stage s(Stage::ST_NOISE);
+    s.Value1 = amount;
+    s.Seed = seed;
+    stages.push_back(s);
+    return *this;
+}
+NFC2& NFC2::Increase(float amount)
+{
+    Stage s(Stage::ST_INCREASE);
+    s.Value1 = amount;
+    stages.push_back(s);
+    return *this;
+}
+NFC2& NFC2::CustomFunc(float(*func)(Vector2u pos, float inNoise, void* customData), void* customData)
+{
+    Stage s(Stage::ST_CUSTOM);
+    s.CustomFunction = func;
+    s.CustomData = customData;
+    stages.push_back(s);
+    return *this;
+}
+
+void NFC2::Apply(Noise2D& noise) const
+{
+    Vector2u size = noise.GetDimensions();
+    if (size.x == 0 || size.y == 0)
+        return;
+
+    //Each pass through the noise finishes the previous smooth (if there was one),
+    //    runs every filter up to the next smooth, then sums each row along X for that smooth.
+    //The sums are double-buffered, because a row's sums from the previous smooth
+    //    are still needed by its neighbors while the next smooth's sums are being written.
+    unsigned int nSmooths = 0;
+    for (unsigned int i = 0; i < stages.size(); ++i)
+        if (stages[i].Type == Stage::ST_SMOOTH)
+            nSmooths += 1;
+    Noise2D sumsA((nSmooths > 0 ? size.x : 1), (nSmooths > 0 ? size.y : 1)),
+            sumsB((nSmooths > 1 ? size.x : 1), (nSmooths > 1 ? size.y : 1));
+    Noise2D *finishSums = 0,
+            *nextSums = &sumsA;
+
+    unsigned int start = 0;
+    while (true)
+    {
+        unsigned int end = FindNextSmooth(stages, start);
+        bool startsSmooth = (end < stages.size());
+
+        ForEachRow(size.y, size.x, Threads, [&](unsigned int y)
+        {
+            float* row = &noise[Vector2u(0, y)];
+
+            if (finishSums != 0)
+            {
+                FinishSmoothing(row,
+                                (y > 0 ? &(*finishSums)[Vector2u(0, y - 1)] : 0),
+                                &(*finishSums)[Vector2u(0, y)],
+                                (y < size.y - 1 ? &(*finishSums)[Vector2u(0, y + 1)] : 0),
+                                size.x, GetNNeighbors(y, size.y), 0.0f);
+            }
+
+            if (end > start)
+                ApplyStages(&stages[start], end - start, row, Vector2u(0, y), size.x);
+
+            if (startsSmooth)
+                SumAlongX(row, &(*nextSums)[Vector2u(0, y)], size.x);
+        });
+
+        if (!startsSmooth)
+            break;
+
+        finishSums = nextSums;
+        nextSums = (nextSums == &sumsA ? &sumsB : &sumsA);
+        start = end + 1;
+    }
+}
+
+void NFC2::Generate(Noise2D& outNoise) const
+{
+    assert(NoiseToFilter != 0);
+
+    NoiseToFilter->Generate(outNoise);
+    Apply(outNoise);
+}
+
+#pragma endregion
+
+
+#pragma region ThreeD Noise
+
+typedef NoiseFilterChain3D NFC3;
+
+NFC3& NFC3::RemapValues(Interval oldVals, Interval newVals)
+{
+    Stage s(Stage::ST_REMAP);
+    s.OldVals = oldVals;
+    s.NewVals = newVals;
+    stages.push_back(s);
+    return *this;
+}
+NFC3& NFC3::ReflectValues(void)
+{
+    stages.push_back(Stage(Stage::ST_REFLECT));
+    return *this;
+}
+NFC3& NFC3::UpContrast(NoiseFilterer3D::UpContrastPowers power, unsigned int passes)
+{
+    Stage s(Stage::ST_UP_CONTRAST);
+    s.IsQuintic = (power == NoiseFilterer3D::QUINTIC);
+    s.Passes = passes;
+    stages.push_back(s);
+    return *this;
+}
+NFC3& NFC3::Set(float value)
+{
+    Stage s(Stage::ST_SET);
+    s.Value1 = value;
+    stages.push_back(s);
+    return *this;
+}
+NFC3& NFC3::Min(float minValue)
+{
+    Stage s(Stage::ST_MIN);
+    s.Value1 = minValue;
+    stages.push_back(s);
+    return *this;
+}
+NFC3& NFC3::Max(float maxValue)
+{
+    Stage s(Stage::ST_MAX);
+    s.Value1 = maxValue;
+    stages.push_back(s);
+    return *this;
+}
+NFC3& NFC3::Clamp(float minValue, float maxValue)
+{
+    Stage s(Stage::ST_CLAMP);
+    s.Value1 = minValue;
+    s.Value2 = maxValue;
+    stages.push_back(s);
+    return *this;
+}
+NFC3& NFC3::Smooth(void)
+{
+    stages.push_back(Stage(Stage::ST_SMOOTH));
+    return *this;
+}
+NFC3& NFC3::Noise(float amount, int seed)
+{
+    Stage s(Stage::ST_NOISE);
+    s.Value1 = amount;
+    s.Seed = seed;
+    stages.push_back(s);
+    return *this;
+}
+NFC3& NFC3::Increase(float amount)
+{
+    Stage s(Stage::ST_INCREASE);
+    s.Value1 = amount;
+    stages.push_back(s);
+    return *this;
+}
+NFC3& NFC3::CustomFunc(float(*func)(Vector3u pos, float inNoise, void* customData), void* customData)
+{
+    Stage s(Stage::ST_CUSTOM);
+    s.CustomFunction = func;
+    s.CustomData = customData;
+    stages.push_back(s);
+    return *this;
+}
+
+void NFC3::Apply(Noise3D& noise) const
+{
+    Vector3u size = noise.GetDimensions();
+    if (size.x == 0 || size.y == 0 || size.z == 0)
+        return;
+
+    //Same as the 2D version, except that each smooth needs one more pass
+    //    to add the X sums together along Y.
+    //The X sums aren't needed anymore once they've been summed along Y,
+    //    so only two buffers are needed no matter how many smooths there are.
+    bool anySmooths = (FindNextSmooth(stages, 0) < stages.size());
+    Vector3u sumsSize = (anySmooths ? size : Vector3u(1, 1, 1));
+    Noise3D sumsX(sumsSize.x, sumsSize.y, sumsSize.z),
+            sumsXY(sumsSize.x, sumsSize.y, sumsSize.z);
+    bool finishingSmooth = false;
+
+    unsigned int nRows = size.y * size.z;
+    unsigned int start = 0;
+    while (true)
+    {
+        unsigned int end = FindNextSmooth(stages, start);
+        bool startsSmooth = (end < stages.size());
+
+        ForEachRow(nRows, size.x, Threads, [&](unsigned int rowI)
+        {
+            Vector3u rowStart(0, rowI % size.y, rowI / size.y);
+            float* row = &noise[rowStart];
+
+            if (finishingSmooth)
+            {
+                Vector3u before(0, rowStart.y, rowStart.z - 1),
+                         after(0, rowStart.y, rowStart.z + 1);
+                FinishSmoothing(row,
+                                (rowStart.z > 0 ? &sumsXY[before] : 0),
+                                &sumsXY[rowStart],
+                                (rowStart.z < size.z - 1 ? &sumsXY[after] : 0),
+                                size.x, GetNNeighbors(rowStart.y, size.y) * GetNNeighbors(rowStart.z, size.z),
+                                0.5f);
+            }
+
+            if (end > start)
+                ApplyStages(&stages[start], end - start, row, rowStart, size.x);
+
+            if (startsSmooth)
+                SumAlongX(row, &sumsX[rowStart], size.x);
+        });
+
+        if (!startsSmooth)
+            break;
+
+        ForEachRow(nRows, size.x, Threads, [&](unsigned int rowI)
+        {
+            Vector3u rowStart(0, rowI % size.y, rowI / size.y);
+            Vector3u before(0, rowStart.y - 1, rowStart.z),
+                     after(0, rowStart.y + 1, rowStart.z);
+            SumRows((rowStart.y > 0 ? &sumsX[before] : 0),
+                    &sumsX[rowStart],
+                    (rowStart.y < size.y - 1 ? &sumsX[after] : 0),
+                    &sumsXY[rowStart], size.x);
+        });
+
+        finishingSmooth = true;
+        start = end + 1;
+    }
+}
+
+void NFC3::Generate(Noise3D& outNoise) const
+{
+    assert(NoiseToFilter != 0);
+
+    NoiseToFilter->Generate(outNoise);
+    Apply(outNoise);
+}
+
+#pragma endregion
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <vector>
+#include "NoiseFilterer.h"
+
+
+template<typename PositionType>
+//A single filter in a NoiseFilterChain2D/3D.
+struct NoiseFilterStage
+{
+public:
+
+    enum StageTypes
+    {
+        ST_REMAP,
+        ST_REFLECT,
+        ST_UP_CONTRAST,
+        ST_SET,
+        ST_MIN,
+        ST_MAX,
+        ST_CLAMP,
+        ST_SMOOTH,
+        ST_NOISE,
+        ST_INCREASE,
+        ST_CUSTOM,
+    };
+
+    StageTypes Type;
+
+    //The settings for whichever filter this is.
+    Interval OldVals, NewVals;
+    float Value1, Value2;
+    unsigned int Passes;
+    bool IsQuintic;
+    int Seed;
+    float(*CustomFunction)(PositionType pos, float inNoise, void* customData);
+    void* CustomData;
+
+
+    NoiseFilterStage(StageTypes type)
+        : Type(type), OldVals(Interval::GetZeroToOne()), NewVals(Interval::GetZeroToOne()),
+          Value1(0.0f), Value2(0.0f), Passes(1), IsQuintic(false), Seed(0),
+          CustomFunction(0), CustomData(0) { }
+};
+
+
+#pragma region TwoD Noise
+
+//Runs a sequence of filters over 2D noise in as few passes through memory as possible.
+//Filters that only look at one noise value at a time are run back-to-back on each row
+//    while it's still in the cache. "Smooth()" is done with separable sums that the filters
+//    before and after it are folded into, so each smooth only costs one more pass.
+//Rows are split across "Threads" if it's set.
+//Each filter acts like the NoiseFilterer2D filter with the same name,
+//    always applied to the entire noise at full strength.
+class NoiseFilterChain2D : public Generator2D
+{
+public:
+
+    typedef NoiseFilterStage<Vector2u> Stage;
+
+
+    //The noise that "Generate()" filters.
+    Generator2D* NoiseToFilter;
+
+
+    NoiseFilterChain2D(Generator2D* noiseToFilter = 0) : NoiseToFilter(noiseToFilter) { }
+
+
+    //The functions below add a filter to the end of the chain and return this chain,
+    //    so that calls can be strung together.
+
+    NoiseFilterChain2D& RemapValues(Interval oldVals, Interval newVals = Interval::GetZeroToOne());
+    NoiseFilterChain2D& ReflectValues(void);
+    NoiseFilterChain2D& UpContrast(NoiseFilterer2D::UpContrastPowers power, unsigned int passes = 1);
+    NoiseFilterChain2D& Flatten(float flatValue);
+    NoiseFilterChain2D& Min(float minValue);
+    NoiseFilterChain2D& Max(float maxValue);
+    NoiseFilterChain2D& Clamp(float minValue, float maxValue);
+    NoiseFilterChain2D& Smooth(void);
+    NoiseFilterChain2D& Noise(float amount, int seed);
+    NoiseFilterChain2D& Increase(float amount);
+    NoiseFilterChain2D& CustomFunc(float(*func)(Vector2u pos, float inNoise, void* customData),
+                                   void* customData = 0);
+
+    unsigned int GetNFilters(void) const { return stages.size(); }
+    void ClearFilters(void) { stages.clear(); }
+
+
+    //Runs every filter in this chain on the given noise, in order.
+    void Apply(Noise2D& noise) const;
+
+    virtual void Generate(Noise2D& outNoise) const override;
+
+
+private:
+
+    std::vector<Stage> stages;
+};
+
+#pragma endregion
+
+
+#pragma region ThreeD Noise
+
+//Runs a sequence of filters over 3D noise in as few passes through memory as possible.
+//Filters that only look at one noise value at a time are run back-to-back on each row
+//    while it's still in the cache. "Smooth()" is done with separable sums that the filters
+//    before and after it are folded into, so each smooth only costs two more passes.
+//Rows are split across "Threads" if it's set.
+//Each filter acts like the NoiseFilterer3D filter with the same name,
+//    always applied to the entire noise at full strength.
+class NoiseFilterChain3D : public Generator3D
+{
+public:
+
+    typedef NoiseFilterStage<Vector3u> Stage;
+
+
+    //The noise that "Generate()" filters.
+    Generator3D* NoiseToFilter;
+
+
+    NoiseFilterChain3D(Generator3D* noiseToFilter = 0) : NoiseToFilter(noiseToFilter) { }
+
+
+    //The functions below add a filter to the end of the chain and return this chain,
+    //    so that calls can be strung together.
+
+    NoiseFilterChain3D& RemapValues(Interval oldVals, Interval newVals = Interval::GetZeroToOne());
+    NoiseFilterChain3D& ReflectValues(void);
+    NoiseFilterChain3D& UpContrast(NoiseFilterer3D::UpContrastPowers power, unsigned int passes = 1);
+    NoiseFilterChain3D& Set(float value);
+    NoiseFilterChain3D& Min(float minValue);
+    NoiseFilterChain3D& Max(float maxValue);
+    NoiseFilterChain3D& Clamp(float minValue, float maxValue);
+    NoiseFilterChain3D& Smooth(void);
+    NoiseFilterChain3D& Noise(float amount, int seed);
+    NoiseFilterChain3D& Increase(float amount);
+    NoiseFilterChain3D& CustomFunc(float(*func)(Vector3u pos, float inNoise, void* customData),
+                                   void* customData = 0);
+
+    unsigned int GetNFilters(void) const { return stages.size(); }
+    void ClearFilters(void) { stages.clear(); }
+
+
+    //Runs every filter in this chain on the given noise, in order.
+    void Apply(Noise3D& noise) const;
+
+    virtual void Generate(Noise3D& outNoise) const override;
+
+
+private:
+
+    std::vector<Stage> stages;
+};
+
+#pragma endregion
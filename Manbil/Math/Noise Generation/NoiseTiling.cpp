@@ -0,0 +1,68 @@
+#include "NoiseTiling.h"
+
+
+namespace NoiseTiling
+{
+    Vector2u GetNTiles(Vector2u noiseSize)
+    {
+        return Vector2u((noiseSize.x + TILE_SIZE_2D - 1) / TILE_SIZE_2D,
+                        (noiseSize.y + TILE_SIZE_2D - 1) / TILE_SIZE_2D);
+    }
+    Vector3u GetNTiles(Vector3u noiseSize)
+    {
+        return Vector3u((noiseSize.x + TILE_SIZE_3D - 1) / TILE_SIZE_3D,
+                        (noiseSize.y + TILE_SIZE_3D - 1) / TILE_SIZE_3D,
+                        (noiseSize.z + TILE_SIZE_3D - 1) / TILE_SIZE_3D);
+    }
+
+
+    TileMinMax::TileMinMax(unsigned int nTiles)
+        : mins(nTiles, std::numeric_limits<float>::max()),
+          maxes(nTiles, -std::numeric_limits<float>::max())
+    {
+
+    }
+
+    void TileMinMax::Set(unsigned int tileIndex, float tileMin, float tileMax)
+    {
+        mins[tileIndex] = tileMin;
+        maxes[tileIndex] = tileMax;
+    }
+
+    NoiseAnalysis2D::MinMax TileMinMax::GetTotal(void) const
+    {
+        NoiseAnalysis2D::MinMax total(std::numeric_limits<float>::max(),
+                                      -std::numeric_limits<float>::max());
+        for (unsigned int i = 0; i < mins.size(); ++i)
+        {
+            total.Min = Mathf::Min(total.Min, mins[i]);
+            total.Max = Mathf::Max(total.Max, maxes[i]);
+        }
+        return total;
+    }
+
+
+    void Remap(Noise2D& noise, Interval oldVals, Interval newVals, ThreadPool* pool)
+    {
+        ForEachTile(noise.GetDimensions(), pool,
+                    [&noise, oldVals, newVals](unsigned int, Vector2u start, Vector2u end)
+        {
+            Vector2u loc;
+            for (loc.y = start.y; loc.y < end.y; ++loc.y)
+                for (loc.x = start.x; loc.x < end.x; ++loc.x)
+                    noise[loc] = oldVals.MapValue(newVals, noise[loc]);
+        });
+    }
+    void Remap(Noise3D& noise, Interval oldVals, Interval newVals, ThreadPool* pool)
+    {
+        ForEachTile(noise.GetDimensions(), pool,
+                    [&noise, oldVals, newVals](unsigned int, Vector3u start, Vector3u end)
+        {
+            Vector3u loc;
+            for (loc.z = start.z; loc.z < end.z; ++loc.z)
+                for (loc.y = start.y; loc.y < end.y; ++loc.y)
+                    for (loc.x = start.x; loc.x < end.x; ++loc.x)
+                        noise[loc] = oldVals.MapValue(newVals, noise[loc]);
+        });
+    }
+}
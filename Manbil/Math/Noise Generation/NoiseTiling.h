@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+#include "BasicGenerators.h"
+#include "../../Threading/ThreadPool.h"
+
+
+//Splits noise into small tiles that fit in the cache, so that they can be generated in parallel.
+//The tiles don't depend on the number of threads, and anything that's combined across tiles
+//    (like the min/max of the noise) is combined in tile order afterwards,
+//    so the generated noise is exactly the same no matter how many threads are used.
+namespace NoiseTiling
+{
+    //The width/height of a 2D tile. 64x64 floats is 16KB.
+    const unsigned int TILE_SIZE_2D = 64;
+    //The width/height/depth of a 3D tile. 16x16x16 floats is 16KB.
+    const unsigned int TILE_SIZE_3D = 16;
+
+
+    //Gets the number of tiles along each axis for noise of the given size.
+    Vector2u GetNTiles(Vector2u noiseSize);
+    //Gets the number of tiles along each axis for noise of the given size.
+    Vector3u GetNTiles(Vector3u noiseSize);
+
+
+    template<typename Func>
+    //Runs "func(unsigned int tileIndex, Vector2u tileStart, Vector2u tileEnd)" for every tile in noise
+    //    of the given size ("tileEnd" is exclusive). Tiles are indexed row by row.
+    //If "pool" is 0, every tile is run on this thread.
+    void ForEachTile(Vector2u noiseSize, ThreadPool* pool, Func func)
+    {
+        Vector2u nTiles = GetNTiles(noiseSize);
+        auto runTile = [&](unsigned int tile)
+        {
+            Vector2u start((tile % nTiles.x) * TILE_SIZE_2D, (tile / nTiles.x) * TILE_SIZE_2D);
+            Vector2u end(Mathf::Min(start.x + TILE_SIZE_2D, noiseSize.x),
+                         Mathf::Min(start.y + TILE_SIZE_2D, noiseSize.y));
+            func(tile, start, end);
+        };
+
+        unsigned int count = nTiles.x * nTiles.y;
+        if (pool == 0)
+        {
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                runTile(i);
+            }
+        }
+        else
+        {
+            pool->ParallelFor(count, runTile);
+        }
+    }
+
+    template<typename Func>
+    //Runs "func(unsigned int tileIndex, Vector3u tileStart, Vector3u tileEnd)" for every tile in noise
+    //    of the given size ("tileEnd" is exclusive). Tiles are indexed along X, then Y, then Z.
+    //If "pool" is 0, every tile is run on this thread.
+    void ForEachTile(Vector3u noiseSize, ThreadPool* pool, Func func)
+    {
+        Vector3u nTiles = GetNTiles(noiseSize);
+        auto runTile = [&](unsigned int tile)
+        {
+            Vector3u start((tile % nTiles.x) * TILE_SIZE_3D,
+                           ((tile / nTiles.x) % nTiles.y) * TILE_SIZE_3D,
+                           (tile / (nTiles.x * nTiles.y)) * TILE_SIZE_3D);
+            Vector3u end(Mathf::Min(start.x + TILE_SIZE_3D, noiseSize.x),
+                         Mathf::Min(start.y + TILE_SIZE_3D, noiseSize.y),
+                         Mathf::Min(start.z + TILE_SIZE_3D, noiseSize.z));
+            func(tile, start, end);
+        };
+
+        unsigned int count = nTiles.x * nTiles.y * nTiles.z;
+        if (pool == 0)
+        {
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                runTile(i);
+            }
+        }
+        else
+        {
+            pool->ParallelFor(count, runTile);
+        }
+    }
+
+
+    //The smallest and largest values found in each tile.
+    //Each tile keeps its own min/max while it runs and sets its slot once at the end,
+    //    and the slots are combined afterwards in tile order.
+    struct TileMinMax
+    {
+    public:
+
+        TileMinMax(unsigned int nTiles);
+
+        void Set(unsigned int tileIndex, float tileMin, float tileMax);
+
+        //Combines the min/max of every tile.
+        NoiseAnalysis2D::MinMax GetTotal(void) const;
+
+    private:
+
+        std::vector<float> mins, maxes;
+    };
+
+
+    //Remaps every value in the noise from the old range to the new range, one tile at a time.
+    //Gives the same result as "NoiseFilterer2D::RemapValues()" over the whole noise.
+    void Remap(Noise2D& noise, Interval oldVals, Interval newVals, ThreadPool* pool);
+    //Remaps every value in the noise from the old range to the new range, one tile at a time.
+    //Gives the same result as "NoiseFilterer3D::RemapValues()" over the whole noise.
+    void Remap(Noise3D& noise, Interval oldVals, Interval newVals, ThreadPool* pool);
+}
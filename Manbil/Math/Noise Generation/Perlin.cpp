@@ -2,13 +2,400 @@
 
 #include <iostream>
 #include <assert.h>
-#include "NoiseFilterer.h"
+#include "NoiseTiling.h"
 
+//Use SSE to compute four pixels at once if the target supports it.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+    #define PERLIN_USE_SSE
+    #include <xmmintrin.h>
+#endif
 
-void Perlin2D::Generate(Array2D<float> & outValues) const
+
+namespace
 {
-	FastRand fr(RandSeed);
+    //The smoothing functions for each "Smoothness" setting.
+    //They're given to the noise kernels as template arguments so that they get inlined.
+    struct LinearSmoother  { static float Smooth(float t) { return t; } };
+    struct CubicSmoother   { static float Smooth(float t) { return Mathf::Smooth(t); } };
+    struct QuinticSmoother { static float Smooth(float t) { return Mathf::Supersmooth(t); } };
+
+
+    template<typename Smoothness>
+    //Smooths the given value using the given setting.
+    float SmoothValue(Smoothness amount, float t)
+    {
+        switch (amount)
+        {
+            case Smoothness::Linear: return LinearSmoother::Smooth(t);
+            case Smoothness::Cubic: return CubicSmoother::Smooth(t);
+            case Smoothness::Quintic: return QuinticSmoother::Smooth(t);
+
+            default:
+                assert(false);
+                return t;
+        }
+    }
+
+
+    //The gradients that grid points can have. Each grid point picks one by hashing its coordinates.
+    const unsigned int N_GRADIENTS_2D = 8;
+    const Vector2f GRADIENTS_2D[N_GRADIENTS_2D] =
+    {
+        Vector2f(1.0f, 1.0f),
+        Vector2f(-1.0f, 1.0f),
+        Vector2f(1.0f, -1.0f),
+        Vector2f(-1.0f, -1.0f),
+        Vector2f(1.0f, 0.0f),
+        Vector2f(0.0f, 1.0f),
+        Vector2f(-1.0f, 0.0f),
+        Vector2f(0.0f, -1.0f),
+    };
+    //The gradients that grid points can have. Each grid point picks one by hashing its coordinates.
+    const unsigned int N_GRADIENTS_3D = 16;
+    const Vector3f GRADIENTS_3D[N_GRADIENTS_3D] =
+    {
+        Vector3f(1, 1, 0),
+        Vector3f(-1, 1, 0),
+        Vector3f(1, -1, 0),
+        Vector3f(-1, -1, 0),
+
+        Vector3f(1, 0, 1),
+        Vector3f(-1, 0, 1),
+        Vector3f(1, 0, -1),
+        Vector3f(-1, 0, -1),
+
+        Vector3f(0, 1, 1),
+        Vector3f(0, -1, 1),
+        Vector3f(0, 1, -1),
+        Vector3f(0, -1, -1),
+
+        Vector3f(1, 1, 0),
+        Vector3f(0, -1, 1),
+        Vector3f(-1, 1, 0),
+        Vector3f(0, -1, -1),
+    };
+
+
+    //The largest number of pixels along any axis of a noise tile.
+    const unsigned int MAX_TILE_SIZE = NoiseTiling::TILE_SIZE_2D;
+
+    //Everything about a tile's pixels that only depends on their position along one axis.
+    //Computing this once per tile takes the grid lookups, clamping, and smoothing out of the inner loop.
+    struct PerlinAxis
+    {
+        //The (clamped) grid points on either side of each pixel.
+        unsigned int MinGrid[MAX_TILE_SIZE], MaxGrid[MAX_TILE_SIZE];
+        //How far each pixel is from its "MinGrid" point, before and after smoothing.
+        float Rel[MAX_TILE_SIZE], Smoothed[MAX_TILE_SIZE];
+
+        template<typename Smoother>
+        void Compute(unsigned int start, unsigned int end,
+                     float withinGridOffset, float invScale, unsigned int nGridPoints)
+        {
+            assert(end - start <= MAX_TILE_SIZE);
+            for (unsigned int i = 0; i < end - start; ++i)
+            {
+                float lerpGrid = ((float)(start + i) + withinGridOffset) * invScale;
+                unsigned int grid = (unsigned int)lerpGrid;
+
+                MinGrid[i] = Mathf::Min<unsigned int>(grid, nGridPoints - 1);
+                MaxGrid[i] = Mathf::Min<unsigned int>(grid + 1, nGridPoints - 1);
+                Rel[i] = lerpGrid - (float)grid;
+                Smoothed[i] = Smoother::Smooth(Rel[i]);
+            }
+        }
+    };
+
+
+#ifdef PERLIN_USE_SSE
+    //The SSE versions of the math in the kernels. They do the exact same operations in the same order
+    //    as the scalar versions, so both give the same results.
+
+    inline __m128 Lerp4(__m128 start, __m128 end, __m128 t)
+    {
+        return _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(end, start)), start);
+    }
+
+    //Gets the dot product of the gradients at four columns in a row with the given offsets.
+    inline __m128 GradientDot4(const Vector2f* gradientRow, const unsigned int* columns,
+                               __m128 offsetX, __m128 offsetY)
+    {
+        __m128 x = _mm_setr_ps(gradientRow[columns[0]].x, gradientRow[columns[1]].x,
+                               gradientRow[columns[2]].x, gradientRow[columns[3]].x),
+               y = _mm_setr_ps(gradientRow[columns[0]].y, gradientRow[columns[1]].y,
+                               gradientRow[columns[2]].y, gradientRow[columns[3]].y);
+        return _mm_add_ps(_mm_mul_ps(x, offsetX), _mm_mul_ps(y, offsetY));
+    }
+    //Gets the dot product of the gradients at four columns in a row with the given offsets.
+    inline __m128 GradientDot4(const Vector3f* gradientRow, const unsigned int* columns,
+                               __m128 offsetX, __m128 offsetY, __m128 offsetZ)
+    {
+        __m128 x = _mm_setr_ps(gradientRow[columns[0]].x, gradientRow[columns[1]].x,
+                               gradientRow[columns[2]].x, gradientRow[columns[3]].x),
+               y = _mm_setr_ps(gradientRow[columns[0]].y, gradientRow[columns[1]].y,
+                               gradientRow[columns[2]].y, gradientRow[columns[3]].y),
+               z = _mm_setr_ps(gradientRow[columns[0]].z, gradientRow[columns[1]].z,
+                               gradientRow[columns[2]].z, gradientRow[columns[3]].z);
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, offsetX), _mm_mul_ps(y, offsetY)),
+                          _mm_mul_ps(z, offsetZ));
+    }
+
+    //Combines the four values in each vector with the given scalar min/max.
+    inline void ReduceMinMax(__m128 mins, __m128 maxes, float& inOutMin, float& inOutMax)
+    {
+        float minVals[4], maxVals[4];
+        _mm_storeu_ps(minVals, mins);
+        _mm_storeu_ps(maxVals, maxes);
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            inOutMin = Mathf::Min(inOutMin, minVals[i]);
+            inOutMax = Mathf::Max(inOutMax, maxVals[i]);
+        }
+    }
+#endif
+
+
+    //The data shared by every tile when generating 2D Perlin noise.
+    struct PerlinTileData2D
+    {
+        const Array2D<Vector2f>* Gradients;
+        Array2D<float>* Output;
+        Vector2f InvScale, WithinGridOffset;
+    };
+
+    template<typename Smoother>
+    //Generates 2D Perlin noise for the given tile and outputs the tile's min/max value.
+    void GeneratePerlinTile2D(const PerlinTileData2D& data, Vector2u start, Vector2u end,
+                              float& outMin, float& outMax)
+    {
+        const Array2D<Vector2f>& gradients = *data.Gradients;
+
+        PerlinAxis xAxis, yAxis;
+        xAxis.Compute<Smoother>(start.x, end.x, data.WithinGridOffset.x, data.InvScale.x,
+                                gradients.GetWidth());
+        yAxis.Compute<Smoother>(start.y, end.y, data.WithinGridOffset.y, data.InvScale.y,
+                                gradients.GetHeight());
+
+        unsigned int width = end.x - start.x;
+        float min = std::numeric_limits<float>::max(),
+              max = -std::numeric_limits<float>::max();
+
+#ifdef PERLIN_USE_SSE
+        __m128 mins = _mm_set1_ps(min),
+               maxes = _mm_set1_ps(max),
+               ones = _mm_set1_ps(1.0f);
+#endif
+
+        for (unsigned int y = 0; y < end.y - start.y; ++y)
+        {
+            //Get the rows of gradients above and below this row of noise.
+            const Vector2f* minRow = &gradients[Vector2u(0, yAxis.MinGrid[y])],
+                          * maxRow = &gradients[Vector2u(0, yAxis.MaxGrid[y])];
+            float relY = yAxis.Rel[y],
+                  relYLess = relY - 1.0f,
+                  smoothY = yAxis.Smoothed[y];
+            float* outRow = &(*data.Output)[Vector2u(start.x, start.y + y)];
+
+            unsigned int x = 0;
+
+#ifdef PERLIN_USE_SSE
+            __m128 relY4 = _mm_set1_ps(relY),
+                   relYLess4 = _mm_set1_ps(relYLess),
+                   smoothY4 = _mm_set1_ps(smoothY);
+            for (; x + 4 <= width; x += 4)
+            {
+                __m128 relX = _mm_loadu_ps(&xAxis.Rel[x]),
+                       relXLess = _mm_sub_ps(relX, ones),
+                       smoothX = _mm_loadu_ps(&xAxis.Smoothed[x]);
+
+                //Get the dot of each grid corner's gradient and the vector from the pixel to that grid corner.
+                __m128 tlDot = GradientDot4(minRow, &xAxis.MinGrid[x], relX, relY4),
+                       trDot = GradientDot4(minRow, &xAxis.MaxGrid[x], relXLess, relY4),
+                       blDot = GradientDot4(maxRow, &xAxis.MinGrid[x], relX, relYLess4),
+                       brDot = GradientDot4(maxRow, &xAxis.MaxGrid[x], relXLess, relYLess4);
+
+                //Interpolate the values.
+                __m128 vals = Lerp4(Lerp4(tlDot, trDot, smoothX),
+                                    Lerp4(blDot, brDot, smoothX),
+                                    smoothY4);
+                _mm_storeu_ps(&outRow[x], vals);
+
+                mins = _mm_min_ps(mins, vals);
+                maxes = _mm_max_ps(maxes, vals);
+            }
+#endif
+
+            for (; x < width; ++x)
+            {
+                float relX = xAxis.Rel[x],
+                      relXLess = relX - 1.0f,
+                      smoothX = xAxis.Smoothed[x];
+
+                //Get the dot of each grid corner's gradient and the vector from the pixel to that grid corner.
+                float tlDot = minRow[xAxis.MinGrid[x]].Dot(Vector2f(relX, relY)),
+                      trDot = minRow[xAxis.MaxGrid[x]].Dot(Vector2f(relXLess, relY)),
+                      blDot = maxRow[xAxis.MinGrid[x]].Dot(Vector2f(relX, relYLess)),
+                      brDot = maxRow[xAxis.MaxGrid[x]].Dot(Vector2f(relXLess, relYLess));
+
+                //Interpolate the values.
+                float val = Mathf::Lerp(Mathf::Lerp(tlDot, trDot, smoothX),
+                                        Mathf::Lerp(blDot, brDot, smoothX),
+                                        smoothY);
+                outRow[x] = val;
+
+                min = Mathf::Min(val, min);
+                max = Mathf::Max(val, max);
+            }
+        }
+
+#ifdef PERLIN_USE_SSE
+        ReduceMinMax(mins, maxes, min, max);
+#endif
+
+        outMin = min;
+        outMax = max;
+    }
+
+
+    //The data shared by every tile when generating 3D Perlin noise.
+    struct PerlinTileData3D
+    {
+        const Array3D<Vector3f>* Gradients;
+        Array3D<float>* Output;
+        Vector3f InvScale, WithinGridOffset;
+    };
+
+    template<typename Smoother>
+    //Generates 3D Perlin noise for the given tile and outputs the tile's min/max value.
+    void GeneratePerlinTile3D(const PerlinTileData3D& data, Vector3u start, Vector3u end,
+                              float& outMin, float& outMax)
+    {
+        const Array3D<Vector3f>& gradients = *data.Gradients;
+
+        PerlinAxis xAxis, yAxis, zAxis;
+        xAxis.Compute<Smoother>(start.x, end.x, data.WithinGridOffset.x, data.InvScale.x,
+                                gradients.GetWidth());
+        yAxis.Compute<Smoother>(start.y, end.y, data.WithinGridOffset.y, data.InvScale.y,
+                                gradients.GetHeight());
+        zAxis.Compute<Smoother>(start.z, end.z, data.WithinGridOffset.z, data.InvScale.z,
+                                gradients.GetDepth());
+
+        unsigned int width = end.x - start.x;
+        float min = std::numeric_limits<float>::max(),
+              max = -std::numeric_limits<float>::max();
+
+#ifdef PERLIN_USE_SSE
+        __m128 mins = _mm_set1_ps(min),
+               maxes = _mm_set1_ps(max),
+               ones = _mm_set1_ps(1.0f);
+#endif
+
+        for (unsigned int z = 0; z < end.z - start.z; ++z)
+        {
+            float relZ = zAxis.Rel[z],
+                  relZLess = relZ - 1.0f,
+                  smoothZ = zAxis.Smoothed[z];
 
+            for (unsigned int y = 0; y < end.y - start.y; ++y)
+            {
+                //Get the four rows of gradients around this row of noise.
+                const Vector3f* minYZRow = &gradients[Vector3u(0, yAxis.MinGrid[y], zAxis.MinGrid[z])],
+                              * maxY_minZRow = &gradients[Vector3u(0, yAxis.MaxGrid[y], zAxis.MinGrid[z])],
+                              * minY_maxZRow = &gradients[Vector3u(0, yAxis.MinGrid[y], zAxis.MaxGrid[z])],
+                              * maxYZRow = &gradients[Vector3u(0, yAxis.MaxGrid[y], zAxis.MaxGrid[z])];
+                float relY = yAxis.Rel[y],
+                      relYLess = relY - 1.0f,
+                      smoothY = yAxis.Smoothed[y];
+                float* outRow = &(*data.Output)[Vector3u(start.x, start.y + y, start.z + z)];
+
+                unsigned int x = 0;
+
+#ifdef PERLIN_USE_SSE
+                __m128 relY4 = _mm_set1_ps(relY),
+                       relYLess4 = _mm_set1_ps(relYLess),
+                       smoothY4 = _mm_set1_ps(smoothY),
+                       relZ4 = _mm_set1_ps(relZ),
+                       relZLess4 = _mm_set1_ps(relZLess),
+                       smoothZ4 = _mm_set1_ps(smoothZ);
+                for (; x + 4 <= width; x += 4)
+                {
+                    const unsigned int* minX = &xAxis.MinGrid[x],
+                                      * maxX = &xAxis.MaxGrid[x];
+                    __m128 relX = _mm_loadu_ps(&xAxis.Rel[x]),
+                           relXLess = _mm_sub_ps(relX, ones),
+                           smoothX = _mm_loadu_ps(&xAxis.Smoothed[x]);
+
+                    //Get the dot of each grid corner's gradient and the vector from the pixel to that grid corner.
+                    __m128 minXYZ_dot = GradientDot4(minYZRow, minX, relX, relY4, relZ4),
+                           minXY_maxZ_dot = GradientDot4(minY_maxZRow, minX, relX, relY4, relZLess4),
+                           minX_maxY_minZ_dot = GradientDot4(maxY_minZRow, minX, relX, relYLess4, relZ4),
+                           minX_maxYZ_dot = GradientDot4(maxYZRow, minX, relX, relYLess4, relZLess4),
+                           maxX_minYZ_dot = GradientDot4(minYZRow, maxX, relXLess, relY4, relZ4),
+                           maxX_minY_maxZ_dot = GradientDot4(minY_maxZRow, maxX, relXLess, relY4, relZLess4),
+                           maxXY_minZ_dot = GradientDot4(maxY_minZRow, maxX, relXLess, relYLess4, relZ4),
+                           maxXYZ_dot = GradientDot4(maxYZRow, maxX, relXLess, relYLess4, relZLess4);
+
+                    //Interpolate the values one axis at a time.
+                    __m128 vals = Lerp4(Lerp4(Lerp4(minXYZ_dot, maxX_minYZ_dot, smoothX),
+                                              Lerp4(minX_maxY_minZ_dot, maxXY_minZ_dot, smoothX),
+                                              smoothY4),
+                                        Lerp4(Lerp4(minXY_maxZ_dot, maxX_minY_maxZ_dot, smoothX),
+                                              Lerp4(minX_maxYZ_dot, maxXYZ_dot, smoothX),
+                                              smoothY4),
+                                        smoothZ4);
+                    _mm_storeu_ps(&outRow[x], vals);
+
+                    mins = _mm_min_ps(mins, vals);
+                    maxes = _mm_max_ps(maxes, vals);
+                }
+#endif
+
+                for (; x < width; ++x)
+                {
+                    unsigned int minX = xAxis.MinGrid[x],
+                                 maxX = xAxis.MaxGrid[x];
+                    float relX = xAxis.Rel[x],
+                          relXLess = relX - 1.0f,
+                          smoothX = xAxis.Smoothed[x];
+
+                    //Get the dot of each grid corner's gradient and the vector from the pixel to that grid corner.
+                    float minXYZ_dot = minYZRow[minX].Dot(Vector3f(relX, relY, relZ)),
+                          minXY_maxZ_dot = minY_maxZRow[minX].Dot(Vector3f(relX, relY, relZLess)),
+                          minX_maxY_minZ_dot = maxY_minZRow[minX].Dot(Vector3f(relX, relYLess, relZ)),
+                          minX_maxYZ_dot = maxYZRow[minX].Dot(Vector3f(relX, relYLess, relZLess)),
+                          maxX_minYZ_dot = minYZRow[maxX].Dot(Vector3f(relXLess, relY, relZ)),
+                          maxX_minY_maxZ_dot = minY_maxZRow[maxX].Dot(Vector3f(relXLess, relY, relZLess)),
+                          maxXY_minZ_dot = maxY_minZRow[maxX].Dot(Vector3f(relXLess, relYLess, relZ)),
+                          maxXYZ_dot = maxYZRow[maxX].Dot(Vector3f(relXLess, relYLess, relZLess));
+
+                    //Interpolate the values one axis at a time.
+                    float val = Mathf::Lerp(Mathf::Lerp(Mathf::Lerp(minXYZ_dot, maxX_minYZ_dot, smoothX),
+                                                        Mathf::Lerp(minX_maxY_minZ_dot, maxXY_minZ_dot, smoothX),
+                                                        smoothY),
+                                            Mathf::Lerp(Mathf::Lerp(minXY_maxZ_dot, maxX_minY_maxZ_dot, smoothX),
+                                                        Mathf::Lerp(minX_maxYZ_dot, maxXYZ_dot, smoothX),
+                                                        smoothY),
+                                            smoothZ);
+                    outRow[x] = val;
+
+                    min = Mathf::Min(val, min);
+                    max = Mathf::Max(val, max);
+                }
+            }
+        }
+
+#ifdef PERLIN_USE_SSE
+        ReduceMinMax(mins, maxes, min, max);
+#endif
+
+        outMin = min;
+        outMax = max;
+    }
+}
+
+
+void Perlin2D::Generate(Array2D<float> & outValues) const
+{
 	Vector2u noiseDim = outValues.GetDimensions();
 
 
@@ -24,129 +411,105 @@ void Perlin2D::Generate(Array2D<float> & outValues) const
     }
 	Array2D<Vector2f> gradients(gradientWidth + 2, gradientHeight + 2);
 
-    //Generate the gradients. by hashing the grid coordinate and using that hash in a look-up table.
-	const unsigned int numGradients = 8;
-	const Vector2f gradientTable[numGradients] = 
-	{
-		Vector2f(1.0f, 1.0f),
-		Vector2f(-1.0f, 1.0f),
-		Vector2f(1.0f, -1.0f),
-		Vector2f(-1.0f, -1.0f),
-		Vector2f(1.0f, 0.0f),
-		Vector2f(0.0f, 1.0f),
-		Vector2f(-1.0f, 0.0f),
-		Vector2f(0.0f, -1.0f),
-	};
-
+    //Generate the gradients by hashing the grid coordinates.
 	Vector2u loc;
-    Vector2i offLoc;
     Vector2i scaledOffset((int)(Offset.x / Scale.x), (int)(Offset.y / Scale.y));
     for (loc.y = 0; loc.y < gradients.GetHeight(); ++loc.y)
-    {
-        offLoc.y = loc.y + scaledOffset.y;
-        offLoc.y %= GradientWrapInterval.y;
-
         for (loc.x = 0; loc.x < gradients.GetWidth(); ++loc.x)
-        {
-            offLoc.x = loc.x + scaledOffset.x;
-            offLoc.x %= GradientWrapInterval.x;
+            gradients[loc] = GetGradient(ToV2i(loc) + scaledOffset);
 
-            fr.Seed = offLoc.GetHashCode() + RandSeed;
-			gradients[loc] = gradientTable[Mathf::Abs(fr.GetRandInt()) % numGradients];
-		}
-	}
 
-
-	//Now compute the noise for every point.
-
-	float (*smoothStepper)(float inF) = 0;
+    //Now compute the noise for every point, one tile at a time.
+    //The kernel is picked here so that the smoothing function is built into it.
+    void (*generateTile)(const PerlinTileData2D& data, Vector2u start, Vector2u end,
+                         float& outMin, float& outMax) = 0;
 	switch (SmoothAmount)
 	{
 		case Smoothness::Linear:
-			smoothStepper = [](float inF) { return inF; };
+            generateTile = &GeneratePerlinTile2D<LinearSmoother>;
 			break;
 		case Smoothness::Cubic:
-			smoothStepper = &Mathf::Smooth;
+            generateTile = &GeneratePerlinTile2D<CubicSmoother>;
 			break;
 		case Smoothness::Quintic:
-			smoothStepper = &Mathf::Supersmooth;
+            generateTile = &GeneratePerlinTile2D<QuinticSmoother>;
 			break;
 
-		default: assert(false);
+		default:
+            assert(false);
+            generateTile = &GeneratePerlinTile2D<LinearSmoother>;
 	}
 
-    //Keep track of the min/max in case the noise should be normalized.
-    float min = std::numeric_limits<float>().max(),
-          max = std::numeric_limits<float>().min();
-	Vector2f lerpGrid, relGrid;
-	Vector2u tlGrid;
-	Vector2f invScale(1.0f / Scale.x, 1.0f / Scale.y);
-	float tlDot, trDot, blDot, brDot;
-    Vector2f withinGridOffset(fmodf(Offset.x, Scale.x), fmodf(Offset.y, Scale.y));
+    PerlinTileData2D tileData;
+    tileData.Gradients = &gradients;
+    tileData.Output = &outValues;
+    tileData.InvScale = Vector2f(1.0f / Scale.x, 1.0f / Scale.y);
+    tileData.WithinGridOffset = Vector2f(fmodf(Offset.x, Scale.x), fmodf(Offset.y, Scale.y));
+
+    //Keep track of each tile's min/max in case the noise should be normalized.
+    Vector2u nTiles = NoiseTiling::GetNTiles(noiseDim);
+    NoiseTiling::TileMinMax tileMinMaxes(nTiles.x * nTiles.y);
 
-    for (loc.y = 0; loc.y < noiseDim.y; ++loc.y)
+    NoiseTiling::ForEachTile(noiseDim, Threads, [&](unsigned int tile, Vector2u start, Vector2u end)
     {
-        lerpGrid.y = ((float)loc.y + withinGridOffset.y) * invScale.y;
+        float min, max;
+        generateTile(tileData, start, end, min, max);
+        tileMinMaxes.Set(tile, min, max);
+    });
 
-        tlGrid.y = (unsigned int)lerpGrid.y;
-        relGrid.y = lerpGrid.y - tlGrid.y;
+    if (RemapValues)
+    {
+        NoiseAnalysis2D::MinMax minMax = tileMinMaxes.GetTotal();
+        NoiseTiling::Remap(outValues, Interval(minMax.Min, minMax.Max, 0.00001f),
+                           Interval::GetZeroToOne(), Threads);
+    }
+}
 
-        for (loc.x = 0; loc.x < noiseDim.x; ++loc.x)
-        {
-            lerpGrid.x = ((float)loc.x + withinGridOffset.x) * invScale.x;
 
-            tlGrid.x = (unsigned int)lerpGrid.x;
-            relGrid.x = lerpGrid.x - tlGrid.x;
+Vector2f Perlin2D::GetGradient(Vector2i gridPos) const
+{
+    gridPos.x %= GradientWrapInterval.x;
+    gridPos.y %= GradientWrapInterval.y;
 
-            //TODO: This bit caused artifacts in the 3D version. See if this can be removed.
-            //The noise value at every grid point is 0.
-            if (false && relGrid.x == 0.0f && relGrid.y == 0.0f)
-            {
-                outValues[loc] = 0.0f;
-                continue;
-            }
+    FastRand fr(gridPos.GetHashCode() + RandSeed);
+    return GRADIENTS_2D[Mathf::Abs(fr.GetRandInt()) % N_GRADIENTS_2D];
+}
+float Perlin2D::Sample(Vector2f pos) const
+{
+    //Do the same math as "Generate()" does for a single pixel.
+    Vector2f invScale(1.0f / Scale.x, 1.0f / Scale.y);
+    Vector2f withinGridOffset(fmodf(Offset.x, Scale.x), fmodf(Offset.y, Scale.y));
+    Vector2i scaledOffset((int)(Offset.x / Scale.x), (int)(Offset.y / Scale.y));
 
-            //Get the dot of each grid corner's gradient and the vector from the coordinate to that grid corner.
-            Vector2f tl = gradients[gradients.Clamp(tlGrid)],
-                     tr = gradients[gradients.Clamp(tlGrid.MoreX())],
-                     bl = gradients[gradients.Clamp(tlGrid.MoreY())],
-                     br = gradients[gradients.Clamp(tlGrid + Vector2u(1, 1))];
-            Vector2f tTL = relGrid,
-                     tTR = relGrid - Vector2f(1.0f, 0.0f),
-                     tBL = relGrid - Vector2f(0.0f, 1.0f),
-                     tBR = relGrid - Vector2f(1.0f, 1.0f);
-            tlDot = tl.Dot(tTL);
-            trDot = tr.Dot(tTR);
-            blDot = bl.Dot(tBL);
-            brDot = br.Dot(tBR);
-
-            //Interpolate the values.
-            float smoothedX = smoothStepper(relGrid.x);
-            float val = Mathf::Lerp(Mathf::Lerp(tlDot, trDot, smoothedX),
-                                        Mathf::Lerp(blDot, brDot, smoothedX),
-                                        smoothStepper(relGrid.y));
-            outValues[loc] = val;
-
-            min = Mathf::Min(val, min);
-            max = Mathf::Max(val, max);
-        }
-    }
+    Vector2f lerpGrid((pos.x + withinGridOffset.x) * invScale.x,
+                      (pos.y + withinGridOffset.y) * invScale.y);
+    Vector2i minGrid((int)floorf(lerpGrid.x), (int)floorf(lerpGrid.y));
+    Vector2f rel(lerpGrid.x - (float)minGrid.x, lerpGrid.y - (float)minGrid.y),
+             relLess(rel.x - 1.0f, rel.y - 1.0f);
+    minGrid += scaledOffset;
+
+    //Get the dot of each grid corner's gradient and the vector from the position to that grid corner.
+    float tlDot = GetGradient(minGrid).Dot(rel),
+          trDot = GetGradient(minGrid + Vector2i(1, 0)).Dot(Vector2f(relLess.x, rel.y)),
+          blDot = GetGradient(minGrid + Vector2i(0, 1)).Dot(Vector2f(rel.x, relLess.y)),
+          brDot = GetGradient(minGrid + Vector2i(1, 1)).Dot(relLess);
+
+    //Interpolate the values.
+    float smoothedX = SmoothValue(SmoothAmount, rel.x);
+    float val = Mathf::Lerp(Mathf::Lerp(tlDot, trDot, smoothedX),
+                            Mathf::Lerp(blDot, brDot, smoothedX),
+                            SmoothValue(SmoothAmount, rel.y));
 
     if (RemapValues)
     {
-        NoiseFilterer2D nf;
-        MaxFilterRegion mfr;
-        nf.FillRegion = &mfr;
-        nf.RemapValues_OldVals = Interval(min, max, 0.00001f);
-        nf.RemapValues(&outValues);
+        val = Mathf::Clamp((val * 0.5f) + 0.5f, 0.0f, 1.0f);
     }
+    return val;
 }
 
 
 void Perlin3D::Generate(Array3D<float> & outNoise) const
 {
-    FastRand fr(RandSeed);
-
     Vector3u dimensions = outNoise.GetDimensions();
 
 
@@ -159,146 +522,111 @@ void Perlin3D::Generate(Array3D<float> & outNoise) const
 
     Array3D<Vector3f> gradients(gradientDims.x, gradientDims.y, gradientDims.z);
 
-    //Compute the gradient by hashing the grid coordinate
-    //  and using the hash to look up a select few pre-made gradients.
-    const unsigned int numGradients = 16;
-    const Vector3f gradientTable[numGradients] =
-    {
-        Vector3f(1, 1, 0),
-        Vector3f(-1, 1, 0),
-        Vector3f(1, -1, 0),
-        Vector3f(-1, -1, 0),
-
-        Vector3f(1, 0, 1),
-        Vector3f(-1, 0, 1),
-        Vector3f(1, 0, -1),
-        Vector3f(-1, 0, -1),
-
-        Vector3f(0, 1, 1),
-        Vector3f(0, -1, 1),
-        Vector3f(0, 1, -1),
-        Vector3f(0, -1, -1),
-
-        Vector3f(1, 1, 0),
-        Vector3f(0, -1, 1),
-        Vector3f(-1, 1, 0),
-        Vector3f(0, -1, -1),
-    };
+    //Compute the gradient by hashing the grid coordinate.
     Vector3u loc;
-    Vector3i offLoc;
     Vector3i scaledOffset((int)(Offset.x / Scale.x), (int)(Offset.y / Scale.y), (int)(Offset.z / Scale.z));
     for (loc.z = 0; loc.z < gradientDims.z; ++loc.z)
-    {
-        offLoc.z = loc.z + scaledOffset.z;
-        offLoc.z %= GradientWrapInterval.z;
-
         for (loc.y = 0; loc.y < gradientDims.y; ++loc.y)
-        {
-            offLoc.y = loc.y + scaledOffset.y;
-            offLoc.y %= GradientWrapInterval.y;
-
             for (loc.x = 0; loc.x < gradientDims.x; ++loc.x)
-            {
-                offLoc.x = loc.x + scaledOffset.x;
-                offLoc.x %= GradientWrapInterval.x;
-
-                fr.Seed = offLoc.GetHashCode() + RandSeed;
-                gradients[loc] = gradientTable[Mathf::Abs(fr.GetRandInt()) % numGradients];
-            }
-        }
-    }
-
+                gradients[loc] = GetGradient(ToV3i(loc) + scaledOffset);
 
-    //Now compute the noise for every point.
 
-    float(*smoothStepper)(float inF);
+    //Now compute the noise for every point, one tile at a time.
+    //The kernel is picked here so that the smoothing function is built into it.
+    void (*generateTile)(const PerlinTileData3D& data, Vector3u start, Vector3u end,
+                         float& outMin, float& outMax) = 0;
     switch (SmoothAmount)
     {
         case Smoothness::Linear:
-            smoothStepper = [](float inF) { return inF; };
+            generateTile = &GeneratePerlinTile3D<LinearSmoother>;
             break;
         case Smoothness::Cubic:
-            smoothStepper = &Mathf::Smooth;
+            generateTile = &GeneratePerlinTile3D<CubicSmoother>;
             break;
         case Smoothness::Quintic:
-            smoothStepper = &Mathf::Supersmooth;
+            generateTile = &GeneratePerlinTile3D<QuinticSmoother>;
             break;
 
         default:
             assert(false);
-            smoothStepper = [](float inF) { return inF; };
+            generateTile = &GeneratePerlinTile3D<LinearSmoother>;
     }
 
+    PerlinTileData3D tileData;
+    tileData.Gradients = &gradients;
+    tileData.Output = &outNoise;
+    tileData.InvScale = Vector3f(1.0f / Scale.x, 1.0f / Scale.y, 1.0f / Scale.z);
+    tileData.WithinGridOffset = Vector3f(fmodf(Offset.x, Scale.x), fmodf(Offset.y, Scale.y),
+                                         fmodf(Offset.z, Scale.z));
 
-    //Keep track of the min/max in case the noise should be normalized.
-    float min = std::numeric_limits<float>().max(),
-          max = std::numeric_limits<float>().min();
-    Vector3f lerpGrid, relGrid, relGridLess;
-    Vector3u minGrid;
-    Vector3f invScale(1.0f / Scale.x, 1.0f / Scale.y, 1.0f / Scale.z);
-    float minXYZ_dot, minXY_maxZ_dot, minX_maxY_minZ_dot, minX_maxYZ_dot,
-          maxX_minYZ_dot, maxX_minY_maxZ_dot, maxXY_minZ_dot, maxXYZ_dot;
-    Vector3f withinGridOffset(fmodf(Offset.x, Scale.x), fmodf(Offset.y, Scale.y), fmodf(Offset.z, Scale.z));
+    //Keep track of each tile's min/max in case the noise should be normalized.
+    Vector3u nTiles = NoiseTiling::GetNTiles(dimensions);
+    NoiseTiling::TileMinMax tileMinMaxes(nTiles.x * nTiles.y * nTiles.z);
 
-    for (loc.z = 0; loc.z < dimensions.z; ++loc.z)
+    NoiseTiling::ForEachTile(dimensions, Threads, [&](unsigned int tile, Vector3u start, Vector3u end)
     {
-        lerpGrid.z = ((float)loc.z + withinGridOffset.z) * invScale.z;
-
-        minGrid.z = (unsigned int)lerpGrid.z;
-        relGrid.z = lerpGrid.z - (float)minGrid.z;
-        relGridLess.z = relGrid.z - 1.0f;
+        float min, max;
+        generateTile(tileData, start, end, min, max);
+        tileMinMaxes.Set(tile, min, max);
+    });
 
-        for (loc.y = 0; loc.y < dimensions.y; ++loc.y)
-        {
-            lerpGrid.y = ((float)loc.y + withinGridOffset.y) * invScale.y;
+    if (RemapValues)
+    {
+        NoiseAnalysis2D::MinMax minMax = tileMinMaxes.GetTotal();
+        NoiseTiling::Remap(outNoise, Interval(minMax.Min, minMax.Max, 0.00001f),
+                           Interval::GetZeroToOne(), Threads);
+    }
+}
 
-            minGrid.y = (unsigned int)lerpGrid.y;
-            relGrid.y = lerpGrid.y - (float)minGrid.y;
-            relGridLess.y = relGrid.y - 1.0f;
+Vector3f Perlin3D::GetGradient(Vector3i gridPos) const
+{
+    gridPos.x %= GradientWrapInterval.x;
+    gridPos.y %= GradientWrapInterval.y;
+    gridPos.z %= GradientWrapInterval.z;
 
-            for (loc.x = 0; loc.x < dimensions.x; ++loc.x)
-            {
-                lerpGrid.x = ((float)loc.x + withinGridOffset.x) * invScale.x;
-
-                minGrid.x = (unsigned int)lerpGrid.x;
-                relGrid.x = lerpGrid.x - (float)minGrid.x;
-                relGridLess.x = relGrid.x - 1.0f;
-
-                //Get the dot of each grid corner's gradient and the vector from the coordinate to that grid corner.
-
-                minXYZ_dot = gradients[gradients.Clamp(minGrid)].Dot(relGrid);
-                minXY_maxZ_dot = gradients[gradients.Clamp(minGrid.MoreZ())].Dot(Vector3f(relGrid.x, relGrid.y, relGridLess.z));
-                minX_maxY_minZ_dot = gradients[gradients.Clamp(minGrid.MoreY())].Dot(Vector3f(relGrid.x, relGridLess.y, relGrid.z));
-                minX_maxYZ_dot = gradients[gradients.Clamp(minGrid.MoreY().MoreZ())].Dot(Vector3f(relGrid.x, relGridLess.y, relGridLess.z));
-                
-                maxX_minYZ_dot = gradients[gradients.Clamp(minGrid.MoreX())].Dot(Vector3f(relGridLess.x, relGrid.y, relGrid.z));
-                maxX_minY_maxZ_dot = gradients[gradients.Clamp(minGrid.MoreX().MoreZ())].Dot(Vector3f(relGridLess.x, relGrid.y, relGridLess.z));
-                maxXY_minZ_dot = gradients[gradients.Clamp(minGrid.MoreX().MoreY())].Dot(Vector3f(relGridLess.x, relGridLess.y, relGrid.z));
-                maxXYZ_dot = gradients[gradients.Clamp(minGrid.MoreX().MoreY().MoreZ())].Dot(relGridLess);
-
-                //Interpolate the values one axis at a time.
-                Vector3f smoothed(smoothStepper(relGrid.x), smoothStepper(relGrid.y), smoothStepper(relGrid.z));
-                float val = Mathf::Lerp(Mathf::Lerp(Mathf::Lerp(minXYZ_dot, maxX_minYZ_dot, smoothed.x),
-                                                            Mathf::Lerp(minX_maxY_minZ_dot, maxXY_minZ_dot, smoothed.x),
-                                                            smoothed.y),
-                                            Mathf::Lerp(Mathf::Lerp(minXY_maxZ_dot, maxX_minY_maxZ_dot, smoothed.x),
-                                                            Mathf::Lerp(minX_maxYZ_dot, maxXYZ_dot, smoothed.x),
-                                                            smoothed.y),
-                                            smoothed.z);
-                outNoise[loc] = val;
+    FastRand fr(gridPos.GetHashCode() + RandSeed);
+    return GRADIENTS_3D[Mathf::Abs(fr.GetRandInt()) % N_GRADIENTS_3D];
+}
+float Perlin3D::Sample(Vector3f pos) const
+{
+    //Do the same math as "Generate()" does for a single pixel.
+    Vector3f invScale(1.0f / Scale.x, 1.0f / Scale.y, 1.0f / Scale.z);
+    Vector3f withinGridOffset(fmodf(Offset.x, Scale.x), fmodf(Offset.y, Scale.y), fmodf(Offset.z, Scale.z));
+    Vector3i scaledOffset((int)(Offset.x / Scale.x), (int)(Offset.y / Scale.y), (int)(Offset.z / Scale.z));
 
-                min = Mathf::Min(val, min);
-                max = Mathf::Max(val, max);
-            }
-        }
-    }
+    Vector3f lerpGrid((pos.x + withinGridOffset.x) * invScale.x,
+                      (pos.y + withinGridOffset.y) * invScale.y,
+                      (pos.z + withinGridOffset.z) * invScale.z);
+    Vector3i minGrid((int)floorf(lerpGrid.x), (int)floorf(lerpGrid.y), (int)floorf(lerpGrid.z));
+    Vector3f rel(lerpGrid.x - (float)minGrid.x, lerpGrid.y - (float)minGrid.y, lerpGrid.z - (float)minGrid.z),
+             relLess(rel.x - 1.0f, rel.y - 1.0f, rel.z - 1.0f);
+    minGrid += scaledOffset;
+
+    //Get the dot of each grid corner's gradient and the vector from the position to that grid corner.
+    float minXYZ_dot = GetGradient(minGrid).Dot(rel),
+          minXY_maxZ_dot = GetGradient(minGrid + Vector3i(0, 0, 1)).Dot(Vector3f(rel.x, rel.y, relLess.z)),
+          minX_maxY_minZ_dot = GetGradient(minGrid + Vector3i(0, 1, 0)).Dot(Vector3f(rel.x, relLess.y, rel.z)),
+          minX_maxYZ_dot = GetGradient(minGrid + Vector3i(0, 1, 1)).Dot(Vector3f(rel.x, relLess.y, relLess.z)),
+          maxX_minYZ_dot = GetGradient(minGrid + Vector3i(1, 0, 0)).Dot(Vector3f(relLess.x, rel.y, rel.z)),
+          maxX_minY_maxZ_dot = GetGradient(minGrid + Vector3i(1, 0, 1)).Dot(Vector3f(relLess.x, rel.y, relLess.z)),
+          maxXY_minZ_dot = GetGradient(minGrid + Vector3i(1, 1, 0)).Dot(Vector3f(relLess.x, relLess.y, rel.z)),
+          maxXYZ_dot = GetGradient(minGrid + Vector3i(1, 1, 1)).Dot(relLess);
+
+    //Interpolate the values one axis at a time.
+    Vector3f smoothed(SmoothValue(SmoothAmount, rel.x),
+                      SmoothValue(SmoothAmount, rel.y),
+                      SmoothValue(SmoothAmount, rel.z));
+    float val = Mathf::Lerp(Mathf::Lerp(Mathf::Lerp(minXYZ_dot, maxX_minYZ_dot, smoothed.x),
+                                        Mathf::Lerp(minX_maxY_minZ_dot, maxXY_minZ_dot, smoothed.x),
+                                        smoothed.y),
+                            Mathf::Lerp(Mathf::Lerp(minXY_maxZ_dot, maxX_minY_maxZ_dot, smoothed.x),
+                                        Mathf::Lerp(minX_maxYZ_dot, maxXYZ_dot, smoothed.x),
+                                        smoothed.y),
+                            smoothed.z);
 
     if (RemapValues)
     {
-        NoiseFilterer3D nf;
-        MaxFilterVolume mfv;
-        nf.FillVolume = &mfv;
-        nf.RemapValues_OldVals = Interval(min, max, 0.00001f);
-        nf.RemapValues(&outNoise);
+        val = Mathf::Clamp((val * 0.5f) + 0.5f, 0.0f, 1.0f);
     }
+    return val;
 }
\ No newline at end of file
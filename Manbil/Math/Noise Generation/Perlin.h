@@ -38,6 +38,16 @@ public:
         : Scale(scale, scale), SmoothAmount(amount), Offset(offset), RandSeed(seed), GradientWrapInterval(gradientWrapInterval), RemapValues(remapValues) { }
 
 	virtual void Generate(Array2D<float> & outValues) const override;
+    virtual bool CanSample(void) const override { return true; }
+    //If "RemapValues" is true, the value is mapped from the noise's theoretical range of [-1, 1] to [0, 1],
+    //    since there isn't any generated noise to get the actual min/max from.
+    virtual float Sample(Vector2f pos) const override;
+
+
+private:
+
+    //Gets the gradient at the given grid point (after the grid's offset has been applied).
+    Vector2f GetGradient(Vector2i gridPos) const;
 };
 
 //3D Perlin noise generator.
@@ -75,4 +85,14 @@ public:
         : Scale(scale), SmoothAmount(amount), Offset(offset), RandSeed(seed), GradientWrapInterval(gradientWrapInterval), RemapValues(remapValues) { }
 
     virtual void Generate(Array3D<float> & outValues) const override;
+    virtual bool CanSample(void) const override { return true; }
+    //If "RemapValues" is true, the value is mapped from the noise's theoretical range of [-1, 1] to [0, 1],
+    //    since there isn't any generated noise to get the actual min/max from.
+    virtual float Sample(Vector3f pos) const override;
+
+
+private:
+
+    //Gets the gradient at the given grid point (after the grid's offset has been applied).
+    Vector3f GetGradient(Vector3i gridPos) const;
 };
\ No newline at end of file
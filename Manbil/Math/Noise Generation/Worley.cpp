@@ -1,6 +1,6 @@
 #include "Worley.h"
 
-#include "NoiseFilterer.h"
+#include "NoiseTiling.h"
 
 
 
@@ -26,7 +26,7 @@ namespace WORLEY_HELPERS
 {
     //Given an array and its size, tries to insert the given element
     //    while keeping the array sorted in ascending order.
-    void Insert(float toInsert, float* insertInto, unsigned int maxSize)
+    inline void Insert(float toInsert, float* insertInto, unsigned int maxSize)
     {
 	    unsigned int i;
 	    for (i = 0; i < maxSize; ++i)
@@ -45,273 +45,479 @@ namespace WORLEY_HELPERS
 		    }
 	    }
     }
-}
-using namespace WORLEY_HELPERS;
 
-void Worley2D::Generate(Array2D<float>& noise) const
-{
-	//Get the size of a cell.
-    unsigned int cSize = Mathf::Min(CellSize, noise.GetWidth(), noise.GetHeight());
-    float cSizeF = (float)cSize;
 
-	//Get the number of cells.
-	Vector2u cells = Vector2u((noise.GetWidth() / cSize),
-							  (noise.GetHeight() / cSize));
+    //The ways of measuring distance that the Worley kernels can use.
+    //Each one has "GetKey()", which gives a value that sorts the same way as the distance
+    //    (but may be cheaper to compute), and "KeyToDistance()", which turns a key into the actual distance.
+    //Only the few closest keys for each pixel are turned into distances.
 
-	Array2D<Vector2f> cellCenters(cells.x, cells.y);
+    template<typename VectorType>
+    //Straight-line distance. Compares squared distances, so only the closest few need a square root.
+    struct StraightLineMetric
+    {
+        float GetKey(VectorType o, VectorType p) const { return o.DistanceSquared(p); }
+        float KeyToDistance(float key) const { return sqrtf(key); }
+    };
 
-	//Generate cell positions.
-	FastRand fr(Seed);
-    Vector2u loc;
-    for (loc.y = 0; loc.y < cells.y; ++loc.y)
+    template<typename VectorType, float (*DistFunc)(VectorType o, VectorType p)>
+    //One of the built-in distance functions, known at compile-time so that it gets inlined.
+    struct StaticMetric
     {
-        //Get the range of Y values available for the center of this cell.
-        float startY = (float)loc.y * cSizeF;
-        Interval yBreadth = Interval(startY, startY + cSizeF, 0.001f, true, true);
-        yBreadth = yBreadth.Inflate(Variability.y);
+        float GetKey(VectorType o, VectorType p) const { return DistFunc(o, p); }
+        float KeyToDistance(float key) const { return key; }
+    };
 
-        for (loc.x = 0; loc.x < cells.x; ++loc.x)
-        {
-            //Get the range of X values available for the center of this cell.
-            float startX = loc.x * cSizeF;
-            Interval xBreadth = Interval(startX, startX + cSizeF, 0.001f, true, true);
-            xBreadth = xBreadth.Inflate(Variability.x);
-
-            //Generate the center position for this cell.
-            fr.Seed = Vector3i(Seed, (int)loc.x + CellOffset.x, (int)loc.y + CellOffset.y).GetHashCode();
-            fr.GetRandInt();
-            fr.GetRandInt();
-            cellCenters[loc] = Vector2f(xBreadth.RandomInsideRange(fr),
-                                        yBreadth.RandomInsideRange(fr));
-
-            Vector2f temp = cellCenters[loc];
-            temp.x = temp.x;
-        }
-    }
+    template<typename VectorType>
+    //A user-defined distance function.
+    struct RuntimeMetric
+    {
+        float (*DistFunc)(VectorType o, VectorType p);
 
+        RuntimeMetric(float (*distFunc)(VectorType o, VectorType p)) : DistFunc(distFunc) { }
 
-	//Get n-th-closest point for every spot on the noise grid.
+        float GetKey(VectorType o, VectorType p) const { return DistFunc(o, p); }
+        float KeyToDistance(float key) const { return key; }
+    };
 
-    float min = std::numeric_limits<float>::max(),
-          max = -std::numeric_limits<float>::max();
 
-	DistanceValues vals;
+    //The data shared by every tile when generating 2D Worley noise.
+    struct WorleyTileData2D
+    {
+        //The center of every cell, with a border of one cell on each side that
+        //    wraps around to the other side of the noise.
+        const Array2D<Vector2f>* CellCenters;
+        unsigned int CellSize;
+        Worley2D::GetValueFunc ValueGenerator;
+        Array2D<float>* Output;
+    };
+
+    template<typename Metric>
+    //Generates 2D Worley noise for the given tile and outputs the tile's min/max value.
+    void GenerateWorleyTile2D(const WorleyTileData2D& data, const Metric& metric,
+                              Vector2u start, Vector2u end, float& outMin, float& outMax)
+    {
+        const unsigned int nValues = Worley2D::NUMB_DISTANCE_VALUES;
+        const Array2D<Vector2f>& centers = *data.CellCenters;
 
-	Vector2f tempPos;
-    Vector2u tempCellLoc;
-    loc = Vector2u();
+        float min = std::numeric_limits<float>::max(),
+              max = -std::numeric_limits<float>::max();
 
-    for (loc.y = 0; loc.y < noise.GetHeight(); ++loc.y)
-    {
-        tempPos.y = (float)loc.y;
-        tempCellLoc.y = loc.y / cSize;
+        float keys[nValues];
+        Worley2D::DistanceValues vals;
 
-        for (loc.x = 0; loc.x < noise.GetWidth(); ++loc.x)
+        Vector2u loc;
+        for (loc.y = start.y; loc.y < end.y; ++loc.y)
         {
-            tempPos.x = (float)loc.x;
-            tempCellLoc.x = loc.x / cSize;
+            //The neighboring cells are the ones right around this one in the bordered cell array.
+            unsigned int cellY = loc.y / data.CellSize;
+            const Vector2f* rows[3] = { &centers[Vector2u(0, cellY)],
+                                        &centers[Vector2u(0, cellY + 1)],
+                                        &centers[Vector2u(0, cellY + 2)] };
+            float* outRow = &(*data.Output)[Vector2u(0, loc.y)];
+
+            for (loc.x = start.x; loc.x < end.x; ++loc.x)
+            {
+                Vector2f pos((float)loc.x, (float)loc.y);
+                unsigned int cellX = loc.x / data.CellSize;
 
-            for (unsigned int i = 0; i < NUMB_DISTANCE_VALUES; ++i)
-                vals.Values[i] = std::numeric_limits<float>::max();
+                for (unsigned int i = 0; i < nValues; ++i)
+                    keys[i] = std::numeric_limits<float>::max();
 
-            //Loop through every surrounding cell.
-            for (int y2 = -1; y2 <= 1; ++y2)
-            {
-                for (int x2 = -1; x2 <= 1; ++x2)
+                //Check every surrounding cell, skipping the sorted insert
+                //    for any that are farther away than all the current closest ones.
+                for (unsigned int y2 = 0; y2 < 3; ++y2)
                 {
-                    //If this cell is out of the bounds of the cell grid, wrap around.
-                    Vector2i tempCell = ToV2i(tempCellLoc) + Vector2i(x2, y2),
-                             tempCellWrapped = tempCell;
-                    Vector2f posOffset;
-                    if (tempCell.x < 0)
+                    for (unsigned int x2 = 0; x2 < 3; ++x2)
                     {
-                        tempCellWrapped.x += cells.x;
-                        posOffset.x = -(float)noise.GetWidth();
-                    }
-                    else if (tempCell.x >= cells.x)
-                    {
-                        tempCellWrapped.x -= cells.x;
-                        posOffset.x = (float)noise.GetWidth();
-                    }
-                    if (tempCell.y < 0)
-                    {
-                        tempCellWrapped.y += cells.y;
-                        posOffset.y = -(float)noise.GetHeight();
+                        float key = metric.GetKey(pos, rows[y2][cellX + x2]);
+                        if (key < keys[nValues - 1])
+                        {
+                            Insert(key, keys, nValues);
+                        }
                     }
-                    else if (tempCell.y >= cells.y)
+                }
+
+                for (unsigned int i = 0; i < nValues; ++i)
+                    vals.Values[i] = metric.KeyToDistance(keys[i]);
+
+                float noiseVal = data.ValueGenerator(vals);
+                min = Mathf::Min(min, noiseVal);
+                max = Mathf::Max(max, noiseVal);
+                outRow[loc.x] = noiseVal;
+            }
+        }
+
+        outMin = min;
+        outMax = max;
+    }
+
+    template<typename Metric>
+    //Generates every tile of 2D Worley noise.
+    void GenerateWorleyTiles2D(const WorleyTileData2D& data, const Metric& metric, ThreadPool* threads,
+                               NoiseTiling::TileMinMax& tileMinMaxes)
+    {
+        NoiseTiling::ForEachTile(data.Output->GetDimensions(), threads,
+                                 [&](unsigned int tile, Vector2u start, Vector2u end)
+        {
+            float min, max;
+            GenerateWorleyTile2D(data, metric, start, end, min, max);
+            tileMinMaxes.Set(tile, min, max);
+        });
+    }
+
+
+    //The data shared by every tile when generating 3D Worley noise.
+    struct WorleyTileData3D
+    {
+        //The center of every cell, with a border of one cell on each side that
+        //    wraps around to the other side of the noise.
+        const Array3D<Vector3f>* CellCenters;
+        unsigned int CellSize;
+        Worley3D::GetValueFunc ValueGenerator;
+        Array3D<float>* Output;
+    };
+
+    template<typename Metric>
+    //Generates 3D Worley noise for the given tile and outputs the tile's min/max value.
+    void GenerateWorleyTile3D(const WorleyTileData3D& data, const Metric& metric,
+                              Vector3u start, Vector3u end, float& outMin, float& outMax)
+    {
+        const unsigned int nValues = Worley3D::NUMB_DISTANCE_VALUES;
+        const Array3D<Vector3f>& centers = *data.CellCenters;
+
+        float min = std::numeric_limits<float>::max(),
+              max = -std::numeric_limits<float>::max();
+
+        float keys[nValues];
+        Worley3D::DistanceValues vals;
+
+        Vector3u loc;
+        for (loc.z = start.z; loc.z < end.z; ++loc.z)
+        {
+            unsigned int cellZ = loc.z / data.CellSize;
+
+            for (loc.y = start.y; loc.y < end.y; ++loc.y)
+            {
+                //The neighboring cells are the ones right around this one in the bordered cell array.
+                unsigned int cellY = loc.y / data.CellSize;
+                const Vector3f* rows[9];
+                for (unsigned int z2 = 0; z2 < 3; ++z2)
+                    for (unsigned int y2 = 0; y2 < 3; ++y2)
+                        rows[y2 + (z2 * 3)] = &centers[Vector3u(0, cellY + y2, cellZ + z2)];
+                float* outRow = &(*data.Output)[Vector3u(0, loc.y, loc.z)];
+
+                for (loc.x = start.x; loc.x < end.x; ++loc.x)
+                {
+                    Vector3f pos((float)loc.x, (float)loc.y, (float)loc.z);
+                    unsigned int cellX = loc.x / data.CellSize;
+
+                    for (unsigned int i = 0; i < nValues; ++i)
+                        keys[i] = std::numeric_limits<float>::max();
+
+                    //Check every surrounding cell, skipping the sorted insert
+                    //    for any that are farther away than all the current closest ones.
+                    for (unsigned int row = 0; row < 9; ++row)
                     {
-                        tempCellWrapped.y -= cells.y;
-                        posOffset.y = (float)noise.GetHeight();
+                        for (unsigned int x2 = 0; x2 < 3; ++x2)
+                        {
+                            float key = metric.GetKey(pos, rows[row][cellX + x2]);
+                            if (key < keys[nValues - 1])
+                            {
+                                Insert(key, keys, nValues);
+                            }
+                        }
                     }
-                    Vector2u tempCellWrappedU = ToV2u(tempCellWrapped);
 
-                    //Get the distance to the cell's center and insert that distance into the sorted array.
-                    float tempDist = DistFunc(tempPos, cellCenters[tempCellWrappedU] + posOffset);
-                    Insert(tempDist, vals.Values, NUMB_DISTANCE_VALUES);
+                    for (unsigned int i = 0; i < nValues; ++i)
+                        vals.Values[i] = metric.KeyToDistance(keys[i]);
+
+                    float noiseVal = data.ValueGenerator(vals);
+                    min = Mathf::Min(min, noiseVal);
+                    max = Mathf::Max(max, noiseVal);
+                    outRow[loc.x] = noiseVal;
                 }
             }
+        }
 
-            float noiseVal = ValueGenerator(vals);
-            min = Mathf::Min(min, noiseVal);
-            max = Mathf::Max(max, noiseVal);
-            noise[loc] = noiseVal;
+        outMin = min;
+        outMax = max;
+    }
+
+    template<typename Metric>
+    //Generates every tile of 3D Worley noise.
+    void GenerateWorleyTiles3D(const WorleyTileData3D& data, const Metric& metric, ThreadPool* threads,
+                               NoiseTiling::TileMinMax& tileMinMaxes)
+    {
+        NoiseTiling::ForEachTile(data.Output->GetDimensions(), threads,
+                                 [&](unsigned int tile, Vector3u start, Vector3u end)
+        {
+            float min, max;
+            GenerateWorleyTile3D(data, metric, start, end, min, max);
+            tileMinMaxes.Set(tile, min, max);
+        });
+    }
+}
+using namespace WORLEY_HELPERS;
+
+
+Vector2f Worley2D::GetCellCenter(Vector2i cell, float cellSize) const
+{
+    //Get the range of values available for the center of this cell.
+    Vector2f start((float)cell.x * cellSize, (float)cell.y * cellSize);
+    Interval xBreadth = Interval(start.x, start.x + cellSize, 0.001f, true, true).Inflate(Variability.x),
+             yBreadth = Interval(start.y, start.y + cellSize, 0.001f, true, true).Inflate(Variability.y);
+
+    //Generate the center position by hashing the cell's coordinates.
+    FastRand fr(Vector3i(Seed, cell.x + CellOffset.x, cell.y + CellOffset.y).GetHashCode());
+    fr.GetRandInt();
+    fr.GetRandInt();
+    Vector2f center;
+    center.x = xBreadth.RandomInsideRange(fr);
+    center.y = yBreadth.RandomInsideRange(fr);
+    return center;
+}
+Vector3f Worley3D::GetCellCenter(Vector3i cell, float cellSize) const
+{
+    //Get the range of values available for the center of this cell.
+    Vector3f start((float)cell.x * cellSize, (float)cell.y * cellSize, (float)cell.z * cellSize);
+    Interval xBreadth = Interval(start.x, start.x + cellSize, 0.001f, true, true).Inflate(Variability.x),
+             yBreadth = Interval(start.y, start.y + cellSize, 0.001f, true, true).Inflate(Variability.y),
+             zBreadth = Interval(start.z, start.z + cellSize, 0.001f, true, true).Inflate(Variability.z);
+
+    //Generate the center position by hashing the cell's coordinates.
+    FastRand fr(Vector4i(Seed, cell.x + CellOffset.x, cell.y + CellOffset.y, cell.z + CellOffset.z).GetHashCode());
+    fr.GetRandInt();
+    fr.GetRandInt();
+    Vector3f center;
+    center.x = xBreadth.RandomInsideRange(fr);
+    center.y = yBreadth.RandomInsideRange(fr);
+    center.z = zBreadth.RandomInsideRange(fr);
+    return center;
+}
+
+
+float Worley2D::Sample(Vector2f pos) const
+{
+    float cSizeF = (float)CellSize;
+    Vector2i cell((int)floorf(pos.x / cSizeF), (int)floorf(pos.y / cSizeF));
+    Vector2f cellPos = pos / cSizeF;
+
+    DistanceValues vals;
+    for (unsigned int i = 0; i < NUMB_DISTANCE_VALUES; ++i)
+        vals.Values[i] = std::numeric_limits<float>::max();
+
+    //Loop through every surrounding cell.
+    for (int y2 = -1; y2 <= 1; ++y2)
+    {
+        for (int x2 = -1; x2 <= 1; ++x2)
+        {
+            Vector2f center = GetCellCenter(cell + Vector2i(x2, y2), cSizeF) / cSizeF;
+            Insert(DistFunc(cellPos, center), vals.Values, NUMB_DISTANCE_VALUES);
         }
     }
 
-	//Remap values to 0-1.
-	NoiseFilterer2D nf;
-    MaxFilterRegion mfr;
-	nf.FillRegion = &mfr;
-	nf.RemapValues_OldVals = Interval(min, max, 0.000001f, true, true);
-    nf.RemapValues_NewVals = Interval(0.0f, 1.0f, 0.000001f, true, true);
-    nf.RemapValues(&noise);
+    return Mathf::Clamp(ValueGenerator(vals), 0.0f, 1.0f);
 }
-void Worley3D::Generate(Array3D<float>& noise) const
+float Worley3D::Sample(Vector3f pos) const
+{
+    float cSizeF = (float)CellSize;
+    Vector3i cell((int)floorf(pos.x / cSizeF), (int)floorf(pos.y / cSizeF), (int)floorf(pos.z / cSizeF));
+    Vector3f cellPos = pos / cSizeF;
+
+    DistanceValues vals;
+    for (unsigned int i = 0; i < NUMB_DISTANCE_VALUES; ++i)
+        vals.Values[i] = std::numeric_limits<float>::max();
+
+    //Loop through every surrounding cell.
+    for (int z2 = -1; z2 <= 1; ++z2)
+    {
+        for (int y2 = -1; y2 <= 1; ++y2)
+        {
+            for (int x2 = -1; x2 <= 1; ++x2)
+            {
+                Vector3f center = GetCellCenter(cell + Vector3i(x2, y2, z2), cSizeF) / cSizeF;
+                Insert(DistFunc(cellPos, center), vals.Values, NUMB_DISTANCE_VALUES);
+            }
+        }
+    }
+
+    return Mathf::Clamp(ValueGenerator(vals), 0.0f, 1.0f);
+}
+
+void Worley2D::Generate(Array2D<float>& noise) const
 {
 	//Get the size of a cell.
-    unsigned int cSize = CellSize;//Mathf::Min(CellSize, noise.GetWidth(),
-                                    //Mathf::Min(noise.GetHeight(), noise.GetDepth()));
+    unsigned int cSize = Mathf::Min(CellSize, noise.GetWidth(), noise.GetHeight());
     float cSizeF = (float)cSize;
 
 	//Get the number of cells.
-	Vector3u cells = Vector3u(Mathf::Max((unsigned int)1, noise.GetWidth() / cSize),
-							  Mathf::Max((unsigned int)1, noise.GetHeight() / cSize),
-                              Mathf::Max((unsigned int)1, noise.GetDepth() / cSize));
-
-	Array3D<Vector3f> cellCenters(cells.x, cells.y, cells.z);
+	Vector2u cells = Vector2u((noise.GetWidth() / cSize),
+							  (noise.GetHeight() / cSize));
 
-	//Generate cell positions.
-	FastRand fr(Seed);
-    Vector3u loc;
-    for (loc.z = 0; loc.z < cells.z; ++loc.z)
+	//Generate cell positions. Cells past the edges of the grid wrap around to the other side.
+    //Add a border of those wrapped cells around the grid so every pixel can just look at
+    //    the cells right around it.
+    Vector2u lastCell((noise.GetWidth() - 1) / cSize, (noise.GetHeight() - 1) / cSize);
+	Array2D<Vector2f> cellCenters(lastCell.x + 3, lastCell.y + 3);
+    Vector2u loc;
+    for (loc.y = 0; loc.y < cellCenters.GetHeight(); ++loc.y)
     {
-        //Get the range of Z values available for the center of this cell.
-        float startZ = loc.z * cSizeF;
-        Interval zBreadth = Interval(startZ, startZ + cSizeF, 0.001f, true, true);
-        zBreadth.Inflate(Variability.z);
-
-        for (loc.y = 0; loc.y < cells.y; ++loc.y)
+        for (loc.x = 0; loc.x < cellCenters.GetWidth(); ++loc.x)
         {
-            //Get the range of Y values available for the center of this cell.
-            float startY = loc.y * cSizeF;
-            Interval yBreadth = Interval(startY, startY + cSizeF, 0.001f, true, true);
-            yBreadth.Inflate(Variability.y);
-
-            for (loc.x = 0; loc.x < cells.x; ++loc.x)
+            Vector2i cell = ToV2i(loc) - Vector2i(1, 1);
+            Vector2f posOffset;
+            while (cell.x < 0)
+            {
+                cell.x += cells.x;
+                posOffset.x -= (float)noise.GetWidth();
+            }
+            while (cell.x >= (int)cells.x)
+            {
+                cell.x -= cells.x;
+                posOffset.x += (float)noise.GetWidth();
+            }
+            while (cell.y < 0)
+            {
+                cell.y += cells.y;
+                posOffset.y -= (float)noise.GetHeight();
+            }
+            while (cell.y >= (int)cells.y)
             {
-                //Get the range of X values available for the center of this cell.
-                float startX = loc.x * cSizeF;
-                Interval xBreadth = Interval(startX, startX + cSizeF, 0.001f, true, true);
-                xBreadth.Inflate(Variability.x);
-
-                //Generate the center position for this cell.
-                fr.Seed = Vector4i(Seed,
-                                   (int)loc.x + CellOffset.x,
-                                   (int)loc.y + CellOffset.y,
-                                   (int)loc.z + CellOffset.z).GetHashCode();
-                fr.GetRandInt();
-                fr.GetRandInt();
-                cellCenters[loc] = Vector3f(xBreadth.RandomInsideRange(fr),
-                                            yBreadth.RandomInsideRange(fr),
-                                            zBreadth.RandomInsideRange(fr));
+                cell.y -= cells.y;
+                posOffset.y += (float)noise.GetHeight();
             }
+
+            cellCenters[loc] = GetCellCenter(cell, cSizeF) + posOffset;
         }
     }
 
 
-	//Get n-th-closest point for every spot on the noise grid.
-
-    float min = std::numeric_limits<float>::max(),
-          max = -std::numeric_limits<float>::max();
+	//Get n-th-closest point for every spot on the noise grid, one tile at a time.
+    //Use a kernel built around the distance function if it's one of the built-in ones.
 
-	DistanceValues vals;
-	Vector3f tempPos;
-    Vector3u tempCellLoc;
-    loc = Vector3u();
+    WorleyTileData2D tileData;
+    tileData.CellCenters = &cellCenters;
+    tileData.CellSize = cSize;
+    tileData.ValueGenerator = ValueGenerator;
+    tileData.Output = &noise;
 
-    for (loc.z = 0; loc.z < noise.GetDepth(); ++loc.z)
-    {
-        tempPos.z = (float)loc.z;
-        tempCellLoc.z = loc.z / cSize;
+    Vector2u nTiles = NoiseTiling::GetNTiles(noise.GetDimensions());
+    NoiseTiling::TileMinMax tileMinMaxes(nTiles.x * nTiles.y);
 
-        for (loc.y = 0; loc.y < noise.GetHeight(); ++loc.y)
-        {
-            tempPos.y = (float)loc.y;
-            tempCellLoc.y = loc.y / cSize;
+    if (DistFunc == &StraightLineDistance)
+        GenerateWorleyTiles2D(tileData, StraightLineMetric<Vector2f>(), Threads, tileMinMaxes);
+    else if (DistFunc == &StraightLineDistanceSquared)
+        GenerateWorleyTiles2D(tileData, StaticMetric<Vector2f, &StraightLineDistanceSquared>(), Threads, tileMinMaxes);
+    else if (DistFunc == &ManhattanDistance)
+        GenerateWorleyTiles2D(tileData, StaticMetric<Vector2f, &ManhattanDistance>(), Threads, tileMinMaxes);
+    else if (DistFunc == &LargestManhattanDistance)
+        GenerateWorleyTiles2D(tileData, StaticMetric<Vector2f, &LargestManhattanDistance>(), Threads, tileMinMaxes);
+    else if (DistFunc == &SmallestManhattanDistance)
+        GenerateWorleyTiles2D(tileData, StaticMetric<Vector2f, &SmallestManhattanDistance>(), Threads, tileMinMaxes);
+    else
+        GenerateWorleyTiles2D(tileData, RuntimeMetric<Vector2f>(DistFunc), Threads, tileMinMaxes);
 
-            for (loc.x = 0; loc.x < noise.GetWidth(); ++loc.x)
-            {
-                tempPos.x = (float)loc.x;
-                tempCellLoc.x = loc.x / cSize;
+	//Remap values to 0-1.
+    NoiseAnalysis2D::MinMax minMax = tileMinMaxes.GetTotal();
+    NoiseTiling::Remap(noise,
+                       Interval(minMax.Min, minMax.Max, 0.000001f, true, true),
+                       Interval(0.0f, 1.0f, 0.000001f, true, true),
+                       Threads);
+}
+void Worley3D::Generate(Array3D<float>& noise) const
+{
+	//Get the size of a cell.
+    unsigned int cSize = CellSize;
+    float cSizeF = (float)cSize;
 
-                for (unsigned int i = 0; i < NUMB_DISTANCE_VALUES; ++i)
-                    vals.Values[i] = std::numeric_limits<float>::max();
+	//Get the number of cells.
+	Vector3u cells = Vector3u(Mathf::Max((unsigned int)1, noise.GetWidth() / cSize),
+							  Mathf::Max((unsigned int)1, noise.GetHeight() / cSize),
+                              Mathf::Max((unsigned int)1, noise.GetDepth() / cSize));
 
-                //Loop through every surrounding cell.
-                for (int z2 = -1; z2 <= 1; ++z2)
+	//Generate cell positions. Cells past the edges of the grid wrap around to the other side.
+    //Add a border of those wrapped cells around the grid so every pixel can just look at
+    //    the cells right around it.
+    Vector3u lastCell((noise.GetWidth() - 1) / cSize,
+                      (noise.GetHeight() - 1) / cSize,
+                      (noise.GetDepth() - 1) / cSize);
+	Array3D<Vector3f> cellCenters(lastCell.x + 3, lastCell.y + 3, lastCell.z + 3);
+    Vector3u loc;
+    for (loc.z = 0; loc.z < cellCenters.GetDepth(); ++loc.z)
+    {
+        for (loc.y = 0; loc.y < cellCenters.GetHeight(); ++loc.y)
+        {
+            for (loc.x = 0; loc.x < cellCenters.GetWidth(); ++loc.x)
+            {
+                Vector3i cell = ToV3i(loc) - Vector3i(1, 1, 1);
+                Vector3f posOffset;
+                while (cell.x < 0)
                 {
-                    for (int y2 = -1; y2 <= 1; ++y2)
-                    {
-                        for (int x2 = -1; x2 <= 1; ++x2)
-                        {
-                            //If this cell is out of the bounds of the cell grid, wrap around.
-                            Vector3i tempCell = ToV3i(tempCellLoc) + Vector3i(x2, y2, z2),
-                                     tempCellWrapped = tempCell;
-                            Vector3f posOffset;
-                            if (tempCell.x < 0)
-                            {
-                                tempCellWrapped.x += cells.x;
-                                posOffset.x = -(float)noise.GetWidth();
-                            }
-                            else if (tempCell.x >= cells.x)
-                            {
-                                tempCellWrapped.x -= cells.x;
-                                posOffset.x = (float)noise.GetWidth();
-                            }
-                            if (tempCell.y < 0)
-                            {
-                                tempCellWrapped.y += cells.y;
-                                posOffset.y = -(float)noise.GetHeight();
-                            }
-                            else if (tempCell.y >= cells.y)
-                            {
-                                tempCellWrapped.y -= cells.y;
-                                posOffset.y = (float)noise.GetHeight();
-                            }
-                            if (tempCell.z < 0)
-                            {
-                                tempCellWrapped.z += cells.z;
-                                posOffset.z = -(float)noise.GetDepth();
-                            }
-                            else if (tempCell.z >= cells.z)
-                            {
-                                tempCellWrapped.z -= cells.z;
-                                posOffset.z = (float)noise.GetDepth();
-                            }
-                            Vector3u tempCellWrappedU = ToV3u(tempCellWrapped);
-
-                            //Get the distance to the cell's center
-                            //    and insert that distance into the sorted array.
-                            float tempDist = DistFunc(tempPos, cellCenters[tempCellWrappedU] + posOffset);
-                            Insert(tempDist, vals.Values, NUMB_DISTANCE_VALUES);
-                        }
-                    }
+                    cell.x += cells.x;
+                    posOffset.x -= (float)noise.GetWidth();
+                }
+                while (cell.x >= (int)cells.x)
+                {
+                    cell.x -= cells.x;
+                    posOffset.x += (float)noise.GetWidth();
+                }
+                while (cell.y < 0)
+                {
+                    cell.y += cells.y;
+                    posOffset.y -= (float)noise.GetHeight();
+                }
+                while (cell.y >= (int)cells.y)
+                {
+                    cell.y -= cells.y;
+                    posOffset.y += (float)noise.GetHeight();
+                }
+                while (cell.z < 0)
+                {
+                    cell.z += cells.z;
+                    posOffset.z -= (float)noise.GetDepth();
+                }
+                while (cell.z >= (int)cells.z)
+                {
+                    cell.z -= cells.z;
+                    posOffset.z += (float)noise.GetDepth();
                 }
 
-                float noiseVal = ValueGenerator(vals);
-                min = Mathf::Min(min, noiseVal);
-                max = Mathf::Max(max, noiseVal);
-                noise[loc] = noiseVal;
+                cellCenters[loc] = GetCellCenter(cell, cSizeF) + posOffset;
             }
         }
     }
 
+
+	//Get n-th-closest point for every spot on the noise grid, one tile at a time.
+    //Use a kernel built around the distance function if it's one of the built-in ones.
+
+    WorleyTileData3D tileData;
+    tileData.CellCenters = &cellCenters;
+    tileData.CellSize = cSize;
+    tileData.ValueGenerator = ValueGenerator;
+    tileData.Output = &noise;
+
+    Vector3u nTiles = NoiseTiling::GetNTiles(noise.GetDimensions());
+    NoiseTiling::TileMinMax tileMinMaxes(nTiles.x * nTiles.y * nTiles.z);
+
+    if (DistFunc == &StraightLineDistance)
+        GenerateWorleyTiles3D(tileData, StraightLineMetric<Vector3f>(), Threads, tileMinMaxes);
+    else if (DistFunc == &StraightLineDistanceSquared)
+        GenerateWorleyTiles3D(tileData, StaticMetric<Vector3f, &StraightLineDistanceSquared>(), Threads, tileMinMaxes);
+    else if (DistFunc == &ManhattanDistance)
+        GenerateWorleyTiles3D(tileData, StaticMetric<Vector3f, &ManhattanDistance>(), Threads, tileMinMaxes);
+    else if (DistFunc == &LargestManhattanDistance)
+        GenerateWorleyTiles3D(tileData, StaticMetric<Vector3f, &LargestManhattanDistance>(), Threads, tileMinMaxes);
+    else if (DistFunc == &SmallestManhattanDistance)
+        GenerateWorleyTiles3D(tileData, StaticMetric<Vector3f, &SmallestManhattanDistance>(), Threads, tileMinMaxes);
+    else
+        GenerateWorleyTiles3D(tileData, RuntimeMetric<Vector3f>(DistFunc), Threads, tileMinMaxes);
+
 	//Remap values to 0-1.
-	NoiseFilterer3D nf;
-    MaxFilterVolume mfv;
-	nf.FillVolume = &mfv;
-	nf.RemapValues_OldVals = Interval(min, max, 0.000001f, true, true);
-    nf.RemapValues(&noise);
+    NoiseAnalysis2D::MinMax minMax = tileMinMaxes.GetTotal();
+    NoiseTiling::Remap(noise, Interval(minMax.Min, minMax.Max, 0.000001f, true, true),
+                       Interval::GetZeroToOne(), Threads);
 }
 
 
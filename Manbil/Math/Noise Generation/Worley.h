@@ -32,6 +32,7 @@ public:
 
 
     //How to calculate the distance between two points.
+    //The built-in distance functions above get their own (faster) version of the generation code.
 	DistanceCalculatorFunc DistFunc;
     //The value of each pixel of worley noise given the distances to the closest cells around it.
     GetValueFunc ValueGenerator;
@@ -56,6 +57,18 @@ public:
 
 
 	virtual void Generate(Noise2D& noise) const override;
+
+    virtual bool CanSample(void) const override { return true; }
+    //Unlike "Generate()", the cells don't wrap around, and the distances are measured in cells
+    //    instead of pixels. The value is clamped to the range 0-1 instead of being remapped.
+    virtual float Sample(Vector2f pos) const override;
+
+
+private:
+
+    //Gets the center of the given cell, given the size of each cell.
+    //Only depends on the cell's position (plus "CellOffset") and this generator's seed.
+    Vector2f GetCellCenter(Vector2i cell, float cellSize) const;
 };
 
 
@@ -73,8 +86,8 @@ public:
     static inline float StraightLineDistance       (Vector3f o, Vector3f p) { return o.Distance(p); }
     static inline float StraightLineDistanceSquared(Vector3f o, Vector3f p) { return o.DistanceSquared(p); }
     static inline float ManhattanDistance          (Vector3f o, Vector3f p) { return o.ManhattanDistance(p); }
-    static inline float LargestManhattanDistance   (Vector3f o, Vector3f p) { return Mathf::Max(Mathf::Abs(o.x - p.x), Mathf::Abs(o.y - p.y)); }
-    static inline float SmallestManhattanDistance  (Vector3f o, Vector3f p) { return Mathf::Min(Mathf::Abs(o.x - p.x), Mathf::Abs(o.y - p.y)); }
+    static inline float LargestManhattanDistance   (Vector3f o, Vector3f p) { return Mathf::Max(Mathf::Abs(o.x - p.x), Mathf::Abs(o.y - p.y), Mathf::Abs(o.z - p.z)); }
+    static inline float SmallestManhattanDistance  (Vector3f o, Vector3f p) { return Mathf::Min(Mathf::Abs(o.x - p.x), Mathf::Abs(o.y - p.y), Mathf::Abs(o.z - p.z)); }
 
 
 	static const unsigned int NUMB_DISTANCE_VALUES = 3;
@@ -86,6 +99,7 @@ public:
 
 
     //How to calculate the distance between two points.
+    //The built-in distance functions above get their own (faster) version of the generation code.
 	DistanceCalculatorFunc DistFunc;
     //The value of each pixel of worley noise given the distances to the closest cells around it.
     GetValueFunc ValueGenerator;
@@ -109,4 +123,16 @@ public:
 
 
 	virtual void Generate(Noise3D& noise) const override;
+
+    virtual bool CanSample(void) const override { return true; }
+    //Unlike "Generate()", the cells don't wrap around, and the distances are measured in cells
+    //    instead of pixels. The value is clamped to the range 0-1 instead of being remapped.
+    virtual float Sample(Vector3f pos) const override;
+
+
+private:
+
+    //Gets the center of the given cell, given the size of each cell.
+    //Only depends on the cell's position (plus "CellOffset") and this generator's seed.
+    Vector3f GetCellCenter(Vector3i cell, float cellSize) const;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Boxes.h"
 
+#include <algorithm>
+#include <limits>
 #include "../Higher Math/Geometryf.h"
 
 
@@ -380,4 +382,83 @@ bool Box3D::IsEqual(const Box3D & other) const
 		   WithinError(dimensions.x, other.dimensions.x) &&
 		   WithinError(dimensions.y, other.dimensions.y) &&
 		   WithinError(dimensions.z, other.dimensions.z);
+}
+
+float Box3D::GetDistanceSquared(Vector3f segmentStart, Vector3f segmentEnd) const
+{
+    //The squared distance from a point on the segment to the box is a piecewise quadratic function
+    //    of the point's position along the segment ("t"), with a new piece wherever the segment
+    //    crosses one of the box's face planes. Minimize each piece separately.
+
+    Vector3f delta = segmentEnd - segmentStart,
+             boxMin = GetMinCorner(),
+             boxMax = GetMaxCorner();
+
+    //Get the values of "t" where the segment crosses a face plane.
+    float pieceBorders[8];
+    unsigned int nPieceBorders = 0;
+    pieceBorders[nPieceBorders++] = 0.0f;
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+        if (delta[axis] != 0.0f)
+        {
+            float tMin = (boxMin[axis] - segmentStart[axis]) / delta[axis],
+                  tMax = (boxMax[axis] - segmentStart[axis]) / delta[axis];
+            if (tMin > 0.0f && tMin < 1.0f)
+                pieceBorders[nPieceBorders++] = tMin;
+            if (tMax > 0.0f && tMax < 1.0f)
+                pieceBorders[nPieceBorders++] = tMax;
+        }
+    }
+    pieceBorders[nPieceBorders++] = 1.0f;
+    std::sort(pieceBorders, pieceBorders + nPieceBorders);
+
+    float closestDistSqr = std::numeric_limits<float>::max();
+    for (unsigned int piece = 0; piece + 1 < nPieceBorders; ++piece)
+    {
+        float tStart = pieceBorders[piece],
+              tEnd = pieceBorders[piece + 1];
+
+        //Along each axis, the whole piece is either inside the box's interval or on one side of it.
+        //The squared distance is the sum of "(start + (delta * t) - face)^2" for every axis it's outside.
+        Vector3f midPoint = segmentStart + (delta * (0.5f * (tStart + tEnd)));
+        Vector3f faces;
+        bool isOutside[3];
+        float numerator = 0.0f,
+              denominator = 0.0f;
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+            isOutside[axis] = true;
+            if (midPoint[axis] < boxMin[axis])
+                faces[axis] = boxMin[axis];
+            else if (midPoint[axis] > boxMax[axis])
+                faces[axis] = boxMax[axis];
+            else
+                isOutside[axis] = false;
+
+            if (isOutside[axis])
+            {
+                numerator -= delta[axis] * (segmentStart[axis] - faces[axis]);
+                denominator += delta[axis] * delta[axis];
+            }
+        }
+
+        //Find the minimum of the quadratic, then clamp it to this piece.
+        float t = (denominator > 0.0f ?
+                       Mathf::Clamp(numerator / denominator, tStart, tEnd) :
+                       tStart);
+        float distSqr = 0.0f;
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+            if (isOutside[axis])
+            {
+                float offset = segmentStart[axis] + (delta[axis] * t) - faces[axis];
+                distSqr += offset * offset;
+            }
+        }
+
+        closestDistSqr = Mathf::Min(closestDistSqr, distSqr);
+    }
+
+    return closestDistSqr;
 }
\ No newline at end of file
@@ -186,6 +186,10 @@ public:
     //Finds if the given point is on a face of this Box3D.
     bool IsPointOnFace(Vector3f point) const;
 
+    //Gets the squared distance between this Box3D and the closest point on the given line segment.
+    //Returns 0 if the segment touches the box.
+    float GetDistanceSquared(Vector3f segmentStart, Vector3f segmentEnd) const;
+
     //Finds if this Box3D is equal to the given one, within the static GeometricError value.
     bool IsEqual(const Box3D & other) const;
 
@@ -0,0 +1,694 @@
+#include "CollisionBatch.h"
+
+
+//Use SSE to test four shapes at once if the target supports it.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+    #define COLLISIONBATCH_USE_SSE
+    #include <xmmintrin.h>
+#endif
+
+
+namespace
+{
+    //Used in place of 0 in denominators.
+    const float TINY = 1.0e-30f;
+    //The "t" value a ray test gives when it doesn't hit anything.
+    const float NO_HIT = -1.0f;
+
+
+    //The shape tests are written once for both single floats and "Float4".
+    //Comparisons give a "mask" -- a bool for single floats, and a Float4 with all bits set or cleared
+    //    in each element for "Float4".
+
+    inline float Min(float a, float b) { return (a < b ? a : b); }
+    inline float Max(float a, float b) { return (a > b ? a : b); }
+    inline float Sqrt(float f) { return sqrtf(f); }
+    inline bool And(bool a, bool b) { return a && b; }
+    inline float Select(bool mask, float ifTrue, float ifFalse) { return (mask ? ifTrue : ifFalse); }
+    inline void Load(const float* f, float& outF) { outF = *f; }
+
+    template<typename Real>
+    struct Mask { typedef bool Type; };
+
+#ifdef COLLISIONBATCH_USE_SSE
+    //Four floats, with the same operators the tests use on a single float.
+    struct Float4
+    {
+        __m128 V;
+
+        Float4(void) { }
+        Float4(__m128 v) : V(v) { }
+        Float4(float f) : V(_mm_set1_ps(f)) { }
+
+        Float4 operator+(Float4 f) const { return _mm_add_ps(V, f.V); }
+        Float4 operator-(Float4 f) const { return _mm_sub_ps(V, f.V); }
+        Float4 operator*(Float4 f) const { return _mm_mul_ps(V, f.V); }
+        Float4 operator/(Float4 f) const { return _mm_div_ps(V, f.V); }
+        Float4 operator-(void) const { return _mm_sub_ps(_mm_setzero_ps(), V); }
+
+        Float4 operator<(Float4 f) const { return _mm_cmplt_ps(V, f.V); }
+        Float4 operator<=(Float4 f) const { return _mm_cmple_ps(V, f.V); }
+        Float4 operator>=(Float4 f) const { return _mm_cmpge_ps(V, f.V); }
+        Float4 operator>(Float4 f) const { return _mm_cmpgt_ps(V, f.V); }
+    };
+    inline Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a.V, b.V); }
+    inline Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a.V, b.V); }
+    inline Float4 Sqrt(Float4 f) { return _mm_sqrt_ps(f.V); }
+    inline Float4 And(Float4 a, Float4 b) { return _mm_and_ps(a.V, b.V); }
+    inline Float4 Select(Float4 mask, Float4 ifTrue, Float4 ifFalse)
+    {
+        return _mm_or_ps(_mm_and_ps(mask.V, ifTrue.V), _mm_andnot_ps(mask.V, ifFalse.V));
+    }
+    inline void Load(const float* f, Float4& outF) { outF = _mm_loadu_ps(f); }
+
+    template<>
+    struct Mask<Float4> { typedef Float4 Type; };
+#endif
+
+    template<typename Real>
+    Real Clamp(Real f, Real min, Real max) { return Min(Max(f, min), max); }
+
+
+    template<typename Real>
+    //A 3D vector of either single floats or "Float4".
+    struct Vec3
+    {
+        Real X, Y, Z;
+
+        Vec3(void) { }
+        Vec3(Real x, Real y, Real z) : X(x), Y(y), Z(z) { }
+        Vec3(Vector3f v) : X(v.x), Y(v.y), Z(v.z) { }
+
+        Vec3 operator+(const Vec3& v) const { return Vec3(X + v.X, Y + v.Y, Z + v.Z); }
+        Vec3 operator-(const Vec3& v) const { return Vec3(X - v.X, Y - v.Y, Z - v.Z); }
+        Vec3 operator*(Real f) const { return Vec3(X * f, Y * f, Z * f); }
+        Real Dot(const Vec3& v) const { return (X * v.X) + (Y * v.Y) + (Z * v.Z); }
+    };
+
+    template<typename Real>
+    Real Load(const std::vector<float>& values, unsigned int i)
+    {
+        Real r;
+        Load(&values[i], r);
+        return r;
+    }
+    template<typename Real>
+    Vec3<Real> Load(const std::vector<float>& x, const std::vector<float>& y, const std::vector<float>& z,
+                    unsigned int i)
+    {
+        return Vec3<Real>(Load<Real>(x, i), Load<Real>(y, i), Load<Real>(z, i));
+    }
+
+
+    template<typename Real>
+    //Gets the squared distance from the given point to the closest point on the given line segment.
+    Real SegmentPointDistanceSquared(const Vec3<Real>& start, const Vec3<Real>& end, const Vec3<Real>& point)
+    {
+        Vec3<Real> delta = end - start,
+                   toPoint = point - start;
+        Real t = Clamp(toPoint.Dot(delta) / Max(delta.Dot(delta), Real(TINY)), Real(0.0f), Real(1.0f));
+
+        Vec3<Real> offset = toPoint - (delta * t);
+        return offset.Dot(offset);
+    }
+    template<typename Real>
+    //Gets the squared distance between the closest points on the two given line segments.
+    //Does the same thing as "Geometryf::ClosestToIntersection()" without any branches.
+    Real SegmentSegmentDistanceSquared(const Vec3<Real>& start1, const Vec3<Real>& end1,
+                                       const Vec3<Real>& start2, const Vec3<Real>& end2)
+    {
+        Vec3<Real> u = end1 - start1,
+                   v = end2 - start2,
+                   w = start1 - start2;
+        Real a = u.Dot(u),
+             b = u.Dot(v),
+             c = v.Dot(v),
+             d = u.Dot(w),
+             e = v.Dot(w);
+        Real zero(0.0f), one(1.0f), tiny(TINY);
+
+        Real denominator = (a * c) - (b * b);
+        Real s = Select(denominator > tiny,
+                        Clamp(((b * e) - (c * d)) / Max(denominator, tiny), zero, one),
+                        zero);
+        Real t = Clamp(((b * s) + e) / Max(c, tiny), zero, one);
+        s = Clamp(((b * t) - d) / Max(a, tiny), zero, one);
+
+        Vec3<Real> offset = (w + (u * s)) - (v * t);
+        return offset.Dot(offset);
+    }
+
+    template<typename Real>
+    //Gets the first "t" value where the given ray touches the given sphere, or "NO_HIT".
+    //"rayDirSqr" is "rayDir.Dot(rayDir)".
+    Real RaySphere(const Vec3<Real>& rayStart, const Vec3<Real>& rayDir, Real rayDirSqr,
+                   const Vec3<Real>& center, Real radius)
+    {
+        Real zero(0.0f);
+
+        Vec3<Real> centerToStart = rayStart - center;
+        Real b = centerToStart.Dot(rayDir),
+             c = centerToStart.Dot(centerToStart) - (radius * radius);
+        Real discriminant = (b * b) - (rayDirSqr * c);
+        Real t = (-b - Sqrt(Max(discriminant, zero))) / rayDirSqr;
+
+        //If the ray starts outside the sphere, both intersections are behind it or in front of it.
+        return Select(c <= zero, zero,
+                      Select(And(discriminant >= zero, t >= zero), t, Real(NO_HIT)));
+    }
+    template<typename Real>
+    //Gets the first "t" value where the given ray touches the side of the given capsule, or "NO_HIT".
+    //Doesn't include the capsule's rounded ends.
+    Real RayCylinder(const Vec3<Real>& rayStart, const Vec3<Real>& rayDir,
+                     const Vec3<Real>& start, const Vec3<Real>& end, Real radius)
+    {
+        Real zero(0.0f), one(1.0f), tiny(TINY);
+
+        //Remove the part of the ray along the cylinder's axis, then solve for the infinite cylinder.
+        Vec3<Real> axis = end - start,
+                   axisToStart = rayStart - start;
+        Real invAxisLenSqr = one / Max(axis.Dot(axis), tiny);
+        Real dirAlongAxis = axis.Dot(rayDir) * invAxisLenSqr,
+             startAlongAxis = axis.Dot(axisToStart) * invAxisLenSqr;
+        Vec3<Real> dirOffAxis = rayDir - (axis * dirAlongAxis),
+                   startOffAxis = axisToStart - (axis * startAlongAxis);
+
+        Real a = dirOffAxis.Dot(dirOffAxis),
+             b = dirOffAxis.Dot(startOffAxis),
+             c = startOffAxis.Dot(startOffAxis) - (radius * radius);
+        Real discriminant = (b * b) - (a * c);
+        Real t = (-b - Sqrt(Max(discriminant, zero))) / Max(a, tiny);
+        Real hitAlongAxis = startAlongAxis + (dirAlongAxis * t);
+
+        //A ray parallel to the axis can only hit the rounded ends.
+        typename Mask<Real>::Type isHit = And(And(a > tiny, discriminant >= zero),
+                         And(t >= zero, And(hitAlongAxis >= zero, hitAlongAxis <= one)));
+        typename Mask<Real>::Type isInside = And(c <= zero, And(startAlongAxis >= zero, startAlongAxis <= one));
+        return Select(isInside, zero, Select(isHit, t, Real(NO_HIT)));
+    }
+    template<typename Real>
+    //Gets whichever of the two ray "t" values is the closest hit, or "NO_HIT" if neither one hit.
+    Real ClosestHit(Real t1, Real t2)
+    {
+        Real zero(0.0f);
+        return Select(t1 < zero, t2,
+                      Select(t2 < zero, t1, Min(t1, t2)));
+    }
+
+
+    //Each query tester has a method "Mask<Real>::Type Test<Real>(unsigned int i) const"
+    //    that tests the shape(s) starting at index "i".
+
+    template<typename Tester>
+    //Adds every shape of the given type that passes the given tester to the end of "outShapes".
+    void FindTouchingShapes(const Tester& tester, unsigned int nShapes, CollisionBatch::ShapeTypes type,
+                            std::vector<CollisionBatch::ShapeRef>& outShapes)
+    {
+        unsigned int i = 0;
+
+#ifdef COLLISIONBATCH_USE_SSE
+        for (; i + 4 <= nShapes; i += 4)
+        {
+            int bits = _mm_movemask_ps(tester.template Test<Float4>(i).V);
+            for (unsigned int j = 0; bits != 0; ++j, bits >>= 1)
+                if ((bits & 1) != 0)
+                    outShapes.push_back(CollisionBatch::ShapeRef(type, i + j));
+        }
+#endif
+
+        for (; i < nShapes; ++i)
+            if (tester.template Test<float>(i))
+                outShapes.push_back(CollisionBatch::ShapeRef(type, i));
+    }
+
+
+    //Each ray tester has a method "Real GetT<Real>(unsigned int i) const"
+    //    that gets the ray's "t" value for the shape(s) starting at index "i", or "NO_HIT".
+
+    template<typename Tester>
+    //Updates "closestHit" if the ray hits a shape of the given type that's closer than it.
+    //Only hits up to "maxT" are counted.
+    void CastRayAtShapes(const Tester& tester, unsigned int nShapes, CollisionBatch::ShapeTypes type,
+                         float maxT, CollisionBatch::RayHit& closestHit)
+    {
+        //Hits at the same distance go to the first shape found.
+        auto tryHit = [&](float t, unsigned int i)
+        {
+            if (t >= 0.0f && (closestHit.DidHit ? (t < closestHit.T) : (t <= maxT)))
+                closestHit = CollisionBatch::RayHit(CollisionBatch::ShapeRef(type, i), t);
+        };
+
+        unsigned int i = 0;
+
+#ifdef COLLISIONBATCH_USE_SSE
+        Float4 zero(0.0f);
+        for (; i + 4 <= nShapes; i += 4)
+        {
+            Float4 t = tester.template GetT<Float4>(i);
+
+            //Skip all four if none of them is a closer hit.
+            Float4 maxT4(closestHit.DidHit ? closestHit.T : maxT);
+            if (_mm_movemask_ps(And(t >= zero, t <= maxT4).V) == 0)
+                continue;
+
+            float ts[4];
+            _mm_storeu_ps(ts, t.V);
+            for (unsigned int j = 0; j < 4; ++j)
+                tryHit(ts[j], i + j);
+        }
+#endif
+
+        for (; i < nShapes; ++i)
+            tryHit(tester.template GetT<float>(i), i);
+    }
+}
+
+
+#pragma region Adding shapes
+
+unsigned int CollisionBatch::AddSphere(const Sphere& sphere)
+{
+    unsigned int index = GetNSpheres();
+    spheres.X.push_back(0.0f);
+    spheres.Y.push_back(0.0f);
+    spheres.Z.push_back(0.0f);
+    spheres.Radius.push_back(0.0f);
+    SetSphere(index, sphere);
+    return index;
+}
+unsigned int CollisionBatch::AddCapsule(const Capsule& capsule)
+{
+    unsigned int index = GetNCapsules();
+    capsules.X1.push_back(0.0f);
+    capsules.Y1.push_back(0.0f);
+    capsules.Z1.push_back(0.0f);
+    capsules.X2.push_back(0.0f);
+    capsules.Y2.push_back(0.0f);
+    capsules.Z2.push_back(0.0f);
+    capsules.Radius.push_back(0.0f);
+    SetCapsule(index, capsule);
+    return index;
+}
+unsigned int CollisionBatch::AddBox(const Box3D& box)
+{
+    unsigned int index = GetNBoxes();
+    boxes.MinX.push_back(0.0f);
+    boxes.MinY.push_back(0.0f);
+    boxes.MinZ.push_back(0.0f);
+    boxes.MaxX.push_back(0.0f);
+    boxes.MaxY.push_back(0.0f);
+    boxes.MaxZ.push_back(0.0f);
+    SetBox(index, box);
+    return index;
+}
+unsigned int CollisionBatch::AddPlane(const Plane& plane)
+{
+    unsigned int index = GetNPlanes();
+    planes.NormalX.push_back(0.0f);
+    planes.NormalY.push_back(0.0f);
+    planes.NormalZ.push_back(0.0f);
+    planes.Dist.push_back(0.0f);
+    SetPlane(index, plane);
+    return index;
+}
+
+void CollisionBatch::SetSphere(unsigned int index, const Sphere& sphere)
+{
+    spheres.X[index] = sphere.GetCenter().x;
+    spheres.Y[index] = sphere.GetCenter().y;
+    spheres.Z[index] = sphere.GetCenter().z;
+    spheres.Radius[index] = sphere.Radius;
+}
+void CollisionBatch::SetCapsule(unsigned int index, const Capsule& capsule)
+{
+    capsules.X1[index] = capsule.GetEndpoint1().x;
+    capsules.Y1[index] = capsule.GetEndpoint1().y;
+    capsules.Z1[index] = capsule.GetEndpoint1().z;
+    capsules.X2[index] = capsule.GetEndpoint2().x;
+    capsules.Y2[index] = capsule.GetEndpoint2().y;
+    capsules.Z2[index] = capsule.GetEndpoint2().z;
+    capsules.Radius[index] = capsule.Radius;
+}
+void CollisionBatch::SetBox(unsigned int index, const Box3D& box)
+{
+    boxes.MinX[index] = box.GetXMin();
+    boxes.MinY[index] = box.GetYMin();
+    boxes.MinZ[index] = box.GetZMin();
+    boxes.MaxX[index] = box.GetXMax();
+    boxes.MaxY[index] = box.GetYMax();
+    boxes.MaxZ[index] = box.GetZMax();
+}
+void CollisionBatch::SetPlane(unsigned int index, const Plane& plane)
+{
+    planes.NormalX[index] = plane.Normal.x;
+    planes.NormalY[index] = plane.Normal.y;
+    planes.NormalZ[index] = plane.Normal.z;
+    planes.Dist[index] = plane.GetCenter().Dot(plane.Normal);
+}
+
+void CollisionBatch::Clear(void)
+{
+    //Keep the arrays' memory around, since batches are often cleared and refilled every frame.
+    spheres.X.clear();
+    spheres.Y.clear();
+    spheres.Z.clear();
+    spheres.Radius.clear();
+
+    capsules.X1.clear();
+    capsules.Y1.clear();
+    capsules.Z1.clear();
+    capsules.X2.clear();
+    capsules.Y2.clear();
+    capsules.Z2.clear();
+    capsules.Radius.clear();
+
+    boxes.MinX.clear();
+    boxes.MinY.clear();
+    boxes.MinZ.clear();
+    boxes.MaxX.clear();
+    boxes.MaxY.clear();
+    boxes.MaxZ.clear();
+
+    planes.NormalX.clear();
+    planes.NormalY.clear();
+    planes.NormalZ.clear();
+    planes.Dist.clear();
+}
+
+#pragma endregion
+
+
+#pragma region Overlap queries
+
+namespace
+{
+    struct SphereQuery
+    {
+        Vector3f Center;
+        float Radius;
+        SphereQuery(const Sphere& s) : Center(s.GetCenter()), Radius(s.Radius) { }
+    };
+    struct CapsuleQuery
+    {
+        Vector3f Start, End;
+        float Radius;
+        CapsuleQuery(const Capsule& c) : Start(c.GetEndpoint1()), End(c.GetEndpoint2()), Radius(c.Radius) { }
+    };
+
+
+    struct SphereVsSpheres
+    {
+        const SphereQuery& Query;
+        const std::vector<float> &X, &Y, &Z, &Radius;
+
+        template<typename Real>
+        typename Mask<Real>::Type Test(unsigned int i) const
+        {
+            Vec3<Real> offset = Load<Real>(X, Y, Z, i) - Vec3<Real>(Query.Center);
+            Real radiusSum = Load<Real>(Radius, i) + Real(Query.Radius);
+            return offset.Dot(offset) <= (radiusSum * radiusSum);
+        }
+    };
+    struct SphereVsCapsules
+    {
+        const SphereQuery& Query;
+        const std::vector<float> &X1, &Y1, &Z1, &X2, &Y2, &Z2, &Radius;
+
+        template<typename Real>
+        typename Mask<Real>::Type Test(unsigned int i) const
+        {
+            Real distSqr = SegmentPointDistanceSquared(Load<Real>(X1, Y1, Z1, i), Load<Real>(X2, Y2, Z2, i),
+                                                       Vec3<Real>(Query.Center));
+            Real radiusSum = Load<Real>(Radius, i) + Real(Query.Radius);
+            return distSqr <= (radiusSum * radiusSum);
+        }
+    };
+    struct SphereVsBoxes
+    {
+        const SphereQuery& Query;
+        const std::vector<float> &MinX, &MinY, &MinZ, &MaxX, &MaxY, &MaxZ;
+
+        template<typename Real>
+        typename Mask<Real>::Type Test(unsigned int i) const
+        {
+            //Get the closest point in/on the box to the sphere's center.
+            Vec3<Real> center(Query.Center),
+                       boxMin = Load<Real>(MinX, MinY, MinZ, i),
+                       boxMax = Load<Real>(MaxX, MaxY, MaxZ, i);
+            Vec3<Real> offset = center - Vec3<Real>(Clamp(center.X, boxMin.X, boxMax.X),
+                                                    Clamp(center.Y, boxMin.Y, boxMax.Y),
+                                                    Clamp(center.Z, boxMin.Z, boxMax.Z));
+            Real radius(Query.Radius);
+            return offset.Dot(offset) <= (radius * radius);
+        }
+    };
+    struct SphereVsPlanes
+    {
+        const SphereQuery& Query;
+        const std::vector<float> &NormalX, &NormalY, &NormalZ, &Dist;
+
+        template<typename Real>
+        typename Mask<Real>::Type Test(unsigned int i) const
+        {
+            Real signedDist = Load<Real>(NormalX, NormalY, NormalZ, i).Dot(Vec3<Real>(Query.Center)) -
+                              Load<Real>(Dist, i);
+            Real radius(Query.Radius);
+            return And(signedDist <= radius, signedDist >= (Real(0.0f) - radius));
+        }
+    };
+
+    struct CapsuleVsSpheres
+    {
+        const CapsuleQuery& Query;
+        const std::vector<float> &X, &Y, &Z, &Radius;
+
+        template<typename Real>
+        typename Mask<Real>::Type Test(unsigned int i) const
+        {
+            Real distSqr = SegmentPointDistanceSquared(Vec3<Real>(Query.Start), Vec3<Real>(Query.End),
+                                                       Load<Real>(X, Y, Z, i));
+            Real radiusSum = Load<Real>(Radius, i) + Real(Query.Radius);
+            return distSqr <= (radiusSum * radiusSum);
+        }
+    };
+    struct CapsuleVsCapsules
+    {
+        const CapsuleQuery& Query;
+        const std::vector<float> &X1, &Y1, &Z1, &X2, &Y2, &Z2, &Radius;
+
+        template<typename Real>
+        typename Mask<Real>::Type Test(unsigned int i) const
+        {
+            Real distSqr = SegmentSegmentDistanceSquared(Vec3<Real>(Query.Start), Vec3<Real>(Query.End),
+                                                         Load<Real>(X1, Y1, Z1, i), Load<Real>(X2, Y2, Z2, i));
+            Real radiusSum = Load<Real>(Radius, i) + Real(Query.Radius);
+            return distSqr <= (radiusSum * radiusSum);
+        }
+    };
+    //Only checks whether the capsule's bounding box touches each box.
+    struct CapsuleVsBoxBounds
+    {
+        const CapsuleQuery& Query;
+        const std::vector<float> &MinX, &MinY, &MinZ, &MaxX, &MaxY, &MaxZ;
+
+        template<typename Real>
+        typename Mask<Real>::Type Test(unsigned int i) const
+        {
+            Vector3f radius(Query.Radius, Query.Radius, Query.Radius);
+            Vec3<Real> capsuleMin(Vector3f(Mathf::Min(Query.Start.x, Query.End.x),
+                                           Mathf::Min(Query.Start.y, Query.End.y),
+                                           Mathf::Min(Query.Start.z, Query.End.z)) - radius),
+                       capsuleMax(Vector3f(Mathf::Max(Query.Start.x, Query.End.x),
+                                           Mathf::Max(Query.Start.y, Query.End.y),
+                                           Mathf::Max(Query.Start.z, Query.End.z)) + radius),
+                       boxMin = Load<Real>(MinX, MinY, MinZ, i),
+                       boxMax = Load<Real>(MaxX, MaxY, MaxZ, i);
+            return And(And(And(capsuleMin.X <= boxMax.X, capsuleMax.X >= boxMin.X),
+                           And(capsuleMin.Y <= boxMax.Y, capsuleMax.Y >= boxMin.Y)),
+                       And(capsuleMin.Z <= boxMax.Z, capsuleMax.Z >= boxMin.Z));
+        }
+    };
+    struct CapsuleVsPlanes
+    {
+        const CapsuleQuery& Query;
+        const std::vector<float> &NormalX, &NormalY, &NormalZ, &Dist;
+
+        template<typename Real>
+        typename Mask<Real>::Type Test(unsigned int i) const
+        {
+            //The capsule touches if its endpoints' signed distances overlap [-radius, radius].
+            Vec3<Real> normal = Load<Real>(NormalX, NormalY, NormalZ, i);
+            Real dist = Load<Real>(Dist, i);
+            Real signedDist1 = normal.Dot(Vec3<Real>(Query.Start)) - dist,
+                 signedDist2 = normal.Dot(Vec3<Real>(Query.End)) - dist;
+            Real radius(Query.Radius);
+            return And(Min(signedDist1, signedDist2) <= radius,
+                       Max(signedDist1, signedDist2) >= (Real(0.0f) - radius));
+        }
+    };
+}
+
+void CollisionBatch::FindTouching(const Sphere& sphere, std::vector<ShapeRef>& outShapes) const
+{
+    SphereQuery query(sphere);
+
+    SphereVsSpheres vsSpheres = { query, spheres.X, spheres.Y, spheres.Z, spheres.Radius };
+    FindTouchingShapes(vsSpheres, GetNSpheres(), ST_SPHERE, outShapes);
+
+    SphereVsCapsules vsCapsules = { query, capsules.X1, capsules.Y1, capsules.Z1,
+                                    capsules.X2, capsules.Y2, capsules.Z2, capsules.Radius };
+    FindTouchingShapes(vsCapsules, GetNCapsules(), ST_CAPSULE, outShapes);
+
+    SphereVsBoxes vsBoxes = { query, boxes.MinX, boxes.MinY, boxes.MinZ, boxes.MaxX, boxes.MaxY, boxes.MaxZ };
+    FindTouchingShapes(vsBoxes, GetNBoxes(), ST_BOX, outShapes);
+
+    SphereVsPlanes vsPlanes = { query, planes.NormalX, planes.NormalY, planes.NormalZ, planes.Dist };
+    FindTouchingShapes(vsPlanes, GetNPlanes(), ST_PLANE, outShapes);
+}
+void CollisionBatch::FindTouching(const Capsule& capsule, std::vector<ShapeRef>& outShapes) const
+{
+    CapsuleQuery query(capsule);
+
+    CapsuleVsSpheres vsSpheres = { query, spheres.X, spheres.Y, spheres.Z, spheres.Radius };
+    FindTouchingShapes(vsSpheres, GetNSpheres(), ST_SPHERE, outShapes);
+
+    CapsuleVsCapsules vsCapsules = { query, capsules.X1, capsules.Y1, capsules.Z1,
+                                     capsules.X2, capsules.Y2, capsules.Z2, capsules.Radius };
+    FindTouchingShapes(vsCapsules, GetNCapsules(), ST_CAPSULE, outShapes);
+
+    //The exact capsule/box test has too many branches to do four at once,
+    //    so first find the boxes touching the capsule's bounds, then check each one exactly.
+    unsigned int firstBox = (unsigned int)outShapes.size();
+    CapsuleVsBoxBounds vsBoxes = { query, boxes.MinX, boxes.MinY, boxes.MinZ,
+                                   boxes.MaxX, boxes.MaxY, boxes.MaxZ };
+    FindTouchingShapes(vsBoxes, GetNBoxes(), ST_BOX, outShapes);
+    float radiusSqr = query.Radius * query.Radius;
+    const BoxArrays& boxesRef = boxes;
+    outShapes.erase(std::remove_if(outShapes.begin() + firstBox, outShapes.end(),
+                                   [&query, radiusSqr, &boxesRef](const ShapeRef& shape)
+                                   {
+                                       unsigned int i = shape.Index;
+                                       Box3D box(boxesRef.MinX[i], boxesRef.MaxX[i],
+                                                 boxesRef.MinY[i], boxesRef.MaxY[i],
+                                                 boxesRef.MinZ[i], boxesRef.MaxZ[i]);
+                                       return box.GetDistanceSquared(query.Start, query.End) > radiusSqr;
+                                   }),
+                    outShapes.end());
+
+    CapsuleVsPlanes vsPlanes = { query, planes.NormalX, planes.NormalY, planes.NormalZ, planes.Dist };
+    FindTouchingShapes(vsPlanes, GetNPlanes(), ST_PLANE, outShapes);
+}
+
+#pragma endregion
+
+
+#pragma region Ray queries
+
+namespace
+{
+    struct RayQuery
+    {
+        Vector3f Start, Dir, InvDir;
+        float DirSqr;
+        RayQuery(Vector3f start, Vector3f dir)
+            : Start(start), Dir(dir), InvDir(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z), DirSqr(dir.Dot(dir)) { }
+    };
+
+
+    struct RayVsSpheres
+    {
+        const RayQuery& Query;
+        const std::vector<float> &X, &Y, &Z, &Radius;
+
+        template<typename Real>
+        Real GetT(unsigned int i) const
+        {
+            return RaySphere(Vec3<Real>(Query.Start), Vec3<Real>(Query.Dir), Real(Query.DirSqr),
+                             Load<Real>(X, Y, Z, i), Load<Real>(Radius, i));
+        }
+    };
+    struct RayVsCapsules
+    {
+        const RayQuery& Query;
+        const std::vector<float> &X1, &Y1, &Z1, &X2, &Y2, &Z2, &Radius;
+
+        template<typename Real>
+        Real GetT(unsigned int i) const
+        {
+            //A capsule is a sphere at each end plus a cylinder between them.
+            Vec3<Real> rayStart(Query.Start), rayDir(Query.Dir),
+                       start = Load<Real>(X1, Y1, Z1, i),
+                       end = Load<Real>(X2, Y2, Z2, i);
+            Real radius = Load<Real>(Radius, i),
+                 rayDirSqr(Query.DirSqr);
+
+            return ClosestHit(ClosestHit(RaySphere(rayStart, rayDir, rayDirSqr, start, radius),
+                                         RaySphere(rayStart, rayDir, rayDirSqr, end, radius)),
+                              RayCylinder(rayStart, rayDir, start, end, radius));
+        }
+    };
+    struct RayVsBoxes
+    {
+        const RayQuery& Query;
+        const std::vector<float> &MinX, &MinY, &MinZ, &MaxX, &MaxY, &MaxZ;
+
+        template<typename Real>
+        Real GetT(unsigned int i) const
+        {
+            //Find where the ray is inside the box's interval along each axis, then intersect them.
+            Vec3<Real> rayStart(Query.Start), invDir(Query.InvDir);
+            Vec3<Real> tMin = Load<Real>(MinX, MinY, MinZ, i) - rayStart,
+                       tMax = Load<Real>(MaxX, MaxY, MaxZ, i) - rayStart;
+            tMin = Vec3<Real>(tMin.X * invDir.X, tMin.Y * invDir.Y, tMin.Z * invDir.Z);
+            tMax = Vec3<Real>(tMax.X * invDir.X, tMax.Y * invDir.Y, tMax.Z * invDir.Z);
+
+            Real tEnter = Max(Max(Min(tMin.X, tMax.X), Min(tMin.Y, tMax.Y)), Min(tMin.Z, tMax.Z)),
+                 tExit = Min(Min(Max(tMin.X, tMax.X), Max(tMin.Y, tMax.Y)), Max(tMin.Z, tMax.Z));
+            tEnter = Max(tEnter, Real(0.0f));
+            return Select(tEnter <= tExit, tEnter, Real(NO_HIT));
+        }
+    };
+    struct RayVsPlanes
+    {
+        const RayQuery& Query;
+        const std::vector<float> &NormalX, &NormalY, &NormalZ, &Dist;
+
+        template<typename Real>
+        Real GetT(unsigned int i) const
+        {
+            Vec3<Real> normal = Load<Real>(NormalX, NormalY, NormalZ, i);
+            Real t = (Load<Real>(Dist, i) - normal.Dot(Vec3<Real>(Query.Start))) /
+                     normal.Dot(Vec3<Real>(Query.Dir));
+
+            //Rays parallel to the plane give an infinite or NaN value.
+            return Select(And(t >= Real(0.0f), t < Real(std::numeric_limits<float>::infinity())),
+                          t, Real(NO_HIT));
+        }
+    };
+}
+
+CollisionBatch::RayHit CollisionBatch::CastRay(Vector3f rayStart, Vector3f rayDir, float maxT) const
+{
+    RayHit closestHit;
+    if (rayDir.x == 0.0f && rayDir.y == 0.0f && rayDir.z == 0.0f)
+        return closestHit;
+
+    RayQuery query(rayStart, rayDir);
+
+    RayVsSpheres vsSpheres = { query, spheres.X, spheres.Y, spheres.Z, spheres.Radius };
+    CastRayAtShapes(vsSpheres, GetNSpheres(), ST_SPHERE, maxT, closestHit);
+
+    RayVsCapsules vsCapsules = { query, capsules.X1, capsules.Y1, capsules.Z1,
+                                 capsules.X2, capsules.Y2, capsules.Z2, capsules.Radius };
+    CastRayAtShapes(vsCapsules, GetNCapsules(), ST_CAPSULE, maxT, closestHit);
+
+    RayVsBoxes vsBoxes = { query, boxes.MinX, boxes.MinY, boxes.MinZ, boxes.MaxX, boxes.MaxY, boxes.MaxZ };
+    CastRayAtShapes(vsBoxes, GetNBoxes(), ST_BOX, maxT, closestHit);
+
+    RayVsPlanes vsPlanes = { query, planes.NormalX, planes.NormalY, planes.NormalZ, planes.Dist };
+    CastRayAtShapes(vsPlanes, GetNPlanes(), ST_PLANE, maxT, closestHit);
+
+    return closestHit;
+}
+
+#pragma endregion
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ThreeDShapes.h"
+
+
+//Stores a large number of spheres, capsules, axis-aligned boxes, and planes for fast collision queries.
+//Each shape type is stored as a separate array for every component (e.x. all sphere X positions,
+//    then all sphere Y positions, etc.), so that queries can test four shapes at once with SSE.
+//Good for checking one thing (a projectile, a line of sight, etc.) against lots of simple shapes.
+class CollisionBatch
+{
+public:
+
+    enum ShapeTypes
+    {
+        ST_SPHERE = 0,
+        ST_CAPSULE,
+        ST_BOX,
+        ST_PLANE,
+    };
+
+    //Identifies a shape in a batch by its type and its index among the shapes of that type.
+    struct ShapeRef
+    {
+        ShapeTypes Type;
+        unsigned int Index;
+        ShapeRef(ShapeTypes type = ST_SPHERE, unsigned int index = 0) : Type(type), Index(index) { }
+    };
+
+    //The result of casting a ray into a batch.
+    struct RayHit
+    {
+        bool DidHit;
+        ShapeRef Shape;
+        //The hit position is [ray start] + ([ray direction] * T).
+        float T;
+        RayHit(void) : DidHit(false), T(0.0f) { }
+        RayHit(ShapeRef shape, float t) : DidHit(true), Shape(shape), T(t) { }
+    };
+
+
+    //Adding shapes returns the index of the new shape among the shapes of its type.
+
+    unsigned int AddSphere(const Sphere& sphere);
+    unsigned int AddCapsule(const Capsule& capsule);
+    unsigned int AddBox(const Box3D& box);
+    unsigned int AddPlane(const Plane& plane);
+
+    void SetSphere(unsigned int index, const Sphere& sphere);
+    void SetCapsule(unsigned int index, const Capsule& capsule);
+    void SetBox(unsigned int index, const Box3D& box);
+    void SetPlane(unsigned int index, const Plane& plane);
+
+    unsigned int GetNSpheres(void) const { return (unsigned int)spheres.Radius.size(); }
+    unsigned int GetNCapsules(void) const { return (unsigned int)capsules.Radius.size(); }
+    unsigned int GetNBoxes(void) const { return (unsigned int)boxes.MinX.size(); }
+    unsigned int GetNPlanes(void) const { return (unsigned int)planes.Dist.size(); }
+
+    //Removes every shape from this batch.
+    void Clear(void);
+
+
+    //Adds every shape in this batch that touches the given one to the end of "outShapes".
+    void FindTouching(const Sphere& sphere, std::vector<ShapeRef>& outShapes) const;
+    //Adds every shape in this batch that touches the given one to the end of "outShapes".
+    void FindTouching(const Capsule& capsule, std::vector<ShapeRef>& outShapes) const;
+
+    //Finds the closest shape hit by the given ray, looking only at "t" values from 0 to "maxT".
+    //The ray's direction doesn't have to be normalized.
+    //If the ray starts inside a shape, that shape is hit at t = 0.
+    RayHit CastRay(Vector3f rayStart, Vector3f rayDir,
+                   float maxT = std::numeric_limits<float>::infinity()) const;
+    //Finds whether any shape touches the line segment between the two given points,
+    //    e.x. to see if something is blocking the line of sight between them.
+    bool IsSegmentBlocked(Vector3f start, Vector3f end) const { return CastRay(start, end - start, 1.0f).DidHit; }
+
+
+private:
+
+    struct SphereArrays { std::vector<float> X, Y, Z, Radius; };
+    struct CapsuleArrays { std::vector<float> X1, Y1, Z1, X2, Y2, Z2, Radius; };
+    struct BoxArrays { std::vector<float> MinX, MinY, MinZ, MaxX, MaxY, MaxZ; };
+    //Each plane is the set of points "p" where "p.Dot(normal) == Dist".
+    struct PlaneArrays { std::vector<float> NormalX, NormalY, NormalZ, Dist; };
+
+    SphereArrays spheres;
+    CapsuleArrays capsules;
+    BoxArrays boxes;
+    PlaneArrays planes;
+};
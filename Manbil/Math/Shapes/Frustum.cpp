@@ -0,0 +1,171 @@
+#include "Frustum.h"
+
+
+//Use SSE to test four shapes at once if the target supports it.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+    #define FRUSTUM_USE_SSE
+    #include <xmmintrin.h>
+#endif
+
+
+Frustum::Frustum(const Matrix4f& viewProj)
+{
+    SetFromMatrix(viewProj);
+}
+Frustum::Frustum(const Camera& cam)
+{
+    Matrix4f viewM, projM;
+    cam.GetViewTransform(viewM);
+    cam.GetPerspectiveProjection(projM);
+    SetFromMatrix(Matrix4f::Multiply(projM, viewM));
+}
+
+void Frustum::SetFromMatrix(const Matrix4f& viewProj)
+{
+    //A point is visible if its clip-space X, Y, and Z are all between -W and W.
+    //Each of those six comparisons is a plane made from two rows of the matrix.
+    Vector4f rows[4];
+    for (unsigned int row = 0; row < 4; ++row)
+    {
+        rows[row] = Vector4f(viewProj[Vector2u(0, row)], viewProj[Vector2u(1, row)],
+                             viewProj[Vector2u(2, row)], viewProj[Vector2u(3, row)]);
+    }
+
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+        Vector4f minSide = rows[3] + rows[axis],
+                 maxSide = rows[3] - rows[axis];
+        planes[axis * 2] = FrustumPlane(Vector3f(minSide.x, minSide.y, minSide.z), minSide.w);
+        planes[(axis * 2) + 1] = FrustumPlane(Vector3f(maxSide.x, maxSide.y, maxSide.z), maxSide.w);
+    }
+
+    //Normalize the planes so that the sphere test can compare distances against the radius.
+    for (unsigned int i = 0; i < S_NUMBER_OF_SIDES; ++i)
+    {
+        float len = planes[i].Normal.Length();
+        if (len > 0.0f)
+        {
+            planes[i].Normal /= len;
+            planes[i].Dist /= len;
+        }
+    }
+}
+
+
+bool Frustum::Touches(Vector3f center, float radius) const
+{
+    for (unsigned int i = 0; i < S_NUMBER_OF_SIDES; ++i)
+        if (center.Dot(planes[i].Normal) + planes[i].Dist < -radius)
+            return false;
+    return true;
+}
+bool Frustum::Touches(const Box3D& box) const
+{
+    Vector3f min = box.GetMinCorner(),
+             max = box.GetMaxCorner();
+
+    //The box is outside if even its corner farthest along a plane's normal is behind that plane.
+    for (unsigned int i = 0; i < S_NUMBER_OF_SIDES; ++i)
+    {
+        const Vector3f& normal = planes[i].Normal;
+        Vector3f farthest((normal.x >= 0.0f ? max.x : min.x),
+                          (normal.y >= 0.0f ? max.y : min.y),
+                          (normal.z >= 0.0f ? max.z : min.z));
+        if (farthest.Dot(normal) + planes[i].Dist < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+
+unsigned int Frustum::CullSpheres(const float* x, const float* y, const float* z, const float* radius,
+                                  unsigned int count, unsigned int* outVisible) const
+{
+    unsigned int nVisible = 0,
+                 i = 0;
+
+#ifdef FRUSTUM_USE_SSE
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 sX = _mm_loadu_ps(&x[i]),
+               sY = _mm_loadu_ps(&y[i]),
+               sZ = _mm_loadu_ps(&z[i]),
+               negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+
+        //Start with all four spheres visible, and clear any sphere that's behind a plane.
+        __m128 isVisible = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps());
+        for (unsigned int side = 0; side < S_NUMBER_OF_SIDES; ++side)
+        {
+            const FrustumPlane& plane = planes[side];
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sX, _mm_set1_ps(plane.Normal.x)),
+                                                _mm_mul_ps(sY, _mm_set1_ps(plane.Normal.y))),
+                                     _mm_add_ps(_mm_mul_ps(sZ, _mm_set1_ps(plane.Normal.z)),
+                                                _mm_set1_ps(plane.Dist)));
+            isVisible = _mm_and_ps(isVisible, _mm_cmpge_ps(dist, negRadius));
+        }
+
+        //Write every index, but only move forward past the visible ones.
+        //This avoids a hard-to-predict branch per shape.
+        int bits = _mm_movemask_ps(isVisible);
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            outVisible[nVisible] = i + j;
+            nVisible += (bits >> j) & 1;
+        }
+    }
+#endif
+
+    for (; i < count; ++i)
+        if (Touches(Vector3f(x[i], y[i], z[i]), radius[i]))
+            outVisible[nVisible++] = i;
+
+    return nVisible;
+}
+unsigned int Frustum::CullBoxes(const float* minX, const float* minY, const float* minZ,
+                                const float* maxX, const float* maxY, const float* maxZ,
+                                unsigned int count, unsigned int* outVisible) const
+{
+    unsigned int nVisible = 0,
+                 i = 0;
+
+#ifdef FRUSTUM_USE_SSE
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 bMinX = _mm_loadu_ps(&minX[i]), bMaxX = _mm_loadu_ps(&maxX[i]),
+               bMinY = _mm_loadu_ps(&minY[i]), bMaxY = _mm_loadu_ps(&maxY[i]),
+               bMinZ = _mm_loadu_ps(&minZ[i]), bMaxZ = _mm_loadu_ps(&maxZ[i]);
+
+        __m128 isVisible = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps());
+        for (unsigned int side = 0; side < S_NUMBER_OF_SIDES; ++side)
+        {
+            //The plane is the same for all four boxes, so the corner to test can be picked up front.
+            const FrustumPlane& plane = planes[side];
+            __m128 cornerX = (plane.Normal.x >= 0.0f ? bMaxX : bMinX),
+                   cornerY = (plane.Normal.y >= 0.0f ? bMaxY : bMinY),
+                   cornerZ = (plane.Normal.z >= 0.0f ? bMaxZ : bMinZ);
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cornerX, _mm_set1_ps(plane.Normal.x)),
+                                                _mm_mul_ps(cornerY, _mm_set1_ps(plane.Normal.y))),
+                                     _mm_add_ps(_mm_mul_ps(cornerZ, _mm_set1_ps(plane.Normal.z)),
+                                                _mm_set1_ps(plane.Dist)));
+            isVisible = _mm_and_ps(isVisible, _mm_cmpge_ps(dist, _mm_setzero_ps()));
+        }
+
+        //Write every index, but only move forward past the visible ones.
+        //This avoids a hard-to-predict branch per shape.
+        int bits = _mm_movemask_ps(isVisible);
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            outVisible[nVisible] = i + j;
+            nVisible += (bits >> j) & 1;
+        }
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        if (Touches(Box3D(minX[i], maxX[i], minY[i], maxY[i], minZ[i], maxZ[i])))
+            outVisible[nVisible++] = i;
+    }
+
+    return nVisible;
+}
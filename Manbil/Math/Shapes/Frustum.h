@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ThreeDShapes.h"
+#include "../Higher Math/Camera.h"
+
+
+//The six planes around the region a camera can see.
+//Used to quickly skip rendering things that are off-screen.
+//The tests are conservative: something that's barely outside the frustum near one of its corners
+//    may still be counted as touching it, but nothing inside it will ever be culled.
+class Frustum
+{
+public:
+
+    enum Sides
+    {
+        S_LEFT = 0,
+        S_RIGHT,
+        S_BOTTOM,
+        S_TOP,
+        S_NEAR,
+        S_FAR,
+
+        S_NUMBER_OF_SIDES,
+    };
+
+    //A plane whose normal points into the frustum.
+    //A point "p" is on the inside of it if "p.Dot(Normal) + Dist >= 0".
+    struct FrustumPlane
+    {
+        Vector3f Normal;
+        float Dist;
+        FrustumPlane(Vector3f normal = Vector3f(), float dist = 0.0f) : Normal(normal), Dist(dist) { }
+    };
+
+
+    //Creates the frustum for an identity view-projection matrix (the cube from -1 to 1).
+    Frustum(void) : Frustum(Matrix4f()) { }
+    //Gets the frustum for the given view-projection matrix (e.x. "RenderInfo::mVP").
+    Frustum(const Matrix4f& viewProj);
+    //Gets the frustum for the given camera's view and perspective projection matrices.
+    Frustum(const Camera& cam);
+
+
+    const FrustumPlane& GetPlane(Sides side) const { return planes[side]; }
+
+
+    bool Touches(Vector3f center, float radius) const;
+    bool Touches(const Sphere& sphere) const { return Touches(sphere.GetCenter(), sphere.Radius); }
+    bool Touches(const Box3D& box) const;
+
+
+    //Tests every sphere in the given arrays against this frustum, four at a time with SSE
+    //    if the target supports it.
+    //Writes the index of every sphere that touches this frustum into "outVisible",
+    //    which must have room for "count" indices, and returns the number of indices written.
+    unsigned int CullSpheres(const float* x, const float* y, const float* z, const float* radius,
+                             unsigned int count, unsigned int* outVisible) const;
+    //Tests every axis-aligned box in the given arrays against this frustum, four at a time with SSE
+    //    if the target supports it.
+    //Writes the index of every box that touches this frustum into "outVisible",
+    //    which must have room for "count" indices, and returns the number of indices written.
+    unsigned int CullBoxes(const float* minX, const float* minY, const float* minZ,
+                           const float* maxX, const float* maxY, const float* maxZ,
+                           unsigned int count, unsigned int* outVisible) const;
+
+
+private:
+
+    FrustumPlane planes[S_NUMBER_OF_SIDES];
+
+
+    void SetFromMatrix(const Matrix4f& viewProj);
+};
@@ -50,522 +50,8 @@ bool Cube::TouchingSphere(const Sphere& sphere) const
 }
 bool Cube::TouchingCapsule(const Capsule& capsule) const
 {
-    //GJK algorithm. http://vec3.ca/gjk/implementation/
-    //TODO: Abstract out to Geometryf, or even a standalone class.
-
-    if (GetCenter() == capsule.GetCenter()) return true;
-
-    const Cube* cbe = this;
-    const Capsule& caps = capsule;
-    auto supportFunc = [cbe, caps](Vector3f dir) -> Vector3f
-    {
-        return cbe->FarthestPointInDirection(dir) - caps.FarthestPointInDirection(-dir);
-    };
-    auto crossABA = [](Vector3f a, Vector3f b) -> Vector3f { return a.Cross(b).Cross(a); };
-    Vector3f b, c, d,
-        v;
-    int n;
-
-    auto DoSimplex = [cbe, caps, &b, &c, &d, &v, &n, crossABA](Vector3f a) -> bool
-    {
-        if (n == 0)
-        {
-            b = a;
-            v = -a;
-            n = 1;
-        }
-        else if (n == 1)
-        {
-            v = crossABA(b - a, -a);
-
-            c = b;
-            b = a;
-            n = 2;
-        }
-        else if (n == 2)
-        {
-            Vector3f ao = -a,
-                ab = b - a,
-                ac = c - a;
-
-            Vector3f abc = ab.Cross(ac),
-                abp = ab.Cross(abc);
-
-            if (abp.Dot(ao) > 0.0f)
-            {
-                c = b;
-                b = a;
-                v = crossABA(ab, ao);
-            }
-            else
-            {
-                Vector3f acp = abc.Cross(ac);
-                if (acp.Dot(ao) > 0.0f)
-                {
-                    b = a;
-                    v = crossABA(ac, ao);
-                }
-                else
-                {
-                    n = 3;
-
-                    if (abc.Dot(ao) > 0.0f)
-                    {
-                        d = c;
-                        c = b;
-                        b = a;
-
-                        v = abc;
-                    }
-                    else
-                    {
-                        d = b;
-                        b = a;
-
-                        v = -abc;
-                    }
-                }
-            }
-        }
-        else if (n == 3)
-        {
-            Vector3f ao = -a,
-                ab = b - a,
-                ac = c - a;
-            Vector3f abc = ab.Cross(ac);
-            Vector3f ad, acd, adb;
-
-            if (abc.Dot(ao) > 0.0f)
-            {
-                goto checkFace;
-            }
-
-            ad = d - a;
-            acd = ac.Cross(ad);
-            if (acd.Dot(ao) > 0.0f)
-            {
-                b = c;
-                c = d;
-
-                ab = ac;
-                ac = ad;
-                abc = acd;
-
-                goto checkFace;
-            }
-
-            adb = ad.Cross(ab);
-            if (adb.Dot(ao) > 0.0f)
-            {
-                c = b;
-                b = d;
-
-                ac = ab;
-                ab = ad;
-
-                abc = adb;
-
-                goto checkFace;
-            }
-
-            return true;
-
-        checkFace:
-
-            Vector3f abp = ab.Cross(abc);
-
-            if (abp.Dot(ao) > 0)
-            {
-                c = b;
-                b = a;
-
-                v = crossABA(ab, ao);
-
-                n = 2;
-            }
-            else
-            {
-                Vector3f acp = abc.Cross(ac);
-                if (acp.Dot(ao) > 0.0f)
-                {
-                    b = a;
-
-                    v = crossABA(ac, ao);
-
-                    n = 2;
-                }
-                else
-                {
-                    d = c;
-                    c = b;
-                    b = a;
-
-                    v = abc;
-
-                    n = 3;
-                }
-            }
-        }
-
-        return false;
-    };
-
-    v = Vector3f(1.0f, 0.0f, 0.0f);
-    n = 0;
-
-    //Normally you should loop infinitely, but thanks to floating point error,
-    //    we might get caught in an infinte loop.
-    for (unsigned int i = 0; i < 10; ++i)
-    {
-        Vector3f a = supportFunc(v);
-
-        if (a.Dot(v) < 0.0f) return false;
-
-        if (DoSimplex(a)) return true;
-
-        v.Normalize();
-    }
-
-    //If the loop never managed to exit, it's very likely that this was an intersection.
-    return true;
-
-
-
-
-
-
-
-
-
-
-
-
-    //Use GJK algorithm.
-    /*
-    const Cube * cbe = this;
-    const Capsule & caps = capsule;
-    auto supportFunc = [cbe, caps](Vector3f dir) -> Vector3f
-    {
-    return cbe->FarthestPointInDirection(dir) - caps.FarthestPointInDirection(-dir);
-    };
-
-    auto DoSimplex = [cbe, caps](Vector3f * simplex, int * nVertices, Vector3f * dir) -> bool
-    {
-    if (*nVertices == 2)
-    {
-    Vector3f a = simplex[1],
-    b = simplex[0];
-    Vector3f a_origin = -a,
-    a_b = b - a;
-    if (a_origin.Dot(a_b) > 0.0f)
-    {
-    simplex[0] = a;
-    simplex[1] = b;
-    *nVertices = 2;
-    *dir = a_b.Cross(a_origin).Cross(a_b);
-    }
-    else
-    {
-    simplex[0] = a;
-    *nVertices = 1;
-    *dir = a_origin;
-    }
-    }
-    else if (*nVertices == 3)
-    {
-    Vector3f a = simplex[2],
-    b = simplex[0],
-    c = simplex[1];
-    Vector3f a_origin = -a,
-    a_b = b - a,
-    a_c = c - a,
-    abc = a_b.Cross(a_c),
-    a_b_cross = a_b.Cross(abc),
-    a_c_cross = abc.Cross(a_c);
-    if (a_c_cross.Dot(a_origin) > 0.0f)
-    {
-    if (a_c.Dot(a_origin) > 0.0f)
-    {
-    simplex[0] = a;
-    simplex[1] = c;
-    *nVertices = 2;
-    *dir = a_c.Cross(a_origin).Cross(a_c);
-    }
-    else
-    {
-    if (a_b.Dot(a_origin) > 0.0f)
-    {
-    simplex[0] = a;
-    simplex[1] = b;
-    *nVertices = 2;
-    *dir = a_b.Cross(a_origin).Cross(a_b);
-    }
-    else
-    {
-    simplex[0] = a;
-    *nVertices = 1;
-    *dir = a_origin;
-    }
-    }
-    }
-    else
-    {
-    if (a_b_cross.Dot(a_origin) > 0.0f)
-    {
-    if (a_b.Dot(a_origin) > 0.0f)
-    {
-    simplex[0] = a;
-    simplex[1] = b;
-    *nVertices = 2;
-    *dir = a_b.Cross(a_origin).Cross(a_b);
-    }
-    else
-    {
-    simplex[0] = a;
-    *nVertices = 1;
-    *dir = a_origin;
-    }
-    }
-    else
-    {
-    if (abc.Dot(a_origin) > 0.0f)
-    {
-    simplex[0] = a;
-    simplex[1] = b;
-    simplex[2] = c;
-    *nVertices = 3;
-    *dir = abc;
-    }
-    else
-    {
-    simplex[0] = a;
-    simplex[1] = c;
-    simplex[2] = b;
-    *nVertices = 3;
-    *dir = -abc;
-    }
-    }
-    }
-    }
-    else if (*nVertices == 4)
-    {
-    //Sorry about the "gotos", but this function is already a nightmare.
-    Vector3f a = simplex[3],
-    b = simplex[2],
-    c = simplex[1],
-    d = simplex[0];
-    Vector3f a_origin = -a,
-    a_b = b - a,
-    a_c = c - a,
-    abc = a_b.Cross(a_c);
-    Vector3f a_d, acd, adb;
-
-    if (abc.Dot(a_origin) > 0.0f)
-    goto checkFace;
-
-    a_d = d - a;
-    acd = a_c.Cross(a_d);
-    if (acd.Dot(a_origin) > 0.0f)
-    {
-    b = c;
-    c = d;
-    a_b = a_c;
-    a_c = a_d;
-
-    abc = acd;
-
-    goto checkFace;
-    }
-
-    adb = a_d.Cross(a_b);
-    if (adb.Dot(a_origin) > 0.0f)
-    {
-    c = b;
-    b = d;
-    a_c = a_b;
-    a_b = a_d;
-
-    abc = adb;
-
-    goto checkFace;
-    }
-
-    dir->Normalize();
-    return true;
-
-    checkFace:
-
-    //We have a CCW-wound triangle ABC. The point is in front of it.
-    //It is NOT "below" BC or "above" the plane through A parallel to BC.
-
-    Vector3f abp = a_b.Cross(abc);
-
-    if (abp.Dot(a_origin) > 0.0f)
-    {
-    simplex[1] = a;
-    simplex[0] = b;
-    *nVertices = 2;
-    *dir = a_b.Cross(a_origin);
-
-    return false;
-    }
-
-    Vector3f acp = abc.Cross(a_c);
-    if (acp.Dot(a_origin) > 0.0f)
-    {
-    simplex[0] = c;
-    simplex[1] = a;
-    *nVertices = 2;
-    *dir = a_c.Cross(a_origin);
-
-    return false;
-    }
-
-    simplex[2] = a;
-    simplex[1] = b;
-    simplex[0] = c;
-    *nVertices = 3;
-    *dir = abc;
-
-    return false;
-    }
-
-    return false;
-    };
-
-    Vector3f startDir(1.0f, 0.0f, 0.0f);
-    Vector3f seedValue = supportFunc(startDir);
-    Vector3f simplex[4];
-    simplex[0] = seedValue;
-    int nVerts = 1;
-    Vector3f dir = -seedValue;
-
-    while (true)
-    {
-    Vector3f a = supportFunc(dir);
-
-    if (a.Dot(dir) < 0.0f)
-    return false;
-
-    simplex[nVerts] = a;
-    nVerts += 1;
-
-    if (DoSimplex(simplex, &nVerts, &dir))
-    return true;
-    }
-
-
-
-
-
-
-
-
-    return false;
-
-
-    Vector3f a = capsule.GetEndpoint1(),
-    b = capsule.GetEndpoint2();
-    Vector3f min = Bounds.GetMinCorner(),
-    max = Bounds.GetMaxCorner();
-    float r = capsule.Radius;
-
-    if (Mathf::Max(a.y, b.y) < min.y || Mathf::Min(a.y, b.y) > max.y)
-    {
-    if (Mathf::Abs(a.x - max.x) < r || Mathf::Abs(a.x - min.x) < r ||
-    Mathf::Abs(a.z - max.z) < r || Mathf::Abs(a.z - min.z) < r)
-    {
-    return true;
-    }
-    else return false;
-    }
-    else return (capsule.TouchingSphere(Sphere(a, r)) || capsule.TouchingSphere(Sphere(b, r)));
-
-
-
-    return false;
-
-    //Test a collision for each of the cube's six planes.
-
-    Vector3f center = GetCenter();
-    Vector3f halfDims = Bounds.GetDimensions() * 0.5f;
-
-    for (float sign = -1.0f; sign <= 1.0f; sign += 2.0f)
-    {
-    for (int axis = 0; axis < 3; ++axis)
-    {
-    int axis1 = (axis + 1) % 3,
-    axis2 = (axis + 2) % 3;
-
-    //Calculate the plane.
-    Vector3f planePos = center,
-    planeNormal = Vector3f();
-    planePos[axis] = center[axis] + (sign * halfDims[axis]);
-    planeNormal[axis] = sign;
-    Plane pl(planePos, planeNormal);
-
-    //If the capsule touches the plane, do more specific tests.
-    if (capsule.TouchingPlane(pl))
-    {
-    //Get the capsule line's intersection with the plane.
-
-    float distL1 = Mathf::Abs(pl.GetDistanceToPlane(capsule.GetEndpoint1())),
-    distL2 = Mathf::Abs(pl.GetDistanceToPlane(capsule.GetEndpoint2()));
-    Vector3f rayStart, rayEnd;
-    if (distL1 > 0.0f)
-    {
-    if (distL2 > distL1)
-    {
-    rayStart = capsule.GetEndpoint2();
-    rayEnd = capsule.GetEndpoint1();
-    }
-    else
-    {
-    rayStart = capsule.GetEndpoint1();
-    rayEnd = capsule.GetEndpoint2();
-    }
-    }
-    else
-    {
-    if (distL2 > distL1)
-    {
-    rayStart = capsule.GetEndpoint1();
-    rayEnd = capsule.GetEndpoint2();
-    }
-    else
-    {
-    rayStart = capsule.GetEndpoint2();
-    rayEnd = capsule.GetEndpoint1();
-    }
-    }
-
-    RayTraceResult intersect = pl.RayHitCheck(rayStart, (rayEnd - rayStart).Normalized());
-
-
-    }
-    }
-
-    faces = center + (Bounds.GetDimensions() * sign);
-
-    //X plane.
-    if (capsule.TouchingPlane(Plane(Vector3f(faces.x, center.y, center.z), Vector3f(sign * 1.0f, 0.0f, 0.0f))))
-    {
-
-    }
-
-    //Y plane.
-    if (capsule.TouchingPlane(Plane(Vector3f(center.x, faces.y, center.z), Vector3f(0.0f, sign * 1.0f, 0.0f))))
-    {
-
-    }
-
-    //Z plane.
-    if (capsule.TouchingPlane(Plane(Vector3f(center.x, center.y, faces.z), Vector3f(0.0f, 0.0f, sign * 1.0f))))
-    {
-
-    }
-    }
-    */
+    return Bounds.GetDistanceSquared(capsule.GetEndpoint1(), capsule.GetEndpoint2()) <=
+               (capsule.Radius * capsule.Radius);
 }
 bool Cube::TouchingPlane(const Plane& plane) const
 {
@@ -747,181 +233,7 @@ Vector3f Capsule::FarthestPointInDirection(Vector3f dirNormalized) const
 
 bool Capsule::TouchingCube(const Cube& cube) const
 {
-    if (cube.GetCenter() == GetCenter()) return true;
-
-    const Cube & cbe = cube;
-    const Capsule * caps = this;
-    auto supportFunc = [cbe, caps](Vector3f dir) -> Vector3f
-    {
-        return cbe.FarthestPointInDirection(dir) - caps->FarthestPointInDirection(-dir);
-    };
-    auto crossABA = [](Vector3f a, Vector3f b) -> Vector3f { return a.Cross(b).Cross(a); };
-    Vector3f b, c, d,
-        v;
-    int n;
-
-    auto DoSimplex = [cbe, caps, &b, &c, &d, &v, &n, crossABA](Vector3f a) -> bool
-    {
-        if (n == 0)
-        {
-            b = a;
-            v = -a;
-            n = 1;
-        }
-        else if (n == 1)
-        {
-            v = crossABA(b - a, -a);
-
-            c = b;
-            b = a;
-            n = 2;
-        }
-        else if (n == 2)
-        {
-            Vector3f ao = -a,
-                ab = b - a,
-                ac = c - a;
-
-            Vector3f abc = ab.Cross(ac),
-                abp = ab.Cross(abc);
-
-            if (abp.Dot(ao) > 0.0f)
-            {
-                c = b;
-                b = a;
-                v = crossABA(ab, ao);
-            }
-            else
-            {
-                Vector3f acp = abc.Cross(ac);
-                if (acp.Dot(ao) > 0.0f)
-                {
-                    b = a;
-                    v = crossABA(ac, ao);
-                }
-                else
-                {
-                    n = 3;
-
-                    if (abc.Dot(ao) > 0.0f)
-                    {
-                        d = c;
-                        c = b;
-                        b = a;
-
-                        v = abc;
-                    }
-                    else
-                    {
-                        d = b;
-                        b = a;
-
-                        v = -abc;
-                    }
-                }
-            }
-        }
-        else if (n == 3)
-        {
-            Vector3f ao = -a,
-                ab = b - a,
-                ac = c - a;
-            Vector3f abc = ab.Cross(ac);
-            Vector3f ad, acd, adb;
-
-            if (abc.Dot(ao) > 0.0f)
-            {
-                goto checkFace;
-            }
-
-            ad = d - a;
-            acd = ac.Cross(ad);
-            if (acd.Dot(ao) > 0.0f)
-            {
-                b = c;
-                c = d;
-
-                ab = ac;
-                ac = ad;
-                abc = acd;
-
-                goto checkFace;
-            }
-
-            adb = ad.Cross(ab);
-            if (adb.Dot(ao) > 0.0f)
-            {
-                c = b;
-                b = d;
-
-                ac = ab;
-                ab = ad;
-
-                abc = adb;
-
-                goto checkFace;
-            }
-
-            return true;
-
-        checkFace:
-
-            Vector3f abp = ab.Cross(abc);
-
-            if (abp.Dot(ao) > 0)
-            {
-                c = b;
-                b = a;
-
-                v = crossABA(ab, ao);
-
-                n = 2;
-            }
-            else
-            {
-                Vector3f acp = abc.Cross(ac);
-                if (acp.Dot(ao) > 0.0f)
-                {
-                    b = a;
-
-                    v = crossABA(ac, ao);
-
-                    n = 2;
-                }
-                else
-                {
-                    d = c;
-                    c = b;
-                    b = a;
-
-                    v = abc;
-
-                    n = 3;
-                }
-            }
-        }
-
-        return false;
-    };
-
-    v = Vector3f(1.0f, 0.0f, 0.0f);
-    n = 0;
-
-    //Normally you should loop infinitely, but thanks to floating point error,
-    //    we might get caught in an infinte loop.
-    for (unsigned int i = 0; i < 10; ++i)
-    {
-        Vector3f a = supportFunc(v);
-
-        if (a.Dot(v) < 0.0f) return false;
-
-        if (DoSimplex(a)) return true;
-
-        v.Normalize();
-    }
-
-    //If the loop never managed to exit, it's very likely that this was an intersection.
-    return true;
+    return cube.TouchingCapsule(*this);
 }
 bool Capsule::TouchingSphere(const Sphere& sphere) const
 {
@@ -936,7 +248,7 @@ bool Capsule::TouchingCapsule(const Capsule& capsule) const
         Geometryf::ClosestToIntersection(l1, l2, capsule.l1, capsule.l2, false);
 
     return cvs.OnFirstLine.DistanceSquared(cvs.OnSecondLine) <=
-        ((Radius * Radius) + (capsule.Radius * capsule.Radius));
+        ((Radius + capsule.Radius) * (Radius + capsule.Radius));
 }
 bool Capsule::TouchingPlane(const Plane& plane) const
 {
@@ -0,0 +1,99 @@
+#include "MemoryAllocator.h"
+
+#include <stdlib.h>
+#include <new>
+#include <atomic>
+#ifdef _MSC_VER
+    #include <malloc.h>
+#endif
+
+
+namespace
+{
+    std::atomic<unsigned int> nHeapAllocations(0);
+
+
+    class HeapAllocator : public MemoryAllocator
+    {
+    public:
+
+        virtual void* Allocate(size_t nBytes, size_t alignment) override
+        {
+            if (nBytes == 0)
+                nBytes = 1;
+            if (alignment < sizeof(void*))
+                alignment = sizeof(void*);
+
+#ifdef _MSC_VER
+            void* block = _aligned_malloc(nBytes, alignment);
+#else
+            void* block = 0;
+            if (posix_memalign(&block, alignment, nBytes) != 0)
+                block = 0;
+#endif
+
+            if (block == 0)
+                throw std::bad_alloc();
+
+            nHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }
+        virtual void Deallocate(void* block) override
+        {
+#ifdef _MSC_VER
+            _aligned_free(block);
+#else
+            free(block);
+#endif
+        }
+    };
+
+    //The heap allocator has no state, so a single global instance can be shared by everything.
+    HeapAllocator heapAllocator;
+}
+
+
+MemoryAllocator& MemoryAllocator::GetHeap(void)
+{
+    return heapAllocator;
+}
+unsigned int MemoryAllocator::GetNHeapAllocations(void)
+{
+    return nHeapAllocations.load(std::memory_order_relaxed);
+}
+
+
+//Replace the global "new" and "delete" so that every heap allocation is counted.
+
+void* operator new(size_t nBytes)
+{
+    void* block = malloc(nBytes == 0 ? 1 : nBytes);
+    if (block == 0)
+        throw std::bad_alloc();
+
+    nHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return block;
+}
+void operator delete(void* block) throw()
+{
+    free(block);
+}
+void* operator new[](size_t nBytes)
+{
+    return operator new(nBytes);
+}
+void operator delete[](void* block) throw()
+{
+    operator delete(block);
+}
+
+//Compilers with sized deallocation (C++14) call these instead of the ones above,
+//    so they have to free the same way.
+void operator delete(void* block, size_t) throw()
+{
+    operator delete(block);
+}
+void operator delete[](void* block, size_t) throw()
+{
+    operator delete(block);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stddef.h>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+
+//Hands out blocks of memory, e.x. from the normal heap or from a pre-allocated arena.
+//Containers that take one of these can have their memory come from somewhere other than the heap.
+class MemoryAllocator
+{
+public:
+
+    //The alignment (in bytes) blocks get when none is specified. Enough for SSE.
+    static const size_t DEFAULT_ALIGNMENT = 16;
+
+
+    //Gets an allocator that uses the normal heap. It can be used from any thread.
+    static MemoryAllocator& GetHeap(void);
+
+    //Gets the total number of heap allocations made so far by any thread,
+    //    through either "new" or the heap allocator.
+    //Comparing this between two points in time shows how much heap traffic happened in between.
+    static unsigned int GetNHeapAllocations(void);
+
+
+    virtual ~MemoryAllocator(void) { }
+
+    //Gets a block of at least the given number of bytes, starting at a multiple of "alignment" bytes.
+    //"alignment" must be a power of 2.
+    virtual void* Allocate(size_t nBytes, size_t alignment = DEFAULT_ALIGNMENT) = 0;
+    //Gives back a block that came from "Allocate()".
+    virtual void Deallocate(void* block) = 0;
+};
+
+
+//The type of object being allocated.
+template<typename T>
+//Lets standard containers get their memory from a MemoryAllocator,
+//    e.x. "std::vector<int, StdAllocator<int>> v(StdAllocator<int>(someArena));".
+//Defaults to the normal heap.
+class StdAllocator
+{
+public:
+
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template<typename U>
+    struct rebind { typedef StdAllocator<U> other; };
+
+
+    StdAllocator(void) : allocator(&MemoryAllocator::GetHeap()) { }
+    StdAllocator(MemoryAllocator& _allocator) : allocator(&_allocator) { }
+    template<typename U>
+    StdAllocator(const StdAllocator<U>& other) : allocator(&other.GetAllocator()) { }
+
+
+    MemoryAllocator& GetAllocator(void) const { return *allocator; }
+
+
+    T* allocate(size_t n, const void* hint = 0)
+    {
+        return (T*)allocator->Allocate(n * sizeof(T), std::alignment_of<T>::value);
+    }
+    void deallocate(T* ptr, size_t n) { allocator->Deallocate(ptr); }
+
+    size_t max_size(void) const { return ((size_t)-1) / sizeof(T); }
+
+    template<typename U, typename... Args>
+    void construct(U* ptr, Args&&... args) { new ((void*)ptr) U(std::forward<Args>(args)...); }
+    template<typename U>
+    void destroy(U* ptr) { ptr->~U(); }
+
+    T* address(T& t) const { return &t; }
+    const T* address(const T& t) const { return &t; }
+
+
+    template<typename U>
+    bool operator==(const StdAllocator<U>& other) const { return allocator == &other.GetAllocator(); }
+    template<typename U>
+    bool operator!=(const StdAllocator<U>& other) const { return allocator != &other.GetAllocator(); }
+
+
+private:
+
+    MemoryAllocator* allocator;
+};
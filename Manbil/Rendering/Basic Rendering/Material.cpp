@@ -436,17 +436,15 @@ void Material::Render(const RenderInfo& info, const UniformDictionary& params,
     {
         const Mesh& mesh = *meshPtrArray[i];
 
-        //Calculate world and wvp matrices.
+        //Calculate the world matrix and pass it to the shader, along with the wvp matrix if it's used.
         mesh.Transform.GetWorldTransform(mWorld);
-        mWVP = Matrix4f::Multiply(info.mVP, mWorld);
-
-        //Pass those matrices to the shader.
         if (worldMatL != INVALID_UNIFORM_LOCATION)
         {
             SetUniformValueMatrix4f(worldMatL, mWorld);
         }
         if (wvpMatL != INVALID_UNIFORM_LOCATION)
         {
+            mWVP = Matrix4f::Multiply(info.mVP, mWorld);
             SetUniformValueMatrix4f(wvpMatL, mWVP);
         }
 
@@ -462,7 +460,7 @@ void Material::Render(const RenderInfo& info, const UniformDictionary& params,
         {
             glDrawElements(PrimitiveTypeToGLEnum(data.PrimType),
                            data.GetRangeSize(), GL_UNSIGNED_INT,
-                           (GLvoid*)data.GetRangeStart());
+                           (GLvoid*)(sizeof(unsigned int) * data.GetRangeStart()));
         }
         else
         {
@@ -567,16 +565,14 @@ void Material::Render(const RenderInfo& info, const MeshData* toRender, const Ma
     {
         const MeshData& meshDat = toRender[i];
 
-        //Calculate world and wvp matrices.
-        mWVP = Matrix4f::Multiply(info.mVP, worldMats[i]);
-
-        //Pass those matrices to the shader.
+        //Pass the world matrix to the shader, along with the wvp matrix if it's used.
         if (worldMatL != INVALID_UNIFORM_LOCATION)
         {
             SetUniformValueMatrix4f(worldMatL, worldMats[i]);
         }
         if (wvpMatL != INVALID_UNIFORM_LOCATION)
         {
+            mWVP = Matrix4f::Multiply(info.mVP, worldMats[i]);
             SetUniformValueMatrix4f(wvpMatL, mWVP);
         }
 
@@ -589,7 +585,8 @@ void Material::Render(const RenderInfo& info, const MeshData* toRender, const Ma
         if (meshDat.GetUsesIndices())
         {
             glDrawElements(PrimitiveTypeToGLEnum(meshDat.PrimType),
-                           meshDat.GetRangeSize(), GL_UNSIGNED_INT, (GLvoid*)meshDat.GetRangeStart());
+                           meshDat.GetRangeSize(), GL_UNSIGNED_INT,
+                           (GLvoid*)(sizeof(unsigned int) * meshDat.GetRangeStart()));
         }
         else
         {
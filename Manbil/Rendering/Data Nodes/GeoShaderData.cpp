@@ -16,13 +16,12 @@ void GeoShaderData::WriteData(DataWriter* writer) const
                   "MaterialUsageFlags is currently assumed to use a uint!");
     writer->WriteUInt(UsageFlags.GetBitmaskValue(), "Built-in uniforms usage bitmask");
 
-    writer->WriteCollection([](DataWriter* writer, const void* elementToWrite,
-                            unsigned int elIndex, void* userData)
+    writer->WriteCollection(Params,
+                            [](DataWriter* writer, const Uniform& u, unsigned int elIndex)
                             {
-                                Uniform& u = *(Uniform*)elementToWrite;
                                 writer->WriteDataStructure(Uniform_Writable(u), std::to_string(elIndex));
                             },
-                            "Params", sizeof(Uniform), Params.data(), Params.size());
+                            "Params");
 
     writer->WriteString(ShaderCode, "Shader code");
 }
@@ -40,16 +39,11 @@ void GeoShaderData::ReadData(DataReader* reader)
     reader->ReadDataStructure(RenderIOAttributes_Readable(OutputTypes));
     reader->ReadUInt(UsageFlags.GetBitmaskValue());
 
-    reader->ReadCollection([](DataReader* reader, void* pCollection, unsigned int elIndex, void* pDat)
+    reader->ReadCollection(Params,
+                           [](DataReader* reader, Uniform& outU, unsigned int elIndex)
                            {
-                               UniformList& uList = *(UniformList*)pCollection;
-                               reader->ReadDataStructure(Uniform_Readable(uList[elIndex]));
-                           },
-                           [](void* pCollection, unsigned int nElements)
-                           {
-                               UniformList* uList = (UniformList*)pCollection;
-                               uList->resize(nElements);
-                           }, &Params);
+                               reader->ReadDataStructure(Uniform_Readable(outU));
+                           });
 
     reader->ReadString(ShaderCode);
 }
\ No newline at end of file
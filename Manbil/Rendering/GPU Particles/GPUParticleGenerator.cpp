@@ -3,6 +3,7 @@
 #include "../Data Nodes/DataNodes.hpp"
 #include "../../DebugAssist.h"
 #include "../../Math/Lower Math/Array2D.h"
+#include "../../Math/Lower Math/CounterRand.h"
 
 
 
@@ -291,6 +292,7 @@ void GPUPG::GenerateGPUPParticles(MeshData& outMesh, GPUPG::NumberOfParticles nu
     //Generate the particle data.
     Array2D<ParticleVertex> particles(length, length);
     const float increment = 1.0f / (float)length;
+    CounterRand rand((unsigned int)randSeed);
     for (Vector2u loc; loc.y < length; ++loc.y)
     {
         float yID = increment * loc.y;
@@ -299,14 +301,11 @@ void GPUPG::GenerateGPUPParticles(MeshData& outMesh, GPUPG::NumberOfParticles nu
         {
             float xID = increment * loc.x;
 
-            FastRand fr(Vector3u(loc.x, loc.y, randSeed).GetHashCode());
-            fr.GetRandInt();
-            fr.GetRandInt();
+            //Each particle's position is used as the counter for its random values.
+            Vector4f rand1 = rand.SampleZeroToOne(Vector4u(loc.x, loc.y, 0, 0)),
+                     rand2 = rand.SampleZeroToOne(Vector4u(loc.x, loc.y, 1, 0));
 
-            particles[loc] = ParticleVertex(Vector2f(xID, yID),
-                                            Vector4f(fr.GetZeroToOne(), fr.GetZeroToOne(),
-                                                     fr.GetZeroToOne(), fr.GetZeroToOne()),
-                                            Vector2f(fr.GetZeroToOne(), fr.GetZeroToOne()));
+            particles[loc] = ParticleVertex(Vector2f(xID, yID), rand1, Vector2f(rand2.x, rand2.y));
         }
     }
 
@@ -1,6 +1,7 @@
 #include "GUISelectionBox.h"
 
 #include "../GUIMaterials.h"
+#include "../../../FrameArena.h"
 
 
 typedef GUISelectionBox GSB;
@@ -350,7 +351,7 @@ void GSB::CustomUpdate(float elapsed, Vector2f relativeMousePos)
 
     //Update the item labels and track which ones are visible.
     //TODO: Store "visibleIndices" as a member field as a replacement for "nVisibleItems".
-    std::vector<unsigned int> visibleIndices;
+    std::vector<unsigned int, StdAllocator<unsigned int>> visibleIndices(FrameArena::GetThreadArena());
     for (unsigned int i = 0; i < itemElements.size(); ++i)
     {
         itemElements[i].Update(elapsed, relativeMousePos - itemElements[i].GetPos());
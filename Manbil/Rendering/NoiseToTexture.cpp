@@ -1,64 +1,105 @@
 #include "NoiseToTexture.h"
 
+#include "../Threading/ThreadPool.h"
+
+
+//Use SSE2 to compute four lookup table indices at once if the target supports it.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+    #define NOISETOTEXTURE_USE_SSE
+    #include <emmintrin.h>
+#endif
+
+
+namespace
+{
+    //Roughly how many pixels each thread grabs at once when splitting up rows.
+    const unsigned int PIXELS_PER_CHUNK = 8192;
+
+
+    template<typename Func>
+    //Calls "doRow(unsigned int y)" for every row of the given noise, using the given threads if they exist.
+    void ForEachRow(const Noise2D& noise, ThreadPool* threads, Func doRow)
+    {
+        if (threads == 0)
+        {
+            for (unsigned int y = 0; y < noise.GetHeight(); ++y)
+                doRow(y);
+        }
+        else
+        {
+            threads->ParallelFor(noise.GetHeight(), doRow,
+                                 Mathf::Max(1U, PIXELS_PER_CHUNK / Mathf::Max(1U, noise.GetWidth())));
+        }
+    }
+}
+
+
+void NoiseToTexture::ConvertRow(const float* noiseValues, Vector4b* outPixels, unsigned int count,
+                                const Vector4b* lookupTable)
+{
+    const float maxIndex = (float)(LOOKUP_TABLE_SIZE - 1);
+    unsigned int x = 0;
+
+#ifdef NOISETOTEXTURE_USE_SSE
+    __m128 zero = _mm_setzero_ps(),
+           one = _mm_set1_ps(1.0f),
+           scale = _mm_set1_ps(maxIndex),
+           half = _mm_set1_ps(0.5f);
+    for (; x + 4 <= count; x += 4)
+    {
+        __m128 values = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(noiseValues + x), one), zero);
+        __m128i indices = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(values, scale), half));
+
+        unsigned int indexArray[4];
+        _mm_storeu_si128((__m128i*)indexArray, indices);
+        outPixels[x] = lookupTable[indexArray[0]];
+        outPixels[x + 1] = lookupTable[indexArray[1]];
+        outPixels[x + 2] = lookupTable[indexArray[2]];
+        outPixels[x + 3] = lookupTable[indexArray[3]];
+    }
+#endif
+
+    for (; x < count; ++x)
+    {
+        //Clamp the same way as the SSE version, so that NaN becomes 1.
+        float value = noiseValues[x];
+        value = (value < 1.0f ? value : 1.0f);
+        value = (value > 0.0f ? value : 0.0f);
+        outPixels[x] = lookupTable[(unsigned int)((value * maxIndex) + 0.5f)];
+    }
+}
 
 void NoiseToTexture::GetImage(Array2D<Vector4b>& outImage) const
 {
-	//The pixel array.
     outImage.Reset(NoiseToUse->GetWidth(), NoiseToUse->GetHeight());
-	
-	//Some temp variables.
-	unsigned int x, y, pixX, pixY;
-	Vector4f col;
-	Vector4b colB;
-	float tempF, readNoise;
-	
-	//Go through every pixel and set its value.
-	for (x = 0; x < NoiseToUse->GetWidth(); ++x)
-	{
-		for (y = 0; y < NoiseToUse->GetHeight(); ++y)
-		{
-			tempF = (*NoiseToUse)[Vector2u(x, y)];
-            readNoise = Mathf::Clamp(tempF, 0.0f, 1.0f);
-
-			//Get the coordinates of the pixel in the out array.
-			pixX = x * 4;
-			pixY = y;
+    GetImage(outImage.GetArray(), outImage.GetRowStride());
+}
+void NoiseToTexture::GetImage(Vector4b* outPixels, unsigned int rowPitch) const
+{
+    Vector4b lookupTable[LOOKUP_TABLE_SIZE];
+    GradientToUse->GetLookupTable(lookupTable, LOOKUP_TABLE_SIZE);
 
-			//Set the pixel values.
-			col = GradientToUse->GetColor(readNoise) * 255.0f;
-			col = Vector4f(Mathf::Clamp(col.x, 0.0f, 255.0f), Mathf::Clamp(col.y, 0.0f, 255.0f),
-						   Mathf::Clamp(col.z, 0.0f, 255.0f), Mathf::Clamp(col.w, 0.0f, 255.0f));
-			colB = Vector4b((unsigned char)Mathf::RoundToInt(col.x),
-							(unsigned char)Mathf::RoundToInt(col.y),
-							(unsigned char)Mathf::RoundToInt(col.z),
-							(unsigned char)Mathf::RoundToInt(col.w));
-            outImage[Vector2u(pixX, pixY)] = colB;
-		}
-	}
+    const Noise2D& noise = *NoiseToUse;
+    const Vector4b* lookupTablePtr = lookupTable;
+    ForEachRow(noise, Threads, [&noise, outPixels, rowPitch, lookupTablePtr](unsigned int y)
+    {
+        ConvertRow(&noise[Vector2u(0, y)], outPixels + (y * rowPitch), noise.GetWidth(), lookupTablePtr);
+    });
 }
 void NoiseToTexture::GetImage(Array2D<Vector4f>& outImage) const
 {
-	//The pixel array.
     outImage.Reset(NoiseToUse->GetWidth(), NoiseToUse->GetHeight());
-	
-	//Some temp variables.
-	unsigned int x, y, pixX, pixY;
-	float tempF, readNoise;
-	
-	//Go through every pixel and set its value.
-	for (x = 0; x < NoiseToUse->GetWidth(); ++x)
-	{
-		for (y = 0; y < NoiseToUse->GetHeight(); ++y)
-		{
-			tempF = (*NoiseToUse)[Vector2u(x, y)];
-            readNoise = Mathf::Clamp(tempF, 0.0f, 1.0f);
 
-			//Get the coordinates of the pixel in the out array.
-			pixX = x * 4;
-			pixY = y;
-
-			//Set the pixel values.
-            outImage[Vector2u(pixX, pixY)] = GradientToUse->GetColor(readNoise);
-		}
-	}
-}
\ No newline at end of file
+    //Unpacked colors are computed exactly instead of with a lookup table.
+    const Noise2D& noise = *NoiseToUse;
+    const ColorGradient& gradient = *GradientToUse;
+    ForEachRow(noise, Threads, [&noise, &gradient, &outImage](unsigned int y)
+    {
+        const float* noiseRow = &noise[Vector2u(0, y)];
+        Vector4f* outRow = &outImage[Vector2u(0, y)];
+        for (unsigned int x = 0; x < noise.GetWidth(); ++x)
+        {
+            outRow[x] = gradient.GetColor(Mathf::Clamp(noiseRow[x], 0.0f, 1.0f));
+        }
+    });
+}
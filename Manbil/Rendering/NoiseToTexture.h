@@ -1,19 +1,64 @@
 #pragma once
 
+#include <vector>
 #include "../Math/Noise Generation/ColorGradient.h"
 #include "../Math/Noise Generation/BasicGenerators.h"
 
+class ThreadPool;
+
+
 //Converts a 2D noise field to a texture.
+//Noise values are clamped to the range [0, 1] before being mapped through the gradient.
 class NoiseToTexture
 {
 public:
 
+    //The number of entries in the lookup table that the gradient is baked into for packed colors.
+    //Noise values are rounded to the nearest entry.
+    static const unsigned int LOOKUP_TABLE_SIZE = 4096;
+
+
 	const ColorGradient* GradientToUse;
 	const Noise2D* NoiseToUse;
 
+    //If this isn't 0, the rows of the image will be split across this pool's threads.
+    ThreadPool* Threads = 0;
+
+
 	NoiseToTexture(ColorGradient* gradient = 0, Noise2D* noise = 0)
         : GradientToUse(gradient), NoiseToUse(noise) { }
 
+
 	void GetImage(Array2D<Vector4b>& outImage) const;
     void GetImage(Array2D<Vector4f>& outImage) const;
-};
\ No newline at end of file
+
+    //Writes the packed colors straight into the given buffer (e.x. a mapped pixel buffer)
+    //    without making a separate image first.
+    //"rowPitch" is the number of pixels from the start of one row in the buffer to the start of the next.
+    void GetImage(Vector4b* outPixels, unsigned int rowPitch) const;
+
+    //A function with signature "void OnRow(unsigned int y, const Vector4b* rowPixels, unsigned int width)".
+    template<typename RowFunc>
+    //Computes the packed colors one row at a time, calling "onRow" on this thread with each finished row.
+    //Only one row of pixels is stored at once.
+    void GetImageRows(RowFunc onRow) const
+    {
+        std::vector<Vector4b> lookupTable(LOOKUP_TABLE_SIZE),
+                              row(NoiseToUse->GetWidth());
+        GradientToUse->GetLookupTable(lookupTable.data(), LOOKUP_TABLE_SIZE);
+
+        for (unsigned int y = 0; y < NoiseToUse->GetHeight(); ++y)
+        {
+            ConvertRow(&(*NoiseToUse)[Vector2u(0, y)], row.data(), NoiseToUse->GetWidth(),
+                       lookupTable.data());
+            onRow(y, (const Vector4b*)row.data(), NoiseToUse->GetWidth());
+        }
+    }
+
+
+private:
+
+    //Maps a row of noise values to packed colors using the given lookup table.
+    static void ConvertRow(const float* noiseValues, Vector4b* outPixels, unsigned int count,
+                           const Vector4b* lookupTable);
+};
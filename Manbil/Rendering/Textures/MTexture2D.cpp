@@ -5,6 +5,18 @@
 #include "../../DebugAssist.h"
 
 
+namespace
+{
+    //Tells OpenGL how far apart the rows of an "Array2D" are while it's being copied to/from a texture,
+    //    since its rows may be padded. Puts back the default (tightly-packed rows) when it goes out of scope.
+    struct RowLengthScope
+    {
+        GLenum Param;
+        RowLengthScope(GLenum param, unsigned int rowStride)
+            : Param(param) { glPixelStorei(Param, (GLint)rowStride); }
+        ~RowLengthScope(void) { glPixelStorei(Param, 0); }
+    };
+}
 
 
 MTexture2D::MTexture2D(MTexture2D&& movedFrom)
@@ -215,6 +227,7 @@ bool MTexture2D::SetDataFromFile(std::string filePath, PixelSizes newSize, std::
     pixelSize = newSize;
 
     Bind();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, outData.GetRowStride());
     glTexImage2D(GL_TEXTURE_2D, 0, ToGLenum(pixelSize), width, height, 0,
                  GL_RGBA, GL_UNSIGNED_BYTE, outData.GetArray());
     if (usesMipmaps)
@@ -253,6 +266,7 @@ bool MTexture2D::SetColorData(const Array2D<Vector4b>& pixelData, PixelSizes new
     height = pixelData.GetHeight();
 
     Bind();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, pixelData.GetRowStride());
     glTexImage2D(GL_TEXTURE_2D, 0, ToGLenum(pixelSize), width, height, 0,
                  GL_RGBA, GL_UNSIGNED_BYTE, pixelData.GetArray());
     if (usesMipmaps)
@@ -281,6 +295,7 @@ bool MTexture2D::SetColorData(const Array2D<Vector4f>& pixelData, PixelSizes new
     height = pixelData.GetHeight();
 
     Bind();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, pixelData.GetRowStride());
     glTexImage2D(GL_TEXTURE_2D, 0, ToGLenum(pixelSize), width, height, 0,
                  GL_RGBA, GL_FLOAT, pixelData.GetArray());
     if (usesMipmaps)
@@ -300,6 +315,7 @@ bool MTexture2D::UpdateColorData(const Array2D<Vector4b>& pixelData,
     }
 
     Bind();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, pixelData.GetRowStride());
     glTexSubImage2D(GL_TEXTURE_2D, 0, offX, offY, pixelData.GetWidth(), pixelData.GetHeight(),
                     GL_RGBA, GL_UNSIGNED_BYTE, pixelData.GetArray());
     if (usesMipmaps)
@@ -319,6 +335,7 @@ bool MTexture2D::UpdateColorData(const Array2D<Vector4f>& pixelData,
     }
 
     Bind();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, pixelData.GetRowStride());
     glTexSubImage2D(GL_TEXTURE_2D, 0, offX, offY, pixelData.GetWidth(), pixelData.GetHeight(),
                     GL_RGBA, GL_FLOAT, pixelData.GetArray());
     if (usesMipmaps)
@@ -348,6 +365,7 @@ bool MTexture2D::SetGreyscaleData(const Array2D<unsigned char>& greyscaleData, P
     height = greyscaleData.GetHeight();
 
     Bind();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, greyscaleData.GetRowStride());
     glTexImage2D(GL_TEXTURE_2D, 0, ToGLenum(pixelSize), width, height, 0,
                  GL_RED, GL_UNSIGNED_BYTE, greyscaleData.GetArray());
     if (usesMipmaps)
@@ -376,6 +394,7 @@ bool MTexture2D::SetGreyscaleData(const Array2D<float>& greyscaleData, PixelSize
     height = greyscaleData.GetHeight();
 
     Bind();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, greyscaleData.GetRowStride());
     glTexImage2D(GL_TEXTURE_2D, 0, ToGLenum(pixelSize), width, height, 0,
                  GL_RED, GL_FLOAT, greyscaleData.GetArray());
     if (usesMipmaps)
@@ -395,6 +414,7 @@ bool MTexture2D::UpdateGreyscaleData(const Array2D<unsigned char>& pixelData,
     }
 
     Bind();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, pixelData.GetRowStride());
     glTexSubImage2D(GL_TEXTURE_2D, 0, offX, offY, pixelData.GetWidth(), pixelData.GetHeight(),
                     GL_RED, GL_UNSIGNED_BYTE, pixelData.GetArray());
     if (usesMipmaps)
@@ -414,6 +434,7 @@ bool MTexture2D::UpdateGreyscaleData(const Array2D<float>& pixelData,
     }
 
     Bind();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, pixelData.GetRowStride());
     glTexSubImage2D(GL_TEXTURE_2D, 0, offX, offY, pixelData.GetWidth(), pixelData.GetHeight(),
                     GL_RED, GL_FLOAT, pixelData.GetArray());
     if (usesMipmaps)
@@ -442,6 +463,7 @@ bool MTexture2D::SetDepthData(const Array2D<unsigned char>& depthData, PixelSize
     Bind();
     width = depthData.GetWidth();
     height = depthData.GetHeight();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, depthData.GetRowStride());
     glTexImage2D(GL_TEXTURE_2D, 0, ToGLenum(pixelSize), width, height, 0,
                  GL_UNSIGNED_BYTE, GL_DEPTH_COMPONENT, depthData.GetArray());
     if (usesMipmaps)
@@ -469,6 +491,7 @@ bool MTexture2D::SetDepthData(const Array2D<float>& depthData, PixelSizes newSiz
     Bind();
     width = depthData.GetWidth();
     height = depthData.GetHeight();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, depthData.GetRowStride());
     glTexImage2D(GL_TEXTURE_2D, 0, ToGLenum(pixelSize), width, height, 0,
                  GL_FLOAT, GL_DEPTH_COMPONENT, depthData.GetArray());
     if (usesMipmaps)
@@ -488,6 +511,7 @@ bool MTexture2D::UpdateDepthData(const Array2D<unsigned char>& pixelData,
     }
 
     Bind();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, pixelData.GetRowStride());
     glTexSubImage2D(GL_TEXTURE_2D, 0, offX, offY, pixelData.GetWidth(), pixelData.GetHeight(),
                     GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, pixelData.GetArray());
     if (usesMipmaps)
@@ -506,6 +530,7 @@ bool MTexture2D::UpdateDepthData(const Array2D<float>& pixelData, unsigned int o
     }
 
     Bind();
+    RowLengthScope rowLength(GL_UNPACK_ROW_LENGTH, pixelData.GetRowStride());
     glTexSubImage2D(GL_TEXTURE_2D, 0, offX, offY, pixelData.GetWidth(), pixelData.GetHeight(),
                     GL_DEPTH_COMPONENT, GL_FLOAT, pixelData.GetArray());
     if (usesMipmaps)
@@ -526,6 +551,7 @@ bool MTexture2D::GetColorData(Array2D<Vector4b>& outData) const
     }
 
     Bind();
+    RowLengthScope rowLength(GL_PACK_ROW_LENGTH, outData.GetRowStride());
     glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, outData.GetArray());
 
     return true;
@@ -539,6 +565,7 @@ bool MTexture2D::GetColorData(Array2D<Vector4f>& outData) const
     }
 
     Bind();
+    RowLengthScope rowLength(GL_PACK_ROW_LENGTH, outData.GetRowStride());
     glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, outData.GetArray());
 
     return true;
@@ -553,6 +580,7 @@ bool MTexture2D::GetGreyscaleData(Array2D<unsigned char>& outData) const
     }
 
     Bind();
+    RowLengthScope rowLength(GL_PACK_ROW_LENGTH, outData.GetRowStride());
     glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_UNSIGNED_BYTE, outData.GetArray());
 
     return true;
@@ -566,6 +594,7 @@ bool MTexture2D::GetGreyscaleData(Array2D<float>& outData) const
     }
 
     Bind();
+    RowLengthScope rowLength(GL_PACK_ROW_LENGTH, outData.GetRowStride());
     glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, outData.GetArray());
 
     return true;
@@ -580,6 +609,7 @@ bool MTexture2D::GetDepthData(Array2D<unsigned char>& outData) const
     }
 
     Bind();
+    RowLengthScope rowLength(GL_PACK_ROW_LENGTH, outData.GetRowStride());
     glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, outData.GetArray());
 
     return true;
@@ -593,6 +623,7 @@ bool MTexture2D::GetDepthData(Array2D<float>& outData) const
     }
 
     Bind();
+    RowLengthScope rowLength(GL_PACK_ROW_LENGTH, outData.GetRowStride());
     glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, outData.GetArray());
 
     return true;
@@ -0,0 +1,117 @@
+#include "ThreadPool.h"
+
+
+unsigned int ThreadPool::GetNHardwareThreads(void)
+{
+    unsigned int n = std::thread::hardware_concurrency();
+    return (n == 0) ? 1 : n;
+}
+
+
+ThreadPool::ThreadPool(unsigned int nThreads)
+    : nUnfinishedJobs(0), isStopping(false)
+{
+    if (nThreads == 0)
+    {
+        nThreads = GetNHardwareThreads() - 1;
+    }
+
+    threads.reserve(nThreads);
+    for (unsigned int i = 0; i < nThreads; ++i)
+    {
+        threads.push_back(std::thread(&ThreadPool::RunWorker, this));
+    }
+}
+ThreadPool::~ThreadPool(void)
+{
+    {
+        std::lock_guard<std::mutex> lck(jobsLock);
+        isStopping = true;
+    }
+    jobAdded.notify_all();
+
+    for (unsigned int i = 0; i < threads.size(); ++i)
+    {
+        threads[i].join();
+    }
+}
+
+void ThreadPool::AddJob(const Job& job)
+{
+    //With no worker threads, just run the job immediately.
+    if (threads.empty())
+    {
+        job();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(jobsLock);
+        jobs.push(job);
+        nUnfinishedJobs += 1;
+    }
+    jobAdded.notify_one();
+}
+void ThreadPool::WaitForAll(void)
+{
+    std::unique_lock<std::mutex> lck(jobsLock);
+    while (nUnfinishedJobs > 0)
+    {
+        jobsFinished.wait(lck);
+    }
+}
+
+void ThreadPool::RunWorker(void)
+{
+    while (true)
+    {
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lck(jobsLock);
+            while (jobs.empty() && !isStopping)
+            {
+                jobAdded.wait(lck);
+            }
+
+            //Finish any remaining jobs before stopping.
+            if (jobs.empty())
+            {
+                return;
+            }
+
+            job = jobs.front();
+            jobs.pop();
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lck(jobsLock);
+            nUnfinishedJobs -= 1;
+            if (nUnfinishedJobs == 0)
+            {
+                jobsFinished.notify_all();
+            }
+        }
+    }
+}
+
+
+void ThreadPool::ForState::FinishChunks(unsigned int n)
+{
+    std::lock_guard<std::mutex> lck(lock);
+    nFinished += n;
+    if (nFinished == NChunks)
+    {
+        allFinished.notify_all();
+    }
+}
+void ThreadPool::ForState::Wait(void)
+{
+    std::unique_lock<std::mutex> lck(lock);
+    while (nFinished < NChunks)
+    {
+        allFinished.wait(lck);
+    }
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+
+//A set of worker threads that run jobs in the background.
+//There is no global pool; whoever needs one creates it (or is handed one) and owns it.
+class ThreadPool
+{
+public:
+
+    typedef std::function<void()> Job;
+
+
+    //Gets the number of threads this machine can run at once. Always returns at least 1.
+    static unsigned int GetNHardwareThreads(void);
+
+
+    //If the given number of threads is 0, one thread is created for each hardware thread
+    //    except the calling one (since it usually waits on and helps with the jobs).
+    ThreadPool(unsigned int nThreads = 0);
+    ~ThreadPool(void);
+
+
+    unsigned int GetNThreads(void) const { return threads.size(); }
+
+    //Queues up a job to be run on one of the worker threads.
+    void AddJob(const Job& job);
+    //Blocks until every job added to this pool so far has finished.
+    void WaitForAll(void);
+
+
+    template<typename Func>
+    //Runs "func(i)" for every i in the range [0, count), splitting the range into chunks of
+    //    the given size that are spread across the worker threads.
+    //The calling thread also works on chunks, and this function doesn't return until all of them are done.
+    //Because of that, it's safe to call this from inside another job.
+    void ParallelFor(unsigned int count, Func func, unsigned int chunkSize = 1)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        if (chunkSize == 0)
+        {
+            chunkSize = 1;
+        }
+
+        unsigned int nChunks = (count + chunkSize - 1) / chunkSize;
+        if (nChunks == 1 || threads.empty())
+        {
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                func(i);
+            }
+            return;
+        }
+
+        //Every thread that takes part in the loop grabs chunks until there are none left.
+        //Helper jobs that start after the loop already finished just see no chunks and exit,
+        //    so "func" is never touched after this function returns.
+        std::shared_ptr<ForState> state(new ForState(nChunks));
+        Func* pFunc = &func;
+        auto runChunks = [state, pFunc, count, chunkSize]()
+        {
+            unsigned int nDone = 0;
+            unsigned int chunk;
+            while ((chunk = state->NextChunk++) < state->NChunks)
+            {
+                unsigned int start = chunk * chunkSize,
+                             end = start + chunkSize;
+                if (end > count)
+                {
+                    end = count;
+                }
+                for (unsigned int i = start; i < end; ++i)
+                {
+                    (*pFunc)(i);
+                }
+                nDone += 1;
+            }
+            if (nDone > 0)
+            {
+                state->FinishChunks(nDone);
+            }
+        };
+
+        unsigned int nHelpers = nChunks - 1;
+        if (nHelpers > threads.size())
+        {
+            nHelpers = threads.size();
+        }
+        for (unsigned int i = 0; i < nHelpers; ++i)
+        {
+            AddJob(runChunks);
+        }
+
+        runChunks();
+        state->Wait();
+    }
+
+
+private:
+
+    //The shared progress of a single "ParallelFor()" call.
+    struct ForState
+    {
+        const unsigned int NChunks;
+        std::atomic<unsigned int> NextChunk;
+
+        ForState(unsigned int nChunks) : NChunks(nChunks), NextChunk(0), nFinished(0) { }
+
+        void FinishChunks(unsigned int n);
+        void Wait(void);
+
+    private:
+
+        unsigned int nFinished;
+        std::mutex lock;
+        std::condition_variable allFinished;
+    };
+
+
+    std::vector<std::thread> threads;
+
+    std::queue<Job> jobs;
+    //The number of jobs that have been added but haven't finished running yet.
+    unsigned int nUnfinishedJobs;
+    bool isStopping;
+
+    std::mutex jobsLock;
+    std::condition_variable jobAdded, jobsFinished;
+
+
+    ThreadPool(const ThreadPool& cpy) = delete;
+    ThreadPool& operator=(const ThreadPool& cpy) = delete;
+
+    void RunWorker(void);
+};
@@ -1,5 +1,6 @@
 #include "K1LL/Room Editor/RoomEditor.h"
 #include "K1LL/GUI Pages/PageManager.h"
+#include "Benchmarks/Benchmarks.h"
 
 //TODO: Add a "Skybox" class in "Rendering/Helper Classes" that simplifies creation/modification/rendering of a cubemapped skybox.
 
@@ -7,5 +8,8 @@
 int main()
 {
     //RoomEditor().RunWorld();
+    //Benchmarks::NormalMaps();
+    //Benchmarks::NoiseGeneration();
+    //Benchmarks::Serialization();
     PageManager().RunWorld();
 }
\ No newline at end of file